@@ -42,11 +42,33 @@
 void MX_GPIO_Init(void)
 {
 
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+
   /* GPIO Ports Clock Enable */
   __HAL_RCC_GPIOD_CLK_ENABLE();
   __HAL_RCC_GPIOB_CLK_ENABLE();
   __HAL_RCC_GPIOA_CLK_ENABLE();
 
+  /*Configure GPIO pins : PB0 PB1 */
+  GPIO_InitStruct.Pin = GPIO_PIN_0|GPIO_PIN_1;
+#ifdef FY_ENCODER_EXTI
+  GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING_FALLING;
+#else
+  /* the encoder is counted by TIM4 on PB6/PB7 (tim.c), no interrupt per edge */
+  GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+#endif
+  GPIO_InitStruct.Pull = GPIO_PULLUP;
+  HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+
+#ifdef FY_ENCODER_EXTI
+  /* EXTI interrupt init, below the UART/DMA/I2C interrupts (priority 0) */
+  HAL_NVIC_SetPriority(EXTI0_IRQn, 1, 0);
+  HAL_NVIC_EnableIRQ(EXTI0_IRQn);
+
+  HAL_NVIC_SetPriority(EXTI1_IRQn, 1, 0);
+  HAL_NVIC_EnableIRQ(EXTI1_IRQn);
+#endif
+
 }
 
 /* USER CODE BEGIN 2 */
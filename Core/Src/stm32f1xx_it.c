@@ -22,6 +22,16 @@
 #include "stm32f1xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#ifdef FY_USE_RTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+#ifdef FY_TRACE
+#include "fy_trace.h"
+#else
+#define FY_TRACE_ISR_ENTER(id)
+#define FY_TRACE_ISR_EXIT(id)
+#endif
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -46,7 +56,10 @@
 
 /* Private function prototypes -----------------------------------------------*/
 /* USER CODE BEGIN PFP */
-
+#ifdef FY_USE_RTOS
+/* FreeRTOS port.c; SVC/PendSV are taken over by the kernel (see FreeRTOSConfig.h) */
+extern void xPortSysTickHandler(void);
+#endif
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
@@ -57,6 +70,7 @@
 /* External variables --------------------------------------------------------*/
 extern DMA_HandleTypeDef hdma_usart1_tx;
 extern DMA_HandleTypeDef hdma_usart1_rx;
+extern I2C_HandleTypeDef hi2c2;
 extern UART_HandleTypeDef huart1;
 /* USER CODE BEGIN EV */
 
@@ -185,11 +199,17 @@ void PendSV_Handler(void)
 void SysTick_Handler(void)
 {
   /* USER CODE BEGIN SysTick_IRQn 0 */
-
+  FY_TRACE_ISR_ENTER(FY_TRACE_ID_SYSTICK);
   /* USER CODE END SysTick_IRQn 0 */
   HAL_IncTick();
   /* USER CODE BEGIN SysTick_IRQn 1 */
-
+#ifdef FY_USE_RTOS
+  if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+  {
+    xPortSysTickHandler();
+  }
+#endif
+  FY_TRACE_ISR_EXIT(FY_TRACE_ID_SYSTICK);
   /* USER CODE END SysTick_IRQn 1 */
 }
 
@@ -200,17 +220,45 @@ void SysTick_Handler(void)
 /* please refer to the startup file (startup_stm32f1xx.s).                    */
 /******************************************************************************/
 
+/**
+  * @brief This function handles EXTI line0 interrupt.
+  */
+void EXTI0_IRQHandler(void)
+{
+  /* USER CODE BEGIN EXTI0_IRQn 0 */
+  FY_TRACE_ISR_ENTER(FY_TRACE_ID_EXTI0);
+  /* USER CODE END EXTI0_IRQn 0 */
+  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_0);
+  /* USER CODE BEGIN EXTI0_IRQn 1 */
+  FY_TRACE_ISR_EXIT(FY_TRACE_ID_EXTI0);
+  /* USER CODE END EXTI0_IRQn 1 */
+}
+
+/**
+  * @brief This function handles EXTI line1 interrupt.
+  */
+void EXTI1_IRQHandler(void)
+{
+  /* USER CODE BEGIN EXTI1_IRQn 0 */
+  FY_TRACE_ISR_ENTER(FY_TRACE_ID_EXTI1);
+  /* USER CODE END EXTI1_IRQn 0 */
+  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_1);
+  /* USER CODE BEGIN EXTI1_IRQn 1 */
+  FY_TRACE_ISR_EXIT(FY_TRACE_ID_EXTI1);
+  /* USER CODE END EXTI1_IRQn 1 */
+}
+
 /**
   * @brief This function handles DMA1 channel4 global interrupt.
   */
 void DMA1_Channel4_IRQHandler(void)
 {
   /* USER CODE BEGIN DMA1_Channel4_IRQn 0 */
-
+  FY_TRACE_ISR_ENTER(FY_TRACE_ID_DMA1_CH4);
   /* USER CODE END DMA1_Channel4_IRQn 0 */
   HAL_DMA_IRQHandler(&hdma_usart1_tx);
   /* USER CODE BEGIN DMA1_Channel4_IRQn 1 */
-
+  FY_TRACE_ISR_EXIT(FY_TRACE_ID_DMA1_CH4);
   /* USER CODE END DMA1_Channel4_IRQn 1 */
 }
 
@@ -220,25 +268,53 @@ void DMA1_Channel4_IRQHandler(void)
 void DMA1_Channel5_IRQHandler(void)
 {
   /* USER CODE BEGIN DMA1_Channel5_IRQn 0 */
-
+  FY_TRACE_ISR_ENTER(FY_TRACE_ID_DMA1_CH5);
   /* USER CODE END DMA1_Channel5_IRQn 0 */
   HAL_DMA_IRQHandler(&hdma_usart1_rx);
   /* USER CODE BEGIN DMA1_Channel5_IRQn 1 */
-
+  FY_TRACE_ISR_EXIT(FY_TRACE_ID_DMA1_CH5);
   /* USER CODE END DMA1_Channel5_IRQn 1 */
 }
 
+/**
+  * @brief This function handles I2C2 event interrupt.
+  */
+void I2C2_EV_IRQHandler(void)
+{
+  /* USER CODE BEGIN I2C2_EV_IRQn 0 */
+  FY_TRACE_ISR_ENTER(FY_TRACE_ID_I2C2_EV);
+  /* USER CODE END I2C2_EV_IRQn 0 */
+  HAL_I2C_EV_IRQHandler(&hi2c2);
+  /* USER CODE BEGIN I2C2_EV_IRQn 1 */
+  FY_TRACE_ISR_EXIT(FY_TRACE_ID_I2C2_EV);
+  /* USER CODE END I2C2_EV_IRQn 1 */
+}
+
+/**
+  * @brief This function handles I2C2 error interrupt.
+  */
+void I2C2_ER_IRQHandler(void)
+{
+  /* USER CODE BEGIN I2C2_ER_IRQn 0 */
+  FY_TRACE_ISR_ENTER(FY_TRACE_ID_I2C2_ER);
+  /* USER CODE END I2C2_ER_IRQn 0 */
+  HAL_I2C_ER_IRQHandler(&hi2c2);
+  /* USER CODE BEGIN I2C2_ER_IRQn 1 */
+  FY_TRACE_ISR_EXIT(FY_TRACE_ID_I2C2_ER);
+  /* USER CODE END I2C2_ER_IRQn 1 */
+}
+
 /**
   * @brief This function handles USART1 global interrupt.
   */
 void USART1_IRQHandler(void)
 {
   /* USER CODE BEGIN USART1_IRQn 0 */
-
+  FY_TRACE_ISR_ENTER(FY_TRACE_ID_USART1);
   /* USER CODE END USART1_IRQn 0 */
   HAL_UART_IRQHandler(&huart1);
   /* USER CODE BEGIN USART1_IRQn 1 */
-
+  FY_TRACE_ISR_EXIT(FY_TRACE_ID_USART1);
   /* USER CODE END USART1_IRQn 1 */
 }
 
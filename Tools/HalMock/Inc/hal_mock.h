@@ -0,0 +1,104 @@
+/*
+说明
+    HAL替身(stm32f1xx_hal.h)的模拟控制接口，供主机上的单元测试与吞吐量基准使用。
+    驱动与中间件按目标板源码原样编译，通过HAL句柄与回调和模拟的外设交互。
+
+时间:
+    模拟时间以HCLK(72MHz)周期为单位，只在hal_mock_advance/hal_mock_run_until(以及阻塞的HAL调用)中前进，
+    HAL_GetTick = 周期数 / 72000。外设事件(移位结束、字节到达、空闲线、I2C传输结束)按时间顺序执行，
+    同一时刻的事件按USART1/2/3、I2C1/2的顺序执行。
+
+中断:
+    外设标志与中断使能同时成立时挂起对应中断号(电平触发，处理函数返回后仍成立则再次挂起)。
+    PRIMASK为0且不在中断中时立即执行，全部同优先级(与工程的NVIC配置一致)，不嵌套，
+    挂起的中断按中断号从小到大依次响应。关中断期间时间前进时中断保持挂起，
+    __set_PRIMASK(0)/__enable_irq时补执行，期间外设照常运行(例如RXNE未读时下一字节到达产生ORE)。
+    处理函数本身不占用模拟时间，hal_mock_irq_count给出各中断号的响应次数。
+
+UART时序:
+    字节时间 = 帧位数(起始位+数据位+停止位) * BRR * (HCLK/PCLK)，BRR由HAL_UART_Init按16倍过采样取整，
+    USART1在PCLK2(72MHz)，USART2/3在PCLK1(36MHz)。
+    发送：TDR空且DMAT置位时DMA立即搬入下一字节，移位寄存器空闲时TDR立即转入移位寄存器，
+    每个字节移出结束时交给发送端回调(hal_mock_uart_set_tx_sink)。
+    接收：hal_mock_uart_inject把字节排到线路上，按字节时间一个接一个到达DR，
+    DMAR置位时DMA立即取走，否则置RXNE；最后一个字节之后空闲一帧置IDLE。
+    USART1/2/3固定使用DMA1通道4/5、7/6、2/3(F103的请求映射)。
+
+I2C时序:
+    每字节9位(8位数据+ACK)，加起始、重复起始、停止各1位，SCL周期 = HCLK / ClockSpeed。
+    器件用hal_mock_i2c_attach挂到总线，按8位地址匹配，读写函数在传输结束时执行，返回-1表示NACK；
+    地址无应答时在地址字节之后结束。
+
+使用方法：
+    hal_mock_reset();                       //清空时间、中断与外设状态
+    MX_USART1_UART_Init();                  //huart1与DMA句柄，配置同Core/Src/usart.c
+    fy_uart_init_ex(&uart, &huart1, &rx_rb, &tx_rb, FY_UART_RX_DMA_IDLE);
+    hal_mock_uart_set_tx_sink(USART1, sink, ctx);
+    hal_mock_uart_inject(USART1, data, len);
+    hal_mock_advance(HAL_MOCK_MS(10));
+*/
+#ifndef __HAL_MOCK_H
+#define __HAL_MOCK_H
+
+#include "stm32f1xx_hal.h"
+
+#define HAL_MOCK_HCLK       72000000UL
+#define HAL_MOCK_PCLK1      36000000UL
+#define HAL_MOCK_PCLK2      72000000UL
+
+#define HAL_MOCK_US(us)     ((uint64_t)(us) * (HAL_MOCK_HCLK / 1000000UL))
+#define HAL_MOCK_MS(ms)     ((uint64_t)(ms) * (HAL_MOCK_HCLK / 1000UL))
+
+#ifndef HAL_MOCK_WIRE_SIZE
+#define HAL_MOCK_WIRE_SIZE  65536   //每个UART线路上排队等待到达的字节数
+#endif
+#ifndef HAL_MOCK_I2C_DEVS
+#define HAL_MOCK_I2C_DEVS   4       //每条I2C总线上的器件数
+#endif
+
+/* 发送端：每个字节移出结束时调用 */
+typedef void (*hal_mock_tx_sink_fn_t)(void *ctx, uint8_t byte);
+
+/* I2C器件，reg为寄存器地址，返回0应答，-1无应答 */
+typedef struct {
+    void *ctx;
+    int32_t (*mem_read)(void *ctx, uint16_t reg, uint8_t *data, uint16_t len);
+    int32_t (*mem_write)(void *ctx, uint16_t reg, const uint8_t *data, uint16_t len);
+} hal_mock_i2c_dev_t;
+
+typedef struct {
+    uint32_t byte_cycles;//当前字节时间(HCLK周期)
+    uint64_t tx_bytes;//移出的字节数
+    uint64_t tx_busy_cycles;//移位寄存器工作的时间
+    uint64_t rx_bytes;//到达的字节数
+    uint32_t rx_overrun;//RXNE未读时又到达字节(ORE)，该字节丢失
+    uint32_t rx_dropped;//注入时线路队列已满而丢弃的字节
+} hal_mock_uart_stats_t;
+
+typedef struct {
+    uint32_t transfers;//完成的传输次数
+    uint32_t nacks;//无应答次数
+    uint64_t bytes;//数据字节数(不含地址)
+    uint64_t busy_cycles;//总线占用时间
+} hal_mock_i2c_stats_t;
+
+void hal_mock_reset(void);
+uint64_t hal_mock_now(void);
+void hal_mock_advance(uint64_t cycles);
+uint64_t hal_mock_next_event(void);
+int32_t hal_mock_run_until(int (*cond)(void *ctx), void *ctx, uint64_t limit);
+uint32_t hal_mock_irq_count(IRQn_Type irq);
+
+void hal_mock_uart_set_tx_sink(USART_TypeDef *uart, hal_mock_tx_sink_fn_t sink, void *ctx);
+size_t hal_mock_uart_inject(USART_TypeDef *uart, const uint8_t *data, size_t len);
+void hal_mock_uart_inject_error(USART_TypeDef *uart, uint32_t sr_flags);
+int hal_mock_uart_tx_idle(USART_TypeDef *uart);
+size_t hal_mock_uart_rx_pending(USART_TypeDef *uart);
+const hal_mock_uart_stats_t *hal_mock_uart_stats(USART_TypeDef *uart);
+
+void hal_mock_dma_inject_error(DMA_Channel_TypeDef *channel);
+
+int32_t hal_mock_i2c_attach(I2C_TypeDef *i2c, uint16_t addr, const hal_mock_i2c_dev_t *dev);
+const hal_mock_i2c_stats_t *hal_mock_i2c_stats(I2C_TypeDef *i2c);
+
+#endif
@@ -0,0 +1,19 @@
+/* 主机构建的i2c.h，hi2c2与Core/Src/i2c.c配置相同(hal_mock_msp.c) */
+#ifndef __I2C_H__
+#define __I2C_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+
+extern I2C_HandleTypeDef hi2c2;
+
+void MX_I2C2_Init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __I2C_H__ */
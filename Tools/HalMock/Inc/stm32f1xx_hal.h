@@ -0,0 +1,471 @@
+/*
+说明
+    主机(x86-64 Linux)构建用的HAL替身，代替Drivers/STM32F1xx_HAL_Driver与CMSIS设备头文件。
+    只提供User/Drivers、User/Middlewares、User/hardware用到的部分：UART(中断/循环DMA+空闲线接收)、
+    DMA通道、I2C寄存器读写(阻塞/中断)、HAL_GetTick与PRIMASK。
+    句柄、字段、回调ID与返回值和F1 HAL一致，驱动源码不做任何修改即可编译；
+    回调的触发时机按HAL_UART_IRQHandler/HAL_DMA_IRQHandler的处理顺序模拟。
+
+    外设寄存器放在64K对齐的静态数组中，偏移取真实地址的低16位，
+    驱动里按(Instance >> 10)计算的槽位与目标板相同。
+    DMA地址寄存器只有32位，主机程序按非PIE链接(见CMakeLists.txt)，DMA缓冲区需为静态变量。
+
+    时间、中断与外设时序由hal_mock.c模拟，控制接口见hal_mock.h。
+*/
+#ifndef __STM32F1xx_HAL_H
+#define __STM32F1xx_HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 通用 ----------------------------------------------------------------------*/
+#define __IO    volatile
+#define UNUSED(X)   (void)X
+
+#define SET_BIT(REG, BIT)       ((REG) |= (BIT))
+#define CLEAR_BIT(REG, BIT)     ((REG) &= ~(BIT))
+#define READ_BIT(REG, BIT)      ((REG) & (BIT))
+#define WRITE_REG(REG, VAL)     ((REG) = (VAL))
+#define READ_REG(REG)           ((REG))
+/* 模拟中没有并发，LDREX/STREX循环退化为普通读改写 */
+#define ATOMIC_SET_BIT(REG, BIT)    SET_BIT(REG, BIT)
+#define ATOMIC_CLEAR_BIT(REG, BIT)  CLEAR_BIT(REG, BIT)
+
+#define HAL_MAX_DELAY   0xFFFFFFFFU
+
+typedef enum {
+    HAL_OK = 0x00U,
+    HAL_ERROR = 0x01U,
+    HAL_BUSY = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+typedef enum {
+    HAL_UNLOCKED = 0x00U,
+    HAL_LOCKED = 0x01U
+} HAL_LockTypeDef;
+
+/* 中断号与stm32f103xb.h相同，同优先级时号小的先响应 */
+typedef enum {
+    DMA1_Channel1_IRQn = 11,
+    DMA1_Channel2_IRQn = 12,
+    DMA1_Channel3_IRQn = 13,
+    DMA1_Channel4_IRQn = 14,
+    DMA1_Channel5_IRQn = 15,
+    DMA1_Channel6_IRQn = 16,
+    DMA1_Channel7_IRQn = 17,
+    I2C1_EV_IRQn = 31,
+    I2C1_ER_IRQn = 32,
+    I2C2_EV_IRQn = 33,
+    I2C2_ER_IRQn = 34,
+    USART1_IRQn = 37,
+    USART2_IRQn = 38,
+    USART3_IRQn = 39,
+} IRQn_Type;
+
+/* Cortex-M3内核 -------------------------------------------------------------*/
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t priMask);
+void __disable_irq(void);
+void __enable_irq(void);
+#define __NOP()     ((void)0)
+#define __DMB()     __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __DSB()     __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+extern uint32_t SystemCoreClock;
+
+/* 寄存器 --------------------------------------------------------------------*/
+typedef struct {
+    __IO uint32_t SR;
+    __IO uint32_t DR;
+    __IO uint32_t BRR;
+    __IO uint32_t CR1;
+    __IO uint32_t CR2;
+    __IO uint32_t CR3;
+    __IO uint32_t GTPR;
+} USART_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR1;
+    __IO uint32_t CR2;
+    __IO uint32_t OAR1;
+    __IO uint32_t OAR2;
+    __IO uint32_t DR;
+    __IO uint32_t SR1;
+    __IO uint32_t SR2;
+    __IO uint32_t CCR;
+    __IO uint32_t TRISE;
+} I2C_TypeDef;
+
+typedef struct {
+    __IO uint32_t CCR;
+    __IO uint32_t CNDTR;
+    __IO uint32_t CPAR;
+    __IO uint32_t CMAR;
+} DMA_Channel_TypeDef;
+
+/* 外设地址的低16位 */
+extern uint8_t hal_mock_periph[0x10000];
+#define HAL_MOCK_PERIPH(OFFSET)     ((void *)&hal_mock_periph[(OFFSET)])
+
+#define USART2          ((USART_TypeDef *)HAL_MOCK_PERIPH(0x4400U))
+#define USART3          ((USART_TypeDef *)HAL_MOCK_PERIPH(0x4800U))
+#define I2C1            ((I2C_TypeDef *)HAL_MOCK_PERIPH(0x5400U))
+#define I2C2            ((I2C_TypeDef *)HAL_MOCK_PERIPH(0x5800U))
+#define USART1          ((USART_TypeDef *)HAL_MOCK_PERIPH(0x3800U))
+#define DMA1_Channel1   ((DMA_Channel_TypeDef *)HAL_MOCK_PERIPH(0x0008U))
+#define DMA1_Channel2   ((DMA_Channel_TypeDef *)HAL_MOCK_PERIPH(0x001CU))
+#define DMA1_Channel3   ((DMA_Channel_TypeDef *)HAL_MOCK_PERIPH(0x0030U))
+#define DMA1_Channel4   ((DMA_Channel_TypeDef *)HAL_MOCK_PERIPH(0x0044U))
+#define DMA1_Channel5   ((DMA_Channel_TypeDef *)HAL_MOCK_PERIPH(0x0058U))
+#define DMA1_Channel6   ((DMA_Channel_TypeDef *)HAL_MOCK_PERIPH(0x006CU))
+#define DMA1_Channel7   ((DMA_Channel_TypeDef *)HAL_MOCK_PERIPH(0x0080U))
+
+#define USART_SR_PE         0x0001U
+#define USART_SR_FE         0x0002U
+#define USART_SR_NE         0x0004U
+#define USART_SR_ORE        0x0008U
+#define USART_SR_IDLE       0x0010U
+#define USART_SR_RXNE       0x0020U
+#define USART_SR_TC         0x0040U
+#define USART_SR_TXE        0x0080U
+#define USART_CR1_RE        0x0004U
+#define USART_CR1_TE        0x0008U
+#define USART_CR1_IDLEIE    0x0010U
+#define USART_CR1_RXNEIE    0x0020U
+#define USART_CR1_TCIE      0x0040U
+#define USART_CR1_TXEIE     0x0080U
+#define USART_CR1_PEIE      0x0100U
+#define USART_CR1_PS        0x0200U
+#define USART_CR1_PCE       0x0400U
+#define USART_CR1_M         0x1000U
+#define USART_CR1_UE        0x2000U
+#define USART_CR2_STOP_1    0x2000U
+#define USART_CR3_EIE       0x0001U
+#define USART_CR3_DMAR      0x0040U
+#define USART_CR3_DMAT      0x0080U
+
+#define DMA_CCR_EN          0x0001U
+#define DMA_CCR_TCIE        0x0002U
+#define DMA_CCR_HTIE        0x0004U
+#define DMA_CCR_TEIE        0x0008U
+#define DMA_CCR_DIR         0x0010U
+#define DMA_CCR_CIRC        0x0020U
+#define DMA_CCR_PINC        0x0040U
+#define DMA_CCR_MINC        0x0080U
+#define DMA_CCR_MEM2MEM     0x4000U
+
+/* DMA -----------------------------------------------------------------------*/
+typedef struct {
+    uint32_t Direction;
+    uint32_t PeriphInc;
+    uint32_t MemInc;
+    uint32_t PeriphDataAlignment;
+    uint32_t MemDataAlignment;
+    uint32_t Mode;
+    uint32_t Priority;
+} DMA_InitTypeDef;
+
+typedef enum {
+    HAL_DMA_STATE_RESET = 0x00U,
+    HAL_DMA_STATE_READY = 0x01U,
+    HAL_DMA_STATE_BUSY = 0x02U,
+    HAL_DMA_STATE_TIMEOUT = 0x03U
+} HAL_DMA_StateTypeDef;
+
+typedef struct __DMA_HandleTypeDef {
+    DMA_Channel_TypeDef *Instance;
+    DMA_InitTypeDef Init;
+    HAL_LockTypeDef Lock;
+    __IO HAL_DMA_StateTypeDef State;
+    void *Parent;
+    void (*XferCpltCallback)(struct __DMA_HandleTypeDef *hdma);
+    void (*XferHalfCpltCallback)(struct __DMA_HandleTypeDef *hdma);
+    void (*XferErrorCallback)(struct __DMA_HandleTypeDef *hdma);
+    void (*XferAbortCallback)(struct __DMA_HandleTypeDef *hdma);
+    __IO uint32_t ErrorCode;
+} DMA_HandleTypeDef;
+
+#define DMA_PERIPH_TO_MEMORY    0x00000000U
+#define DMA_MEMORY_TO_PERIPH    DMA_CCR_DIR
+#define DMA_MEMORY_TO_MEMORY    DMA_CCR_MEM2MEM
+#define DMA_PINC_ENABLE         DMA_CCR_PINC
+#define DMA_PINC_DISABLE        0x00000000U
+#define DMA_MINC_ENABLE         DMA_CCR_MINC
+#define DMA_MINC_DISABLE        0x00000000U
+#define DMA_PDATAALIGN_BYTE     0x00000000U
+#define DMA_MDATAALIGN_BYTE     0x00000000U
+#define DMA_NORMAL              0x00000000U
+#define DMA_CIRCULAR            DMA_CCR_CIRC
+#define DMA_PRIORITY_LOW        0x00000000U
+#define DMA_PRIORITY_HIGH       0x00002000U
+
+#define DMA_IT_TC               DMA_CCR_TCIE
+#define DMA_IT_HT               DMA_CCR_HTIE
+#define DMA_IT_TE               DMA_CCR_TEIE
+
+#define HAL_DMA_ERROR_NONE      0x00000000U
+#define HAL_DMA_ERROR_TE        0x00000001U
+#define HAL_DMA_ERROR_NO_XFER   0x00000004U
+
+#define __HAL_DMA_GET_COUNTER(__HANDLE__)   ((__HANDLE__)->Instance->CNDTR)
+#define __HAL_LINKDMA(__HANDLE__, __PPP_DMA_FIELD__, __DMA_HANDLE__) \
+    do { \
+        (__HANDLE__)->__PPP_DMA_FIELD__ = &(__DMA_HANDLE__); \
+        (__DMA_HANDLE__).Parent = (__HANDLE__); \
+    } while (0U)
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma);
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef *hdma, uint32_t SrcAddress, uint32_t DstAddress, uint32_t DataLength);
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma);
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef *hdma);
+
+/* UART ----------------------------------------------------------------------*/
+typedef struct {
+    uint32_t BaudRate;
+    uint32_t WordLength;
+    uint32_t StopBits;
+    uint32_t Parity;
+    uint32_t Mode;
+    uint32_t HwFlowCtl;
+    uint32_t OverSampling;
+} UART_InitTypeDef;
+
+typedef enum {
+    HAL_UART_STATE_RESET = 0x00U,
+    HAL_UART_STATE_READY = 0x20U,
+    HAL_UART_STATE_BUSY = 0x24U,
+    HAL_UART_STATE_BUSY_TX = 0x21U,
+    HAL_UART_STATE_BUSY_RX = 0x22U,
+    HAL_UART_STATE_BUSY_TX_RX = 0x23U,
+    HAL_UART_STATE_TIMEOUT = 0xA0U,
+    HAL_UART_STATE_ERROR = 0xE0U
+} HAL_UART_StateTypeDef;
+
+typedef uint32_t HAL_UART_RxTypeTypeDef;
+typedef uint32_t HAL_UART_RxEventTypeTypeDef;
+
+#define HAL_UART_RECEPTION_STANDARD     0x00000000U
+#define HAL_UART_RECEPTION_TOIDLE       0x00000001U
+#define HAL_UART_RXEVENT_TC             0x00000000U
+#define HAL_UART_RXEVENT_HT             0x00000001U
+#define HAL_UART_RXEVENT_IDLE           0x00000002U
+
+typedef struct __UART_HandleTypeDef {
+    USART_TypeDef *Instance;
+    UART_InitTypeDef Init;
+    const uint8_t *pTxBuffPtr;
+    uint16_t TxXferSize;
+    __IO uint16_t TxXferCount;
+    uint8_t *pRxBuffPtr;
+    uint16_t RxXferSize;
+    __IO uint16_t RxXferCount;
+    __IO HAL_UART_RxTypeTypeDef ReceptionType;
+    __IO HAL_UART_RxEventTypeTypeDef RxEventType;
+    DMA_HandleTypeDef *hdmatx;
+    DMA_HandleTypeDef *hdmarx;
+    HAL_LockTypeDef Lock;
+    __IO HAL_UART_StateTypeDef gState;
+    __IO HAL_UART_StateTypeDef RxState;
+    __IO uint32_t ErrorCode;
+    void (*TxHalfCpltCallback)(struct __UART_HandleTypeDef *huart);
+    void (*TxCpltCallback)(struct __UART_HandleTypeDef *huart);
+    void (*RxHalfCpltCallback)(struct __UART_HandleTypeDef *huart);
+    void (*RxCpltCallback)(struct __UART_HandleTypeDef *huart);
+    void (*ErrorCallback)(struct __UART_HandleTypeDef *huart);
+    void (*AbortCpltCallback)(struct __UART_HandleTypeDef *huart);
+    void (*AbortTransmitCpltCallback)(struct __UART_HandleTypeDef *huart);
+    void (*AbortReceiveCpltCallback)(struct __UART_HandleTypeDef *huart);
+    void (*WakeupCallback)(struct __UART_HandleTypeDef *huart);
+    void (*RxEventCallback)(struct __UART_HandleTypeDef *huart, uint16_t Pos);
+    void (*MspInitCallback)(struct __UART_HandleTypeDef *huart);
+    void (*MspDeInitCallback)(struct __UART_HandleTypeDef *huart);
+} UART_HandleTypeDef;
+
+typedef enum {
+    HAL_UART_TX_HALFCOMPLETE_CB_ID = 0x00U,
+    HAL_UART_TX_COMPLETE_CB_ID = 0x01U,
+    HAL_UART_RX_HALFCOMPLETE_CB_ID = 0x02U,
+    HAL_UART_RX_COMPLETE_CB_ID = 0x03U,
+    HAL_UART_ERROR_CB_ID = 0x04U,
+    HAL_UART_ABORT_COMPLETE_CB_ID = 0x05U,
+    HAL_UART_ABORT_TRANSMIT_COMPLETE_CB_ID = 0x06U,
+    HAL_UART_ABORT_RECEIVE_COMPLETE_CB_ID = 0x07U,
+    HAL_UART_WAKEUP_CB_ID = 0x08U,
+    HAL_UART_MSPINIT_CB_ID = 0x0BU,
+    HAL_UART_MSPDEINIT_CB_ID = 0x0CU
+} HAL_UART_CallbackIDTypeDef;
+
+typedef void (*pUART_CallbackTypeDef)(UART_HandleTypeDef *huart);
+typedef void (*pUART_RxEventCallbackTypeDef)(UART_HandleTypeDef *huart, uint16_t Pos);
+
+#define HAL_UART_ERROR_NONE     0x00000000U
+#define HAL_UART_ERROR_PE       0x00000001U
+#define HAL_UART_ERROR_NE       0x00000002U
+#define HAL_UART_ERROR_FE       0x00000004U
+#define HAL_UART_ERROR_ORE      0x00000008U
+#define HAL_UART_ERROR_DMA      0x00000010U
+#define HAL_UART_ERROR_INVALID_CALLBACK 0x00000020U
+
+#define UART_WORDLENGTH_8B      0x00000000U
+#define UART_WORDLENGTH_9B      USART_CR1_M
+#define UART_STOPBITS_1         0x00000000U
+#define UART_STOPBITS_2         USART_CR2_STOP_1
+#define UART_PARITY_NONE        0x00000000U
+#define UART_PARITY_EVEN        USART_CR1_PCE
+#define UART_PARITY_ODD         (USART_CR1_PCE | USART_CR1_PS)
+#define UART_MODE_TX_RX         (USART_CR1_TE | USART_CR1_RE)
+#define UART_HWCONTROL_NONE     0x00000000U
+#define UART_OVERSAMPLING_16    0x00000000U
+
+/* 中断位编码与HAL相同：bit28~31为寄存器序号，低16位为使能位 */
+#define UART_CR1_REG_INDEX      1U
+#define UART_CR2_REG_INDEX      2U
+#define UART_CR3_REG_INDEX      3U
+#define UART_IT_MASK            0x0000FFFFU
+#define UART_IT_PE              ((uint32_t)(UART_CR1_REG_INDEX << 28U | USART_CR1_PEIE))
+#define UART_IT_TXE             ((uint32_t)(UART_CR1_REG_INDEX << 28U | USART_CR1_TXEIE))
+#define UART_IT_TC              ((uint32_t)(UART_CR1_REG_INDEX << 28U | USART_CR1_TCIE))
+#define UART_IT_RXNE            ((uint32_t)(UART_CR1_REG_INDEX << 28U | USART_CR1_RXNEIE))
+#define UART_IT_IDLE            ((uint32_t)(UART_CR1_REG_INDEX << 28U | USART_CR1_IDLEIE))
+#define UART_IT_ERR             ((uint32_t)(UART_CR3_REG_INDEX << 28U | USART_CR3_EIE))
+
+#define __HAL_UART_ENABLE_IT(__HANDLE__, __INTERRUPT__) \
+    ((((__INTERRUPT__) >> 28U) == UART_CR1_REG_INDEX) ? ((__HANDLE__)->Instance->CR1 |= ((__INTERRUPT__) & UART_IT_MASK)) : \
+     (((__INTERRUPT__) >> 28U) == UART_CR2_REG_INDEX) ? ((__HANDLE__)->Instance->CR2 |= ((__INTERRUPT__) & UART_IT_MASK)) : \
+     ((__HANDLE__)->Instance->CR3 |= ((__INTERRUPT__) & UART_IT_MASK)))
+#define __HAL_UART_DISABLE_IT(__HANDLE__, __INTERRUPT__) \
+    ((((__INTERRUPT__) >> 28U) == UART_CR1_REG_INDEX) ? ((__HANDLE__)->Instance->CR1 &= ~((__INTERRUPT__) & UART_IT_MASK)) : \
+     (((__INTERRUPT__) >> 28U) == UART_CR2_REG_INDEX) ? ((__HANDLE__)->Instance->CR2 &= ~((__INTERRUPT__) & UART_IT_MASK)) : \
+     ((__HANDLE__)->Instance->CR3 &= ~((__INTERRUPT__) & UART_IT_MASK)))
+#define __HAL_UART_GET_FLAG(__HANDLE__, __FLAG__)   (((__HANDLE__)->Instance->SR & (__FLAG__)) == (__FLAG__))
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart);
+void HAL_UART_MspInit(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_Abort(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UART_RegisterCallback(UART_HandleTypeDef *huart, HAL_UART_CallbackIDTypeDef CallbackID, pUART_CallbackTypeDef pCallback);
+HAL_StatusTypeDef HAL_UART_UnRegisterCallback(UART_HandleTypeDef *huart, HAL_UART_CallbackIDTypeDef CallbackID);
+HAL_StatusTypeDef HAL_UART_RegisterRxEventCallback(UART_HandleTypeDef *huart, pUART_RxEventCallbackTypeDef pCallback);
+HAL_StatusTypeDef HAL_UART_UnRegisterRxEventCallback(UART_HandleTypeDef *huart);
+void HAL_UART_IRQHandler(UART_HandleTypeDef *huart);
+
+/* I2C -----------------------------------------------------------------------*/
+typedef struct {
+    uint32_t ClockSpeed;
+    uint32_t DutyCycle;
+    uint32_t OwnAddress1;
+    uint32_t AddressingMode;
+    uint32_t DualAddressMode;
+    uint32_t OwnAddress2;
+    uint32_t GeneralCallMode;
+    uint32_t NoStretchMode;
+} I2C_InitTypeDef;
+
+typedef enum {
+    HAL_I2C_STATE_RESET = 0x00U,
+    HAL_I2C_STATE_READY = 0x20U,
+    HAL_I2C_STATE_BUSY = 0x24U,
+    HAL_I2C_STATE_BUSY_TX = 0x21U,
+    HAL_I2C_STATE_BUSY_RX = 0x22U,
+    HAL_I2C_STATE_ABORT = 0x60U,
+    HAL_I2C_STATE_ERROR = 0xE0U
+} HAL_I2C_StateTypeDef;
+
+typedef enum {
+    HAL_I2C_MODE_NONE = 0x00U,
+    HAL_I2C_MODE_MASTER = 0x10U,
+    HAL_I2C_MODE_SLAVE = 0x20U,
+    HAL_I2C_MODE_MEM = 0x40U
+} HAL_I2C_ModeTypeDef;
+
+typedef struct __I2C_HandleTypeDef {
+    I2C_TypeDef *Instance;
+    I2C_InitTypeDef Init;
+    uint8_t *pBuffPtr;
+    uint16_t XferSize;
+    __IO uint16_t XferCount;
+    __IO uint32_t XferOptions;
+    __IO uint32_t PreviousState;
+    DMA_HandleTypeDef *hdmatx;
+    DMA_HandleTypeDef *hdmarx;
+    HAL_LockTypeDef Lock;
+    __IO HAL_I2C_StateTypeDef State;
+    __IO HAL_I2C_ModeTypeDef Mode;
+    __IO uint32_t ErrorCode;
+    __IO uint32_t Devaddress;
+    __IO uint32_t Memaddress;
+    __IO uint32_t MemaddSize;
+    __IO uint32_t EventCount;
+    void (*MasterTxCpltCallback)(struct __I2C_HandleTypeDef *hi2c);
+    void (*MasterRxCpltCallback)(struct __I2C_HandleTypeDef *hi2c);
+    void (*SlaveTxCpltCallback)(struct __I2C_HandleTypeDef *hi2c);
+    void (*SlaveRxCpltCallback)(struct __I2C_HandleTypeDef *hi2c);
+    void (*ListenCpltCallback)(struct __I2C_HandleTypeDef *hi2c);
+    void (*MemTxCpltCallback)(struct __I2C_HandleTypeDef *hi2c);
+    void (*MemRxCpltCallback)(struct __I2C_HandleTypeDef *hi2c);
+    void (*ErrorCallback)(struct __I2C_HandleTypeDef *hi2c);
+    void (*AbortCpltCallback)(struct __I2C_HandleTypeDef *hi2c);
+    void (*MspInitCallback)(struct __I2C_HandleTypeDef *hi2c);
+    void (*MspDeInitCallback)(struct __I2C_HandleTypeDef *hi2c);
+} I2C_HandleTypeDef;
+
+typedef enum {
+    HAL_I2C_MASTER_TX_COMPLETE_CB_ID = 0x00U,
+    HAL_I2C_MASTER_RX_COMPLETE_CB_ID = 0x01U,
+    HAL_I2C_SLAVE_TX_COMPLETE_CB_ID = 0x02U,
+    HAL_I2C_SLAVE_RX_COMPLETE_CB_ID = 0x03U,
+    HAL_I2C_LISTEN_COMPLETE_CB_ID = 0x04U,
+    HAL_I2C_MEM_TX_COMPLETE_CB_ID = 0x05U,
+    HAL_I2C_MEM_RX_COMPLETE_CB_ID = 0x06U,
+    HAL_I2C_ERROR_CB_ID = 0x07U,
+    HAL_I2C_ABORT_CB_ID = 0x08U,
+    HAL_I2C_MSPINIT_CB_ID = 0x09U,
+    HAL_I2C_MSPDEINIT_CB_ID = 0x0AU
+} HAL_I2C_CallbackIDTypeDef;
+
+typedef void (*pI2C_CallbackTypeDef)(I2C_HandleTypeDef *hi2c);
+
+#define HAL_I2C_ERROR_NONE      0x00000000U
+#define HAL_I2C_ERROR_BERR      0x00000001U
+#define HAL_I2C_ERROR_ARLO      0x00000002U
+#define HAL_I2C_ERROR_AF        0x00000004U
+#define HAL_I2C_ERROR_OVR       0x00000008U
+#define HAL_I2C_ERROR_TIMEOUT   0x00000020U
+#define HAL_I2C_ERROR_INVALID_CALLBACK  0x00000080U
+
+#define I2C_MEMADD_SIZE_8BIT        0x00000001U
+#define I2C_MEMADD_SIZE_16BIT       0x00000010U
+#define I2C_DUTYCYCLE_2             0x00000000U
+#define I2C_ADDRESSINGMODE_7BIT     0x00004000U
+#define I2C_DUALADDRESS_DISABLE     0x00000000U
+#define I2C_GENERALCALL_DISABLE     0x00000000U
+#define I2C_NOSTRETCH_DISABLE       0x00000000U
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_MspInit(I2C_HandleTypeDef *hi2c);
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Write_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Master_Abort_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress);
+HAL_StatusTypeDef HAL_I2C_RegisterCallback(I2C_HandleTypeDef *hi2c, HAL_I2C_CallbackIDTypeDef CallbackID, pI2C_CallbackTypeDef pCallback);
+HAL_StatusTypeDef HAL_I2C_UnRegisterCallback(I2C_HandleTypeDef *hi2c, HAL_I2C_CallbackIDTypeDef CallbackID);
+void HAL_I2C_EV_IRQHandler(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_ER_IRQHandler(I2C_HandleTypeDef *hi2c);
+
+/* 时基 ----------------------------------------------------------------------*/
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
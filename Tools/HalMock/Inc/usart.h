@@ -0,0 +1,19 @@
+/* 主机构建的usart.h，huart1与Core/Src/usart.c配置相同(hal_mock_msp.c) */
+#ifndef __USART_H__
+#define __USART_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+
+extern UART_HandleTypeDef huart1;
+
+void MX_USART1_UART_Init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USART_H__ */
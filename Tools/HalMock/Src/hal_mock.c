@@ -0,0 +1,1474 @@
+/* hal_mock.c
+ * Simulated F103 peripherals behind the HAL mock: a cycle clock, NVIC-style
+ * pending/dispatch, USART with TDR/shift register and RXNE/ORE/IDLE, DMA1
+ * channels with HT/TC/TE and the I2C memory transfers. The HAL functions
+ * follow the F1 HAL code paths closely enough that callbacks arrive in the
+ * same order and from the same "interrupt" as on the target.
+ */
+#include "hal_mock.h"
+#include <string.h>
+
+uint8_t hal_mock_periph[0x10000] __attribute__((aligned(0x10000)));
+uint32_t SystemCoreClock = HAL_MOCK_HCLK;
+
+/* Private types -------------------------------------------------------------*/
+#define NEVER           UINT64_MAX
+#define IRQ_COUNT       64
+#define UART_COUNT      3
+#define I2C_COUNT       2
+#define DMA_CHANNELS    7
+
+/* DMA1->ISR的每通道标志 */
+#define DMA_FLAG_GI     0x1U
+#define DMA_FLAG_TC     0x2U
+#define DMA_FLAG_HT     0x4U
+#define DMA_FLAG_TE     0x8U
+
+typedef struct {
+    uint64_t due;
+    void (*fn)(void *obj);
+    void *obj;
+} mock_timer_t;
+
+typedef struct mock_uart mock_uart_t;
+
+typedef struct {
+    DMA_Channel_TypeDef *regs;
+    DMA_HandleTypeDef *hdma;
+    IRQn_Type irqn;
+    mock_uart_t *uart;//请求来自该USART
+    uint32_t flags;//DMA_FLAG_xx
+    uint32_t len;//CNDTR的装载值
+    uint32_t pos;//本轮已传输的数据项
+    uint8_t error_pending;
+} mock_dma_t;
+
+struct mock_uart {
+    USART_TypeDef *regs;
+    UART_HandleTypeDef *huart;
+    IRQn_Type irqn;
+    uint32_t pclk;
+    mock_dma_t *dma_tx;
+    mock_dma_t *dma_rx;
+    mock_timer_t *tx_timer;//移位结束
+    mock_timer_t *rx_timer;//字节到达
+    mock_timer_t *idle_timer;//空闲线
+    uint8_t tdr;
+    uint8_t tdr_full;
+    uint8_t shift;
+    uint8_t shift_busy;
+    uint8_t tx_servicing;
+    uint8_t tx_again;
+    uint8_t rdr;
+    uint32_t rx_error;//随下一字节到达的错误标志
+    uint8_t wire[HAL_MOCK_WIRE_SIZE];
+    size_t wire_head;
+    size_t wire_count;
+    hal_mock_tx_sink_fn_t sink;
+    void *sink_ctx;
+    hal_mock_uart_stats_t stats;
+};
+
+typedef struct {
+    uint16_t addr;
+    hal_mock_i2c_dev_t dev;
+} mock_i2c_slot_t;
+
+typedef struct {
+    I2C_TypeDef *regs;
+    I2C_HandleTypeDef *hi2c;
+    IRQn_Type ev_irqn;
+    IRQn_Type er_irqn;
+    mock_timer_t *timer;
+    mock_i2c_slot_t devs[HAL_MOCK_I2C_DEVS];
+    uint8_t op;//I2C_OP_xx
+    uint8_t done;//EV：传输完成
+    uint8_t nack;//ER：应答失败
+    uint64_t start;
+    hal_mock_i2c_stats_t stats;
+} mock_i2c_t;
+
+#define I2C_OP_NONE     0
+#define I2C_OP_READ     1
+#define I2C_OP_WRITE    2
+
+/* Private variables ---------------------------------------------------------*/
+static uint64_t now;
+static uint32_t primask;
+static uint8_t in_isr;
+static uint8_t irq_pending[IRQ_COUNT];
+static uint32_t irq_counts[IRQ_COUNT];
+
+/* 同一时刻按数组顺序执行：到达先于空闲线判断 */
+static mock_timer_t timers[UART_COUNT * 3 + I2C_COUNT];
+static mock_dma_t dma[DMA_CHANNELS];
+static mock_uart_t uarts[UART_COUNT];
+static mock_i2c_t i2cs[I2C_COUNT];
+
+/* Private functions ---------------------------------------------------------*/
+static void irq_service(int n);
+
+static void timer_start(mock_timer_t *t, uint64_t due)
+{
+    t->due = due;
+}
+
+static void timer_stop(mock_timer_t *t)
+{
+    t->due = NEVER;
+}
+
+static mock_timer_t *timer_next(void)
+{
+    mock_timer_t *next = NULL;
+
+    for (size_t i = 0; i < sizeof(timers) / sizeof(timers[0]); i++) {
+        if (timers[i].due != NEVER && (next == NULL || timers[i].due < next->due)) {
+            next = &timers[i];
+        }
+    }
+    return next;
+}
+
+/* 同优先级不嵌套：只在线程模式且未关中断时响应，号小的先响应 */
+static void irq_dispatch(void)
+{
+    while (!primask && !in_isr) {
+        int n;
+
+        for (n = 0; n < IRQ_COUNT && !irq_pending[n]; n++) {
+        }
+        if (n == IRQ_COUNT) {
+            break;
+        }
+        irq_pending[n] = 0;
+        irq_counts[n]++;
+        in_isr = 1;
+        irq_service(n);
+        in_isr = 0;
+    }
+}
+
+static void irq_set_pending(IRQn_Type n)
+{
+    irq_pending[n] = 1;
+    irq_dispatch();
+}
+
+/* DMA ----------------------------------------------------------------------*/
+static mock_dma_t *dma_of(const DMA_Channel_TypeDef *regs)
+{
+    for (int i = 0; i < DMA_CHANNELS; i++) {
+        if (dma[i].regs == regs) {
+            return &dma[i];
+        }
+    }
+    return NULL;
+}
+
+static void dma_irq_update(mock_dma_t *d)
+{
+    uint32_t ccr = d->regs->CCR;
+
+    if (((d->flags & DMA_FLAG_TC) && (ccr & DMA_CCR_TCIE)) ||
+        ((d->flags & DMA_FLAG_HT) && (ccr & DMA_CCR_HTIE)) ||
+        ((d->flags & DMA_FLAG_TE) && (ccr & DMA_CCR_TEIE))) {
+        irq_set_pending(d->irqn);
+    }
+}
+
+/* 外设发出一次请求，传输一个字节；通道未使能或已传完返回-1 */
+static int dma_request(mock_dma_t *d, uint8_t *periph)
+{
+    DMA_Channel_TypeDef *c = (d != NULL) ? d->regs : NULL;
+    uint8_t *mem;
+
+    if (c == NULL || !(c->CCR & DMA_CCR_EN) || c->CNDTR == 0) {
+        return -1;
+    }
+    if (d->error_pending) {
+        //传输错误时硬件关闭通道
+        d->error_pending = 0;
+        c->CCR &= ~DMA_CCR_EN;
+        d->flags |= DMA_FLAG_TE | DMA_FLAG_GI;
+        dma_irq_update(d);
+        return -1;
+    }
+    mem = (uint8_t *)(uintptr_t)c->CMAR + ((c->CCR & DMA_CCR_MINC) ? d->pos : 0);
+    if (c->CCR & DMA_CCR_DIR) {
+        *periph = *mem;
+    } else {
+        *mem = *periph;
+    }
+    d->pos++;
+    c->CNDTR--;
+    if (d->len >= 2 && d->pos == d->len / 2) {
+        d->flags |= DMA_FLAG_HT | DMA_FLAG_GI;
+    }
+    if (c->CNDTR == 0) {
+        d->flags |= DMA_FLAG_TC | DMA_FLAG_GI;
+        if (c->CCR & DMA_CCR_CIRC) {
+            c->CNDTR = d->len;
+            d->pos = 0;
+        }
+    }
+    dma_irq_update(d);
+    return 0;
+}
+
+/* UART ---------------------------------------------------------------------*/
+static mock_uart_t *uart_of(const USART_TypeDef *regs)
+{
+    for (int i = 0; i < UART_COUNT; i++) {
+        if (uarts[i].regs == regs) {
+            return &uarts[i];
+        }
+    }
+    return NULL;
+}
+
+static uint32_t uart_byte_cycles(const mock_uart_t *u)
+{
+    uint32_t bits = 1U + ((u->regs->CR1 & USART_CR1_M) ? 9U : 8U) + ((u->regs->CR2 & USART_CR2_STOP_1) ? 2U : 1U);
+    uint32_t brr = u->regs->BRR;
+
+    if (brr == 0) {
+        brr = (u->pclk + 115200U / 2U) / 115200U;
+    }
+    return bits * brr * (uint32_t)(HAL_MOCK_HCLK / u->pclk);
+}
+
+static void uart_irq_update(mock_uart_t *u)
+{
+    uint32_t sr = u->regs->SR, cr1 = u->regs->CR1, cr3 = u->regs->CR3;
+
+    if (((sr & USART_SR_RXNE) && (cr1 & USART_CR1_RXNEIE)) ||
+        ((sr & USART_SR_ORE) && (cr1 & USART_CR1_RXNEIE)) ||
+        ((sr & USART_SR_IDLE) && (cr1 & USART_CR1_IDLEIE)) ||
+        ((sr & USART_SR_PE) && (cr1 & USART_CR1_PEIE)) ||
+        ((sr & (USART_SR_ORE | USART_SR_NE | USART_SR_FE)) && (cr3 & USART_CR3_EIE)) ||
+        ((sr & USART_SR_TXE) && (cr1 & USART_CR1_TXEIE)) ||
+        ((sr & USART_SR_TC) && (cr1 & USART_CR1_TCIE))) {
+        irq_set_pending(u->irqn);
+    }
+}
+
+static void uart_tx_shift(mock_uart_t *u)
+{
+    u->shift = u->tdr;
+    u->tdr_full = 0;
+    u->shift_busy = 1;
+    u->stats.byte_cycles = uart_byte_cycles(u);
+    u->regs->SR |= USART_SR_TXE;
+    timer_start(u->tx_timer, now + u->stats.byte_cycles);
+}
+
+/* TDR空时DMA搬入下一字节，DMA中断里重新启动通道会再次进入，只做标记 */
+static void uart_tx_service(mock_uart_t *u)
+{
+    if (u->tx_servicing) {
+        u->tx_again = 1;
+        return;
+    }
+    u->tx_servicing = 1;
+    do {
+        u->tx_again = 0;
+        while (!u->tdr_full && (u->regs->CR1 & USART_CR1_UE) && (u->regs->CR3 & USART_CR3_DMAT) &&
+               dma_request(u->dma_tx, &u->tdr) == 0) {
+            u->tdr_full = 1;
+            u->regs->SR &= ~(USART_SR_TXE | USART_SR_TC);
+            if (!u->shift_busy) {
+                uart_tx_shift(u);
+            }
+        }
+    } while (u->tx_again);
+    u->tx_servicing = 0;
+}
+
+static void uart_tx_done(void *obj)
+{
+    mock_uart_t *u = obj;
+
+    u->stats.tx_bytes++;
+    u->stats.tx_busy_cycles += u->stats.byte_cycles;
+    u->shift_busy = 0;
+    if (u->sink != NULL) {
+        u->sink(u->sink_ctx, u->shift);
+    }
+    if (u->tdr_full) {
+        uart_tx_shift(u);
+    } else {
+        u->regs->SR |= USART_SR_TC;
+    }
+    uart_tx_service(u);
+    uart_irq_update(u);
+}
+
+/* DMAR置位时DR中的字节立即被DMA取走 */
+static void uart_rx_dma(mock_uart_t *u)
+{
+    if ((u->regs->SR & USART_SR_RXNE) && (u->regs->CR3 & USART_CR3_DMAR) && dma_request(u->dma_rx, &u->rdr) == 0) {
+        u->regs->SR &= ~USART_SR_RXNE;
+    }
+}
+
+static void uart_rx_arrive(void *obj)
+{
+    mock_uart_t *u = obj;
+    uint8_t byte = u->wire[u->wire_head];
+
+    u->wire_head = (u->wire_head + 1) % HAL_MOCK_WIRE_SIZE;
+    u->wire_count--;
+    u->stats.rx_bytes++;
+    u->stats.byte_cycles = uart_byte_cycles(u);
+    if (u->regs->CR1 & USART_CR1_UE) {
+        if (u->regs->SR & USART_SR_RXNE) {
+            //上一字节还没被读走，新字节丢失
+            u->regs->SR |= USART_SR_ORE;
+            u->stats.rx_overrun++;
+        } else {
+            u->rdr = byte;
+            u->regs->DR = byte;
+            u->regs->SR |= USART_SR_RXNE | u->rx_error;
+        }
+        u->rx_error = 0;
+        uart_rx_dma(u);
+    }
+    if (u->wire_count > 0) {
+        timer_start(u->rx_timer, now + u->stats.byte_cycles);
+    } else {
+        timer_start(u->idle_timer, now + u->stats.byte_cycles);
+    }
+    uart_irq_update(u);
+}
+
+static void uart_idle(void *obj)
+{
+    mock_uart_t *u = obj;
+
+    if (u->regs->CR1 & USART_CR1_UE) {
+        u->regs->SR |= USART_SR_IDLE;
+        uart_irq_update(u);
+    }
+}
+
+/* I2C ----------------------------------------------------------------------*/
+static mock_i2c_t *i2c_of(const I2C_TypeDef *regs)
+{
+    for (int i = 0; i < I2C_COUNT; i++) {
+        if (i2cs[i].regs == regs) {
+            return &i2cs[i];
+        }
+    }
+    return NULL;
+}
+
+static mock_i2c_slot_t *i2c_find(mock_i2c_t *m, uint16_t addr)
+{
+    for (int i = 0; i < HAL_MOCK_I2C_DEVS; i++) {
+        if (m->devs[i].dev.mem_read != NULL && m->devs[i].addr == (addr & 0xFEU)) {
+            return &m->devs[i];
+        }
+    }
+    return NULL;
+}
+
+static uint64_t i2c_bit_cycles(const I2C_HandleTypeDef *hi2c)
+{
+    uint32_t speed = (hi2c->Init.ClockSpeed != 0) ? hi2c->Init.ClockSpeed : 100000U;
+
+    return (HAL_MOCK_HCLK + speed / 2U) / speed;
+}
+
+/* 起始 + 地址 + 寄存器地址 [+ 重复起始 + 地址] + 数据 + 停止 */
+static uint64_t i2c_mem_cycles(const I2C_HandleTypeDef *hi2c, uint16_t MemAddSize, uint16_t Size, int read)
+{
+    uint32_t bits = 1U + 9U + ((MemAddSize == I2C_MEMADD_SIZE_16BIT) ? 18U : 9U) + 9U * Size + 1U;
+
+    if (read) {
+        bits += 1U + 9U;
+    }
+    return bits * i2c_bit_cycles(hi2c);
+}
+
+/* 在传输结束时访问器件，返回0应答 */
+static int32_t i2c_transfer(mock_i2c_t *m, I2C_HandleTypeDef *hi2c, int read)
+{
+    mock_i2c_slot_t *slot = i2c_find(m, (uint16_t)hi2c->Devaddress);
+    int32_t ret;
+
+    if (slot == NULL) {
+        ret = -1;
+    } else if (read) {
+        ret = slot->dev.mem_read(slot->dev.ctx, (uint16_t)hi2c->Memaddress, hi2c->pBuffPtr, hi2c->XferSize);
+    } else {
+        ret = (slot->dev.mem_write != NULL) ?
+              slot->dev.mem_write(slot->dev.ctx, (uint16_t)hi2c->Memaddress, hi2c->pBuffPtr, hi2c->XferSize) : -1;
+    }
+    m->stats.busy_cycles += now - m->start;
+    if (ret == 0) {
+        m->stats.transfers++;
+        m->stats.bytes += hi2c->XferSize;
+    } else {
+        m->stats.nacks++;
+    }
+    return ret;
+}
+
+static void i2c_done(void *obj)
+{
+    mock_i2c_t *m = obj;
+
+    if (m->op == I2C_OP_NONE || m->hi2c == NULL) {
+        return;
+    }
+    if (i2c_transfer(m, m->hi2c, m->op == I2C_OP_READ) == 0) {
+        m->done = 1;
+        irq_set_pending(m->ev_irqn);
+    } else {
+        m->nack = 1;
+        irq_set_pending(m->er_irqn);
+    }
+}
+
+static HAL_StatusTypeDef i2c_mem_start(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize,
+                                       uint8_t *pData, uint16_t Size, int read)
+{
+    if (hi2c->State != HAL_I2C_STATE_READY) {
+        return HAL_BUSY;
+    }
+    if (pData == NULL || Size == 0U) {
+        return HAL_ERROR;
+    }
+    hi2c->State = read ? HAL_I2C_STATE_BUSY_RX : HAL_I2C_STATE_BUSY_TX;
+    hi2c->Mode = HAL_I2C_MODE_MEM;
+    hi2c->ErrorCode = HAL_I2C_ERROR_NONE;
+    hi2c->pBuffPtr = pData;
+    hi2c->XferSize = Size;
+    hi2c->XferCount = Size;
+    hi2c->Devaddress = DevAddress;
+    hi2c->Memaddress = MemAddress;
+    hi2c->MemaddSize = MemAddSize;
+    return HAL_OK;
+}
+
+static void i2c_mem_end(I2C_HandleTypeDef *hi2c)
+{
+    hi2c->XferCount = 0;
+    hi2c->State = HAL_I2C_STATE_READY;
+    hi2c->Mode = HAL_I2C_MODE_NONE;
+}
+
+/* NVIC -----------------------------------------------------------------------*/
+/* 相当于stm32f1xx_it.c：按中断号调用HAL的处理函数，返回后按电平重新判断 */
+static void irq_service(int n)
+{
+    if (n >= DMA1_Channel1_IRQn && n <= DMA1_Channel7_IRQn) {
+        mock_dma_t *d = &dma[n - DMA1_Channel1_IRQn];
+
+        if (d->hdma != NULL) {
+            HAL_DMA_IRQHandler(d->hdma);
+        } else {
+            d->flags = 0;
+        }
+        dma_irq_update(d);
+    } else if (n >= USART1_IRQn && n <= USART3_IRQn) {
+        mock_uart_t *u = &uarts[n - USART1_IRQn];
+
+        if (u->huart != NULL) {
+            HAL_UART_IRQHandler(u->huart);
+        } else {
+            u->regs->CR1 &= ~(USART_CR1_RXNEIE | USART_CR1_IDLEIE | USART_CR1_TXEIE | USART_CR1_TCIE | USART_CR1_PEIE);
+        }
+        uart_irq_update(u);
+    } else if (n >= I2C1_EV_IRQn && n <= I2C2_ER_IRQn) {
+        mock_i2c_t *m = &i2cs[(n - I2C1_EV_IRQn) / 2];
+
+        if (m->hi2c == NULL) {
+            m->done = m->nack = 0;
+        } else if ((n - I2C1_EV_IRQn) % 2 == 0) {
+            HAL_I2C_EV_IRQHandler(m->hi2c);
+        } else {
+            HAL_I2C_ER_IRQHandler(m->hi2c);
+        }
+    }
+}
+
+/* Exported functions: core ---------------------------------------------------*/
+uint32_t __get_PRIMASK(void)
+{
+    return primask;
+}
+
+void __set_PRIMASK(uint32_t priMask)
+{
+    primask = priMask & 1U;
+    irq_dispatch();
+}
+
+void __disable_irq(void)
+{
+    primask = 1;
+}
+
+void __enable_irq(void)
+{
+    __set_PRIMASK(0);
+}
+
+uint32_t HAL_GetTick(void)
+{
+    return (uint32_t)(now / (HAL_MOCK_HCLK / 1000UL));
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+    hal_mock_advance(HAL_MOCK_MS(Delay));
+}
+
+/* Exported functions: DMA ----------------------------------------------------*/
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma)
+{
+    mock_dma_t *d;
+
+    if (hdma == NULL || (d = dma_of(hdma->Instance)) == NULL) {
+        return HAL_ERROR;
+    }
+    hdma->Instance->CCR = hdma->Init.Direction | hdma->Init.PeriphInc | hdma->Init.MemInc |
+                          hdma->Init.PeriphDataAlignment | hdma->Init.MemDataAlignment |
+                          hdma->Init.Mode | hdma->Init.Priority;
+    d->hdma = hdma;
+    d->flags = 0;
+    hdma->ErrorCode = HAL_DMA_ERROR_NONE;
+    hdma->State = HAL_DMA_STATE_READY;
+    hdma->Lock = HAL_UNLOCKED;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef *hdma, uint32_t SrcAddress, uint32_t DstAddress, uint32_t DataLength)
+{
+    DMA_Channel_TypeDef *c = hdma->Instance;
+    mock_dma_t *d = dma_of(c);
+
+    if (d == NULL) {
+        return HAL_ERROR;
+    }
+    if (hdma->Lock == HAL_LOCKED) {
+        return HAL_BUSY;
+    }
+    hdma->Lock = HAL_LOCKED;
+    if (hdma->State != HAL_DMA_STATE_READY) {
+        hdma->Lock = HAL_UNLOCKED;
+        return HAL_BUSY;
+    }
+    hdma->State = HAL_DMA_STATE_BUSY;
+    hdma->ErrorCode = HAL_DMA_ERROR_NONE;
+    d->hdma = hdma;
+
+    c->CCR &= ~DMA_CCR_EN;
+    //DMA_SetConfig
+    d->flags = 0;
+    c->CNDTR = DataLength;
+    d->len = DataLength;
+    d->pos = 0;
+    if (hdma->Init.Direction == DMA_MEMORY_TO_PERIPH) {
+        c->CPAR = DstAddress;
+        c->CMAR = SrcAddress;
+    } else {
+        c->CPAR = SrcAddress;
+        c->CMAR = DstAddress;
+    }
+    if (hdma->XferHalfCpltCallback != NULL) {
+        c->CCR |= DMA_IT_TC | DMA_IT_HT | DMA_IT_TE;
+    } else {
+        c->CCR &= ~DMA_IT_HT;
+        c->CCR |= DMA_IT_TC | DMA_IT_TE;
+    }
+    c->CCR |= DMA_CCR_EN;
+
+    //使能后外设的请求立即生效
+    if (d->uart != NULL) {
+        if (d == d->uart->dma_tx) {
+            uart_tx_service(d->uart);
+        } else {
+            uart_rx_dma(d->uart);
+        }
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma)
+{
+    mock_dma_t *d = dma_of(hdma->Instance);
+
+    if (hdma->State != HAL_DMA_STATE_BUSY) {
+        hdma->ErrorCode = HAL_DMA_ERROR_NO_XFER;
+        hdma->Lock = HAL_UNLOCKED;
+        return HAL_ERROR;
+    }
+    hdma->Instance->CCR &= ~(DMA_IT_TC | DMA_IT_HT | DMA_IT_TE);
+    hdma->Instance->CCR &= ~DMA_CCR_EN;
+    if (d != NULL) {
+        d->flags = 0;
+    }
+    hdma->State = HAL_DMA_STATE_READY;
+    hdma->Lock = HAL_UNLOCKED;
+    return HAL_OK;
+}
+
+/* 与HAL相同：每次只处理一个标志，HT优先 */
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef *hdma)
+{
+    mock_dma_t *d = dma_of(hdma->Instance);
+    uint32_t flags = (d != NULL) ? d->flags : 0;
+    uint32_t source = hdma->Instance->CCR;
+
+    if ((flags & DMA_FLAG_HT) && (source & DMA_IT_HT)) {
+        if (!(source & DMA_CCR_CIRC)) {
+            hdma->Instance->CCR &= ~DMA_IT_HT;
+        }
+        d->flags &= ~DMA_FLAG_HT;
+        if (hdma->XferHalfCpltCallback != NULL) {
+            hdma->XferHalfCpltCallback(hdma);
+        }
+    } else if ((flags & DMA_FLAG_TC) && (source & DMA_IT_TC)) {
+        if (!(source & DMA_CCR_CIRC)) {
+            hdma->Instance->CCR &= ~(DMA_IT_TE | DMA_IT_TC);
+            hdma->State = HAL_DMA_STATE_READY;
+        }
+        d->flags &= ~DMA_FLAG_TC;
+        hdma->Lock = HAL_UNLOCKED;
+        if (hdma->XferCpltCallback != NULL) {
+            hdma->XferCpltCallback(hdma);
+        }
+    } else if ((flags & DMA_FLAG_TE) && (source & DMA_IT_TE)) {
+        hdma->Instance->CCR &= ~(DMA_IT_TC | DMA_IT_HT | DMA_IT_TE);
+        d->flags = 0;
+        hdma->ErrorCode = HAL_DMA_ERROR_TE;
+        hdma->State = HAL_DMA_STATE_READY;
+        hdma->Lock = HAL_UNLOCKED;
+        if (hdma->XferErrorCallback != NULL) {
+            hdma->XferErrorCallback(hdma);
+        }
+    }
+}
+
+/* Exported functions: UART ---------------------------------------------------*/
+__attribute__((weak)) void HAL_UART_MspInit(UART_HandleTypeDef *huart)
+{
+    UNUSED(huart);
+}
+
+static void UART_EndRxTransfer(UART_HandleTypeDef *huart)
+{
+    huart->Instance->CR1 &= ~(USART_CR1_RXNEIE | USART_CR1_PEIE);
+    huart->Instance->CR3 &= ~USART_CR3_EIE;
+    if (huart->ReceptionType == HAL_UART_RECEPTION_TOIDLE) {
+        huart->Instance->CR1 &= ~USART_CR1_IDLEIE;
+    }
+    huart->RxState = HAL_UART_STATE_READY;
+    huart->ReceptionType = HAL_UART_RECEPTION_STANDARD;
+}
+
+static void UART_Receive_IT(UART_HandleTypeDef *huart)
+{
+    if (huart->RxState != HAL_UART_STATE_BUSY_RX) {
+        return;
+    }
+    //先读SR再读DR：清除RXNE与错误标志
+    *huart->pRxBuffPtr++ = (uint8_t)huart->Instance->DR;
+    huart->Instance->SR &= ~(USART_SR_RXNE | USART_SR_ORE | USART_SR_NE | USART_SR_FE | USART_SR_PE);
+    if (--huart->RxXferCount == 0U) {
+        huart->Instance->CR1 &= ~(USART_CR1_RXNEIE | USART_CR1_PEIE);
+        huart->Instance->CR3 &= ~USART_CR3_EIE;
+        huart->RxState = HAL_UART_STATE_READY;
+        huart->RxEventType = HAL_UART_RXEVENT_TC;
+        if (huart->ReceptionType == HAL_UART_RECEPTION_TOIDLE) {
+            huart->ReceptionType = HAL_UART_RECEPTION_STANDARD;
+            huart->Instance->CR1 &= ~USART_CR1_IDLEIE;
+            if (huart->RxEventCallback != NULL) {
+                huart->RxEventCallback(huart, huart->RxXferSize);
+            }
+        } else if (huart->RxCpltCallback != NULL) {
+            huart->RxCpltCallback(huart);
+        }
+    }
+}
+
+static void UART_DMAReceiveCplt(DMA_HandleTypeDef *hdma)
+{
+    UART_HandleTypeDef *huart = (UART_HandleTypeDef *)hdma->Parent;
+
+    if (!(hdma->Instance->CCR & DMA_CCR_CIRC)) {
+        huart->RxXferCount = 0U;
+        huart->Instance->CR1 &= ~USART_CR1_PEIE;
+        huart->Instance->CR3 &= ~(USART_CR3_EIE | USART_CR3_DMAR);
+        huart->RxState = HAL_UART_STATE_READY;
+        if (huart->ReceptionType == HAL_UART_RECEPTION_TOIDLE) {
+            huart->Instance->CR1 &= ~USART_CR1_IDLEIE;
+        }
+    }
+    huart->RxEventType = HAL_UART_RXEVENT_TC;
+    if (huart->ReceptionType == HAL_UART_RECEPTION_TOIDLE) {
+        if (huart->RxEventCallback != NULL) {
+            huart->RxEventCallback(huart, huart->RxXferSize);
+        }
+    } else if (huart->RxCpltCallback != NULL) {
+        huart->RxCpltCallback(huart);
+    }
+}
+
+static void UART_DMARxHalfCplt(DMA_HandleTypeDef *hdma)
+{
+    UART_HandleTypeDef *huart = (UART_HandleTypeDef *)hdma->Parent;
+
+    huart->RxEventType = HAL_UART_RXEVENT_HT;
+    if (huart->ReceptionType == HAL_UART_RECEPTION_TOIDLE) {
+        if (huart->RxEventCallback != NULL) {
+            huart->RxEventCallback(huart, huart->RxXferSize / 2U);
+        }
+    } else if (huart->RxHalfCpltCallback != NULL) {
+        huart->RxHalfCpltCallback(huart);
+    }
+}
+
+static void UART_DMAError(DMA_HandleTypeDef *hdma)
+{
+    UART_HandleTypeDef *huart = (UART_HandleTypeDef *)hdma->Parent;
+
+    if (huart->RxState == HAL_UART_STATE_BUSY_RX && (huart->Instance->CR3 & USART_CR3_DMAR)) {
+        huart->RxXferCount = 0U;
+        UART_EndRxTransfer(huart);
+    }
+    huart->ErrorCode |= HAL_UART_ERROR_DMA;
+    if (huart->ErrorCallback != NULL) {
+        huart->ErrorCallback(huart);
+    }
+}
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart)
+{
+    mock_uart_t *u;
+    USART_TypeDef *r;
+
+    if (huart == NULL || (u = uart_of(huart->Instance)) == NULL || huart->Init.BaudRate == 0U) {
+        return HAL_ERROR;
+    }
+    r = huart->Instance;
+    if (huart->gState == HAL_UART_STATE_RESET) {
+        huart->Lock = HAL_UNLOCKED;
+        //UART_InitCallbacksToDefault：默认回调为空
+        huart->TxHalfCpltCallback = NULL;
+        huart->TxCpltCallback = NULL;
+        huart->RxHalfCpltCallback = NULL;
+        huart->RxCpltCallback = NULL;
+        huart->ErrorCallback = NULL;
+        huart->AbortCpltCallback = NULL;
+        huart->AbortTransmitCpltCallback = NULL;
+        huart->AbortReceiveCpltCallback = NULL;
+        huart->WakeupCallback = NULL;
+        huart->RxEventCallback = NULL;
+        if (huart->MspInitCallback == NULL) {
+            huart->MspInitCallback = HAL_UART_MspInit;
+        }
+        huart->MspInitCallback(huart);
+    }
+    huart->gState = HAL_UART_STATE_BUSY;
+    r->CR1 &= ~USART_CR1_UE;
+    //UART_SetConfig，BRR = PCLK / 波特率(16倍过采样的整数与小数部分合起来)
+    r->CR2 = huart->Init.StopBits;
+    r->CR1 = huart->Init.WordLength | huart->Init.Parity | huart->Init.Mode;
+    r->CR3 = huart->Init.HwFlowCtl;
+    r->BRR = (u->pclk + huart->Init.BaudRate / 2U) / huart->Init.BaudRate;
+    r->SR = USART_SR_TXE | USART_SR_TC;
+    r->CR1 |= USART_CR1_UE;
+    u->huart = huart;
+    u->stats.byte_cycles = uart_byte_cycles(u);
+    huart->ErrorCode = HAL_UART_ERROR_NONE;
+    huart->gState = HAL_UART_STATE_READY;
+    huart->RxState = HAL_UART_STATE_READY;
+    huart->ReceptionType = HAL_UART_RECEPTION_STANDARD;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    if (huart->RxState != HAL_UART_STATE_READY) {
+        return HAL_BUSY;
+    }
+    if (pData == NULL || Size == 0U) {
+        return HAL_ERROR;
+    }
+    huart->ReceptionType = HAL_UART_RECEPTION_STANDARD;
+    huart->pRxBuffPtr = pData;
+    huart->RxXferSize = Size;
+    huart->RxXferCount = Size;
+    huart->ErrorCode = HAL_UART_ERROR_NONE;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    if (huart->Init.Parity != UART_PARITY_NONE) {
+        huart->Instance->CR1 |= USART_CR1_PEIE;
+    }
+    huart->Instance->CR3 |= USART_CR3_EIE;
+    huart->Instance->CR1 |= USART_CR1_RXNEIE;
+    //DR中已有未读字节时中断立即挂起
+    uart_irq_update(uart_of(huart->Instance));
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    mock_uart_t *u = uart_of(huart->Instance);
+
+    if (huart->RxState != HAL_UART_STATE_READY) {
+        return HAL_BUSY;
+    }
+    if (pData == NULL || Size == 0U || huart->hdmarx == NULL) {
+        return HAL_ERROR;
+    }
+    huart->ReceptionType = HAL_UART_RECEPTION_TOIDLE;
+    huart->RxEventType = HAL_UART_RXEVENT_TC;
+    //UART_Start_Receive_DMA
+    huart->pRxBuffPtr = pData;
+    huart->RxXferSize = Size;
+    huart->ErrorCode = HAL_UART_ERROR_NONE;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    huart->hdmarx->XferCpltCallback = UART_DMAReceiveCplt;
+    huart->hdmarx->XferHalfCpltCallback = UART_DMARxHalfCplt;
+    huart->hdmarx->XferErrorCallback = UART_DMAError;
+    huart->hdmarx->XferAbortCallback = NULL;
+    HAL_DMA_Start_IT(huart->hdmarx, (uint32_t)(uintptr_t)&huart->Instance->DR, (uint32_t)(uintptr_t)pData, Size);
+    //__HAL_UART_CLEAR_OREFLAG：读SR再读DR
+    huart->Instance->SR &= ~(USART_SR_ORE | USART_SR_RXNE | USART_SR_NE | USART_SR_FE | USART_SR_PE);
+    if (huart->Init.Parity != UART_PARITY_NONE) {
+        huart->Instance->CR1 |= USART_CR1_PEIE;
+    }
+    huart->Instance->CR3 |= USART_CR3_EIE;
+    huart->Instance->CR3 |= USART_CR3_DMAR;
+    //__HAL_UART_CLEAR_IDLEFLAG
+    huart->Instance->SR &= ~USART_SR_IDLE;
+    huart->Instance->CR1 |= USART_CR1_IDLEIE;
+    uart_rx_dma(u);
+    uart_irq_update(u);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Abort(UART_HandleTypeDef *huart)
+{
+    USART_TypeDef *r = huart->Instance;
+
+    r->CR1 &= ~(USART_CR1_RXNEIE | USART_CR1_PEIE | USART_CR1_TXEIE | USART_CR1_TCIE);
+    r->CR3 &= ~USART_CR3_EIE;
+    if (huart->ReceptionType == HAL_UART_RECEPTION_TOIDLE) {
+        r->CR1 &= ~USART_CR1_IDLEIE;
+    }
+    if (r->CR3 & USART_CR3_DMAT) {
+        r->CR3 &= ~USART_CR3_DMAT;
+        if (huart->hdmatx != NULL) {
+            huart->hdmatx->XferAbortCallback = NULL;
+            HAL_DMA_Abort(huart->hdmatx);
+        }
+    }
+    if (r->CR3 & USART_CR3_DMAR) {
+        r->CR3 &= ~USART_CR3_DMAR;
+        if (huart->hdmarx != NULL) {
+            huart->hdmarx->XferAbortCallback = NULL;
+            HAL_DMA_Abort(huart->hdmarx);
+        }
+    }
+    huart->TxXferCount = 0U;
+    huart->RxXferCount = 0U;
+    huart->ErrorCode = HAL_UART_ERROR_NONE;
+    huart->gState = HAL_UART_STATE_READY;
+    huart->RxState = HAL_UART_STATE_READY;
+    huart->ReceptionType = HAL_UART_RECEPTION_STANDARD;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_RegisterCallback(UART_HandleTypeDef *huart, HAL_UART_CallbackIDTypeDef CallbackID, pUART_CallbackTypeDef pCallback)
+{
+    if (pCallback == NULL) {
+        huart->ErrorCode |= HAL_UART_ERROR_INVALID_CALLBACK;
+        return HAL_ERROR;
+    }
+    if (huart->gState != HAL_UART_STATE_READY) {
+        if (huart->gState == HAL_UART_STATE_RESET && CallbackID == HAL_UART_MSPINIT_CB_ID) {
+            huart->MspInitCallback = pCallback;
+            return HAL_OK;
+        }
+        huart->ErrorCode |= HAL_UART_ERROR_INVALID_CALLBACK;
+        return HAL_ERROR;
+    }
+    switch (CallbackID) {
+    case HAL_UART_TX_HALFCOMPLETE_CB_ID: huart->TxHalfCpltCallback = pCallback; break;
+    case HAL_UART_TX_COMPLETE_CB_ID: huart->TxCpltCallback = pCallback; break;
+    case HAL_UART_RX_HALFCOMPLETE_CB_ID: huart->RxHalfCpltCallback = pCallback; break;
+    case HAL_UART_RX_COMPLETE_CB_ID: huart->RxCpltCallback = pCallback; break;
+    case HAL_UART_ERROR_CB_ID: huart->ErrorCallback = pCallback; break;
+    case HAL_UART_ABORT_COMPLETE_CB_ID: huart->AbortCpltCallback = pCallback; break;
+    case HAL_UART_ABORT_TRANSMIT_COMPLETE_CB_ID: huart->AbortTransmitCpltCallback = pCallback; break;
+    case HAL_UART_ABORT_RECEIVE_COMPLETE_CB_ID: huart->AbortReceiveCpltCallback = pCallback; break;
+    case HAL_UART_WAKEUP_CB_ID: huart->WakeupCallback = pCallback; break;
+    case HAL_UART_MSPINIT_CB_ID: huart->MspInitCallback = pCallback; break;
+    case HAL_UART_MSPDEINIT_CB_ID: huart->MspDeInitCallback = pCallback; break;
+    default:
+        huart->ErrorCode |= HAL_UART_ERROR_INVALID_CALLBACK;
+        return HAL_ERROR;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_UnRegisterCallback(UART_HandleTypeDef *huart, HAL_UART_CallbackIDTypeDef CallbackID)
+{
+    if (huart->gState != HAL_UART_STATE_READY) {
+        huart->ErrorCode |= HAL_UART_ERROR_INVALID_CALLBACK;
+        return HAL_ERROR;
+    }
+    switch (CallbackID) {
+    case HAL_UART_TX_HALFCOMPLETE_CB_ID: huart->TxHalfCpltCallback = NULL; break;
+    case HAL_UART_TX_COMPLETE_CB_ID: huart->TxCpltCallback = NULL; break;
+    case HAL_UART_RX_HALFCOMPLETE_CB_ID: huart->RxHalfCpltCallback = NULL; break;
+    case HAL_UART_RX_COMPLETE_CB_ID: huart->RxCpltCallback = NULL; break;
+    case HAL_UART_ERROR_CB_ID: huart->ErrorCallback = NULL; break;
+    case HAL_UART_ABORT_COMPLETE_CB_ID: huart->AbortCpltCallback = NULL; break;
+    case HAL_UART_ABORT_TRANSMIT_COMPLETE_CB_ID: huart->AbortTransmitCpltCallback = NULL; break;
+    case HAL_UART_ABORT_RECEIVE_COMPLETE_CB_ID: huart->AbortReceiveCpltCallback = NULL; break;
+    case HAL_UART_WAKEUP_CB_ID: huart->WakeupCallback = NULL; break;
+    case HAL_UART_MSPINIT_CB_ID: huart->MspInitCallback = HAL_UART_MspInit; break;
+    case HAL_UART_MSPDEINIT_CB_ID: huart->MspDeInitCallback = NULL; break;
+    default:
+        huart->ErrorCode |= HAL_UART_ERROR_INVALID_CALLBACK;
+        return HAL_ERROR;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_RegisterRxEventCallback(UART_HandleTypeDef *huart, pUART_RxEventCallbackTypeDef pCallback)
+{
+    if (pCallback == NULL || huart->gState != HAL_UART_STATE_READY) {
+        huart->ErrorCode |= HAL_UART_ERROR_INVALID_CALLBACK;
+        return HAL_ERROR;
+    }
+    huart->RxEventCallback = pCallback;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_UnRegisterRxEventCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->gState != HAL_UART_STATE_READY) {
+        huart->ErrorCode |= HAL_UART_ERROR_INVALID_CALLBACK;
+        return HAL_ERROR;
+    }
+    huart->RxEventCallback = NULL;
+    return HAL_OK;
+}
+
+/* HAL_UART_IRQHandler中接收相关的分支，顺序相同：无错误时的RXNE、错误、IDLE */
+void HAL_UART_IRQHandler(UART_HandleTypeDef *huart)
+{
+    USART_TypeDef *r = huart->Instance;
+    uint32_t isrflags = r->SR;
+    uint32_t cr1its = r->CR1;
+    uint32_t cr3its = r->CR3;
+    uint32_t errorflags = isrflags & (USART_SR_PE | USART_SR_FE | USART_SR_ORE | USART_SR_NE);
+
+    if (errorflags == 0U && (isrflags & USART_SR_RXNE) && (cr1its & USART_CR1_RXNEIE)) {
+        UART_Receive_IT(huart);
+        return;
+    }
+    if (errorflags != 0U && ((cr3its & USART_CR3_EIE) || (cr1its & (USART_CR1_RXNEIE | USART_CR1_PEIE)))) {
+        if ((isrflags & USART_SR_PE) && (cr1its & USART_CR1_PEIE)) {
+            huart->ErrorCode |= HAL_UART_ERROR_PE;
+        }
+        if ((isrflags & USART_SR_NE) && (cr3its & USART_CR3_EIE)) {
+            huart->ErrorCode |= HAL_UART_ERROR_NE;
+        }
+        if ((isrflags & USART_SR_FE) && (cr3its & USART_CR3_EIE)) {
+            huart->ErrorCode |= HAL_UART_ERROR_FE;
+        }
+        if ((isrflags & USART_SR_ORE) && ((cr1its & USART_CR1_RXNEIE) || (cr3its & USART_CR3_EIE))) {
+            huart->ErrorCode |= HAL_UART_ERROR_ORE;
+        }
+        if (huart->ErrorCode != HAL_UART_ERROR_NONE) {
+            uint32_t dmarequest = r->CR3 & USART_CR3_DMAR;
+
+            if ((isrflags & USART_SR_RXNE) && (cr1its & USART_CR1_RXNEIE)) {
+                UART_Receive_IT(huart);
+            }
+            r->SR &= ~errorflags;
+            if ((huart->ErrorCode & HAL_UART_ERROR_ORE) || dmarequest) {
+                //阻塞性错误：结束接收，DMA模式同时停止DMA
+                UART_EndRxTransfer(huart);
+                if (r->CR3 & USART_CR3_DMAR) {
+                    r->CR3 &= ~USART_CR3_DMAR;
+                    if (huart->hdmarx != NULL) {
+                        HAL_DMA_Abort(huart->hdmarx);
+                        huart->RxXferCount = 0U;
+                    }
+                }
+                if (huart->ErrorCallback != NULL) {
+                    huart->ErrorCallback(huart);
+                }
+            } else {
+                if (huart->ErrorCallback != NULL) {
+                    huart->ErrorCallback(huart);
+                }
+                huart->ErrorCode = HAL_UART_ERROR_NONE;
+            }
+        }
+        return;
+    }
+    if (huart->ReceptionType == HAL_UART_RECEPTION_TOIDLE && (isrflags & USART_SR_IDLE) && (cr1its & USART_CR1_IDLEIE)) {
+        r->SR &= ~USART_SR_IDLE;
+        if ((r->CR3 & USART_CR3_DMAR) && huart->hdmarx != NULL) {
+            uint16_t nb_remaining_rx_data = (uint16_t)__HAL_DMA_GET_COUNTER(huart->hdmarx);
+
+            if (nb_remaining_rx_data > 0U && nb_remaining_rx_data < huart->RxXferSize) {
+                huart->RxXferCount = nb_remaining_rx_data;
+                if (huart->hdmarx->Init.Mode != DMA_CIRCULAR) {
+                    r->CR1 &= ~USART_CR1_PEIE;
+                    r->CR3 &= ~(USART_CR3_EIE | USART_CR3_DMAR);
+                    huart->RxState = HAL_UART_STATE_READY;
+                    huart->ReceptionType = HAL_UART_RECEPTION_STANDARD;
+                    r->CR1 &= ~USART_CR1_IDLEIE;
+                    HAL_DMA_Abort(huart->hdmarx);
+                }
+                huart->RxEventType = HAL_UART_RXEVENT_IDLE;
+                if (huart->RxEventCallback != NULL) {
+                    huart->RxEventCallback(huart, huart->RxXferSize - huart->RxXferCount);
+                }
+            }
+        }
+        return;
+    }
+    //发送由DMA完成，TXE/TC中断不使用
+    r->CR1 &= ~(USART_CR1_TXEIE | USART_CR1_TCIE);
+}
+
+/* Exported functions: I2C ----------------------------------------------------*/
+__attribute__((weak)) void HAL_I2C_MspInit(I2C_HandleTypeDef *hi2c)
+{
+    UNUSED(hi2c);
+}
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c)
+{
+    mock_i2c_t *m;
+
+    if (hi2c == NULL || (m = i2c_of(hi2c->Instance)) == NULL) {
+        return HAL_ERROR;
+    }
+    if (hi2c->State == HAL_I2C_STATE_RESET) {
+        hi2c->Lock = HAL_UNLOCKED;
+        hi2c->MasterTxCpltCallback = NULL;
+        hi2c->MasterRxCpltCallback = NULL;
+        hi2c->SlaveTxCpltCallback = NULL;
+        hi2c->SlaveRxCpltCallback = NULL;
+        hi2c->ListenCpltCallback = NULL;
+        hi2c->MemTxCpltCallback = NULL;
+        hi2c->MemRxCpltCallback = NULL;
+        hi2c->ErrorCallback = NULL;
+        hi2c->AbortCpltCallback = NULL;
+        if (hi2c->MspInitCallback == NULL) {
+            hi2c->MspInitCallback = HAL_I2C_MspInit;
+        }
+        hi2c->MspInitCallback(hi2c);
+    }
+    m->hi2c = hi2c;
+    m->op = I2C_OP_NONE;
+    hi2c->ErrorCode = HAL_I2C_ERROR_NONE;
+    hi2c->State = HAL_I2C_STATE_READY;
+    hi2c->Mode = HAL_I2C_MODE_NONE;
+    return HAL_OK;
+}
+
+/* 阻塞传输：总线占用期间时间前进，其他中断照常响应 */
+static HAL_StatusTypeDef i2c_mem_blocking(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize,
+                                          uint8_t *pData, uint16_t Size, uint32_t Timeout, int read)
+{
+    mock_i2c_t *m = i2c_of(hi2c->Instance);
+    uint64_t cycles = i2c_mem_cycles(hi2c, MemAddSize, Size, read);
+    HAL_StatusTypeDef status;
+
+    if (m == NULL) {
+        return HAL_ERROR;
+    }
+    if ((status = i2c_mem_start(hi2c, DevAddress, MemAddress, MemAddSize, pData, Size, read)) != HAL_OK) {
+        return status;
+    }
+    if (cycles > HAL_MOCK_MS(Timeout)) {
+        hal_mock_advance(HAL_MOCK_MS(Timeout));
+        hi2c->ErrorCode = HAL_I2C_ERROR_TIMEOUT;
+        i2c_mem_end(hi2c);
+        return HAL_TIMEOUT;
+    }
+    m->start = now;
+    hal_mock_advance(cycles);
+    if (i2c_transfer(m, hi2c, read) != 0) {
+        hi2c->ErrorCode = HAL_I2C_ERROR_AF;
+        i2c_mem_end(hi2c);
+        return HAL_ERROR;
+    }
+    i2c_mem_end(hi2c);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    return i2c_mem_blocking(hi2c, DevAddress, MemAddress, MemAddSize, pData, Size, Timeout, 0);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    return i2c_mem_blocking(hi2c, DevAddress, MemAddress, MemAddSize, pData, Size, Timeout, 1);
+}
+
+static HAL_StatusTypeDef i2c_mem_it(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize,
+                                    uint8_t *pData, uint16_t Size, int read)
+{
+    mock_i2c_t *m = i2c_of(hi2c->Instance);
+    HAL_StatusTypeDef status;
+
+    if (m == NULL) {
+        return HAL_ERROR;
+    }
+    if ((status = i2c_mem_start(hi2c, DevAddress, MemAddress, MemAddSize, pData, Size, read)) != HAL_OK) {
+        return status;
+    }
+    m->hi2c = hi2c;
+    m->op = read ? I2C_OP_READ : I2C_OP_WRITE;
+    m->done = 0;
+    m->nack = 0;
+    m->start = now;
+    //无器件时地址字节之后就失败
+    timer_start(m->timer, now + ((i2c_find(m, DevAddress) == NULL) ? 10U * i2c_bit_cycles(hi2c) :
+                                 i2c_mem_cycles(hi2c, MemAddSize, Size, read)));
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t *pData, uint16_t Size)
+{
+    return i2c_mem_it(hi2c, DevAddress, MemAddress, MemAddSize, pData, Size, 0);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t *pData, uint16_t Size)
+{
+    return i2c_mem_it(hi2c, DevAddress, MemAddress, MemAddSize, pData, Size, 1);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Abort_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress)
+{
+    mock_i2c_t *m = i2c_of(hi2c->Instance);
+
+    UNUSED(DevAddress);
+    if (m == NULL || m->op == I2C_OP_NONE || (hi2c->Mode != HAL_I2C_MODE_MASTER && hi2c->Mode != HAL_I2C_MODE_MEM)) {
+        return HAL_ERROR;
+    }
+    timer_stop(m->timer);
+    m->op = I2C_OP_NONE;
+    m->done = 0;
+    m->nack = 0;
+    //I2C_ITError：ABORT状态下回调AbortCpltCallback
+    i2c_mem_end(hi2c);
+    if (hi2c->AbortCpltCallback != NULL) {
+        hi2c->AbortCpltCallback(hi2c);
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_RegisterCallback(I2C_HandleTypeDef *hi2c, HAL_I2C_CallbackIDTypeDef CallbackID, pI2C_CallbackTypeDef pCallback)
+{
+    if (pCallback == NULL || hi2c->State != HAL_I2C_STATE_READY) {
+        hi2c->ErrorCode |= HAL_I2C_ERROR_INVALID_CALLBACK;
+        return HAL_ERROR;
+    }
+    switch (CallbackID) {
+    case HAL_I2C_MASTER_TX_COMPLETE_CB_ID: hi2c->MasterTxCpltCallback = pCallback; break;
+    case HAL_I2C_MASTER_RX_COMPLETE_CB_ID: hi2c->MasterRxCpltCallback = pCallback; break;
+    case HAL_I2C_SLAVE_TX_COMPLETE_CB_ID: hi2c->SlaveTxCpltCallback = pCallback; break;
+    case HAL_I2C_SLAVE_RX_COMPLETE_CB_ID: hi2c->SlaveRxCpltCallback = pCallback; break;
+    case HAL_I2C_LISTEN_COMPLETE_CB_ID: hi2c->ListenCpltCallback = pCallback; break;
+    case HAL_I2C_MEM_TX_COMPLETE_CB_ID: hi2c->MemTxCpltCallback = pCallback; break;
+    case HAL_I2C_MEM_RX_COMPLETE_CB_ID: hi2c->MemRxCpltCallback = pCallback; break;
+    case HAL_I2C_ERROR_CB_ID: hi2c->ErrorCallback = pCallback; break;
+    case HAL_I2C_ABORT_CB_ID: hi2c->AbortCpltCallback = pCallback; break;
+    case HAL_I2C_MSPINIT_CB_ID: hi2c->MspInitCallback = pCallback; break;
+    case HAL_I2C_MSPDEINIT_CB_ID: hi2c->MspDeInitCallback = pCallback; break;
+    default:
+        hi2c->ErrorCode |= HAL_I2C_ERROR_INVALID_CALLBACK;
+        return HAL_ERROR;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_UnRegisterCallback(I2C_HandleTypeDef *hi2c, HAL_I2C_CallbackIDTypeDef CallbackID)
+{
+    if (hi2c->State != HAL_I2C_STATE_READY) {
+        hi2c->ErrorCode |= HAL_I2C_ERROR_INVALID_CALLBACK;
+        return HAL_ERROR;
+    }
+    switch (CallbackID) {
+    case HAL_I2C_MASTER_TX_COMPLETE_CB_ID: hi2c->MasterTxCpltCallback = NULL; break;
+    case HAL_I2C_MASTER_RX_COMPLETE_CB_ID: hi2c->MasterRxCpltCallback = NULL; break;
+    case HAL_I2C_SLAVE_TX_COMPLETE_CB_ID: hi2c->SlaveTxCpltCallback = NULL; break;
+    case HAL_I2C_SLAVE_RX_COMPLETE_CB_ID: hi2c->SlaveRxCpltCallback = NULL; break;
+    case HAL_I2C_LISTEN_COMPLETE_CB_ID: hi2c->ListenCpltCallback = NULL; break;
+    case HAL_I2C_MEM_TX_COMPLETE_CB_ID: hi2c->MemTxCpltCallback = NULL; break;
+    case HAL_I2C_MEM_RX_COMPLETE_CB_ID: hi2c->MemRxCpltCallback = NULL; break;
+    case HAL_I2C_ERROR_CB_ID: hi2c->ErrorCallback = NULL; break;
+    case HAL_I2C_ABORT_CB_ID: hi2c->AbortCpltCallback = NULL; break;
+    case HAL_I2C_MSPINIT_CB_ID: hi2c->MspInitCallback = HAL_I2C_MspInit; break;
+    case HAL_I2C_MSPDEINIT_CB_ID: hi2c->MspDeInitCallback = NULL; break;
+    default:
+        hi2c->ErrorCode |= HAL_I2C_ERROR_INVALID_CALLBACK;
+        return HAL_ERROR;
+    }
+    return HAL_OK;
+}
+
+void HAL_I2C_EV_IRQHandler(I2C_HandleTypeDef *hi2c)
+{
+    mock_i2c_t *m = i2c_of(hi2c->Instance);
+    uint8_t op;
+
+    if (m == NULL || !m->done) {
+        return;
+    }
+    op = m->op;
+    m->done = 0;
+    m->op = I2C_OP_NONE;
+    i2c_mem_end(hi2c);
+    if (op == I2C_OP_READ) {
+        if (hi2c->MemRxCpltCallback != NULL) {
+            hi2c->MemRxCpltCallback(hi2c);
+        }
+    } else if (hi2c->MemTxCpltCallback != NULL) {
+        hi2c->MemTxCpltCallback(hi2c);
+    }
+}
+
+void HAL_I2C_ER_IRQHandler(I2C_HandleTypeDef *hi2c)
+{
+    mock_i2c_t *m = i2c_of(hi2c->Instance);
+
+    if (m == NULL || !m->nack) {
+        return;
+    }
+    //应答失败：产生停止条件，I2C_ITError回调ErrorCallback
+    m->nack = 0;
+    m->op = I2C_OP_NONE;
+    hi2c->ErrorCode |= HAL_I2C_ERROR_AF;
+    i2c_mem_end(hi2c);
+    if (hi2c->ErrorCallback != NULL) {
+        hi2c->ErrorCallback(hi2c);
+    }
+}
+
+/* Exported functions: simulation control -------------------------------------*/
+void hal_mock_reset(void)
+{
+    static const struct {
+        USART_TypeDef *regs;
+        IRQn_Type irqn;
+        uint32_t pclk;
+        int tx_ch;
+        int rx_ch;
+    } uart_cfg[UART_COUNT] = {
+        {USART1, USART1_IRQn, HAL_MOCK_PCLK2, 4, 5},
+        {USART2, USART2_IRQn, HAL_MOCK_PCLK1, 7, 6},
+        {USART3, USART3_IRQn, HAL_MOCK_PCLK1, 2, 3},
+    };
+    static DMA_Channel_TypeDef *const dma_regs[DMA_CHANNELS] = {
+        DMA1_Channel1, DMA1_Channel2, DMA1_Channel3, DMA1_Channel4, DMA1_Channel5, DMA1_Channel6, DMA1_Channel7,
+    };
+
+    memset(hal_mock_periph, 0, sizeof(hal_mock_periph));
+    memset(dma, 0, sizeof(dma));
+    memset(uarts, 0, sizeof(uarts));
+    memset(i2cs, 0, sizeof(i2cs));
+    memset(irq_pending, 0, sizeof(irq_pending));
+    memset(irq_counts, 0, sizeof(irq_counts));
+    now = 0;
+    primask = 0;
+    in_isr = 0;
+
+    for (int i = 0; i < DMA_CHANNELS; i++) {
+        dma[i].regs = dma_regs[i];
+        dma[i].irqn = (IRQn_Type)(DMA1_Channel1_IRQn + i);
+    }
+    for (int i = 0; i < UART_COUNT; i++) {
+        mock_uart_t *u = &uarts[i];
+
+        u->regs = uart_cfg[i].regs;
+        u->irqn = uart_cfg[i].irqn;
+        u->pclk = uart_cfg[i].pclk;
+        u->dma_tx = &dma[uart_cfg[i].tx_ch - 1];
+        u->dma_rx = &dma[uart_cfg[i].rx_ch - 1];
+        u->dma_tx->uart = u;
+        u->dma_rx->uart = u;
+        u->tx_timer = &timers[i * 3 + 0];
+        u->rx_timer = &timers[i * 3 + 1];
+        u->idle_timer = &timers[i * 3 + 2];
+        *u->tx_timer = (mock_timer_t){NEVER, uart_tx_done, u};
+        *u->rx_timer = (mock_timer_t){NEVER, uart_rx_arrive, u};
+        *u->idle_timer = (mock_timer_t){NEVER, uart_idle, u};
+        u->regs->SR = USART_SR_TXE | USART_SR_TC;
+        u->stats.byte_cycles = uart_byte_cycles(u);
+    }
+    for (int i = 0; i < I2C_COUNT; i++) {
+        mock_i2c_t *m = &i2cs[i];
+
+        m->regs = (i == 0) ? I2C1 : I2C2;
+        m->ev_irqn = (IRQn_Type)(I2C1_EV_IRQn + 2 * i);
+        m->er_irqn = (IRQn_Type)(I2C1_ER_IRQn + 2 * i);
+        m->timer = &timers[UART_COUNT * 3 + i];
+        *m->timer = (mock_timer_t){NEVER, i2c_done, m};
+    }
+}
+
+uint64_t hal_mock_now(void)
+{
+    return now;
+}
+
+/* 依次执行到期的外设事件，最后停在now + cycles */
+void hal_mock_advance(uint64_t cycles)
+{
+    uint64_t end = now + cycles;
+    mock_timer_t *t;
+
+    while ((t = timer_next()) != NULL && t->due <= end) {
+        if (t->due > now) {
+            now = t->due;
+        }
+        t->due = NEVER;
+        t->fn(t->obj);
+    }
+    if (end > now) {
+        now = end;
+    }
+}
+
+uint64_t hal_mock_next_event(void)
+{
+    mock_timer_t *t = timer_next();
+
+    return (t != NULL) ? t->due : NEVER;
+}
+
+/* 一个事件一个事件地前进，直到cond成立(返回0)或经过limit个周期(返回-1) */
+int32_t hal_mock_run_until(int (*cond)(void *ctx), void *ctx, uint64_t limit)
+{
+    uint64_t end = now + limit;
+
+    while (!cond(ctx)) {
+        uint64_t next = hal_mock_next_event();
+
+        if (next > end) {
+            hal_mock_advance(end - now);
+            return cond(ctx) ? 0 : -1;
+        }
+        hal_mock_advance((next > now) ? next - now : 0);
+    }
+    return 0;
+}
+
+uint32_t hal_mock_irq_count(IRQn_Type irq)
+{
+    return ((unsigned)irq < IRQ_COUNT) ? irq_counts[irq] : 0;
+}
+
+void hal_mock_uart_set_tx_sink(USART_TypeDef *uart, hal_mock_tx_sink_fn_t sink, void *ctx)
+{
+    mock_uart_t *u = uart_of(uart);
+
+    if (u != NULL) {
+        u->sink = sink;
+        u->sink_ctx = ctx;
+    }
+}
+
+/* 字节接在线路上已排队的字节之后，线路空闲时从现在开始，返回排入的字节数 */
+size_t hal_mock_uart_inject(USART_TypeDef *uart, const uint8_t *data, size_t len)
+{
+    mock_uart_t *u = uart_of(uart);
+    size_t n;
+
+    if (u == NULL) {
+        return 0;
+    }
+    for (n = 0; n < len && u->wire_count < HAL_MOCK_WIRE_SIZE; n++) {
+        u->wire[(u->wire_head + u->wire_count) % HAL_MOCK_WIRE_SIZE] = data[n];
+        u->wire_count++;
+    }
+    u->stats.rx_dropped += (uint32_t)(len - n);
+    if (n > 0 && u->rx_timer->due == NEVER) {
+        u->stats.byte_cycles = uart_byte_cycles(u);
+        timer_start(u->rx_timer, now + u->stats.byte_cycles);
+    }
+    return n;
+}
+
+/* 下一个到达的字节带上错误标志(USART_SR_NE/FE/PE) */
+void hal_mock_uart_inject_error(USART_TypeDef *uart, uint32_t sr_flags)
+{
+    mock_uart_t *u = uart_of(uart);
+
+    if (u != NULL) {
+        u->rx_error |= sr_flags & (USART_SR_NE | USART_SR_FE | USART_SR_PE);
+    }
+}
+
+int hal_mock_uart_tx_idle(USART_TypeDef *uart)
+{
+    mock_uart_t *u = uart_of(uart);
+
+    return u == NULL || (!u->shift_busy && !u->tdr_full);
+}
+
+size_t hal_mock_uart_rx_pending(USART_TypeDef *uart)
+{
+    mock_uart_t *u = uart_of(uart);
+
+    return (u != NULL) ? u->wire_count : 0;
+}
+
+const hal_mock_uart_stats_t *hal_mock_uart_stats(USART_TypeDef *uart)
+{
+    mock_uart_t *u = uart_of(uart);
+
+    return (u != NULL) ? &u->stats : NULL;
+}
+
+/* 通道的下一次传输产生TE */
+void hal_mock_dma_inject_error(DMA_Channel_TypeDef *channel)
+{
+    mock_dma_t *d = dma_of(channel);
+
+    if (d != NULL) {
+        d->error_pending = 1;
+    }
+}
+
+int32_t hal_mock_i2c_attach(I2C_TypeDef *i2c, uint16_t addr, const hal_mock_i2c_dev_t *dev)
+{
+    mock_i2c_t *m = i2c_of(i2c);
+
+    if (m == NULL || dev == NULL || dev->mem_read == NULL) {
+        return -1;
+    }
+    for (int i = 0; i < HAL_MOCK_I2C_DEVS; i++) {
+        if (m->devs[i].dev.mem_read == NULL || m->devs[i].addr == (addr & 0xFEU)) {
+            m->devs[i].addr = addr & 0xFEU;
+            m->devs[i].dev = *dev;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const hal_mock_i2c_stats_t *hal_mock_i2c_stats(I2C_TypeDef *i2c)
+{
+    mock_i2c_t *m = i2c_of(i2c);
+
+    return (m != NULL) ? &m->stats : NULL;
+}
@@ -0,0 +1,87 @@
+/* hal_mock_msp.c
+ * Host counterpart of Core/Src/usart.c and Core/Src/i2c.c: the same handles
+ * with the same CubeMX configuration, so middleware tests start from the
+ * state the target has after MX_xxx_Init. Each init clears its handles first
+ * so the peripherals can be set up again after hal_mock_reset().
+ */
+#include "usart.h"
+#include "i2c.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+UART_HandleTypeDef huart1;
+DMA_HandleTypeDef hdma_usart1_tx;
+DMA_HandleTypeDef hdma_usart1_rx;
+I2C_HandleTypeDef hi2c2;
+
+void Error_Handler(void)
+{
+    fprintf(stderr, "Error_Handler\n");
+    abort();
+}
+
+void MX_USART1_UART_Init(void)
+{
+    memset(&huart1, 0, sizeof(huart1));
+    memset(&hdma_usart1_tx, 0, sizeof(hdma_usart1_tx));
+    memset(&hdma_usart1_rx, 0, sizeof(hdma_usart1_rx));
+    huart1.Instance = USART1;
+    huart1.Init.BaudRate = 115200;
+    huart1.Init.WordLength = UART_WORDLENGTH_8B;
+    huart1.Init.StopBits = UART_STOPBITS_1;
+    huart1.Init.Parity = UART_PARITY_NONE;
+    huart1.Init.Mode = UART_MODE_TX_RX;
+    huart1.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+    huart1.Init.OverSampling = UART_OVERSAMPLING_16;
+    if (HAL_UART_Init(&huart1) != HAL_OK) {
+        Error_Handler();
+    }
+}
+
+void HAL_UART_MspInit(UART_HandleTypeDef *uartHandle)
+{
+    if (uartHandle->Instance == USART1) {
+        hdma_usart1_tx.Instance = DMA1_Channel4;
+        hdma_usart1_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+        hdma_usart1_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+        hdma_usart1_tx.Init.MemInc = DMA_MINC_ENABLE;
+        hdma_usart1_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+        hdma_usart1_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+        hdma_usart1_tx.Init.Mode = DMA_NORMAL;
+        hdma_usart1_tx.Init.Priority = DMA_PRIORITY_LOW;
+        if (HAL_DMA_Init(&hdma_usart1_tx) != HAL_OK) {
+            Error_Handler();
+        }
+        __HAL_LINKDMA(uartHandle, hdmatx, hdma_usart1_tx);
+
+        hdma_usart1_rx.Instance = DMA1_Channel5;
+        hdma_usart1_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+        hdma_usart1_rx.Init.PeriphInc = DMA_PINC_DISABLE;
+        hdma_usart1_rx.Init.MemInc = DMA_MINC_ENABLE;
+        hdma_usart1_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+        hdma_usart1_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+        hdma_usart1_rx.Init.Mode = DMA_CIRCULAR;
+        hdma_usart1_rx.Init.Priority = DMA_PRIORITY_LOW;
+        if (HAL_DMA_Init(&hdma_usart1_rx) != HAL_OK) {
+            Error_Handler();
+        }
+        __HAL_LINKDMA(uartHandle, hdmarx, hdma_usart1_rx);
+    }
+}
+
+void MX_I2C2_Init(void)
+{
+    memset(&hi2c2, 0, sizeof(hi2c2));
+    hi2c2.Instance = I2C2;
+    hi2c2.Init.ClockSpeed = 400000;
+    hi2c2.Init.DutyCycle = I2C_DUTYCYCLE_2;
+    hi2c2.Init.OwnAddress1 = 0;
+    hi2c2.Init.AddressingMode = I2C_ADDRESSINGMODE_7BIT;
+    hi2c2.Init.DualAddressMode = I2C_DUALADDRESS_DISABLE;
+    hi2c2.Init.OwnAddress2 = 0;
+    hi2c2.Init.GeneralCallMode = I2C_GENERALCALL_DISABLE;
+    hi2c2.Init.NoStretchMode = I2C_NOSTRETCH_DISABLE;
+    if (HAL_I2C_Init(&hi2c2) != HAL_OK) {
+        Error_Handler();
+    }
+}
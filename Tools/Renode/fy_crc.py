@@ -0,0 +1,30 @@
+# Renode Python peripheral: STM32F1 CRC unit at 0x40023000.
+#
+# CRC-32 polynomial 0x04C11DB7, MSB first, init 0xFFFFFFFF, no reflection, one
+# 32-bit word per DR write, the same as fy_crc32_sw (User/Drivers/Crc).
+#   DR   write: feed a word, read: current CRC
+#   IDR  8-bit scratch register
+#   CR   bit 0 resets DR to 0xFFFFFFFF
+
+if request.isInit:
+    crc = 0xFFFFFFFF
+    idr = 0
+elif request.isRead:
+    if request.offset == 0x00:
+        request.value = crc
+    elif request.offset == 0x04:
+        request.value = idr
+    else:
+        request.value = 0
+elif request.isWrite:
+    if request.offset == 0x00:
+        crc = crc ^ (request.value & 0xFFFFFFFF)
+        for i in range(32):
+            if crc & 0x80000000:
+                crc = ((crc << 1) ^ 0x04C11DB7) & 0xFFFFFFFF
+            else:
+                crc = (crc << 1) & 0xFFFFFFFF
+    elif request.offset == 0x04:
+        idr = request.value & 0xFF
+    elif request.offset == 0x08 and (request.value & 1):
+        crc = 0xFFFFFFFF
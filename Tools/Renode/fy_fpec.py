@@ -0,0 +1,70 @@
+# Renode Python peripheral: STM32F1 flash controller (FPEC) at 0x40022000.
+#
+# Enough of the register interface for the HAL and fy_flash (Tools/fy_emu.py loads
+# it next to the CPU platform):
+#   ACR      latency/prefetch, read back by HAL_RCC_ClockConfig
+#   KEYR     KEY1/KEY2 sequence clears CR.LOCK
+#   SR       EOP is set when an operation starts (CR.STRT with PER/MER, or a rising
+#            CR.PG edge), BSY always reads 0; EOP/PGERR/WRPRTERR are write-1-to-clear
+#   CR, AR   stored
+#   OBR/WRPR no read protection, no write protection
+# Programming goes straight to the flash memory of the platform and an erase does
+# not fill the page with 0xFF, the bootloader verifies what it programmed.
+# There is no interrupt line from here: fy_flash_port.c built with FY_EMU pends
+# FLASH_IRQn in software while EOPIE and EOP are set.
+
+KEY1 = 0x45670123
+KEY2 = 0xCDEF89AB
+CR_PG = 0x01
+CR_PER = 0x02
+CR_MER = 0x04
+CR_STRT = 0x40
+CR_LOCK = 0x80
+SR_W1C = 0x34
+SR_EOP = 0x20
+
+if request.isInit:
+    acr = 0x30
+    sr = 0
+    cr = CR_LOCK
+    ar = 0
+    key_stage = 0
+elif request.isRead:
+    if request.offset == 0x00:
+        request.value = acr
+    elif request.offset == 0x0C:
+        request.value = sr
+    elif request.offset == 0x10:
+        request.value = cr
+    elif request.offset == 0x14:
+        request.value = ar
+    elif request.offset == 0x1C:
+        request.value = 0x03FFFFFC
+    elif request.offset == 0x20:
+        request.value = 0xFFFFFFFF
+    else:
+        request.value = 0
+elif request.isWrite:
+    v = request.value
+    if request.offset == 0x00:
+        acr = (v & 0x1F) | (0x20 if v & 0x10 else 0)
+    elif request.offset == 0x04:
+        if key_stage == 0 and v == KEY1:
+            key_stage = 1
+        elif key_stage == 1 and v == KEY2:
+            cr = cr & ~CR_LOCK
+            key_stage = 0
+        else:
+            key_stage = 0
+    elif request.offset == 0x0C:
+        sr = sr & ~(v & SR_W1C)
+    elif request.offset == 0x10 and not (cr & CR_LOCK):
+        if (v & CR_STRT) and (v & (CR_PER | CR_MER)):
+            sr = sr | SR_EOP
+        elif (v & CR_PG) and not (cr & CR_PG):
+            sr = sr | SR_EOP
+        cr = v & ~CR_STRT
+    elif request.offset == 0x10 and (v & CR_LOCK):
+        cr = cr | CR_LOCK
+    elif request.offset == 0x14:
+        ar = v
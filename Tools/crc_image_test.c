@@ -0,0 +1,180 @@
+/*
+ * Host check of the app image CRC (User/Drivers/Crc).
+ *
+ * fy_crc32_sw must match the STM32 CRC peripheral bit for bit. The reference
+ * here is a plain bitwise CRC-32/MPEG-2 over bytes (anchored on its check
+ * value), which equals the peripheral when each little-endian word is fed
+ * most significant byte first. Then fy_image_check is run on images packed
+ * the same way as Tools/fy_image.py: a good image passes, any flipped bit,
+ * a bad length or a missing footer is reported.
+ *
+ *   crc_image_test [image.bin ...]     also check files made by fy_image.py pack
+ */
+#include "fy_crc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REGION_SIZE     (48U * 1024U)
+
+static uint32_t errors;
+static unsigned seed = 1;
+static uint32_t region[REGION_SIZE / 4];
+
+static unsigned sim_rand(unsigned max)
+{
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 16) % max;
+}
+
+/* CRC-32/MPEG-2：0x04C11DB7，初值0xFFFFFFFF，不反射，无结果异或 */
+static uint32_t ref_mpeg2(const uint8_t *data, size_t len)
+{
+    uint32_t crc = 0xFFFFFFFFUL;
+
+    while (len--) {
+        crc ^= (uint32_t)*data++ << 24;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x80000000UL) ? (crc << 1) ^ 0x04C11DB7UL : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+/* 外设按字的高位在前处理：每个字的4个字节逆序后按字节计算 */
+static uint32_t ref_words(const uint32_t *data, uint32_t words)
+{
+    uint8_t *be = malloc(words * 4U + 1U);
+    uint32_t crc;
+
+    for (uint32_t i = 0; i < words; i++) {
+        be[i * 4 + 0] = (uint8_t)(data[i] >> 24);
+        be[i * 4 + 1] = (uint8_t)(data[i] >> 16);
+        be[i * 4 + 2] = (uint8_t)(data[i] >> 8);
+        be[i * 4 + 3] = (uint8_t)data[i];
+    }
+    crc = ref_mpeg2(be, words * 4U);
+    free(be);
+    return crc;
+}
+
+static void expect(int cond, const char *what)
+{
+    if (!cond) {
+        printf("ERROR: %s\n", what);
+        errors++;
+    }
+}
+
+/* 与fy_image.py pack相同：补齐到4字节，写入魔数与长度，追加CRC */
+static uint32_t pack(uint32_t len)
+{
+    uint8_t *p = (uint8_t *)region;
+
+    memset(region, 0xFF, sizeof(region));
+    for (uint32_t i = 0; i < len; i++) p[i] = (uint8_t)sim_rand(256);
+    len = (len + 3U) & ~3U;
+    region[FY_IMAGE_MAGIC_OFFSET / 4] = FY_IMAGE_MAGIC;
+    region[FY_IMAGE_SIZE_OFFSET / 4] = len;
+    region[len / 4] = ref_words(region, len / 4);
+    return len;
+}
+
+static void test_crc(void)
+{
+    static const uint8_t check[] = "123456789";
+    uint32_t buf[64];
+
+    expect(ref_mpeg2(check, 9) == 0x0376E6E7UL, "reference CRC-32/MPEG-2 check value");
+    for (uint32_t words = 0; words <= 64; words++) {
+        for (uint32_t i = 0; i < words; i++) {
+            buf[i] = (uint32_t)sim_rand(65536) << 16 | sim_rand(65536);
+        }
+        expect(fy_crc32_sw(buf, words) == ref_words(buf, words), "fy_crc32_sw against the reference");
+        if (words >= 2) {
+            uint32_t split = sim_rand(words);
+            uint32_t crc = fy_crc32_update(fy_crc32_update(FY_CRC_INIT, buf, split), buf + split, words - split);
+
+            expect(crc == fy_crc32_sw(buf, words), "chained fy_crc32_update");
+        }
+    }
+    expect(fy_crc32(buf, 64) == fy_crc32_sw(buf, 64), "fy_crc32 falls back to software on the host");
+}
+
+static void test_image(void)
+{
+    static const uint32_t sizes[] = {FY_IMAGE_MIN_SIZE, 100, 4097, 30001, REGION_SIZE - 4};
+    uint32_t crc, len;
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        len = pack(sizes[i]);
+        expect(fy_image_check(region, REGION_SIZE, NULL, &crc) == FY_IMAGE_OK, "packed image passes");
+        expect(crc == region[len / 4], "reported crc");
+        expect(fy_image_check(region, REGION_SIZE, fy_crc32_sw, NULL) == FY_IMAGE_OK, "explicit crc_fn");
+
+        //镜像或尾部中任意一位翻转
+        for (int k = 0; k < 32; k++) {
+            uint32_t bit = sim_rand(len * 8U + 32U);
+            uint32_t word = bit / 32;
+
+            if (word == FY_IMAGE_MAGIC_OFFSET / 4 || word == FY_IMAGE_SIZE_OFFSET / 4) {
+                continue;
+            }
+            region[word] ^= 1UL << (bit % 32);
+            expect(fy_image_check(region, REGION_SIZE, NULL, NULL) == FY_IMAGE_BAD_CRC, "bit flip caught");
+            region[word] ^= 1UL << (bit % 32);
+        }
+        //区域比镜像加尾部小
+        expect(fy_image_check(region, len, NULL, NULL) == FY_IMAGE_BAD_SIZE, "footer outside the region");
+    }
+
+    len = pack(2000);
+    region[FY_IMAGE_SIZE_OFFSET / 4] = len + 4;
+    expect(fy_image_check(region, REGION_SIZE, NULL, NULL) == FY_IMAGE_BAD_CRC, "length off by a word");
+    region[FY_IMAGE_SIZE_OFFSET / 4] = len + 2;
+    expect(fy_image_check(region, REGION_SIZE, NULL, NULL) == FY_IMAGE_BAD_SIZE, "unaligned length");
+    region[FY_IMAGE_SIZE_OFFSET / 4] = 0xFFFFFFFFUL;
+    expect(fy_image_check(region, REGION_SIZE, NULL, NULL) == FY_IMAGE_BAD_SIZE, "erased length");
+    region[FY_IMAGE_MAGIC_OFFSET / 4] = 0;
+    expect(fy_image_check(region, REGION_SIZE, NULL, NULL) == FY_IMAGE_NO_FOOTER, "image without footer");
+    memset(region, 0xFF, sizeof(region));
+    expect(fy_image_check(region, REGION_SIZE, NULL, NULL) == FY_IMAGE_NO_FOOTER, "erased region");
+}
+
+static int check_file(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    size_t len;
+    uint32_t crc = 0;
+    int32_t r;
+
+    if (f == NULL) {
+        perror(path);
+        return 0;
+    }
+    memset(region, 0xFF, sizeof(region));
+    len = fread(region, 1, sizeof(region), f);
+    fclose(f);
+    r = fy_image_check(region, REGION_SIZE, NULL, &crc);
+    printf("%s: %lu bytes, %s", path, (unsigned long)len,
+           r == FY_IMAGE_OK ? "ok" : r == FY_IMAGE_NO_FOOTER ? "no footer" :
+           r == FY_IMAGE_BAD_SIZE ? "bad size" : "bad crc");
+    if (r == FY_IMAGE_OK || r == FY_IMAGE_BAD_CRC) {
+        printf(", crc 0x%08lX", (unsigned long)crc);
+    }
+    printf("\n");
+    return r == FY_IMAGE_OK;
+}
+
+int main(int argc, char **argv)
+{
+    test_crc();
+    test_image();
+    for (int i = 1; i < argc; i++) {
+        if (!check_file(argv[i])) {
+            errors++;
+        }
+    }
+    printf("%s\n", errors ? "FAIL" : "PASS");
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""
+Round trip of the binary log: encode record -> decode -> compare text.
+
+Runs the host build of elog with ELOG_BINARY_OUTPUT_ENABLE
+(Tools/elog_binary_host.c), which logs a set of printf cases as binary frames
+on stdout and writes the text each frame must decode to. The capture is then
+decoded with Tools/elog_decode.py twice, with the strings read directly from
+the ELF and through the dictionary written by 'extract', and every line is
+compared. The dictionary must hold only .rodata text strings, no code.
+
+    cmake -S User/Middlewares/easyLogger -B build/elog_host -DCMAKE_BUILD_TYPE=Release
+    cmake --build build/elog_host
+    elog_binary_check.py build/elog_host/elog_binary_host
+"""
+
+import argparse
+import io
+import os
+import subprocess
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import elog_decode  # noqa: E402
+
+
+def decode(capture, strings):
+    out = io.StringIO()
+    tail = elog_decode.decode_stream(capture, strings, out)
+    return out.getvalue(), tail
+
+
+def compare(name, got, expected):
+    errors = 0
+    got_lines = got.splitlines()
+    exp_lines = expected.splitlines()
+    for i in range(max(len(got_lines), len(exp_lines))):
+        g = got_lines[i] if i < len(got_lines) else "<missing>"
+        e = exp_lines[i] if i < len(exp_lines) else "<missing>"
+        if g != e:
+            errors += 1
+            if errors <= 10:
+                print("ERROR: %s line %d\n  expected: %s\n  decoded:  %s" % (name, i + 1, e, g))
+    return errors
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("host", help="elog_binary_host executable")
+    args = ap.parse_args()
+
+    errors = 0
+    with tempfile.TemporaryDirectory() as tmp:
+        exp_path = os.path.join(tmp, "expected.txt")
+        dict_path = os.path.join(tmp, "elogdict.json")
+        capture = subprocess.run([args.host, exp_path], check=True, stdout=subprocess.PIPE).stdout
+        with open(exp_path, encoding="utf-8") as f:
+            expected = f.read()
+
+        from_elf = elog_decode.StringTable.from_elf(args.host)
+        from_elf.save(dict_path)
+        from_dict = elog_decode.StringTable.from_dict(dict_path)
+
+        for name, strings in (("elf", from_elf), ("dict", from_dict)):
+            text, tail = decode(capture, strings)
+            if tail:
+                errors += 1
+                print("ERROR: %s: %d bytes left undecoded" % (name, len(tail)))
+            errors += compare(name, text, expected)
+
+        # the dictionary holds text strings only, never code
+        text_size = sum(len(s) + 1 for _, s in from_dict.strings)
+        for addr, s in from_dict.strings:
+            if elog_decode.text_start(s, 0, len(s)) != 0 or b"\0" in s:
+                errors += 1
+                print("ERROR: non-text entry at 0x%x" % addr)
+                break
+        print("%d bytes captured, dictionary: %d strings, %d bytes of text, %d bytes of json"
+              % (len(capture), len(from_dict.strings), text_size, os.path.getsize(dict_path)))
+        print("%d lines compared" % len(expected.splitlines()))
+
+    print("FAIL" if errors else "PASS")
+    return 1 if errors else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
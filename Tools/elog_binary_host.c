@@ -0,0 +1,129 @@
+/*
+ * Host round trip of the binary log (ELOG_BINARY_OUTPUT_ENABLE, see
+ * encode_record() in User/Middlewares/easyLogger/elog_async.c).
+ *
+ * Every case is logged through the normal elog macros; the frames, mixed with
+ * raw text output, go to stdout. The text the decoder has to produce for each
+ * case is formatted with the host printf and written to the expected file.
+ * Tools/elog_binary_check.py extracts the string table from this executable,
+ * decodes stdout with Tools/elog_decode.py and compares the two.
+ *
+ * Covered: int/long/long long/size_t/char/short conversions, flags, width and
+ * precision (also '*'), double, "%s" (also a pointer into the middle of a
+ * literal), "%p", "%%", UTF-8 text, every level, and a record that is
+ * truncated at ELOG_ASYNC_ARG_WORDS.
+ *
+ *   elog_binary_host expected.txt > capture.bin
+ */
+#include "elog.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+#define TAG             "BIN"
+
+static FILE *expected;
+static const char words[] = "alpha beta";
+static int anchor;
+
+static void stdout_out(const char *log, size_t size)
+{
+    fwrite(log, 1, size, stdout);
+}
+
+/* the line elog_decode.py renders for one record: level tag (func)message */
+static void expect(const char *lvl, const char *func, const char *fmt, ...)
+{
+    va_list args;
+
+    fprintf(expected, "%s%s (%s)", lvl, TAG, func);
+    va_start(args, fmt);
+    vfprintf(expected, fmt, args);
+    va_end(args);
+    fputc('\n', expected);
+}
+
+#define CASE(l, lvl, fmt, ...)                                                \
+    do {                                                                      \
+        elog_##l(TAG, fmt, ##__VA_ARGS__);                                    \
+        expect(lvl, __func__, fmt, ##__VA_ARGS__);                            \
+        elog_async_flush();                                                   \
+    } while (0)
+
+static void integers(void)
+{
+    CASE(i, "I/", "plain text");
+    CASE(i, "I/", "int %d %i %d", 0, -1, 2147483647);
+    CASE(i, "I/", "unsigned %u %x %X %o", 4294967295U, 0xdeadbeefU, 0xabcU, 8U);
+    CASE(i, "I/", "flags [%5d] [%-5d] [%05d] [%+d] [% d] [%#x] [%.3d]", 42, 42, -42, 7, 7, 255U, 5);
+    CASE(i, "I/", "long %ld %lu %lx", -1234567890L, 1234567890UL, 0x7fffffffUL);
+    CASE(i, "I/", "long long %lld %llu %llx", -9000000000LL, 18000000000ULL, 0x123456789abcdefULL);
+    CASE(i, "I/", "size %zu %zd", (size_t)65536, (ssize_t)-3);
+    CASE(i, "I/", "char '%c' short %hd %hu %hhd %hhx", 'Z', (short)-2, (unsigned short)65535, (signed char)-5,
+         (unsigned char)0xAB);
+    //printf把提升后的int再截回short/char
+    CASE(i, "I/", "narrow %hd %hu %hhd %hhu", 70000, -1, 300, -1);
+    CASE(i, "I/", "star [%*d] [%-*d] [%.*d]", 6, 12, 4, 3, 4, 9);
+}
+
+static void others(void)
+{
+    CASE(i, "I/", "double %f %.3f %e %g %G", 3.14159, -2.5, 1e-5, 123456789.0, 0.0001);
+    CASE(i, "I/", "string [%s] [%8s] [%-6s] [%.3s] [%.*s]", "static", "pad", "left", "precision", 2, "star");
+    CASE(i, "I/", "suffix [%s]", words + 6);
+    CASE(i, "I/", "pointer %p", (void *)&anchor);
+    CASE(i, "I/", "percent 100%% %d%%", 50);
+    CASE(i, "I/", "温度 %d℃ 状态 %s", 25, "正常");
+}
+
+static void levels(void)
+{
+    CASE(a, "A/", "assert %d", 0);
+    CASE(e, "E/", "error %d", 1);
+    CASE(w, "W/", "warn %d", 2);
+    CASE(d, "D/", "debug %d", 4);
+    CASE(v, "V/", "verbose %d", 5);
+}
+
+static void truncated(void)
+{
+    //13个int超出ELOG_ASYNC_ARG_WORDS(12)，解码到第12个后以"..."结束
+    elog_i(TAG, "%d %d %d %d %d %d %d %d %d %d %d %d %d end", 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13);
+    fprintf(expected, "I/%s (%s)1 2 3 4 5 6 7 8 9 10 11 12 ...\n", TAG, __func__);
+    elog_async_flush();
+}
+
+int main(int argc, char **argv)
+{
+    easy_logger_int_struct_t init = {0};
+
+    if (argc != 2 || (expected = fopen(argv[1], "w")) == NULL) {
+        fprintf(stderr, "usage: %s expected.txt > capture.bin\n", argv[0]);
+        return 2;
+    }
+
+    init.output = stdout_out;
+    if (elog_init(&init) != ELOG_NO_ERR) {
+        fprintf(stderr, "elog_init failed\n");
+        return 1;
+    }
+    elog_start();
+    //elog_start的版本信息，tag与格式串来自elog.c
+    fprintf(expected, "I/elog (elog_start)EasyLogger V%s is initialize success.\n\n", ELOG_SW_VERSION);
+    elog_async_flush();
+
+    //raw输出不经过二进制编码，解码器原样透传
+    elog_raw("raw text before the frames %d\n", 1);
+    fprintf(expected, "raw text before the frames %d\n", 1);
+    integers();
+    others();
+    elog_raw("raw text between the frames\n");
+    fprintf(expected, "raw text between the frames\n");
+    levels();
+    truncated();
+
+    elog_deinit();
+    fclose(expected);
+    fflush(stdout);
+    return 0;
+}
@@ -0,0 +1,373 @@
+#!/usr/bin/env python3
+"""
+EasyLogger binary (dictionary) log decoder.
+
+With ELOG_BINARY_OUTPUT_ENABLE the target only sends the addresses of the
+format/tag/func/file strings plus the raw argument words, see encode_record()
+in User/Middlewares/easyLogger/elog_async.c. The strings are read back from
+the .rodata section of the firmware ELF; "extract" keeps only its text
+strings, so the dictionary holds no code or other constant data.
+
+    # build time: dump the string table next to the ELF
+    elog_decode.py extract STM32F103.elf -o STM32F103.elogdict.json
+
+    # decode a capture (file or stdin, e.g. from a serial port)
+    elog_decode.py decode -d STM32F103.elogdict.json capture.bin
+    elog_decode.py decode -e STM32F103.elf /dev/ttyUSB0
+
+Bytes outside valid frames (raw/hex output, boot messages) are passed through.
+"""
+
+import argparse
+import bisect
+import json
+import re
+import struct
+import sys
+
+SYNC = 0xA5
+HDR_FUNC = 1 << 3
+HDR_FILE_LINE = 1 << 4
+HDR_TRUNCATED = 1 << 5
+
+LEVELS = ["A/", "E/", "W/", "I/", "D/", "V/"]
+
+SHF_WRITE = 0x1
+SHF_ALLOC = 0x2
+SHT_PROGBITS = 1
+
+DEFAULT_ADDR_BASE = 0x08000000
+
+
+# ---------------------------------------------------------------------------
+# string table
+# ---------------------------------------------------------------------------
+
+def read_elf_strings(path):
+    """return ([(addr, bytes)], ptr_size) of the NUL-terminated text strings in .rodata
+
+    Only .rodata (and .rodata.* of unlinked objects) is read: the format, tag,
+    func and "%s" strings of a log call are string literals and land there,
+    code and other constant data are not needed to decode a frame.
+    """
+    with open(path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF":
+        raise ValueError("%s is not an ELF file" % path)
+    is64 = elf[4] == 2
+    end = "<" if elf[5] == 1 else ">"
+    if is64:
+        shoff, = struct.unpack_from(end + "Q", elf, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from(end + "HHH", elf, 0x3A)
+        sh_fmt = end + "IIQQQQIIQQ"
+    else:
+        shoff, = struct.unpack_from(end + "I", elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from(end + "HHH", elf, 0x2E)
+        sh_fmt = end + "IIIIIIIIII"
+
+    headers = [struct.unpack_from(sh_fmt, elf, shoff + i * shentsize) for i in range(shnum)]
+    names_off = headers[shstrndx][4] if shstrndx < shnum else 0
+
+    def section_name(off):
+        stop = elf.find(b"\0", names_off + off)
+        return elf[names_off + off:stop].decode("ascii", "replace")
+
+    strings = []
+    for (name, sh_type, flags, addr, offset, size, _link, _info, _align, _entsize) in headers:
+        if sh_type != SHT_PROGBITS or not flags & SHF_ALLOC or flags & SHF_WRITE or not size:
+            continue
+        name = section_name(name)
+        if name != ".rodata" and not name.startswith(".rodata."):
+            continue
+        data = elf[offset:offset + size]
+        pos = 0
+        while pos < len(data):
+            stop = data.find(b"\0", pos)
+            if stop < 0:
+                break
+            start = text_start(data, pos, stop)
+            if start < stop:
+                strings.append((addr + start, data[start:stop]))
+            pos = stop + 1
+    return strings, (8 if is64 else 4)
+
+
+TEXT_CTRL = b"\t\n\r\x1b"
+
+
+def text_start(data, pos, stop):
+    """start of the longest text tail of data[pos:stop]
+
+    A string placed right after a constant table shares its run of non-NUL
+    bytes, keep only the part after the last byte that cannot be text.
+    """
+    start = pos
+    for i in range(stop - 1, pos - 1, -1):
+        b = data[i]
+        if (b < 0x20 and b not in TEXT_CTRL) or b == 0x7F:
+            start = i + 1
+            break
+    while start < stop:
+        try:
+            data[start:stop].decode("utf-8")
+            return start
+        except UnicodeDecodeError:
+            start += 1
+    return stop
+
+
+class StringTable:
+    def __init__(self, strings, ptr_size=4, addr_base=DEFAULT_ADDR_BASE):
+        self.strings = sorted(strings)
+        self.addrs = [a for a, _ in self.strings]
+        self.ptr_size = ptr_size
+        self.addr_base = addr_base
+
+    @classmethod
+    def from_elf(cls, path, addr_base=DEFAULT_ADDR_BASE):
+        strings, ptr_size = read_elf_strings(path)
+        return cls(strings, ptr_size, addr_base)
+
+    @classmethod
+    def from_dict(cls, path):
+        with open(path, encoding="utf-8") as f:
+            d = json.load(f)
+        strings = [(int(a, 0), text.encode("utf-8")) for a, text in d["strings"]]
+        return cls(strings, d["ptr_size"], int(d["addr_base"], 0))
+
+    def save(self, path):
+        d = {
+            "ptr_size": self.ptr_size,
+            "addr_base": hex(self.addr_base),
+            "strings": [[hex(a), data.decode("utf-8")] for a, data in self.strings],
+        }
+        with open(path, "w", encoding="utf-8") as f:
+            json.dump(d, f, ensure_ascii=False)
+
+    def string(self, addr):
+        # the linker merges a string into the tail of a longer one, so a pointer
+        # may also land inside a string or on its terminating NUL
+        i = bisect.bisect_right(self.addrs, addr) - 1
+        if i < 0:
+            return None
+        base, data = self.strings[i]
+        if addr - base > len(data):
+            return None
+        return data[addr - base:].decode("utf-8", "replace")
+
+    def string_at_offset(self, offset):
+        mask = (1 << (self.ptr_size * 8)) - 1
+        return self.string((offset + self.addr_base) & mask)
+
+
+# ---------------------------------------------------------------------------
+# printf on the host
+# ---------------------------------------------------------------------------
+
+SPEC_RE = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|j|z|t|L)?([diuxXocspfFeEgGaA%])")
+
+
+class ArgReader:
+    def __init__(self, words, ptr_size):
+        self.words = words
+        self.pos = 0
+        self.ptr_size = ptr_size
+
+    def take(self, size):
+        n = (size + 3) // 4
+        if self.pos + n > len(self.words):
+            raise IndexError
+        raw = struct.pack("<%dI" % n, *self.words[self.pos:self.pos + n])
+        self.pos += n
+        return raw[:size]
+
+
+def c_format(fmt, words, strings, truncated):
+    args = ArgReader(words, strings.ptr_size)
+    out = []
+    last = 0
+
+    def int_arg(length, signed):
+        if length in ("ll", "j"):
+            size = 8
+        elif length in ("l", "z", "t"):
+            size = strings.ptr_size
+        else:
+            size = 4
+        raw = args.take(size)
+        # char/short arguments arrive promoted to int, printf narrows them again
+        if length in ("hh", "h"):
+            raw = raw[:1 if length == "hh" else 2]
+        return int.from_bytes(raw, "little", signed=signed)
+
+    for m in SPEC_RE.finditer(fmt):
+        out.append(fmt[last:m.start()])
+        last = m.end()
+        flags, width, prec, length, conv = m.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+        try:
+            if width == "*":
+                width = str(int_arg(None, True))
+            if prec == "*":
+                prec = str(int_arg(None, True))
+            spec = "%" + flags + (width or "") + ("." + prec if prec is not None else "")
+            if conv in "di":
+                out.append((spec + "d") % int_arg(length, True))
+            elif conv in "uxXo":
+                out.append((spec + ("d" if conv == "u" else conv)) % int_arg(length, False))
+            elif conv == "c":
+                out.append((spec + "c") % chr(int_arg(length, False) & 0xFF))
+            elif conv in "fFeEgGaA":
+                val, = struct.unpack("<d", args.take(8))
+                out.append((spec + ("f" if conv in "aA" else conv)) % val)
+            elif conv == "s":
+                addr = int.from_bytes(args.take(strings.ptr_size), "little")
+                s = strings.string(addr)
+                out.append((spec + "s") % (s if s is not None else "<0x%x>" % addr))
+            elif conv == "p":
+                addr = int.from_bytes(args.take(strings.ptr_size), "little")
+                out.append("0x%x" % addr)
+        except IndexError:
+            out.append("..." if truncated else "<missing>")
+            last = len(fmt)
+            break
+    out.append(fmt[last:])
+    return "".join(out)
+
+
+# ---------------------------------------------------------------------------
+# frames
+# ---------------------------------------------------------------------------
+
+def read_varint(buf, pos):
+    val = shift = 0
+    while True:
+        if pos >= len(buf) or shift > 63:
+            raise IndexError
+        b = buf[pos]
+        pos += 1
+        val |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            return val, pos
+
+
+def parse_frame(buf, pos):
+    """parse a frame starting at buf[pos] == SYNC, return (record, next pos)"""
+    start = pos
+    hdr = buf[pos + 1]
+    pos += 2
+    rec = {"level": hdr & 0x07, "truncated": bool(hdr & HDR_TRUNCATED)}
+    rec["fmt"], pos = read_varint(buf, pos)
+    rec["tag"], pos = read_varint(buf, pos)
+    rec["func"] = rec["file"] = rec["line"] = None
+    if hdr & HDR_FUNC:
+        rec["func"], pos = read_varint(buf, pos)
+    if hdr & HDR_FILE_LINE:
+        rec["file"], pos = read_varint(buf, pos)
+        rec["line"], pos = read_varint(buf, pos)
+    if pos >= len(buf):
+        raise IndexError
+    nwords = buf[pos]
+    pos += 1
+    words = []
+    for _ in range(nwords):
+        zz, pos = read_varint(buf, pos)
+        words.append(((zz >> 1) ^ -(zz & 1)) & 0xFFFFFFFF)
+    rec["words"] = words
+    if pos >= len(buf):
+        raise IndexError
+    if (~sum(buf[start:pos])) & 0xFF != buf[pos]:
+        raise ValueError
+    return rec, pos + 1
+
+
+def render(rec, strings):
+    def s(off, default="?"):
+        v = strings.string_at_offset(off) if off is not None else None
+        return v if v is not None else default
+
+    fmt = strings.string_at_offset(rec["fmt"])
+    if fmt is None:
+        return "<unknown format 0x%x>" % rec["fmt"]
+    line = LEVELS[rec["level"]] if rec["level"] < len(LEVELS) else "?/"
+    line += s(rec["tag"]) + " "
+    if rec["file"] is not None or rec["func"] is not None:
+        where = []
+        if rec["file"] is not None:
+            where.append("%s:%d" % (s(rec["file"]), rec["line"]))
+        if rec["func"] is not None:
+            where.append(s(rec["func"]))
+        line += "(" + " ".join(where) + ")"
+    return line + c_format(fmt, rec["words"], strings, rec["truncated"])
+
+
+def decode_stream(data, strings, out):
+    """decode frames from data, return the unconsumed tail"""
+    pos = 0
+    text = bytearray()
+    while pos < len(data):
+        if data[pos] != SYNC:
+            text.append(data[pos])
+            pos += 1
+            continue
+        try:
+            rec, nxt = parse_frame(data, pos)
+        except IndexError:
+            break
+        except ValueError:
+            text.append(data[pos])
+            pos += 1
+            continue
+        if text:
+            out.write(text.decode("utf-8", "replace"))
+            text.clear()
+        out.write(render(rec, strings) + "\n")
+        pos = nxt
+    if text:
+        out.write(text.decode("utf-8", "replace"))
+    out.flush()
+    return data[pos:]
+
+
+# ---------------------------------------------------------------------------
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = ap.add_subparsers(dest="cmd", required=True)
+
+    ex = sub.add_parser("extract", help="dump the .rodata strings of an ELF")
+    ex.add_argument("elf")
+    ex.add_argument("-o", "--output", required=True)
+    ex.add_argument("--addr-base", type=lambda v: int(v, 0), default=DEFAULT_ADDR_BASE,
+                    help="ELOG_BINARY_ADDR_BASE of the firmware")
+
+    de = sub.add_parser("decode", help="decode a binary log capture")
+    src = de.add_mutually_exclusive_group(required=True)
+    src.add_argument("-d", "--dict", help="string table from 'extract'")
+    src.add_argument("-e", "--elf", help="read the strings directly from the ELF")
+    de.add_argument("--addr-base", type=lambda v: int(v, 0), default=DEFAULT_ADDR_BASE)
+    de.add_argument("input", nargs="?", help="capture file or tty, default stdin")
+
+    args = ap.parse_args()
+
+    if args.cmd == "extract":
+        StringTable.from_elf(args.elf, args.addr_base).save(args.output)
+        return 0
+
+    strings = StringTable.from_dict(args.dict) if args.dict else StringTable.from_elf(args.elf, args.addr_base)
+    f = open(args.input, "rb", buffering=0) if args.input else sys.stdin.buffer
+    pending = b""
+    with f:
+        while True:
+            chunk = f.read(4096)
+            if not chunk:
+                break
+            pending = decode_stream(pending + chunk, strings, sys.stdout)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,131 @@
+/*
+ * Host check of the elog tag level filter (elog_set_filter_tag_lvl in
+ * User/Middlewares/easyLogger/elog.c), an open addressing hash table whose
+ * removed entries stay in place as part of the probe chains.
+ *
+ * A few tags keep a level filter for the whole run while many rounds of other
+ * tags are added up to ELOG_FILTER_TAG_LVL_MAX_NUM and removed again, so far
+ * more distinct tags pass through the table than it has slots. Checked:
+ *   - every add succeeds while fewer than ELOG_FILTER_TAG_LVL_MAX_NUM filters
+ *     are set, the next one is refused, a removed tag can be set again
+ *   - the permanent tags keep their level through all the churn
+ *   - a log below its tag's level is not output, others are
+ *
+ *   elog_filter_test
+ */
+#include "elog.h"
+#include <stdio.h>
+#include <string.h>
+
+#define KEEP_NUM        4U
+#define ROUNDS          200U
+
+static uint32_t errors, lines;
+
+static void fail(const char *what, unsigned a, unsigned b)
+{
+    if (++errors <= 10) {
+        printf("ERROR: %s (%u, %u)\n", what, a, b);
+    }
+}
+
+static void count_output(const char *log, size_t size)
+{
+    (void)log;
+    (void)size;
+    lines++;
+}
+
+static void tag_name(char *buf, const char *prefix, unsigned n)
+{
+    snprintf(buf, ELOG_FILTER_TAG_MAX_LEN + 1, "%s%u", prefix, n);
+}
+
+static void check_keep(unsigned round)
+{
+    char tag[ELOG_FILTER_TAG_MAX_LEN + 1];
+    unsigned i;
+
+    for (i = 0; i < KEEP_NUM; i++) {
+        tag_name(tag, "keep", i);
+        if (elog_get_filter_tag_lvl(tag) != i) fail("permanent tag lost its level", round, i);
+    }
+}
+
+static void churn(void)
+{
+    char tag[ELOG_FILTER_TAG_MAX_LEN + 1];
+    unsigned round, i, free_num = ELOG_FILTER_TAG_LVL_MAX_NUM - KEEP_NUM;
+
+    for (round = 0; round < ROUNDS; round++) {
+        for (i = 0; i < free_num; i++) {
+            tag_name(tag, "t", round * free_num + i);
+            elog_set_filter_tag_lvl(tag, ELOG_LVL_INFO);
+            if (elog_get_filter_tag_lvl(tag) != ELOG_LVL_INFO) fail("tag refused", round, i);
+        }
+        //表中已有ELOG_FILTER_TAG_LVL_MAX_NUM条，再加一条应被拒绝
+        elog_set_filter_tag_lvl("overflow", ELOG_LVL_WARN);
+        if (elog_get_filter_tag_lvl("overflow") != ELOG_FILTER_LVL_ALL) fail("tag over the limit accepted", round, 0);
+        check_keep(round);
+        for (i = 0; i < free_num; i++) {
+            tag_name(tag, "t", round * free_num + i);
+            elog_set_filter_tag_lvl(tag, ELOG_FILTER_LVL_ALL);
+            if (elog_get_filter_tag_lvl(tag) != ELOG_FILTER_LVL_ALL) fail("tag not removed", round, i);
+        }
+    }
+    printf("%u tags set and removed on a %u slot table\n", ROUNDS * free_num, ELOG_FILTER_TAG_LVL_HASH_SIZE);
+}
+
+static void reuse(void)
+{
+    elog_set_filter_tag_lvl("again", ELOG_LVL_WARN);
+    elog_set_filter_tag_lvl("again", ELOG_FILTER_LVL_ALL);
+    elog_set_filter_tag_lvl("again", ELOG_LVL_ERROR);
+    if (elog_get_filter_tag_lvl("again") != ELOG_LVL_ERROR) fail("removed tag not set again", 0, 0);
+    elog_set_filter_tag_lvl("again", ELOG_FILTER_LVL_ALL);
+}
+
+static void output(void)
+{
+    uint32_t before;
+
+    elog_set_filter_tag_lvl("quiet", ELOG_LVL_WARN);
+    before = lines;
+    elog_i("quiet", "filtered out %d", 1);
+    if (lines != before) fail("log below the tag level output", lines, before);
+    elog_w("quiet", "output %d", 2);
+    elog_i("other", "output %d", 3);
+    if (lines != before + 2) fail("log not output", lines, before + 2);
+    elog_set_filter_tag_lvl("quiet", ELOG_FILTER_LVL_ALL);
+    elog_i("quiet", "output %d", 4);
+    if (lines != before + 3) fail("log after removing the filter not output", lines, before + 3);
+}
+
+int main(void)
+{
+    easy_logger_int_struct_t init = {0};
+    char tag[ELOG_FILTER_TAG_MAX_LEN + 1];
+    unsigned i;
+
+    init.output = count_output;
+    if (elog_init(&init) != ELOG_NO_ERR) {
+        fprintf(stderr, "elog_init failed\n");
+        return 1;
+    }
+    elog_start();
+    //同步输出，便于按行计数
+    elog_async_enabled(false);
+
+    for (i = 0; i < KEEP_NUM; i++) {
+        tag_name(tag, "keep", i);
+        elog_set_filter_tag_lvl(tag, (uint8_t)i);
+    }
+    churn();
+    reuse();
+    output();
+    check_keep(ROUNDS);
+
+    elog_deinit();
+    printf("%s\n", errors ? "FAIL" : "PASS");
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,220 @@
+/*
+ * Host stress test of the elog line pool (line_claim/line_publish/line_drain
+ * in User/Middlewares/easyLogger/elog.c) with several writer threads.
+ *
+ * Every writer logs numbered lines with a payload derived from its thread and
+ * line number, in turn through elog_raw, elog_i with async output off and
+ * elog_output_line with a message formatter of its own. That formatter yields
+ * now and then, so a writer is switched out between claiming and publishing
+ * its line while the others claim the rest of the pool and drop when it is
+ * full; a writer that saw a drop yields before its next line. The output
+ * callback checks each chunk it gets:
+ *   - it is exactly one whole line, "<thread:seq:payload>" plus the line end,
+ *     with the payload expected for that thread and number, so two writers
+ *     formatting into the same line or a line cut short shows up at once
+ *   - no other output call runs at the same time (one drainer at a time)
+ *   - the lines of one writer arrive in the order they were logged
+ * It yields now and then too, so writers publish behind the drainer and leave
+ * their lines to it; the test fails if that never happens. At the end every
+ * line is either output or counted by elog_get_line_dropped().
+ *
+ *   elog_line_stress [-t threads] [-n lines per thread]     default 4, 20000
+ */
+#include "elog.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define THREADS_MAX     16U
+#define PAYLOAD_MAX     40U
+
+static unsigned threads = 4, lines = 20000;
+static uint32_t errors;
+static volatile uint32_t in_output;
+static uint32_t outputs, handed_over, format_calls;
+static __thread unsigned self = ~0U;
+static long next_seq[THREADS_MAX];
+
+static void fail(const char *what, const char *log, size_t size)
+{
+    if (__atomic_add_fetch(&errors, 1, __ATOMIC_RELAXED) <= 10) {
+        printf("ERROR: %s: \"%.*s\"\n", what, (int)size, log);
+    }
+}
+
+static size_t make_payload(char *buf, unsigned tid, unsigned seq)
+{
+    size_t len = (tid * 7U + seq) % PAYLOAD_MAX, i;
+
+    for (i = 0; i < len; i++) {
+        buf[i] = (char)('a' + (tid + seq + i) % 26U);
+    }
+    buf[len] = '\0';
+    return len;
+}
+
+static void check_line(const char *log, size_t size)
+{
+    char line[ELOG_LINE_BUF_SIZE + 1], payload[PAYLOAD_MAX + 1];
+    const char *open, *close, *end;
+    unsigned tid, seq;
+    int n = 0;
+
+    memcpy(line, log, size);
+    line[size] = '\0';
+    open = strchr(line, '<');
+    close = strchr(line, '>');
+    if (open == NULL || close == NULL || strchr(open + 1, '<') != NULL || strchr(close + 1, '>') != NULL) {
+        fail("not one whole line", log, size);
+        return;
+    }
+    //raw行以"\n"结束，格式化行以ELOG_NEWLINE_SIGN结束
+    end = close + 1;
+    if (strcmp(end, "\n") != 0 && strcmp(end, ELOG_NEWLINE_SIGN) != 0) {
+        fail("bad line end", log, size);
+        return;
+    }
+    if (sscanf(open, "<%u:%u:%n", &tid, &seq, &n) != 2 || n == 0 || tid >= threads || seq >= lines) {
+        fail("bad header", log, size);
+        return;
+    }
+    make_payload(payload, tid, seq);
+    if ((size_t)(close - (open + n)) != strlen(payload) || memcmp(open + n, payload, strlen(payload)) != 0) {
+        fail("payload", log, size);
+        return;
+    }
+    if ((long)seq <= next_seq[tid] - 1) {
+        fail("out of order", log, size);
+        return;
+    }
+    next_seq[tid] = (long)seq + 1;
+    if (tid != self) {
+        handed_over++;
+    }
+}
+
+typedef struct {
+    unsigned tid, seq;
+    const char *payload;
+} line_ctx_t;
+
+/* 在claim与publish之间调用，偶尔让出CPU */
+static int yield_formatter(char *buf, size_t size, void *ctx)
+{
+    line_ctx_t *c = ctx;
+
+    if ((__atomic_add_fetch(&format_calls, 1, __ATOMIC_RELAXED) & 3U) == 0) {
+        sched_yield();
+    }
+    return snprintf(buf, size, "<%u:%u:%s>", c->tid, c->seq, c->payload);
+}
+
+static void output(const char *log, size_t size)
+{
+    if (__atomic_exchange_n(&in_output, 1, __ATOMIC_ACQUIRE)) {
+        fail("concurrent output", log, size);
+        return;
+    }
+    check_line(log, size);
+    outputs++;
+    //偶尔让出CPU，其他写入者在输出期间claim/publish
+    if ((outputs & 7U) == 0) {
+        sched_yield();
+    }
+    __atomic_store_n(&in_output, 0, __ATOMIC_RELEASE);
+}
+
+static void *writer(void *arg)
+{
+    unsigned tid = (unsigned)(uintptr_t)arg, seq;
+    char payload[PAYLOAD_MAX + 1];
+    uint32_t dropped;
+
+    self = tid;
+    for (seq = 0; seq < lines; seq++) {
+        make_payload(payload, tid, seq);
+        dropped = elog_get_line_dropped();
+        switch ((tid + seq) % 3U) {
+        case 0:
+            elog_raw("<%u:%u:%s>\n", tid, seq, payload);
+            break;
+        case 1:
+            elog_i("STRESS", "<%u:%u:%s>", tid, seq, payload);
+            break;
+        default: {
+            line_ctx_t ctx = { tid, seq, payload };
+
+            elog_output_line(ELOG_LVL_INFO, "STRESS", NULL, NULL, 0, yield_formatter, &ctx);
+            break;
+        }
+        }
+        //行池满时让持有行的写入者先发布
+        if (elog_get_line_dropped() != dropped) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    easy_logger_int_struct_t init = {0};
+    pthread_t th[THREADS_MAX];
+    unsigned long sent;
+    uint32_t dropped;
+    unsigned i;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:n:")) != -1) {
+        switch (opt) {
+        case 't': threads = (unsigned)atoi(optarg); break;
+        case 'n': lines = (unsigned)atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-t threads] [-n lines per thread]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (threads == 0 || threads > THREADS_MAX || lines == 0) {
+        fprintf(stderr, "threads 1..%u, lines > 0\n", THREADS_MAX);
+        return 2;
+    }
+
+    init.output = output;
+    if (elog_init(&init) != ELOG_NO_ERR) {
+        fprintf(stderr, "elog_init failed\n");
+        return 1;
+    }
+    elog_start();
+    //格式化日志同步经过行池
+    elog_async_enabled(false);
+    outputs = 0;
+
+    for (i = 0; i < threads; i++) {
+        pthread_create(&th[i], NULL, writer, (void *)(uintptr_t)i);
+    }
+    for (i = 0; i < threads; i++) {
+        pthread_join(th[i], NULL);
+    }
+
+    sent = (unsigned long)threads * lines;
+    dropped = elog_get_line_dropped();
+    printf("%u writers, %lu lines: %u output, %u dropped (pool of %u lines), %u output by another writer\n",
+           threads, sent, outputs, dropped, ELOG_LINE_POOL_NUM, handed_over);
+    if (outputs + dropped != sent) {
+        errors++;
+        printf("ERROR: %lu lines lost\n", sent - outputs - dropped);
+    }
+    if (threads > 1 && handed_over == 0) {
+        errors++;
+        printf("ERROR: no line was left to another writer's drain\n");
+    }
+    //deinit的版本信息不是压力测试的行
+    elog_set_output_enabled(false);
+    elog_deinit();
+
+    printf("%s\n", errors ? "FAIL" : "PASS");
+    return errors ? 1 : 0;
+}
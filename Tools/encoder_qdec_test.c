@@ -0,0 +1,182 @@
+/*
+ * Host test of the EXTI quadrature decoder (fy_encoder_exti_input).
+ *
+ * First every one of the 16 (previous, current) state pairs is checked against
+ * the expected -1/0/+1/illegal result, and the count is run across the 32-bit
+ * wrap. Then each recorded edge sequence given on the command line is replayed.
+ *
+ * Trace format (logic analyzer export, one row per change of A or B):
+ *   # expect count=<n> illegal=<n> [glitch=<n>]
+ *   time_us,a,b
+ *   0.0,0,0
+ *   12.5,1,0
+ *   ...
+ * The first row is the initial state. Every later row is one edge interrupt
+ * that reads the pins at that moment; a row that repeats the previous state is
+ * an interrupt whose glitch was gone before the read. With -l the ISR reads the
+ * pins latency_us after the edge instead, so the rows in between are merged into
+ * one read, like edges that come while the EXTI line is still pending; then only
+ * the count is compared.
+ *
+ *   encoder_qdec_test [-l latency_us] [-v] trace.csv...
+ */
+#include "fy_encoder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define ROW_MAX     (1 << 20)
+
+typedef struct {
+    double t;
+    uint8_t a, b;
+} row_t;
+
+static row_t rows[ROW_MAX];
+static uint32_t errors;
+
+static void check_table(void)
+{
+    /* forward 0 -> 2 -> 3 -> 1 -> 0 */
+    static const uint8_t next_fwd[4] = {2, 0, 3, 1};
+    uint32_t prev, cur;
+
+    for (prev = 0; prev < 4; prev++) {
+        for (cur = 0; cur < 4; cur++) {
+            fy_encoder_t enc;
+            int32_t expect_count = 0;
+            uint32_t expect_illegal = 0, expect_glitch = 0;
+
+            memset(&enc, 0, sizeof(enc));
+            fy_encoder_exti_sync(&enc, prev >> 1, prev & 1);
+            fy_encoder_exti_input(&enc, cur >> 1, cur & 1);
+            if (cur == prev) {
+                expect_glitch = 1;
+            } else if (next_fwd[prev] == cur) {
+                expect_count = 1;
+            } else if (next_fwd[cur] == prev) {
+                expect_count = -1;
+            } else {
+                expect_illegal = 1;
+            }
+            if ((int32_t)enc.exti_count != expect_count || enc.exti_illegal != expect_illegal ||
+                enc.exti_glitch != expect_glitch || enc.exti_state != cur) {
+                printf("ERROR: transition %u -> %u: count %d illegal %u glitch %u\n", prev, cur,
+                       (int32_t)enc.exti_count, enc.exti_illegal, enc.exti_glitch);
+                errors++;
+            }
+        }
+    }
+
+    /* the 32-bit counter wraps, the sampled count follows the difference */
+    fy_encoder_t enc;
+    uint8_t s = 0;
+
+    memset(&enc, 0, sizeof(enc));
+    fy_encoder_reset(&enc, FY_ENCODER_MODE_EXTI, 0xFFFFFFF0U, 0);
+    enc.exti_count = 0xFFFFFFF0U;
+    for (int i = 0; i < 40; i++) {
+        s = (uint8_t)((s == 0) ? 2 : (s == 2) ? 3 : (s == 3) ? 1 : 0);
+        fy_encoder_exti_input(&enc, s >> 1, s & 1);
+    }
+    if (fy_encoder_sample(&enc, enc.exti_count, 1) != 40 || enc.exti_count != 0x18U) {
+        printf("ERROR: wrap: count %d, raw 0x%08x\n", enc.count, enc.exti_count);
+        errors++;
+    }
+    printf("table: 16 transitions, wrap: %s\n", errors ? "FAIL" : "ok");
+}
+
+static int replay(const char *path, double latency_us, int verbose)
+{
+    FILE *f = fopen(path, "r");
+    char line[256];
+    long expect_count = 0, expect_illegal = 0, expect_glitch = -1;
+    int have_expect = 0;
+    size_t n = 0, i;
+
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), f) != NULL) {
+        double t;
+        unsigned a, b;
+        char *p;
+
+        if (line[0] == '#') {
+            if ((p = strstr(line, "expect")) != NULL) {
+                have_expect = 1;
+                if ((p = strstr(line, "count=")) != NULL) expect_count = strtol(p + 6, NULL, 10);
+                if ((p = strstr(line, "illegal=")) != NULL) expect_illegal = strtol(p + 8, NULL, 10);
+                if ((p = strstr(line, "glitch=")) != NULL) expect_glitch = strtol(p + 7, NULL, 10);
+            }
+            continue;
+        }
+        if (sscanf(line, "%lf,%u,%u", &t, &a, &b) != 3) continue;//header
+        if (n == ROW_MAX) {
+            printf("%s: more than %d rows\n", path, ROW_MAX);
+            fclose(f);
+            return -1;
+        }
+        rows[n].t = t;
+        rows[n].a = (uint8_t)(a != 0);
+        rows[n].b = (uint8_t)(b != 0);
+        n++;
+    }
+    fclose(f);
+    if (n == 0 || !have_expect) {
+        printf("%s: no rows or no '# expect' line\n", path);
+        return -1;
+    }
+
+    fy_encoder_t enc;
+
+    memset(&enc, 0, sizeof(enc));
+    fy_encoder_reset(&enc, FY_ENCODER_MODE_EXTI, 0, 0);
+    fy_encoder_exti_sync(&enc, rows[0].a, rows[0].b);
+    for (i = 1; i < n; i++) {
+        size_t j = i;
+
+        //the ISR reads the pins latency_us after the edge: later rows up to then are merged
+        while (j + 1 < n && rows[j + 1].t <= rows[i].t + latency_us) j++;
+        fy_encoder_exti_input(&enc, rows[j].a, rows[j].b);
+        if (verbose) {
+            printf("  %10.1f us  %u%u  count %d\n", rows[j].t, rows[j].a, rows[j].b, (int32_t)enc.exti_count);
+        }
+        i = j;
+    }
+    fy_encoder_sample(&enc, enc.exti_count, 0);
+
+    //merged reads change the illegal/glitch counters, with -l only the count is compared
+    int ok = (enc.count == expect_count && (latency_us > 0 || ((long)enc.exti_illegal == expect_illegal &&
+              (expect_glitch < 0 || (long)enc.exti_glitch == expect_glitch))));
+    printf("%-40s rows %6zu  irqs %6u  count %8d (expect %ld)  illegal %u (expect %ld)  glitch %u  %s\n",
+           path, n, enc.exti_irqs, enc.count, expect_count, enc.exti_illegal, expect_illegal,
+           enc.exti_glitch, ok ? "ok" : "FAIL");
+    return ok ? 0 : -1;
+}
+
+int main(int argc, char **argv)
+{
+    double latency_us = 0;
+    int verbose = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "l:v")) != -1) {
+        switch (opt) {
+        case 'l': latency_us = atof(optarg); break;
+        case 'v': verbose = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-l latency_us] [-v] trace.csv...\n", argv[0]);
+            return 2;
+        }
+    }
+
+    check_table();
+    for (int i = optind; i < argc; i++) {
+        if (replay(argv[i], latency_us, verbose) != 0) errors++;
+    }
+    printf("%s\n", errors ? "FAIL" : "PASS");
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,315 @@
+/*
+ * Host simulation of the quadrature encoder driver (User/hardware/Encoder).
+ *
+ * A motion profile is turned into A/B edges on a 100 ns grid and fed to both
+ * counting paths of the driver at the same time:
+ *   - TIM: the encoder interface counts every edge (x4) in a 16-bit CNT, the
+ *     driver only reads CNT every update period
+ *   - EXTI: every edge of A or B sets the pending bit of its line, the ISR runs
+ *     when the CPU is free, reads both pins after the HAL overhead and feeds the
+ *     state to the table decoder; an edge that comes while its line is still
+ *     pending is merged with it. Other interrupts of the firmware (I2C, UART)
+ *     occupy the CPU now and then, like on the target.
+ * Every update period both encoders are sampled exactly like fy_encoder_update()
+ * does on the target.
+ *
+ * Checked at the end:
+ *   - the TIM count equals the true position after every update, across CNT
+ *     wrap-around and in both directions
+ *   - while the ISR keeps up (slow motion, vibration, contact bounce) the EXTI
+ *     count is at most one edge behind the position, and exact once it rests
+ *   - the velocity of both paths matches the profile on the constant-speed parts
+ * Reported only: EXTI interrupts, CPU time spent in them, merged edges and the
+ * glitch/illegal counters of the decoder.
+ *
+ *   encoder_sim [-u update_ms] [-s speed_edges_per_s] [-r trace.csv] [-v]
+ *   -r records the A/B edges in the format of Tools/encoder_qdec_test.c
+ */
+#include "fy_encoder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define STEP_NS             100ULL
+#define EXTI_LATENCY_NS     170ULL      //12 cycles at 72MHz
+#define EXTI_READ_NS        1000ULL     //HAL_GPIO_EXTI_IRQHandler + callback up to the pin reads
+#define EXTI_COST_NS        2000ULL     //whole ISR
+#define OTHER_IRQ_NS        10000ULL    //I2C/UART handlers
+#define OTHER_IRQ_PERIOD_NS 1000000ULL
+#define BOUNCE_NS           300ULL      //contact bounce: the edge flips back and forth twice
+
+typedef struct {
+    const char *name;
+    double duration;//s
+    double v_start;//edges/s
+    double v_end;
+    uint32_t dither_us;//>0: shaft vibrates by one edge every dither_us instead
+    uint8_t bounce;//every edge bounces
+    uint8_t exti_check;//EXTI count must follow the position
+} segment_t;
+
+static segment_t profile[] = {
+    {"slow ramp up",     0.5,       0,   20000,   0, 0, 1},
+    {"slow hold",        1.0,   20000,   20000,   0, 0, 1},
+    {"slow reverse",     1.0,   20000,  -20000,   0, 0, 1},
+    {"slow hold back",   1.0,  -20000,  -20000,   0, 0, 1},
+    {"slow stop",        0.5,  -20000,       0,   0, 0, 1},
+    {"vibration",        0.5,       0,       0, 250, 0, 1},
+    {"bounce",           0.5,    2000,    2000,   0, 1, 1},
+    {"bounce stop",      0.2,    2000,       0,   0, 1, 1},
+    {"fast ramp up",     0.5,       0,  400000,   0, 0, 0},
+    {"fast hold",        1.0,  400000,  400000,   0, 0, 0},
+    {"fast reverse",     1.0,  400000, -400000,   0, 0, 0},
+    {"fast hold back",   1.0, -400000, -400000,   0, 0, 0},
+    {"fast stop",        0.5, -400000,       0,   0, 0, 0},
+};
+#define SEGMENT_NUM (sizeof(profile) / sizeof(profile[0]))
+
+static uint64_t now_ns;
+static int64_t pos;//true position in edges
+static int64_t pos_sampled;//position at the last update
+static uint32_t errors;
+static FILE *trace;
+static uint64_t trace_edges;
+
+static fy_encoder_t enc_tim;
+static fy_encoder_t enc_exti;
+
+/* EXTI model */
+static uint8_t exti_pending[2];
+static int8_t exti_active = -1;//line in service
+static uint8_t exti_read_done;
+static uint64_t exti_read_at;
+static uint64_t cpu_free_at;
+static uint8_t other_pending;
+static uint64_t other_next = OTHER_IRQ_PERIOD_NS / 2;
+static uint64_t exti_merged, exti_busy_ns, other_irqs;
+
+/* contact bounce: pending flips back and forth */
+static int bounce_dir;
+static int bounce_left;
+static uint64_t bounce_at;
+
+static uint8_t level_a(int64_t p)
+{
+    //Gray code 00 10 11 01: A leads B when the position increases
+    uint32_t s = (uint32_t)(p & 3);
+    return (s == 1 || s == 2);
+}
+
+static uint8_t level_b(int64_t p)
+{
+    uint32_t s = (uint32_t)(p & 3);
+    return (s == 2 || s == 3);
+}
+
+static void move(int dir)
+{
+    uint8_t a = level_a(pos), b = level_b(pos);
+
+    pos += dir;
+    if (a != level_a(pos)) {
+        if (exti_pending[0]) exti_merged++;
+        exti_pending[0] = 1;
+    }
+    if (b != level_b(pos)) {
+        if (exti_pending[1]) exti_merged++;
+        exti_pending[1] = 1;
+    }
+    if (trace != NULL) {
+        fprintf(trace, "%.1f,%u,%u\n", (double)now_ns / 1000.0, level_a(pos), level_b(pos));
+        trace_edges++;
+    }
+}
+
+/* CPU: one interrupt at a time, lower line number first (EXTI0, EXTI1, then the others) */
+static void cpu_step(void)
+{
+    if (now_ns >= other_next) {
+        other_next += OTHER_IRQ_PERIOD_NS + (uint64_t)(rand() % 200) * 1000ULL;
+        other_pending = 1;
+    }
+    if (exti_active >= 0 && !exti_read_done && now_ns >= exti_read_at) {
+        fy_encoder_exti_input(&enc_exti, level_a(pos), level_b(pos));
+        exti_read_done = 1;
+    }
+    if (now_ns < cpu_free_at) return;
+    exti_active = -1;
+    for (int line = 0; line < 2; line++) {
+        if (exti_pending[line]) {
+            //HAL clears the pending bit before the callback
+            exti_pending[line] = 0;
+            exti_active = (int8_t)line;
+            exti_read_done = 0;
+            exti_read_at = now_ns + EXTI_LATENCY_NS + EXTI_READ_NS;
+            cpu_free_at = now_ns + EXTI_LATENCY_NS + EXTI_COST_NS;
+            exti_busy_ns += EXTI_LATENCY_NS + EXTI_COST_NS;
+            return;
+        }
+    }
+    if (other_pending) {
+        other_pending = 0;
+        cpu_free_at = now_ns + OTHER_IRQ_NS;
+        other_irqs++;
+    }
+}
+
+static int exti_idle(void)
+{
+    return !exti_pending[0] && !exti_pending[1] && (exti_active < 0 || exti_read_done);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t update_ms = 10;
+    double speed_scale = 1.0;
+    const char *trace_path = NULL;
+    int verbose = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "u:s:r:v")) != -1) {
+        switch (opt) {
+        case 'u': update_ms = (uint32_t)atoi(optarg); break;
+        case 's': speed_scale = atof(optarg) / 400000.0; break;
+        case 'r': trace_path = optarg; break;
+        case 'v': verbose = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-u update_ms] [-s speed_edges_per_s] [-r trace.csv] [-v]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (update_ms == 0 || speed_scale <= 0) {
+        fprintf(stderr, "update_ms and speed must be > 0\n");
+        return 2;
+    }
+    if (trace_path != NULL) {
+        trace = fopen(trace_path, "w");
+        if (trace == NULL) {
+            perror(trace_path);
+            return 2;
+        }
+        fprintf(trace, "# recorded by encoder_sim\ntime_us,a,b\n0.0,0,0\n");
+    }
+    for (size_t i = 0; i < SEGMENT_NUM; i++) {
+        if (profile[i].name[0] == 'f') {
+            profile[i].v_start *= speed_scale;
+            profile[i].v_end *= speed_scale;
+        }
+    }
+    srand(1);
+
+    fy_encoder_reset(&enc_tim, FY_ENCODER_MODE_TIM, 0, 0);
+    fy_encoder_reset(&enc_exti, FY_ENCODER_MODE_EXTI, 0, 0);
+    fy_encoder_exti_sync(&enc_exti, level_a(0), level_b(0));
+
+    uint64_t next_update = (uint64_t)update_ms * 1000000ULL;
+    uint64_t seg_start = 0;
+    double phase = 0;
+    uint32_t tim_checks = 0, vel_checks = 0, exti_checks = 0;
+    int64_t exti_err_max = 0;
+
+    //counts as of the last update in each segment
+    printf("%-16s %10s %10s %10s %9s %8s %8s %8s %8s\n", "segment", "position", "tim", "exti",
+           "exti irqs", "irq cpu", "merged", "glitch", "illegal");
+    for (size_t i = 0; i < SEGMENT_NUM; i++) {
+        const segment_t *seg = &profile[i];
+        uint64_t seg_ns = (uint64_t)(seg->duration * 1e9);
+        uint64_t busy0 = exti_busy_ns, merged0 = exti_merged;
+        uint32_t irqs0 = enc_exti.exti_irqs, glitch0 = enc_exti.exti_glitch, illegal0 = enc_exti.exti_illegal;
+        int dither_dir = 1;
+
+        for (uint64_t t = 0; t < seg_ns; t += STEP_NS) {
+            double v = seg->v_start + (seg->v_end - seg->v_start) * (double)t / (double)seg_ns;
+
+            now_ns = seg_start + t;
+            if (bounce_left > 0 && now_ns >= bounce_at) {
+                bounce_dir = -bounce_dir;
+                move(bounce_dir);
+                bounce_left--;
+                bounce_at = now_ns + BOUNCE_NS;
+            } else if (seg->dither_us) {
+                if (t % ((uint64_t)seg->dither_us * 1000ULL) == 0) {
+                    move(dither_dir);
+                    dither_dir = -dither_dir;
+                }
+            } else if (bounce_left == 0) {
+                int dir = 0;
+
+                phase += v * (double)STEP_NS * 1e-9;
+                while (phase >= 1.0) { move(1); phase -= 1.0; dir = 1; }
+                while (phase <= -1.0) { move(-1); phase += 1.0; dir = -1; }
+                if (dir != 0 && seg->bounce) {
+                    bounce_dir = dir;
+                    bounce_left = 2;
+                    bounce_at = now_ns + BOUNCE_NS;
+                }
+            }
+            cpu_step();
+
+            if (now_ns < next_update) continue;
+            next_update += (uint64_t)update_ms * 1000000ULL;
+
+            uint32_t ms = (uint32_t)(now_ns / 1000000ULL);
+            pos_sampled = pos;
+            fy_encoder_sample(&enc_tim, (uint16_t)pos, ms);
+            fy_encoder_sample(&enc_exti, __atomic_load_n(&enc_exti.exti_count, __ATOMIC_ACQUIRE), ms);
+
+            tim_checks++;
+            if (enc_tim.count != pos) {
+                if (errors++ < 10) {
+                    printf("ERROR: %s: tim count %d, position %lld\n", seg->name, enc_tim.count, (long long)pos);
+                }
+            }
+            if (seg->exti_check) {
+                //the edge of the last microsecond may still be in the ISR
+                int64_t err = enc_exti.count - pos;
+
+                exti_checks++;
+                if (err < 0) err = -err;
+                if (err > exti_err_max) exti_err_max = err;
+                if ((err > 1 || (err != 0 && exti_idle())) && errors++ < 10) {
+                    printf("ERROR: %s: exti count %d, position %lld\n", seg->name, enc_exti.count, (long long)pos);
+                }
+            }
+            //constant speed: both windows of the velocity estimate lie inside the segment
+            if (seg->v_start == seg->v_end && !seg->dither_us &&
+                now_ns >= seg_start + (uint64_t)(2 * FY_ENCODER_VEL_WINDOW_MS + update_ms) * 1000000ULL) {
+                double tol = seg->v_end / 100.0;
+                double q = 2.0 * 1000.0 / FY_ENCODER_VEL_WINDOW_MS;
+                double dv_tim = (double)enc_tim.velocity - seg->v_end;
+                double dv_exti = (double)enc_exti.velocity - seg->v_end;
+
+                if (tol < 0) tol = -tol;
+                vel_checks++;
+                if ((dv_tim > tol + q || dv_tim < -tol - q) && errors++ < 10) {
+                    printf("ERROR: %s: tim velocity %d/s, expected %.0f/s\n", seg->name, enc_tim.velocity, seg->v_end);
+                }
+                if (seg->exti_check && (dv_exti > tol + q || dv_exti < -tol - q) && errors++ < 10) {
+                    printf("ERROR: %s: exti velocity %d/s, expected %.0f/s\n", seg->name, enc_exti.velocity,
+                           seg->v_end);
+                }
+            }
+            if (verbose && ms % 100 == 0) {
+                printf("  %6u ms pos %lld tim %d (%d/s) exti %d (%d/s)\n", ms, (long long)pos, enc_tim.count,
+                       enc_tim.velocity, enc_exti.count, enc_exti.velocity);
+            }
+        }
+        seg_start += seg_ns;
+        printf("%-16s %10lld %10d %10d %9u %7.1f%% %8llu %8u %8u\n", seg->name, (long long)pos_sampled,
+               enc_tim.count, enc_exti.count, enc_exti.exti_irqs - irqs0,
+               100.0 * (double)(exti_busy_ns - busy0) / (double)seg_ns,
+               (unsigned long long)(exti_merged - merged0), enc_exti.exti_glitch - glitch0,
+               enc_exti.exti_illegal - illegal0);
+    }
+
+    if (trace != NULL) {
+        fprintf(trace, "# expect count=%lld illegal=0\n", (long long)pos);
+        fclose(trace);
+        printf("recorded %llu edges to %s\n", (unsigned long long)trace_edges, trace_path);
+    }
+    printf("checks: tim %u, exti %u (max error %lld), velocity %u; other irqs %llu\n", tim_checks,
+           exti_checks, (long long)exti_err_max, vel_checks, (unsigned long long)other_irqs);
+    printf("%s\n", errors ? "FAIL" : "PASS");
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,373 @@
+/*
+ * Host simulation of the pipelined flash writer (User/Drivers/Flash).
+ *
+ * The port drives an emulated F103 flash controller on a simulated clock:
+ * a page erase takes 20 ms, a doubleword program 4 x 52.5 us (four halfwords,
+ * one interrupt), programming a location that is not erased raises PGERR, and
+ * starting an operation while one is in flight is an error. Operation end is
+ * the "interrupt": fy_flash_op_done() then fy_flash_continue(), exactly as
+ * fy_flash_irq_handler() does on the target. The main loop writes the data in
+ * chunks the way the bootloader hands over YMODEM packets and calls poll.
+ *
+ * Reported per scenario: sustained rate against the controller ceiling
+ * 1024 / (erase + 512 halfword programs) and the write busy count.
+ * Checked: final content and 0xFF padding, nothing written outside the region,
+ * every page erased before it is programmed, injected bit flips caught by the
+ * read-back CRC, injected PGERR stops the writer, flash locked at the end.
+ *
+ *   flash_writer_sim [-v]
+ */
+#include "fy_flash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SIM_BASE            0x08004000UL
+#define SIM_REGION          (48U * 1024U)
+#define SIM_GUARD           FY_FLASH_PAGE_SIZE  //区域之后的一页，不应被改动
+
+#define ERASE_NS            20000000ULL
+#define HALFWORD_NS         52500ULL
+#define PROGRAM_NS          (4 * HALFWORD_NS)
+
+#define OP_IDLE             0
+#define OP_ERASE            1
+#define OP_PROGRAM          2
+
+typedef struct {
+    const char *name;
+    uint32_t size;//文件大小
+    uint32_t rate;//到达速率(字节/秒)，0为不限
+    uint32_t chunk;//每次write的大小，0为随机1..1024
+    uint32_t loop_us;//主循环一次的时间
+    uint8_t chain;//中断中衔接下一次操作
+    uint8_t stall;//操作期间CPU暂停(从Flash取指)
+    int32_t flip_page;//编程后翻转该页的一位，-1不注入
+    int32_t fail_program;//第n次编程报PGERR，-1不注入
+    int32_t expect;//finish的期望结果
+    uint32_t min_pct;//速率至少为上限的百分比，0不检查
+} scenario_t;
+
+static uint8_t flash[SIM_REGION + SIM_GUARD];
+static uint8_t image[SIM_REGION + FY_FLASH_CHUNK];//too-big多出的字节
+static uint8_t guard[SIM_GUARD];
+static uint64_t sim_ns;
+static uint32_t errors;
+static int verbose;
+static unsigned seed = 1;
+
+static struct {
+    uint8_t op;
+    uint64_t end_ns;
+    uint32_t addr;
+    uint64_t data;
+    uint8_t unlocked;
+    uint32_t programs;
+    uint8_t flipped;
+    const scenario_t *sc;
+    fy_flash_t *fw;
+} ctl;
+
+static unsigned sim_rand(unsigned max)
+{
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 16) % max;
+}
+
+/* port ----------------------------------------------------------------------*/
+
+static void sim_begin(fy_flash_t *fw)
+{
+    ctl.fw = fw;
+    ctl.unlocked = 1;
+}
+
+static void sim_end(fy_flash_t *fw)
+{
+    (void)fw;
+    if (ctl.op != OP_IDLE) {
+        printf("ERROR: locked with an operation in flight\n");
+        errors++;
+    }
+    ctl.unlocked = 0;
+}
+
+static int32_t sim_start(uint8_t op, uint32_t addr, uint64_t data, uint64_t ns)
+{
+    if (!ctl.unlocked || ctl.op != OP_IDLE) {
+        printf("ERROR: %s at 0x%08lx with the controller %s\n", op == OP_ERASE ? "erase" : "program",
+               (unsigned long)addr, ctl.unlocked ? "busy" : "locked");
+        errors++;
+        return -1;
+    }
+    if (addr < SIM_BASE || addr >= SIM_BASE + SIM_REGION) {
+        printf("ERROR: access at 0x%08lx outside the region\n", (unsigned long)addr);
+        errors++;
+        return -1;
+    }
+    ctl.op = op;
+    ctl.addr = addr;
+    ctl.data = data;
+    ctl.end_ns = sim_ns + ns;
+    return 0;
+}
+
+static int32_t sim_erase(uint32_t addr)
+{
+    if ((addr & (FY_FLASH_PAGE_SIZE - 1U)) != 0) {
+        printf("ERROR: erase of unaligned address 0x%08lx\n", (unsigned long)addr);
+        errors++;
+        return -1;
+    }
+    return sim_start(OP_ERASE, addr, 0, ERASE_NS);
+}
+
+static int32_t sim_program(uint32_t addr, uint64_t data)
+{
+    return sim_start(OP_PROGRAM, addr, data, PROGRAM_NS);
+}
+
+static const uint8_t *sim_map(uint32_t addr)
+{
+    return &flash[addr - SIM_BASE];
+}
+
+static uint32_t sim_now(void)
+{
+    return (uint32_t)(sim_ns / 1000000ULL);
+}
+
+static const fy_flash_port_t sim_port = {
+    .begin = sim_begin,
+    .end = sim_end,
+    .erase = sim_erase,
+    .program = sim_program,
+    .map = sim_map,
+    .now = sim_now,
+};
+
+/* controller ----------------------------------------------------------------*/
+
+/* 当前操作结束：修改Flash内容，然后进入"中断" */
+static void sim_complete(void)
+{
+    uint8_t *p = &flash[ctl.addr - SIM_BASE];
+    uint8_t ok = 1;
+
+    sim_ns = ctl.end_ns;
+    if (ctl.op == OP_ERASE) {
+        memset(p, 0xFF, FY_FLASH_PAGE_SIZE);
+    } else {
+        for (int i = 0; i < FY_FLASH_CHUNK; i++) {
+            if (p[i] != 0xFF) ok = 0;
+        }
+        if (!ok) {
+            printf("ERROR: PGERR, 0x%08lx programmed before erase\n", (unsigned long)ctl.addr);
+            errors++;
+        } else if (ctl.sc->fail_program >= 0 && ctl.programs == (uint32_t)ctl.sc->fail_program) {
+            ok = 0;//注入的PGERR，内容不变
+        } else {
+            memcpy(p, &ctl.data, FY_FLASH_CHUNK);
+        }
+        if (ok && ctl.sc->flip_page >= 0 && !ctl.flipped &&
+            (ctl.addr - SIM_BASE) / FY_FLASH_PAGE_SIZE == (uint32_t)ctl.sc->flip_page) {
+            p[3] ^= 0x10;//编程后这一位没有写对
+            ctl.flipped = 1;
+        }
+        ctl.programs++;
+    }
+    ctl.op = OP_IDLE;
+    fy_flash_op_done(ctl.fw, ok);
+    if (ctl.sc->chain) {
+        fy_flash_continue(ctl.fw);
+    }
+}
+
+/* 主循环运行us微秒，期间结束的操作在"中断"中处理 */
+static void sim_run(uint32_t us)
+{
+    uint64_t t = sim_ns + us * 1000ULL;
+
+    if (ctl.sc->stall) {
+        //擦写期间CPU取指暂停，主循环在控制器空闲之后才得到这段时间
+        while (ctl.op != OP_IDLE) {
+            sim_complete();
+        }
+        sim_ns += us * 1000ULL;
+        return;
+    }
+    while (ctl.op != OP_IDLE && ctl.end_ns <= t) {
+        sim_complete();
+    }
+    sim_ns = t;
+}
+
+/* scenarios -----------------------------------------------------------------*/
+
+static double ceiling_bps(void)
+{
+    return FY_FLASH_PAGE_SIZE * 1e9 /
+           (ERASE_NS + FY_FLASH_PAGE_SIZE / 2 * HALFWORD_NS);
+}
+
+static int run(const scenario_t *sc)
+{
+    fy_flash_t *fw = malloc(sizeof(*fw));
+    uint32_t errors0 = errors, sent = 0, n = 0, pad;
+    uint64_t start_ns, deadline;
+    int32_t r = 0;
+    int ok = 1;
+
+    memset(&ctl, 0, sizeof(ctl));
+    ctl.sc = sc;
+    sim_ns = 1000000ULL;
+    //旧固件内容，未擦除就编程会报PGERR
+    for (uint32_t i = 0; i < sizeof(flash); i++) flash[i] = (uint8_t)sim_rand(256);
+    flash[0] = 0;
+    memcpy(guard, &flash[SIM_REGION], SIM_GUARD);
+    for (uint32_t i = 0; i < sc->size; i++) image[i] = (uint8_t)sim_rand(256);
+    deadline = sim_ns + 60ULL * 1000000000ULL;
+
+    if (fy_flash_open(fw, &sim_port, SIM_BASE, SIM_REGION) != 0) {
+        printf("ERROR: %s: open failed\n", sc->name);
+        free(fw);
+        return 0;
+    }
+    start_ns = sim_ns;
+    while (sent < sc->size && sim_ns < deadline) {
+        uint64_t avail = sc->size;
+
+        sim_run(sc->loop_us);
+        if (sc->rate != 0) {
+            avail = (sim_ns - start_ns) * sc->rate / 1000000000ULL;
+            if (avail > sc->size) avail = sc->size;
+        }
+        if (n == 0) {
+            n = (sc->chunk != 0) ? sc->chunk : 1 + sim_rand(1024);
+            if (n > sc->size - sent) n = sc->size - sent;
+        }
+        if (avail - sent >= n) {
+            r = fy_flash_write(fw, &image[sent], n);
+            if (r < 0) break;
+            if (r == 0) {
+                sent += n;
+                n = 0;
+            }
+        }
+        fy_flash_poll(fw);
+    }
+    if (r >= 0) {
+        while ((r = fy_flash_finish(fw)) == 1 && sim_ns < deadline) {
+            sim_run(sc->loop_us);
+        }
+    } else {
+        fy_flash_abort(fw);
+    }
+    //出错后等控制器停下来，poll负责加锁
+    while (ctl.op != OP_IDLE) {
+        sim_run(sc->loop_us);
+        fy_flash_poll(fw);
+    }
+
+    printf("%-14s %6lu B  %7.2f KB/s  %5.1f%%  erases %3lu  busy %5lu  verified %2lu  "
+           "verify_err %lu  op_err %lu  finish %ld\n",
+           sc->name, (unsigned long)sc->size, fy_flash_rate_bps(fw) / 1024.0,
+           fy_flash_rate_bps(fw) * 100.0 / ceiling_bps(), (unsigned long)fw->erases,
+           (unsigned long)fw->busy, (unsigned long)fw->verified, (unsigned long)fw->verify_errors,
+           (unsigned long)fw->op_errors, (long)r);
+
+    if (r != sc->expect) {
+        printf("ERROR: %s: finish returned %ld, expected %ld\n", sc->name, (long)r, (long)sc->expect);
+        ok = 0;
+    }
+    if (memcmp(guard, &flash[SIM_REGION], SIM_GUARD) != 0) {
+        printf("ERROR: %s: flash after the region modified\n", sc->name);
+        ok = 0;
+    }
+    if (ctl.unlocked) {
+        printf("ERROR: %s: flash left unlocked\n", sc->name);
+        ok = 0;
+    }
+    if (sc->expect == 0) {
+        pad = (FY_FLASH_CHUNK - (sc->size & (FY_FLASH_CHUNK - 1U))) & (FY_FLASH_CHUNK - 1U);
+        if (memcmp(flash, image, sc->size) != 0) {
+            printf("ERROR: %s: content mismatch\n", sc->name);
+            ok = 0;
+        }
+        for (uint32_t i = 0; i < pad; i++) {
+            if (flash[sc->size + i] != 0xFF) {
+                printf("ERROR: %s: padding not 0xFF\n", sc->name);
+                ok = 0;
+                break;
+            }
+        }
+        if (fw->verified != (sc->size + FY_FLASH_PAGE_SIZE - 1U) / FY_FLASH_PAGE_SIZE) {
+            printf("ERROR: %s: %lu pages verified\n", sc->name, (unsigned long)fw->verified);
+            ok = 0;
+        }
+    }
+    if (sc->min_pct != 0 && fy_flash_rate_bps(fw) * 100.0 < ceiling_bps() * sc->min_pct) {
+        printf("ERROR: %s: rate below %lu%% of the ceiling\n", sc->name, (unsigned long)sc->min_pct);
+        ok = 0;
+    }
+    if (sc->flip_page >= 0 && fw->verify_errors != 1) {
+        printf("ERROR: %s: bit flip not caught\n", sc->name);
+        ok = 0;
+    }
+    if (sc->fail_program >= 0 && fw->op_errors != 1) {
+        printf("ERROR: %s: PGERR not reported\n", sc->name);
+        ok = 0;
+    }
+    if (verbose) {
+        printf("    %.1f ms, %lu programs, stage %u B, erase ahead %u\n", (sim_ns - start_ns) / 1e6,
+               (unsigned long)ctl.programs, FY_FLASH_STAGE_SIZE, FY_FLASH_ERASE_AHEAD);
+    }
+    free(fw);
+    return ok && errors == errors0;
+}
+
+int main(int argc, char **argv)
+{
+    static const scenario_t scenarios[] = {
+        //name            size   rate    chunk loop  chain stall flip fail expect min%
+        {"uart115200",    45000, 11520,  1024, 100,  1, 0, -1, -1,  0,  0},
+        {"burst",         49152, 0,      1024, 100,  1, 0, -1, -1,  0,  95},
+        {"burst-stall",   49152, 0,      1024, 100,  1, 1, -1, -1,  0,  95},
+        //只在主循环中启动操作(1ms一次)，作为对比
+        {"burst-nochain", 49152, 0,      1024, 1000, 0, 0, -1, -1,  0,  0},
+        {"odd-chunks",    45001, 0,      0,    100,  1, 0, -1, -1,  0,  90},
+        {"tiny",          100,   0,      128,  100,  1, 0, -1, -1,  0,  0},
+        {"bitflip",       45000, 0,      1024, 100,  1, 0, 7,  -1,  -1, 0},
+        {"pgerr",         45000, 0,      1024, 100,  1, 0, -1, 300, -1, 0},
+        {"too-big",       49153, 0,      1024, 100,  1, 0, -1, -1,  -1, 0},
+    };
+    static const uint8_t check[] = "123456789";
+    int opt, failed = 0;
+
+    while ((opt = getopt(argc, argv, "v")) != -1) {
+        switch (opt) {
+        case 'v': verbose = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-v]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (fy_flash_crc32(0, check, 9) != 0xCBF43926UL ||
+        fy_flash_crc32(fy_flash_crc32(0, check, 4), check + 4, 5) != 0xCBF43926UL) {
+        printf("ERROR: crc32 check value\n");
+        failed++;
+    }
+
+    printf("controller ceiling %.2f KB/s (erase %.1f ms + %u x %.1f us per page)\n",
+           ceiling_bps() / 1024.0, ERASE_NS / 1e6, FY_FLASH_PAGE_SIZE / 2, HALFWORD_NS / 1e3);
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        if (!run(&scenarios[i])) {
+            failed++;
+        }
+    }
+
+    printf("%s\n", failed ? "FAIL" : "PASS");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""
+Collect and compare the microbenchmark results of User/Middlewares/Bench.
+
+The firmware built with FY_BENCH prints the results on USART1 at startup,
+the host build (fy_bench_host) prints them on stdout:
+
+    #bench,v1,unit=cycles,hz=72000000,n=101,warmup=8,overhead=12
+    bench,<name>,<n>,<min>,<median>,<max>
+    #bench,end
+
+Everything else on the line (log output, the cases' own UART payload) is
+ignored. collect reads until "#bench,end" and writes a CSV with the header
+values as comment lines; diff compares two such files by median.
+
+    fy_bench.py collect --port /dev/ttyUSB0 -o new.csv      reset the board after starting
+    fy_bench.py collect -o new.csv --exec build/Host/User/Middlewares/Bench/fy_bench_host
+    fy_bench.py collect capture.txt -o new.csv              saved terminal log, '-' for stdin
+    fy_bench.py diff base.csv new.csv --fail 5              exit 1 if a median got >5% slower
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import termios
+import time
+
+LINE_RE = re.compile(r'(#?bench,.*)$')
+FIELDS = ('n', 'min', 'median', 'max')
+
+
+def serial_lines(path, baud, timeout):
+    """raw 8N1 serial port without pyserial"""
+    speed = getattr(termios, 'B%d' % baud, None)
+    if speed is None:
+        raise SystemExit('unsupported baud rate %d' % baud)
+    fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)
+    attr = termios.tcgetattr(fd)
+    attr[0] = 0                                     # iflag
+    attr[1] = 0                                     # oflag
+    attr[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+    attr[3] = 0                                     # lflag
+    attr[4] = attr[5] = speed
+    attr[6][termios.VMIN] = 0
+    attr[6][termios.VTIME] = 1
+    termios.tcsetattr(fd, termios.TCSANOW, attr)
+    termios.tcflush(fd, termios.TCIFLUSH)
+    deadline = time.monotonic() + timeout
+    buf = b''
+    try:
+        while time.monotonic() < deadline:
+            chunk = os.read(fd, 256)
+            buf += chunk
+            while b'\n' in buf:
+                line, buf = buf.split(b'\n', 1)
+                yield line.decode('ascii', 'replace')
+    finally:
+        os.close(fd)
+    raise SystemExit('timeout waiting for #bench,end on %s' % path)
+
+
+def source_lines(args):
+    if args.port:
+        return serial_lines(args.port, args.baud, args.timeout)
+    if args.exec:
+        out = subprocess.run(args.exec, check=True, stdout=subprocess.PIPE, timeout=args.timeout)
+        return out.stdout.decode('ascii', 'replace').splitlines()
+    if args.input in (None, '-'):
+        return sys.stdin
+    return open(args.input, 'r', errors='replace')
+
+
+def parse(lines):
+    """return (header dict, [(name, {n,min,median,max})]) of the first complete run"""
+    header, results, done = None, [], None
+    for raw in lines:
+        m = LINE_RE.search(raw.rstrip('\r\n'))
+        if not m:
+            continue
+        fields = m.group(1).split(',')
+        if fields[0] == '#bench' and len(fields) > 1 and fields[1] == 'v1':
+            header = dict(f.split('=', 1) for f in fields[2:] if '=' in f)
+            results = []
+        elif fields[0] == '#bench' and fields[1:] == ['end'] and header is not None:
+            done = (header, results)
+            break
+        elif fields[0] == 'bench' and header is not None and len(fields) == 6:
+            try:
+                results.append((fields[1], dict(zip(FIELDS, map(int, fields[2:])))))
+            except ValueError:
+                pass                                # garbled line
+    if done is None:
+        raise SystemExit('no complete benchmark run found')
+    return done
+
+
+def write_csv(f, header, results):
+    for k, v in header.items():
+        f.write('# %s=%s\n' % (k, v))
+    f.write('name,%s\n' % ','.join(FIELDS))
+    for name, r in results:
+        f.write('%s,%s\n' % (name, ','.join(str(r[k]) for k in FIELDS)))
+
+
+def read_csv(path):
+    header, results = {}, {}
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if line.startswith('#'):
+                k, _, v = line[1:].strip().partition('=')
+                header[k] = v
+            elif line and not line.startswith('name,'):
+                name, *vals = line.split(',')
+                results[name] = dict(zip(FIELDS, map(int, vals)))
+    return header, results
+
+
+def cmd_collect(args):
+    header, results = parse(source_lines(args))
+    if args.output:
+        with open(args.output, 'w') as f:
+            write_csv(f, header, results)
+    else:
+        write_csv(sys.stdout, header, results)
+    print('%d cases, unit %s' % (len(results), header.get('unit', '?')), file=sys.stderr)
+    return 0
+
+
+def cmd_diff(args):
+    base_hdr, base = read_csv(args.base)
+    new_hdr, new = read_csv(args.new)
+    if base_hdr.get('unit') != new_hdr.get('unit') or base_hdr.get('hz') != new_hdr.get('hz'):
+        print('warning: different units (%s@%s vs %s@%s)' % (base_hdr.get('unit'), base_hdr.get('hz'),
+              new_hdr.get('unit'), new_hdr.get('hz')), file=sys.stderr)
+    unit = new_hdr.get('unit', '')
+    print('%-20s %10s %10s %8s %10s %10s' % ('case', 'base', 'new', 'delta', 'base min', 'new min'))
+    worst = 0.0
+    for name in list(base) + [n for n in new if n not in base]:
+        b, n = base.get(name), new.get(name)
+        if b is None or n is None:
+            print('%-20s %10s %10s' % (name, b['median'] if b else '-', n['median'] if n else '-'))
+            continue
+        delta = 100.0 * (n['median'] - b['median']) / b['median'] if b['median'] else 0.0
+        worst = max(worst, delta)
+        flag = ' !' if args.fail is not None and delta > args.fail else ''
+        print('%-20s %10d %10d %+7.1f%% %10d %10d%s' % (name, b['median'], n['median'], delta,
+              b['min'], n['min'], flag))
+    print('median %s, worst %+.1f%%' % (unit, worst))
+    if args.fail is not None and worst > args.fail:
+        return 1
+    return 0
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = ap.add_subparsers(dest='cmd', required=True)
+
+    c = sub.add_parser('collect', help='read one benchmark run and write it as CSV')
+    c.add_argument('input', nargs='?', help="captured output, '-' or omitted for stdin")
+    c.add_argument('--port', help='serial port of the board (USART1)')
+    c.add_argument('--baud', type=int, default=115200)
+    c.add_argument('--exec', nargs=argparse.REMAINDER, help='run a host benchmark binary')
+    c.add_argument('--timeout', type=float, default=60.0, help='seconds (serial port, --exec)')
+    c.add_argument('-o', '--output', help='CSV file, default stdout')
+    c.set_defaults(func=cmd_collect)
+
+    d = sub.add_parser('diff', help='compare two CSV files by median')
+    d.add_argument('base')
+    d.add_argument('new')
+    d.add_argument('--fail', type=float, metavar='PCT', help='exit 1 if any median is more than PCT%% slower')
+    d.set_defaults(func=cmd_diff)
+
+    args = ap.parse_args()
+    sys.exit(args.func(args))
+
+
+if __name__ == '__main__':
+    main()
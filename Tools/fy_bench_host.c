@@ -0,0 +1,83 @@
+/*
+ * Host run of the on-target microbenchmarks (User/Middlewares/Bench).
+ *
+ * The built-in cases run on fy_uart/elog over the HAL mock's USART1 at the
+ * firmware's settings, timed with clock_gettime (unit ns). The mock executes
+ * DMA and interrupt work inline, so the transmit cases include the simulated
+ * peripheral, and the numbers only compare host builds with each other.
+ * Output is the same line format as the firmware prints on USART1:
+ *
+ *   fy_bench_host [iterations [warmup]]
+ *   Tools/fy_bench.py collect -o new.csv --exec build/Host/User/Middlewares/Bench/fy_bench_host
+ */
+#include "hal_mock.h"
+#include "usart.h"
+#include "fy_uart.h"
+#include "elog.h"
+#include "fy_bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static uint8_t uart_rx_buffer[256];
+static uint8_t uart_tx_buffer[256];
+static ringBuffer_t uart_rx_rb;
+static ringBuffer_t uart_tx_rb;
+static fy_uart_t uart;
+static fy_bench_t bench;
+
+static void elog_uart_out(const char *log, size_t size)
+{
+    uart.uartTx(&uart, (const uint8_t *)log, size);
+}
+
+static int tx_drained(void *ctx)
+{
+    (void)ctx;
+    return !uart.tx_busy && uart.tx_q_count == 0 && hal_mock_uart_tx_idle(USART1);
+}
+
+static void wait_idle(fy_uart_t *u)
+{
+    (void)u;
+    if (hal_mock_run_until(tx_drained, NULL, HAL_MOCK_MS(1000)) != 0) {
+        fprintf(stderr, "uart tx stuck\n");
+        exit(1);
+    }
+}
+
+/* 结果直接写stdout，串口上的数据由模拟线路丢弃 */
+static void bench_out(const char *line, size_t len)
+{
+    fwrite(line, 1, len, stdout);
+}
+
+int main(int argc, char **argv)
+{
+    easy_logger_int_struct_t init = {0};
+    uint32_t iterations = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : FY_BENCH_ITER_MAX;
+    uint32_t warmup = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : FY_BENCH_WARMUP;
+
+    hal_mock_reset();
+    MX_USART1_UART_Init();
+    ringBuffer_init(&uart_rx_rb, uart_rx_buffer, sizeof(uart_rx_buffer));
+    ringBuffer_init(&uart_tx_rb, uart_tx_buffer, sizeof(uart_tx_buffer));
+    if (fy_uart_init_ex(&uart, &huart1, &uart_rx_rb, &uart_tx_rb, FY_UART_RX_DMA_IDLE) != 0) {
+        fprintf(stderr, "fy_uart_init_ex failed\n");
+        return 1;
+    }
+    init.output = elog_uart_out;
+    elog_init(&init);
+    elog_set_fmt(ELOG_LVL_INFO, ELOG_FMT_TAG | ELOG_FMT_FUNC);
+    elog_set_filter_lvl(ELOG_LVL_VERBOSE);
+    elog_start();
+
+    if (fy_bench_init(&bench, NULL, bench_out) != 0 ||
+        fy_bench_set_iterations(&bench, iterations, warmup) != 0 ||
+        fy_bench_cases_add(&bench, &uart, wait_idle) != 0) {
+        fprintf(stderr, "bench setup failed\n");
+        return 1;
+    }
+    fy_bench_run_all(&bench);
+    elog_deinit();
+    return 0;
+}
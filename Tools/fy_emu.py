@@ -0,0 +1,414 @@
+#!/usr/bin/env python3
+"""
+Run the firmware in the Renode emulator and drive scripted scenarios through
+USART1, attached to a host pty.
+
+The STM32F103 platform that ships with Renode (platforms/cpus/stm32f103.repl)
+is extended with models of the flash controller and the CRC unit
+(Tools/Renode/fy_fpec.py, fy_crc.py). The firmware has to be built with
+FY_EMU: the app echoes USART1 and floods the log on 'F', and the flash
+writer pends its interrupt in software for the flash controller model.
+
+Scenarios:
+  bench        collect the FY_BENCH startup results (User/Middlewares/Bench)
+  log_flood    'F', 200 async log lines, firmware reports bytes and ms
+  uart_echo    4 KB in 64 byte chunks, each echoed before the next is sent
+  boot_upload  bootloader only, YMODEM upload of the app image, jump to the app
+
+Every scenario reports the instructions executed by the CPU
+(sysbus.cpu ExecutedInstructions), and the log flood and upload also report
+the firmware's own timing in virtual ms. The CPU runs at --mips, so virtual
+time follows the instruction count. Renode's UART has no line timing, so the
+numbers measure the CPU cost of a path, not the wire. The results are written
+in the CSV format of fy_bench.py and compared the same way:
+
+    cmake --preset Release-Emu && cmake --build --preset Release-Emu --target emu_test
+    fy_emu.py --elf build/Release-Emu/STM32F103.elf -o new.csv
+    fy_emu.py --elf STM32F103.elf --boot Bootloader.elf --app STM32F103_app.bin -o new.csv
+    fy_bench.py diff base.csv new.csv --fail 5
+"""
+
+import argparse
+import os
+import re
+import socket
+import subprocess
+import sys
+import tempfile
+import termios
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import fy_bench  # noqa: E402
+
+RENODE_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'Renode')
+ANSI_RE = re.compile(rb'\x1b\[[0-9;?]*[A-Za-z]')
+PROMPT_RE = re.compile(r'\([\w.-]+\) $')
+
+ECHO_ALPHABET = b'~^`|'                             # never appears in log output
+ECHO_BYTES = 4096
+ECHO_CHUNK = 64
+FLOOD_LINES = 200                                   # EMU_FLOOD_LINES in userMain.c
+
+OVERLAY = '''
+fy_fpec: Python.PythonPeripheral @ sysbus 0x40022000
+    size: 0x400
+    initable: true
+    filename: "{fpec}"
+
+fy_crc: Python.PythonPeripheral @ sysbus 0x40023000
+    size: 0x400
+    initable: true
+    filename: "{crc}"
+'''
+
+
+class EmuError(Exception):
+    pass
+
+
+class Monitor:
+    """Renode monitor on a telnet port"""
+
+    def __init__(self, port, timeout):
+        deadline = time.monotonic() + timeout
+        while True:
+            try:
+                self.sock = socket.create_connection(('127.0.0.1', port), timeout=1.0)
+                break
+            except OSError:
+                if time.monotonic() > deadline:
+                    raise EmuError('no Renode monitor on port %d' % port)
+                time.sleep(0.2)
+        self.sock.settimeout(0.2)
+        self.read_prompt(timeout)
+
+    def read_prompt(self, timeout):
+        buf = b''
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            try:
+                chunk = self.sock.recv(4096)
+            except socket.timeout:
+                chunk = b''
+            if chunk:
+                buf += chunk
+                text = ANSI_RE.sub(b'', buf).replace(b'\r', b'').decode('utf-8', 'replace')
+                if PROMPT_RE.search(text):
+                    return text
+        raise EmuError('Renode monitor did not answer: %r' % buf[-200:])
+
+    def cmd(self, line, timeout=30.0):
+        self.sock.sendall(line.encode() + b'\n')
+        out = self.read_prompt(timeout)
+        for err in ('Could not', 'There was an error'):
+            if err in out:
+                raise EmuError('%s\n%s' % (line, out))
+        return out
+
+    def instructions(self):
+        out = PROMPT_RE.sub('', self.cmd('sysbus.cpu ExecutedInstructions').rstrip(' '))
+        values = re.findall(r'\b0x[0-9A-Fa-f]+\b|\b\d+\b', out)
+        if not values:
+            raise EmuError('cannot parse instruction count: %r' % out)
+        return int(values[-1], 0)
+
+    def close(self):
+        try:
+            self.sock.sendall(b'quit\n')
+        except OSError:
+            pass
+        self.sock.close()
+
+
+class Pty:
+    """USART1 as seen from the host, raw mode"""
+
+    def __init__(self, path, timeout):
+        deadline = time.monotonic() + timeout
+        while not os.path.exists(path):
+            if time.monotonic() > deadline:
+                raise EmuError('pty %s not created' % path)
+            time.sleep(0.1)
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        attr = termios.tcgetattr(self.fd)
+        attr[0] = attr[1] = attr[3] = 0
+        attr[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+        attr[6][termios.VMIN] = 0
+        attr[6][termios.VTIME] = 1
+        termios.tcsetattr(self.fd, termios.TCSANOW, attr)
+        self.buf = b''
+        self.log = None
+
+    def write(self, data):
+        os.write(self.fd, data)
+
+    def fill(self):
+        chunk = os.read(self.fd, 4096)
+        if chunk and self.log:
+            self.log.write(chunk)
+        self.buf += chunk
+        return len(chunk)
+
+    def expect(self, pattern, timeout):
+        """consume up to and including the first match of a bytes regex"""
+        rx = re.compile(pattern)
+        deadline = time.monotonic() + timeout
+        while True:
+            m = rx.search(self.buf)
+            if m:
+                before = self.buf[:m.end()]
+                self.buf = self.buf[m.end():]
+                return m, before
+            if time.monotonic() > deadline:
+                raise EmuError('timeout waiting for %r, got %r' % (pattern, self.buf[-200:]))
+            self.fill()
+
+    def getc(self, timeout):
+        deadline = time.monotonic() + timeout
+        while not self.buf:
+            if time.monotonic() > deadline:
+                return None
+            self.fill()
+        c, self.buf = self.buf[0], self.buf[1:]
+        return c
+
+    def close(self):
+        os.close(self.fd)
+
+
+class Emulator:
+    def __init__(self, args, elfs, workdir, name):
+        self.args = args
+        self.pty_path = os.path.join(workdir, name + '.pty')
+        overlay = os.path.join(workdir, 'fy_overlay.repl')
+        with open(overlay, 'w') as f:
+            f.write(OVERLAY.format(fpec=os.path.join(RENODE_DIR, 'fy_fpec.py'),
+                                   crc=os.path.join(RENODE_DIR, 'fy_crc.py')))
+        self.proc = subprocess.Popen([args.renode, '-P', str(args.monitor_port)] + args.renode_args.split(),
+                                     stdin=subprocess.DEVNULL, stdout=subprocess.DEVNULL,
+                                     stderr=subprocess.DEVNULL if not args.verbose else None)
+        try:
+            self.mon = Monitor(args.monitor_port, args.timeout)
+            self.mon.cmd('mach create "fy"')
+            self.mon.cmd('machine LoadPlatformDescription @%s' % args.platform)
+            self.mon.cmd('machine LoadPlatformDescription @%s' % overlay)
+            self.mon.cmd('sysbus.cpu PerformanceInMips %d' % args.mips)
+            self.mon.cmd('emulation CreateUartPtyTerminal "term" "%s" true' % self.pty_path)
+            self.mon.cmd('connector Connect %s term' % args.uart)
+            for elf in elfs:
+                self.mon.cmd('sysbus LoadELF @%s' % os.path.abspath(elf))
+            # the vector table of the first image (the bootloader when there is one)
+            self.mon.cmd('sysbus.cpu VectorTableOffset 0x08000000')
+            self.pty = Pty(self.pty_path, args.timeout)
+            if args.verbose:
+                self.pty.log = sys.stdout.buffer
+            self.mon.cmd('start')
+        except Exception:
+            self.close()
+            raise
+
+    def close(self):
+        if getattr(self, 'pty', None):
+            self.pty.close()
+        if getattr(self, 'mon', None):
+            self.mon.close()
+        try:
+            self.proc.wait(timeout=5)
+        except subprocess.TimeoutExpired:
+            self.proc.kill()
+
+
+def row(results, name, value):
+    v = int(round(value))
+    results.append((name, {'n': 1, 'min': v, 'median': v, 'max': v}))
+
+
+def wait_app(emu, timeout):
+    emu.pty.expect(rb'EasyLogger V[\d.]+', timeout)
+
+
+def scenario_bench(emu, results, timeout):
+    lines = []
+    while not lines or '#bench,end' not in lines[-1]:
+        try:
+            _, line = emu.pty.expect(rb'\n', timeout)
+        except EmuError:
+            raise EmuError('no #bench,end, is the firmware built with FY_BENCH?')
+        lines.append(line.decode('ascii', 'replace'))
+    header, bench = fy_bench.parse(lines)
+    for name, r in bench:
+        results.append(('bench.' + name, r))
+    return header
+
+
+def scenario_log_flood(emu, results, timeout):
+    i0 = emu.mon.instructions()
+    emu.pty.write(b'F')
+    m, before = emu.pty.expect(rb'flood lines:(\d+) bytes:(\d+) ms:(\d+)', timeout)
+    i1 = emu.mon.instructions()
+    lines, nbytes, ms = (int(x) for x in m.groups())
+    received = len(re.findall(rb'flood \d+ tick \d+', before))
+    if received != lines or lines != FLOOD_LINES:
+        raise EmuError('log flood: %d of %d lines received' % (received, lines))
+    row(results, 'log_flood.instr_per_byte', (i1 - i0) / nbytes)
+    row(results, 'log_flood.us_per_kb', ms * 1000.0 * 1024.0 / nbytes)
+    print('log_flood   %d lines, %d bytes, %d ms virtual, %d instructions' % (lines, nbytes, ms, i1 - i0))
+
+
+def scenario_uart_echo(emu, results, timeout):
+    payload = bytes(ECHO_ALPHABET[(i * 7 + i // 5) % len(ECHO_ALPHABET)] for i in range(ECHO_BYTES))
+    echoed = bytearray()
+    t0 = time.monotonic()
+    i0 = emu.mon.instructions()
+    for pos in range(0, ECHO_BYTES, ECHO_CHUNK):
+        emu.pty.write(payload[pos:pos + ECHO_CHUNK])
+        deadline = time.monotonic() + timeout
+        while len(echoed) < pos + ECHO_CHUNK:
+            if time.monotonic() > deadline:
+                raise EmuError('uart echo: %d of %d bytes echoed' % (len(echoed), pos + ECHO_CHUNK))
+            emu.pty.fill()
+            echoed += bytes(c for c in emu.pty.buf if c in ECHO_ALPHABET)
+            emu.pty.buf = b''
+    i1 = emu.mon.instructions()
+    wall = time.monotonic() - t0
+    if bytes(echoed[:ECHO_BYTES]) != payload:
+        raise EmuError('uart echo: data mismatch')
+    row(results, 'uart_echo.instr_per_byte', (i1 - i0) / ECHO_BYTES)
+    print('uart_echo   %d bytes, %d instructions, %.0f ms wall' % (ECHO_BYTES, i1 - i0, wall * 1000.0))
+
+
+def crc16(data):
+    crc = 0
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def ymodem_packet(blk, data, size):
+    data = data.ljust(size, b'\x1a' if blk else b'\0')
+    hdr = b'\x01' if size == 128 else b'\x02'
+    return hdr + bytes([blk & 0xFF, 0xFF - (blk & 0xFF)]) + data + crc16(data).to_bytes(2, 'big')
+
+
+def ymodem_send(pty, name, image, timeout):
+    """YMODEM-1K batch of one file, last block as SOH 128 when it fits"""
+    def wait(expected):
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            c = pty.getc(0.5)
+            if c in expected:
+                return c
+            if c == 0x18:
+                raise EmuError('ymodem: cancelled by the receiver')
+        raise EmuError('ymodem: timeout waiting for %r' % expected)
+
+    def send(pkt):
+        for _ in range(10):
+            pty.write(pkt)
+            if wait((0x06, 0x15)) == 0x06:
+                return
+        raise EmuError('ymodem: too many NAKs')
+
+    wait((0x43,))
+    send(ymodem_packet(0, name.encode() + b'\0' + str(len(image)).encode(), 128))
+    wait((0x43,))
+    pos, blk = 0, 1
+    while pos < len(image):
+        size = 128 if len(image) - pos <= 128 else 1024
+        send(ymodem_packet(blk, image[pos:pos + size], size))
+        pos += size
+        blk += 1
+    pty.write(b'\x04')
+    if wait((0x06, 0x15)) == 0x15:
+        pty.write(b'\x04')
+        wait((0x06,))
+    wait((0x43,))
+    send(ymodem_packet(0, b'', 128))
+
+
+def scenario_boot_upload(emu, results, timeout, app):
+    with open(app, 'rb') as f:
+        image = f.read()
+    emu.pty.expect(rb"send the app \.bin with YMODEM", timeout)
+    i0 = emu.mon.instructions()
+    ymodem_send(emu.pty, os.path.basename(app), image, timeout)
+    m, _ = emu.pty.expect(rb'received (\d+) bytes, (\d+) pages, (\d+) ms.*?naks (\d+)', timeout)
+    i1 = emu.mon.instructions()
+    nbytes, pages, ms, naks = (int(x) for x in m.groups())
+    if nbytes != len(image):
+        raise EmuError('boot upload: %d of %d bytes written' % (nbytes, len(image)))
+    emu.pty.expect(rb'jump', timeout)
+    wait_app(emu, timeout)
+    row(results, 'boot_upload.instr_per_kb', (i1 - i0) * 1024.0 / nbytes)
+    row(results, 'boot_upload.ms', ms)
+    row(results, 'boot_upload.naks', naks)
+    print('boot_upload %d bytes, %d pages, %d ms virtual, %d naks, %d instructions' %
+          (nbytes, pages, ms, naks, i1 - i0))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('--elf', required=True, help='app ELF built with FY_EMU')
+    ap.add_argument('--boot', help='bootloader ELF (FY_BOOTLOADER), enables boot_upload')
+    ap.add_argument('--app', help='app image with CRC footer for boot_upload (STM32F103_app.bin)')
+    ap.add_argument('--scenarios', default='bench,log_flood,uart_echo,boot_upload',
+                    help='comma separated, default %(default)s; missing inputs skip bench/boot_upload')
+    ap.add_argument('--renode', default='renode')
+    ap.add_argument('--renode-args', default='--disable-xwt --hide-log', help='extra Renode options')
+    ap.add_argument('--platform', default='platforms/cpus/stm32f103.repl', help='Renode platform description')
+    ap.add_argument('--uart', default='sysbus.usart1', help='USART1 in the platform')
+    ap.add_argument('--mips', type=int, default=72)
+    ap.add_argument('--monitor-port', type=int, default=12345)
+    ap.add_argument('--timeout', type=float, default=60.0, help='seconds per step')
+    ap.add_argument('-o', '--output', help='CSV file (fy_bench.py format), default stdout')
+    ap.add_argument('-v', '--verbose', action='store_true', help='show Renode output and USART1')
+    args = ap.parse_args()
+
+    scenarios = [s for s in args.scenarios.split(',') if s]
+    results = []
+    header = {'unit': 'mixed', 'mips': str(args.mips)}
+    with tempfile.TemporaryDirectory(prefix='fy_emu_') as workdir:
+        app_scenarios = [s for s in scenarios if s in ('bench', 'log_flood', 'uart_echo')]
+        if app_scenarios:
+            # behind the bootloader the app starts after BOOT_WAIT_MS
+            emu = Emulator(args, [args.boot, args.elf] if args.boot else [args.elf], workdir, 'app')
+            try:
+                wait_app(emu, args.timeout)
+                if 'bench' in app_scenarios:
+                    try:
+                        header.update(bench_unit=scenario_bench(emu, results, 10.0).get('unit', ''))
+                    except EmuError as e:
+                        print('bench skipped: %s' % e, file=sys.stderr)
+                if 'log_flood' in app_scenarios:
+                    scenario_log_flood(emu, results, args.timeout)
+                if 'uart_echo' in app_scenarios:
+                    scenario_uart_echo(emu, results, args.timeout)
+            finally:
+                emu.close()
+        if 'boot_upload' in scenarios:
+            if not (args.boot and args.app):
+                print('boot_upload skipped: needs --boot and --app', file=sys.stderr)
+            else:
+                emu = Emulator(args, [args.boot], workdir, 'boot')
+                try:
+                    scenario_boot_upload(emu, results, args.timeout, args.app)
+                finally:
+                    emu.close()
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            fy_bench.write_csv(f, header, results)
+    else:
+        fy_bench.write_csv(sys.stdout, header, results)
+    return 0
+
+
+if __name__ == '__main__':
+    try:
+        sys.exit(main())
+    except EmuError as e:
+        print('error: %s' % e, file=sys.stderr)
+        sys.exit(1)
@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+"""
+App image footer for the bootloader CRC check (User/Drivers/Crc/Inc/fy_crc.h).
+
+The raw .bin is padded to a multiple of 4 with 0xFF, the reserved vector table
+entries 7 and 8 get the magic and the image length, and the CRC-32 of the
+patched image is appended. The CRC is the one of the STM32 CRC peripheral:
+polynomial 0x04C11DB7, init 0xFFFFFFFF, 32-bit little-endian words fed MSB
+first, no reflection, no final XOR.
+
+    # build time (FY_BOOTLOADER=ON): STM32F103.bin -> STM32F103_app.bin
+    fy_image.py pack STM32F103.bin -o STM32F103_app.bin --max 49152
+
+    # check an image file (or a flash dump of the app region)
+    fy_image.py check STM32F103_app.bin
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = 0x50415946  # "FYAP"
+MAGIC_OFFSET = 0x1C
+SIZE_OFFSET = 0x20
+MIN_SIZE = 0x24
+POLY = 0x04C11DB7
+
+
+def _table():
+    table = []
+    for i in range(256):
+        c = i << 24
+        for _ in range(8):
+            c = ((c << 1) ^ POLY) if c & 0x80000000 else (c << 1)
+        table.append(c & 0xFFFFFFFF)
+    return table
+
+
+TABLE = _table()
+
+
+def crc32_stm32(data, crc=0xFFFFFFFF):
+    """CRC of the STM32 CRC peripheral over len(data)/4 little-endian words."""
+    if len(data) % 4:
+        raise ValueError("length must be a multiple of 4")
+    for (word,) in struct.iter_unpack("<I", data):
+        crc ^= word
+        for _ in range(4):
+            crc = ((crc << 8) & 0xFFFFFFFF) ^ TABLE[crc >> 24]
+    return crc
+
+
+def pack(raw, max_size=None):
+    image = bytearray(raw)
+    if len(image) < MIN_SIZE:
+        raise ValueError("image too small for a vector table")
+    image += b"\xff" * (-len(image) % 4)
+    magic, size = struct.unpack_from("<II", image, MAGIC_OFFSET)
+    if magic == MAGIC:
+        raise ValueError("image already has a footer")
+    if magic != 0 or size != 0:
+        raise ValueError("reserved vector table entries 7/8 are not zero")
+    struct.pack_into("<II", image, MAGIC_OFFSET, MAGIC, len(image))
+    image += struct.pack("<I", crc32_stm32(bytes(image)))
+    if max_size is not None and len(image) > max_size:
+        raise ValueError("image with footer is %d bytes, the region is %d" % (len(image), max_size))
+    return bytes(image)
+
+
+def check(image):
+    """Returns (status, length, crc): 'ok', 'no footer', 'bad size' or 'bad crc'."""
+    if len(image) < MIN_SIZE:
+        return "bad size", 0, None
+    magic, size = struct.unpack_from("<II", image, MAGIC_OFFSET)
+    if magic != MAGIC:
+        return "no footer", 0, None
+    if size < MIN_SIZE or size % 4 or size + 4 > len(image):
+        return "bad size", size, None
+    crc = crc32_stm32(image[:size])
+    (stored,) = struct.unpack_from("<I", image, size)
+    return ("ok" if crc == stored else "bad crc"), size, crc
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="cmd", required=True)
+    p = sub.add_parser("pack", help="add the length and CRC footer to a raw .bin")
+    p.add_argument("input")
+    p.add_argument("-o", "--output", required=True)
+    p.add_argument("--max", type=lambda s: int(s, 0), default=None, help="app region size in bytes")
+    c = sub.add_parser("check", help="verify the footer of an image")
+    c.add_argument("input")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        data = f.read()
+    if args.cmd == "pack":
+        try:
+            image = pack(data, args.max)
+        except ValueError as e:
+            print("fy_image: %s" % e, file=sys.stderr)
+            return 1
+        with open(args.output, "wb") as f:
+            f.write(image)
+        print("fy_image: %s, %d bytes, crc 0x%08X" % (args.output, len(image) - 4, crc32_stm32(image[:-4])))
+        return 0
+    status, size, crc = check(data)
+    print("%s: %s, %d bytes%s" % (args.input, status, size, "" if crc is None else ", crc 0x%08X" % crc))
+    return 0 if status == "ok" else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,260 @@
+#!/usr/bin/env python3
+"""
+Collect and symbolize the sampling profile of User/Middlewares/Prof.
+
+The firmware built with FY_PROF samples continuously and prints the histogram
+on USART1 when it receives 'P' (prof_sim prints it on stdout):
+
+    #prof,v1,hz=997,samples=N,dropped=D,ms=M,overhead_permille=P,sample_max=C
+    prof,<pc hex>,<lr hex>,<count>
+    #prof,end
+
+Everything else on the line (log output) is ignored. collect saves one dump,
+report maps the PCs to functions with nm and prints a flat profile, the
+per-line profile (addr2line) or folded stacks for flamegraph.pl/speedscope.
+The caller from the stacked LR is only exact for leaf functions.
+
+    fy_prof.py collect --port /dev/ttyUSB0 -o prof.txt        sends 'P' and waits for the dump
+    fy_prof.py report prof.txt --elf build/Release/STM32F103.elf
+    fy_prof.py report prof.txt --elf app.elf --lines --top 20
+    fy_prof.py report prof.txt --elf app.elf --folded > prof.folded
+    build/Host/User/Middlewares/Prof/prof_sim | fy_prof.py report --elf build/Host/User/Middlewares/Prof/prof_sim --nm nm
+"""
+
+import argparse
+import bisect
+import os
+import re
+import subprocess
+import sys
+import termios
+import time
+
+LINE_RE = re.compile(r'(#?prof,.*)$')
+EM_ARM = 40
+
+
+def serial_lines(path, baud, timeout):
+    """raw 8N1 serial port without pyserial, 'P' requests the dump"""
+    speed = getattr(termios, 'B%d' % baud, None)
+    if speed is None:
+        raise SystemExit('unsupported baud rate %d' % baud)
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    attr = termios.tcgetattr(fd)
+    attr[0] = 0                                     # iflag
+    attr[1] = 0                                     # oflag
+    attr[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+    attr[3] = 0                                     # lflag
+    attr[4] = attr[5] = speed
+    attr[6][termios.VMIN] = 0
+    attr[6][termios.VTIME] = 1
+    termios.tcsetattr(fd, termios.TCSANOW, attr)
+    termios.tcflush(fd, termios.TCIOFLUSH)
+    os.write(fd, b'P')
+    deadline = time.monotonic() + timeout
+    buf = b''
+    try:
+        while time.monotonic() < deadline:
+            chunk = os.read(fd, 256)
+            buf += chunk
+            while b'\n' in buf:
+                line, buf = buf.split(b'\n', 1)
+                yield line.decode('ascii', 'replace')
+    finally:
+        os.close(fd)
+    raise SystemExit('timeout waiting for #prof,end on %s' % path)
+
+
+def source_lines(args):
+    if args.port:
+        return serial_lines(args.port, args.baud, args.timeout)
+    if args.input in (None, '-'):
+        return sys.stdin
+    return open(args.input, 'r', errors='replace')
+
+
+def parse(lines):
+    """return (header dict, [(pc, lr, count)]) of the first complete dump"""
+    header, samples, done = None, [], None
+    for raw in lines:
+        m = LINE_RE.search(raw.rstrip('\r\n'))
+        if not m:
+            continue
+        fields = m.group(1).split(',')
+        if fields[0] == '#prof' and len(fields) > 1 and fields[1] == 'v1':
+            header = dict(f.split('=', 1) for f in fields[2:] if '=' in f)
+            samples = []
+        elif fields[0] == '#prof' and fields[1:] == ['end'] and header is not None:
+            done = (header, samples)
+            break
+        elif fields[0] == 'prof' and header is not None and len(fields) == 4:
+            try:
+                samples.append((int(fields[1], 16), int(fields[2], 16), int(fields[3])))
+            except ValueError:
+                pass                                # garbled line
+    if done is None:
+        raise SystemExit('no complete profile dump found')
+    return done
+
+
+def write_dump(f, header, samples):
+    f.write('#prof,v1,%s\n' % ','.join('%s=%s' % kv for kv in header.items()))
+    for pc, lr, count in samples:
+        f.write('prof,%08x,%08x,%d\n' % (pc, lr, count))
+    f.write('#prof,end\n')
+
+
+class Symbols:
+    """function symbols of an ELF from nm, Thumb bit cleared on ARM"""
+
+    def __init__(self, elf, nm):
+        with open(elf, 'rb') as f:
+            ident = f.read(20)
+        if ident[:4] != b'\x7fELF':
+            raise SystemExit('%s: not an ELF file' % elf)
+        machine = int.from_bytes(ident[18:20], 'little' if ident[5] == 1 else 'big')
+        mask = ~1 if machine == EM_ARM else ~0
+        try:
+            out = subprocess.run([nm, '-n', '-S', '--defined-only', elf], check=True,
+                                 stdout=subprocess.PIPE, universal_newlines=True).stdout
+        except (OSError, subprocess.CalledProcessError) as e:
+            raise SystemExit('%s: %s' % (nm, e))
+        syms = {}
+        for line in out.splitlines():
+            parts = line.split()
+            if len(parts) == 4:
+                addr, size, kind, name = parts
+            elif len(parts) == 3:
+                (addr, kind, name), size = parts, '0'
+            else:
+                continue
+            if kind not in 'tTwW':
+                continue
+            a = int(addr, 16) & mask
+            s = int(size, 16)
+            # aliases (weak handlers on Default_Handler): keep the sized/first one
+            if a not in syms or (syms[a][0] == 0 and s):
+                syms[a] = (s, name)
+        self.addrs = sorted(syms)
+        self.syms = [syms[a] for a in self.addrs]
+        self.arm = machine == EM_ARM
+
+    def lookup(self, addr):
+        i = bisect.bisect_right(self.addrs, addr) - 1
+        if i < 0:
+            return None
+        size, name = self.syms[i]
+        if size and addr >= self.addrs[i] + size:
+            return None
+        return name
+
+    def name(self, addr):
+        return self.lookup(addr) or '0x%08x' % addr
+
+    def caller(self, lr):
+        """function containing the call that set lr, None for EXC_RETURN and 0"""
+        if lr == 0 or (self.arm and lr >= 0xfffffff0):
+            return None
+        return self.lookup((lr & ~1) - 1)
+
+
+def addr2line(tool, elf, pcs):
+    if not pcs:
+        return {}
+    try:
+        out = subprocess.run([tool, '-e', elf] + ['%x' % pc for pc in pcs], check=True,
+                             stdout=subprocess.PIPE, universal_newlines=True).stdout
+    except (OSError, subprocess.CalledProcessError) as e:
+        raise SystemExit('%s: %s' % (tool, e))
+    return dict(zip(pcs, (l.strip() for l in out.splitlines())))
+
+
+def print_table(rows, total, label):
+    print('%8s %6s %6s  %s' % ('samples', '%', 'cum%', label))
+    cum = 0
+    for key, n in rows:
+        cum += n
+        print('%8d %5.1f%% %5.1f%%  %s' % (n, 100.0 * n / total, 100.0 * cum / total, key))
+
+
+def cmd_collect(args):
+    header, samples = parse(source_lines(args))
+    if args.output:
+        with open(args.output, 'w') as f:
+            write_dump(f, header, samples)
+    else:
+        write_dump(sys.stdout, header, samples)
+    print('%s samples, %d addresses' % (header.get('samples', '?'), len(samples)), file=sys.stderr)
+    return 0
+
+
+def cmd_report(args):
+    header, samples = parse(source_lines(args))
+    syms = Symbols(args.elf, args.nm)
+    total = sum(n for _, _, n in samples)
+    if total == 0:
+        raise SystemExit('empty profile')
+
+    if args.folded:
+        stacks = {}
+        for pc, lr, n in samples:
+            func, caller = syms.name(pc & ~1), syms.caller(lr)
+            key = '%s;%s' % (caller, func) if caller and caller != func else func
+            stacks[key] = stacks.get(key, 0) + n
+        for key, n in sorted(stacks.items(), key=lambda kv: -kv[1]):
+            print('%s %d' % (key, n))
+        return 0
+
+    print('# samples=%s dropped=%s ms=%s hz=%s overhead=%.1f%% sample_max=%s' % (
+        header.get('samples', '?'), header.get('dropped', '?'), header.get('ms', '?'), header.get('hz', '?'),
+        int(header.get('overhead_permille', 0)) / 10.0, header.get('sample_max', '?')))
+    if args.lines:
+        tool = args.addr2line or re.sub(r'nm$', 'addr2line', args.nm)
+        where = addr2line(tool, args.elf, sorted({pc & ~1 for pc, _, _ in samples}))
+        counts = {}
+        for pc, _, n in samples:
+            key = '%s %s' % (syms.name(pc & ~1), where.get(pc & ~1, '??'))
+            counts[key] = counts.get(key, 0) + n
+        label = 'function file:line'
+    else:
+        counts = {}
+        for pc, _, n in samples:
+            key = syms.name(pc & ~1)
+            counts[key] = counts.get(key, 0) + n
+        label = 'function'
+    rows = sorted(counts.items(), key=lambda kv: -kv[1])
+    print_table(rows[:args.top] if args.top else rows, total, label)
+    return 0
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = ap.add_subparsers(dest='cmd', required=True)
+
+    def add_source(p):
+        p.add_argument('input', nargs='?', help="captured output, '-' or omitted for stdin")
+        p.add_argument('--port', help='serial port of the board (USART1), sends P')
+        p.add_argument('--baud', type=int, default=115200)
+        p.add_argument('--timeout', type=float, default=10.0, help='seconds (serial port)')
+
+    c = sub.add_parser('collect', help='read one profile dump and save it')
+    add_source(c)
+    c.add_argument('-o', '--output', help='dump file, default stdout')
+    c.set_defaults(func=cmd_collect)
+
+    r = sub.add_parser('report', help='symbolize a dump against the ELF')
+    add_source(r)
+    r.add_argument('--elf', required=True, help='the image that produced the dump')
+    r.add_argument('--nm', default='arm-none-eabi-nm')
+    r.add_argument('--addr2line', help='default: --nm with addr2line for nm')
+    r.add_argument('--lines', action='store_true', help='profile by source line')
+    r.add_argument('--folded', action='store_true', help='caller;function count lines for flamegraph.pl')
+    r.add_argument('--top', type=int, default=0, help='only the first N rows')
+    r.set_defaults(func=cmd_report)
+
+    args = ap.parse_args()
+    sys.exit(args.func(args))
+
+
+if __name__ == '__main__':
+    main()
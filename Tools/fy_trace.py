@@ -0,0 +1,244 @@
+#!/usr/bin/env python3
+"""
+Collect the event trace of User/Middlewares/Trace and convert it to Chrome trace JSON.
+
+The firmware built with FY_TRACE streams the records on USART1 between the log
+lines (trace_sim prints the same stream on stdout):
+
+    #trace,v1,hz=72000000,records=256,cost=40,lost=0
+    #trace,names,<id>=<name>,...
+    #T,<seq>,<cycles:8 type:2 id:2 arg:4>,...      hex, seq counts lines mod 256
+
+Everything else on the line is ignored. collect keeps only the trace lines,
+convert writes JSON for chrome://tracing or ui.perfetto.dev: interrupts
+(id 0-15) as nested slices on the "Handler" track with the fy_uart events
+(16-31) as instants, tasks and user ids (32-63) on the "Thread" track.
+Lost records and missing lines show up as global instants; slices open
+across such a gap are dropped.
+
+    fy_trace.py collect --port /dev/ttyUSB0 --seconds 10 -o trace.txt   sends 'T' for the names first
+    fy_trace.py convert trace.txt -o trace.json --summary
+    build/Host/User/Middlewares/Trace/trace_sim | fy_trace.py convert -o trace.json --summary
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+import termios
+import time
+
+LINE_RE = re.compile(r'(#trace,.*|#T,.*)$')
+T_ENTER, T_EXIT, T_EVENT, T_LOST, T_SYNC = range(5)
+ID_USER = 32
+TID_HANDLER, TID_THREAD = 1, 2
+
+
+def serial_lines(path, baud, seconds):
+    """raw 8N1 serial port without pyserial, 'T' repeats the header and names"""
+    speed = getattr(termios, 'B%d' % baud, None)
+    if speed is None:
+        raise SystemExit('unsupported baud rate %d' % baud)
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    attr = termios.tcgetattr(fd)
+    attr[0] = 0                                     # iflag
+    attr[1] = 0                                     # oflag
+    attr[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+    attr[3] = 0                                     # lflag
+    attr[4] = attr[5] = speed
+    attr[6][termios.VMIN] = 0
+    attr[6][termios.VTIME] = 1
+    termios.tcsetattr(fd, termios.TCSANOW, attr)
+    termios.tcflush(fd, termios.TCIOFLUSH)
+    os.write(fd, b'T')
+    deadline = time.monotonic() + seconds
+    buf = b''
+    try:
+        while time.monotonic() < deadline:
+            buf += os.read(fd, 256)
+            while b'\n' in buf:
+                line, buf = buf.split(b'\n', 1)
+                yield line.decode('ascii', 'replace')
+    finally:
+        os.close(fd)
+
+
+def source_lines(args):
+    if getattr(args, 'port', None):
+        return serial_lines(args.port, args.baud, args.seconds)
+    if args.input in (None, '-'):
+        return sys.stdin
+    return open(args.input, 'r', errors='replace')
+
+
+def trace_lines(lines):
+    for raw in lines:
+        m = LINE_RE.search(raw.rstrip('\r\n'))
+        if m:
+            yield m.group(1)
+
+
+class Converter:
+    def __init__(self, hz):
+        self.hz = hz
+        self.header = {}
+        self.names = {}
+        self.events = []
+        self.stacks = {TID_HANDLER: [], TID_THREAD: []}
+        self.seq = None
+        self.base = None
+        self.last = None
+        self.wrap = 0
+        self.lost_records = 0
+        self.lost_lines = 0
+        self.records = 0
+
+    def name(self, id_):
+        return self.names.get(id_, 'id%d' % id_)
+
+    def ts(self, cycles):
+        """unwrap the 32-bit counter (records are at most ~59 s apart at 72 MHz, SYNC every second)"""
+        if self.last is not None and cycles < self.last:
+            self.wrap += 1 << 32
+        self.last = cycles
+        t = self.wrap + cycles
+        if self.base is None:
+            self.base = t
+        return (t - self.base) * 1e6 / self.hz
+
+    def gap(self, ts, label):
+        for stack in self.stacks.values():
+            stack.clear()
+        self.events.append({'name': label, 'ph': 'i', 's': 'g', 'ts': ts, 'pid': 1, 'tid': TID_HANDLER})
+
+    def line(self, text):
+        fields = text.split(',')
+        if fields[0] == '#trace':
+            if len(fields) > 1 and fields[1] == 'v1':
+                self.header = dict(f.split('=', 1) for f in fields[2:] if '=' in f)
+                if 'hz' in self.header and not self.hz_fixed:
+                    self.hz = int(self.header['hz'])
+            elif len(fields) > 1 and fields[1] == 'names':
+                for f in fields[2:]:
+                    id_, _, name = f.partition('=')
+                    if id_.isdigit():
+                        self.names[int(id_)] = name
+            return
+        try:
+            seq = int(fields[1], 16)
+            recs = [(int(r[0:8], 16), int(r[8:10], 16), int(r[10:12], 16), int(r[12:16], 16))
+                    for r in fields[2:] if len(r) == 16]
+        except (IndexError, ValueError):
+            return                                  # garbled line
+        if len(recs) != len(fields) - 2:
+            return
+        missing = 0 if self.seq is None else (seq - self.seq - 1) & 0xff
+        self.seq = seq
+        for i, (cycles, type_, id_, arg) in enumerate(recs):
+            ts = self.ts(cycles)
+            if i == 0 and missing:
+                self.lost_lines += missing
+                self.gap(ts, 'lost %d lines' % missing)
+            self.record(ts, type_, id_, arg)
+
+    def record(self, ts, type_, id_, arg):
+        self.records += 1
+        tid = TID_HANDLER if id_ < ID_USER else TID_THREAD
+        if type_ == T_ENTER:
+            self.stacks[tid].append((id_, ts))
+        elif type_ == T_EXIT:
+            stack = self.stacks[tid]
+            for i in range(len(stack) - 1, -1, -1):
+                if stack[i][0] == id_:
+                    begin = stack[i][1]
+                    del stack[i:]                   # inner slices without an exit are dropped
+                    self.events.append({'name': self.name(id_), 'ph': 'X', 'ts': begin, 'dur': ts - begin,
+                                        'pid': 1, 'tid': tid})
+                    break
+        elif type_ == T_EVENT:
+            self.events.append({'name': self.name(id_), 'ph': 'i', 's': 't', 'ts': ts, 'pid': 1, 'tid': tid,
+                                'args': {'arg': arg}})
+        elif type_ == T_LOST:
+            self.lost_records += arg
+            self.gap(ts, 'lost %d records' % arg)
+
+    def json(self):
+        meta = [{'name': 'process_name', 'ph': 'M', 'pid': 1, 'args': {'name': 'STM32F103'}},
+                {'name': 'thread_name', 'ph': 'M', 'pid': 1, 'tid': TID_HANDLER, 'args': {'name': 'Handler'}},
+                {'name': 'thread_name', 'ph': 'M', 'pid': 1, 'tid': TID_THREAD, 'args': {'name': 'Thread'}}]
+        return {'traceEvents': meta + self.events, 'displayTimeUnit': 'ns',
+                'otherData': dict(self.header, lost_records=self.lost_records, lost_lines=self.lost_lines)}
+
+    def summary(self, f):
+        slices, instants = {}, {}
+        for e in self.events:
+            if e['ph'] == 'X':
+                slices.setdefault(e['name'], []).append(e['dur'])
+            elif e['ph'] == 'i' and e['s'] == 't':
+                instants.setdefault(e['name'], []).append(e['ts'])
+        span = max((e['ts'] + e.get('dur', 0) for e in self.events), default=0.0)
+        f.write('# %d records, %.1f ms, lost %d records, %d lines, record cost %s cycles\n' % (
+            self.records, span / 1000.0, self.lost_records, self.lost_lines, self.header.get('cost', '?')))
+        f.write('%-16s %7s %10s %9s %9s %6s\n' % ('slice', 'count', 'total us', 'mean us', 'max us', 'busy%'))
+        for name, d in sorted(slices.items(), key=lambda kv: -sum(kv[1])):
+            f.write('%-16s %7d %10.1f %9.2f %9.2f %5.1f%%\n' % (name, len(d), sum(d), sum(d) / len(d), max(d),
+                    100.0 * sum(d) / span if span else 0.0))
+        f.write('%-16s %7s %10s %9s\n' % ('event', 'count', 'min gap us', 'max gap us'))
+        for name, ts in sorted(instants.items()):
+            gaps = [b - a for a, b in zip(ts, ts[1:])]
+            f.write('%-16s %7d %10.1f %10.1f\n' % (name, len(ts), min(gaps, default=0.0), max(gaps, default=0.0)))
+
+
+def cmd_collect(args):
+    out = open(args.output, 'w') if args.output else sys.stdout
+    n = 0
+    for text in trace_lines(source_lines(args)):
+        out.write(text + '\n')
+        n += 1
+    if args.output:
+        out.close()
+    print('%d trace lines' % n, file=sys.stderr)
+    return 0
+
+
+def cmd_convert(args):
+    conv = Converter(args.hz or 72000000)
+    conv.hz_fixed = args.hz is not None
+    for text in trace_lines(source_lines(args)):
+        conv.line(text)
+    if conv.records == 0:
+        raise SystemExit('no trace records found')
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(conv.json(), f)
+    if args.summary or not args.output:
+        conv.summary(sys.stdout if args.output else sys.stderr)
+    return 0
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = ap.add_subparsers(dest='cmd', required=True)
+
+    c = sub.add_parser('collect', help='keep the trace lines of a capture')
+    c.add_argument('input', nargs='?', help="captured output, '-' or omitted for stdin")
+    c.add_argument('--port', help='serial port of the board (USART1), sends T')
+    c.add_argument('--baud', type=int, default=115200)
+    c.add_argument('--seconds', type=float, default=10.0, help='capture time on the serial port')
+    c.add_argument('-o', '--output', help='trace file, default stdout')
+    c.set_defaults(func=cmd_collect)
+
+    v = sub.add_parser('convert', help='write Chrome trace JSON')
+    v.add_argument('input', nargs='?', help="trace lines, '-' or omitted for stdin")
+    v.add_argument('-o', '--output', help='JSON file (without it only the summary is printed)')
+    v.add_argument('--hz', type=int, help='timestamp clock, default from the header or 72 MHz')
+    v.add_argument('--summary', action='store_true', help='print per-slice and per-event statistics')
+    v.set_defaults(func=cmd_convert)
+
+    args = ap.parse_args()
+    sys.exit(args.func(args))
+
+
+if __name__ == '__main__':
+    main()
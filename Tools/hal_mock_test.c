@@ -0,0 +1,549 @@
+/*
+ * Host check of fy_uart, elog and fy_mpu6050 against the HAL mock (Tools/HalMock).
+ *
+ * The drivers are compiled from the firmware sources unchanged and run on the
+ * simulated USART1/DMA1/I2C2 with the CubeMX configuration of the target:
+ *  - masked interrupts stay pending and run when PRIMASK is cleared
+ *  - uartTx keeps the line busy (utilization) and every byte arrives in order,
+ *    also across tx_rb wrap-around and HT early release
+ *  - fy_uart_tx_buffer calls done in queue order; a DMA transfer error drops
+ *    the segment, counts tx_error_count and the queue carries on
+ *  - uartTx whose descriptor slot an ISR takes after the queue check returns 0
+ *    and leaves nothing in tx_rb
+ *  - DMA_IDLE reception of random bursts is byte exact and needs a handful of
+ *    interrupts per burst; a reader that stops is reported as rx_overrun_count
+ *  - IT reception: ORE under a long masked section and a noise error are
+ *    counted and reception resumes
+ *  - deinit while a transfer is in flight, then init again
+ *  - fy_mpu6050 on a simulated sensor: init/WHO_AM_I, single reads, FIFO stream
+ *    with continuous frames and timestamps, overflow reset, missing device
+ *  - elog async output through uartTx reaches the line
+ *
+ *   hal_mock_test
+ */
+#include "hal_mock.h"
+#include "usart.h"
+#include "i2c.h"
+#include "fy_uart.h"
+#include "fy_mpu6050.h"
+#include "elog.h"
+#include <stdio.h>
+#include <string.h>
+
+static uint32_t errors;
+static unsigned seed = 1;
+
+static unsigned sim_rand(unsigned max)
+{
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 16) % max;
+}
+
+static void expect(int cond, const char *what)
+{
+    if (!cond) {
+        printf("ERROR: %s\n", what);
+        errors++;
+    }
+}
+
+/* UART --------------------------------------------------------------------*/
+#define WIRE_MAX    65536U
+
+/* DMA地址寄存器只有32位，DMA访问的缓冲区都放在静态区 */
+static uint8_t uart_rx_buffer[256];
+static uint8_t uart_tx_buffer[256];
+static ringBuffer_t uart_rx_rb;
+static ringBuffer_t uart_tx_rb;
+static fy_uart_t uart;
+
+static uint8_t wire[WIRE_MAX];//发送端收到的字节
+static size_t wire_len;
+static uint8_t pattern[WIRE_MAX];
+
+static void wire_sink(void *ctx, uint8_t byte)
+{
+    (void)ctx;
+    if (wire_len < WIRE_MAX) {
+        wire[wire_len] = byte;
+    }
+    wire_len++;
+}
+
+static void uart_setup(fy_uart_rx_mode_t mode)
+{
+    hal_mock_reset();
+    MX_USART1_UART_Init();
+    ringBuffer_init(&uart_rx_rb, uart_rx_buffer, sizeof(uart_rx_buffer));
+    ringBuffer_init(&uart_tx_rb, uart_tx_buffer, sizeof(uart_tx_buffer));
+    wire_len = 0;
+    hal_mock_uart_set_tx_sink(USART1, wire_sink, NULL);
+    expect(fy_uart_init_ex(&uart, &huart1, &uart_rx_rb, &uart_tx_rb, mode) == 0, "fy_uart_init_ex");
+}
+
+static int tx_drained(void *ctx)
+{
+    (void)ctx;
+    return !uart.tx_busy && uart.tx_q_count == 0 && hal_mock_uart_tx_idle(USART1);
+}
+
+static void uart_drain(void)
+{
+    expect(hal_mock_run_until(tx_drained, NULL, HAL_MOCK_MS(5000)) == 0, "tx drains");
+}
+
+static uint64_t byte_time(void)
+{
+    return hal_mock_uart_stats(USART1)->byte_cycles;
+}
+
+static void test_core(void)
+{
+    uint32_t irqs;
+
+    hal_mock_reset();
+    HAL_Delay(5);
+    expect(HAL_GetTick() == 5, "HAL_GetTick follows the cycle clock");
+    hal_mock_advance(HAL_MOCK_US(999));
+    expect(HAL_GetTick() == 5, "tick does not round up");
+
+    //关中断期间到达的字节：中断保持挂起，开中断时补执行
+    uart_setup(FY_UART_RX_IT);
+    irqs = hal_mock_irq_count(USART1_IRQn);
+    __disable_irq();
+    hal_mock_uart_inject(USART1, (const uint8_t *)"A", 1);
+    hal_mock_advance(byte_time() * 4);
+    expect(hal_mock_irq_count(USART1_IRQn) == irqs, "masked IRQ stays pending");
+    __enable_irq();
+    expect(hal_mock_irq_count(USART1_IRQn) == irqs + 1, "pending IRQ runs on enable");
+    expect(uart_rx_rb.used(&uart_rx_rb) == 1, "byte delivered after enable");
+    fy_uart_deinit(&uart);
+}
+
+static void test_tx_stream(void)
+{
+    const size_t total = 40000;
+    size_t sent = 0;
+    uint32_t util;
+
+    uart_setup(FY_UART_RX_DMA_IDLE);
+    for (size_t i = 0; i < total; i++) {
+        pattern[i] = (uint8_t)sim_rand(256);
+    }
+    //生产者按随机块写入，每次写不下时等待一段时间
+    while (sent < total) {
+        size_t n = 1 + sim_rand(100);
+
+        if (n > total - sent) n = total - sent;
+        sent += uart.uartTx(&uart, pattern + sent, n);
+        hal_mock_advance(byte_time() * (1 + sim_rand(40)));
+    }
+    uart_drain();
+    expect(wire_len == total, "tx byte count");
+    expect(memcmp(wire, pattern, total) == 0, "tx bytes in order");
+    expect(uart.tx_bytes == total, "tx_bytes");
+    util = fy_uart_tx_line_utilization(&uart);
+    expect(util >= 990, "tx line stays busy");
+    printf("tx stream: %lu bytes, %lu DMA starts, utilization %lu permille, %lu DMA IRQs\n",
+           (unsigned long)total, (unsigned long)uart.tx_dma_starts, (unsigned long)util,
+           (unsigned long)hal_mock_irq_count(DMA1_Channel4_IRQn));
+    fy_uart_deinit(&uart);
+}
+
+static uint8_t done_order[8];
+static uint8_t done_count;
+static uint8_t seg_a[300], seg_b[50], seg_c[1000];
+
+static void tx_done(fy_uart_t *u, void *arg)
+{
+    (void)u;
+    if (done_count < sizeof(done_order)) {
+        done_order[done_count] = (uint8_t)(uintptr_t)arg;
+    }
+    done_count++;
+}
+
+static void test_tx_buffer(void)
+{
+    size_t pos = 0;
+
+    uart_setup(FY_UART_RX_DMA_IDLE);
+    memset(seg_a, 'a', sizeof(seg_a));
+    memset(seg_b, 'b', sizeof(seg_b));
+    memset(seg_c, 'c', sizeof(seg_c));
+    done_count = 0;
+    expect(fy_uart_tx_buffer(&uart, seg_a, sizeof(seg_a), tx_done, (void *)1) == 0, "queue a");
+    expect(uart.uartTx(&uart, (const uint8_t *)"0123456789", 10) == 10, "ring data between");
+    expect(fy_uart_tx_buffer(&uart, seg_b, sizeof(seg_b), tx_done, (void *)2) == 0, "queue b");
+    expect(fy_uart_tx_buffer(&uart, seg_c, sizeof(seg_c), tx_done, (void *)3) == 0, "queue c");
+    uart_drain();
+    expect(done_count == 3 && done_order[0] == 1 && done_order[1] == 2 && done_order[2] == 3, "done in queue order");
+    expect(wire_len == sizeof(seg_a) + 10 + sizeof(seg_b) + sizeof(seg_c), "tx_buffer byte count");
+    expect(memcmp(wire, seg_a, sizeof(seg_a)) == 0, "segment a");
+    pos += sizeof(seg_a);
+    expect(memcmp(wire + pos, "0123456789", 10) == 0, "ring data between segments");
+    pos += 10;
+    expect(memcmp(wire + pos, seg_b, sizeof(seg_b)) == 0, "segment b");
+    pos += sizeof(seg_b);
+    expect(memcmp(wire + pos, seg_c, sizeof(seg_c)) == 0, "segment c");
+
+    //DMA传输错误：当前段丢弃，队列继续
+    wire_len = 0;
+    done_count = 0;
+    hal_mock_dma_inject_error(DMA1_Channel4);
+    expect(fy_uart_tx_buffer(&uart, seg_a, sizeof(seg_a), tx_done, (void *)1) == 0, "queue a");
+    expect(fy_uart_tx_buffer(&uart, seg_b, sizeof(seg_b), tx_done, (void *)2) == 0, "queue b");
+    uart_drain();
+    expect(uart.tx_error_count == 1, "tx_error_count");
+    expect(done_count == 2, "done after a DMA error");
+    expect(wire_len == sizeof(seg_b) && memcmp(wire, seg_b, sizeof(seg_b)) == 0, "queue continues after a DMA error");
+    expect(huart1.hdmatx->State == HAL_DMA_STATE_READY, "tx DMA idle");
+    fy_uart_deinit(&uart);
+}
+
+/* tx_rb的写锁在uartTx检查队列之后、进入临界区之前调用，在此模拟中断占用最后一个描述符 */
+static int isr_fill_armed;
+
+static void isr_fill_queue(void)
+{
+    if (!isr_fill_armed) return;
+    isr_fill_armed = 0;
+    expect(fy_uart_tx_buffer(&uart, seg_b, sizeof(seg_b), tx_done, (void *)2) == 0, "ISR takes the last slot");
+}
+
+static void isr_fill_done(void)
+{
+}
+
+static void test_tx_queue_race(void)
+{
+    unsigned i;
+
+    uart_setup(FY_UART_RX_DMA_IDLE);
+    ringBuffer_registerLocks(&uart_tx_rb, NULL, NULL, isr_fill_queue, isr_fill_done);
+    done_count = 0;
+    for (i = 0; i < FY_UART_TX_QUEUE_LEN - 1; i++) {
+        expect(fy_uart_tx_buffer(&uart, seg_a, sizeof(seg_a), tx_done, (void *)1) == 0, "fill the queue");
+    }
+    isr_fill_armed = 1;
+    expect(uart.uartTx(&uart, (const uint8_t *)"lost", 4) == 0, "uartTx refused when the ISR filled the queue");
+    expect(uart_tx_rb.used(&uart_tx_rb) == 0, "refused bytes taken back out of tx_rb");
+    uart_drain();
+    expect(done_count == FY_UART_TX_QUEUE_LEN, "every queued buffer done");
+    expect(wire_len == (FY_UART_TX_QUEUE_LEN - 1) * sizeof(seg_a) + sizeof(seg_b), "race byte count");
+    expect(memcmp(wire + wire_len - sizeof(seg_b), seg_b, sizeof(seg_b)) == 0, "ISR buffer sent last");
+    //之后的ring数据正常发送
+    wire_len = 0;
+    expect(uart.uartTx(&uart, (const uint8_t *)"0123456789", 10) == 10, "uartTx after the race");
+    uart_drain();
+    expect(wire_len == 10 && memcmp(wire, "0123456789", 10) == 0, "ring data after the race");
+    fy_uart_deinit(&uart);
+}
+
+static uint8_t rx_out[WIRE_MAX];
+
+static void test_rx_dma_idle(void)
+{
+    const size_t total = 50000;
+    size_t injected = 0, got = 0;
+    uint32_t bursts = 0, irqs;
+
+    uart_setup(FY_UART_RX_DMA_IDLE);
+    for (size_t i = 0; i < total; i++) {
+        pattern[i] = (uint8_t)sim_rand(256);
+    }
+    irqs = hal_mock_irq_count(USART1_IRQn) + hal_mock_irq_count(DMA1_Channel5_IRQn);
+    while (injected < total) {
+        size_t n = 1 + sim_rand(200);
+
+        if (n > total - injected) n = total - injected;
+        hal_mock_uart_inject(USART1, pattern + injected, n);
+        injected += n;
+        bursts++;
+        //读端在突发中途也读取，突发结束后空闲线送出最后一段
+        while (hal_mock_uart_rx_pending(USART1) > 0) {
+            hal_mock_advance(byte_time() * (1 + sim_rand(64)));
+            got += uart.uartRx(&uart, rx_out + got, sizeof(rx_out) - got);
+        }
+        hal_mock_advance(byte_time() * (2 + sim_rand(20)));
+        got += uart.uartRx(&uart, rx_out + got, sizeof(rx_out) - got);
+    }
+    irqs = hal_mock_irq_count(USART1_IRQn) + hal_mock_irq_count(DMA1_Channel5_IRQn) - irqs;
+    expect(got == total, "rx byte count");
+    expect(memcmp(rx_out, pattern, total) == 0, "rx bytes in order");
+    expect(uart.rx_overrun_count == 0, "no rx overrun");
+    expect(hal_mock_uart_stats(USART1)->rx_overrun == 0, "no ORE with DMA");
+    expect(irqs <= bursts * 4U, "interrupts per burst, not per byte");
+    printf("rx dma_idle: %lu bytes in %lu bursts, %lu IRQs\n",
+           (unsigned long)total, (unsigned long)bursts, (unsigned long)irqs);
+
+    //读端停止：DMA覆盖未读数据
+    hal_mock_uart_inject(USART1, pattern, 1000);
+    hal_mock_advance(byte_time() * 1100);
+    expect(uart.rx_overrun_count > 0, "rx_overrun_count when the reader stalls");
+    fy_uart_deinit(&uart);
+}
+
+static void test_rx_it(void)
+{
+    uint8_t out[64];
+
+    uart_setup(FY_UART_RX_IT);
+    for (size_t i = 0; i < 50; i++) {
+        pattern[i] = (uint8_t)sim_rand(256);
+    }
+    hal_mock_uart_inject(USART1, pattern, 50);
+    hal_mock_advance(byte_time() * 60);
+    expect(uart.uartRx(&uart, out, sizeof(out)) == 50 && memcmp(out, pattern, 50) == 0, "IT rx bytes");
+    expect(hal_mock_irq_count(USART1_IRQn) >= 50, "one IRQ per byte");
+
+    //长时间关中断：第一个字节留在DR，其后产生ORE
+    __disable_irq();
+    hal_mock_uart_inject(USART1, pattern, 10);
+    hal_mock_advance(byte_time() * 12);
+    __enable_irq();
+    expect(hal_mock_uart_stats(USART1)->rx_overrun == 9, "ORE while masked");
+    expect(uart.rx_error_count == 1, "ORE reported once");
+    expect(uart.uartRx(&uart, out, sizeof(out)) == 1 && out[0] == pattern[0], "byte held in DR");
+    hal_mock_uart_inject(USART1, pattern + 10, 20);
+    hal_mock_advance(byte_time() * 30);
+    expect(uart.uartRx(&uart, out, sizeof(out)) == 20 && memcmp(out, pattern + 10, 20) == 0, "reception resumes after ORE");
+
+    //噪声错误：HAL照常交付该字节
+    hal_mock_uart_inject_error(USART1, USART_SR_NE);
+    hal_mock_uart_inject(USART1, pattern, 5);
+    hal_mock_advance(byte_time() * 10);
+    expect(uart.rx_error_count == 2, "noise error reported");
+    expect(uart.uartRx(&uart, out, sizeof(out)) == 5 && memcmp(out, pattern, 5) == 0, "bytes around a noise error");
+    fy_uart_deinit(&uart);
+}
+
+static void test_reinit(void)
+{
+    uart_setup(FY_UART_RX_IT);
+    uart.uartTx(&uart, (const uint8_t *)"abcdefghijklmnopqrstuvwxyz", 26);
+    hal_mock_advance(byte_time() * 5);
+    expect(uart.tx_busy, "transfer in flight");
+    expect(fy_uart_deinit(&uart) == 0, "deinit");
+    expect(huart1.hdmatx->State == HAL_DMA_STATE_READY, "tx DMA aborted");
+    expect(!(USART1->CR3 & USART_CR3_DMAT), "DMAT cleared");
+    hal_mock_advance(byte_time() * 30);
+    expect(wire_len < 26, "nothing sent after deinit");
+
+    ringBuffer_init(&uart_tx_rb, uart_tx_buffer, sizeof(uart_tx_buffer));
+    expect(fy_uart_init_ex(&uart, &huart1, &uart_rx_rb, &uart_tx_rb, FY_UART_RX_DMA_IDLE) == 0, "init again");
+    wire_len = 0;
+    uart.uartTx(&uart, (const uint8_t *)"hello", 5);
+    uart_drain();
+    expect(wire_len == 5 && memcmp(wire, "hello", 5) == 0, "tx after reinit");
+    hal_mock_uart_inject(USART1, (const uint8_t *)"world", 5);
+    hal_mock_advance(byte_time() * 8);
+    expect(uart.uartRx(&uart, rx_out, sizeof(rx_out)) == 5 && memcmp(rx_out, "world", 5) == 0, "rx after reinit");
+    fy_uart_deinit(&uart);
+}
+
+/* MPU6050 -------------------------------------------------------------------*/
+/* 寄存器与按时间产生帧的FIFO，帧内容为帧序号，FIFO复位后序号从0开始 */
+typedef struct {
+    uint8_t regs[128];
+    uint64_t fifo_t0;//FIFO复位时刻
+    uint32_t fifo_read;//已读出的帧数
+    uint32_t fifo_resets;
+} fake_mpu_t;
+
+static fake_mpu_t fake;
+
+static uint64_t fake_period(const fake_mpu_t *m)
+{
+    return HAL_MOCK_US(1000) * (1U + m->regs[MPU6050_SMPLRT_DIV]);
+}
+
+static uint32_t fake_fifo_count(const fake_mpu_t *m)
+{
+    uint64_t frames;
+
+    if (!(m->regs[MPU6050_USER_CTRL] & 0x40) || m->regs[MPU6050_FIFO_EN] == 0) {
+        return 0;
+    }
+    frames = (hal_mock_now() - m->fifo_t0) / fake_period(m) - m->fifo_read;
+    return (frames * 14U > 1024U) ? 1024U : (uint32_t)frames * 14U;
+}
+
+static void fake_frame(uint32_t seq, uint8_t *p)
+{
+    int16_t v[7] = {(int16_t)seq, (int16_t)~seq, 16384, 1234, (int16_t)(seq * 3U), 0, (int16_t)-seq};
+
+    for (int i = 0; i < 7; i++) {
+        p[2 * i] = (uint8_t)((uint16_t)v[i] >> 8);
+        p[2 * i + 1] = (uint8_t)v[i];
+    }
+}
+
+static int32_t fake_read(void *ctx, uint16_t reg, uint8_t *data, uint16_t len)
+{
+    fake_mpu_t *m = ctx;
+
+    if (reg == MPU6050_FIFO_COUNTH) {
+        uint32_t count = fake_fifo_count(m);
+
+        data[0] = (uint8_t)(count >> 8);
+        data[1] = (uint8_t)count;
+    } else if (reg == MPU6050_FIFO_R_W) {
+        for (uint16_t i = 0; i + 14U <= len; i += 14U) {
+            fake_frame(m->fifo_read++, data + i);
+        }
+    } else if (reg == MPU6050_ACCEL_XOUT_H) {
+        fake_frame(0x1234, data);
+    } else {
+        memcpy(data, &m->regs[reg & 0x7F], len);
+    }
+    return 0;
+}
+
+static int32_t fake_write(void *ctx, uint16_t reg, const uint8_t *data, uint16_t len)
+{
+    fake_mpu_t *m = ctx;
+
+    for (uint16_t i = 0; i < len; i++) {
+        m->regs[(reg + i) & 0x7F] = data[i];
+    }
+    if (reg == MPU6050_USER_CTRL && (data[0] & 0x04)) {
+        m->regs[MPU6050_USER_CTRL] &= (uint8_t)~0x04;
+        m->fifo_t0 = hal_mock_now();
+        m->fifo_read = 0;
+        m->fifo_resets++;
+    }
+    return 0;
+}
+
+static fy_mpu6050_t mpu;
+static uint8_t mpu_sample_buffer[2048];
+static ringBuffer_t mpu_sample_rb;
+static int32_t mpu_done_status;
+static uint32_t mpu_done_count;
+
+static void mpu_done(fy_mpu6050_t *m, int32_t status, void *arg)
+{
+    (void)m;
+    (void)arg;
+    mpu_done_status = status;
+    mpu_done_count++;
+}
+
+static void test_mpu6050(void)
+{
+    const hal_mock_i2c_dev_t dev = {&fake, fake_read, fake_write};
+    fy_mpu6050_sample_t s;
+    fy_mpu6050_record_t rec[64];
+    uint32_t ts, expect_seq = 0, prev_ts = 0, records = 0, gaps = 0;
+
+    hal_mock_reset();
+    MX_I2C2_Init();
+    memset(&fake, 0, sizeof(fake));
+    fake.regs[MPU6050_WHO_AM_I] = FY_MPU6050_ID;
+
+    expect(fy_mpu6050_init(&mpu, &hi2c2, MPU6050_ADDRESS, mpu_done, NULL) == -1, "init without a device");
+    expect(hal_mock_i2c_stats(I2C2)->nacks > 0, "address NACK");
+    expect(hal_mock_i2c_attach(I2C2, MPU6050_ADDRESS, &dev) == 0, "attach");
+    expect(fy_mpu6050_init(&mpu, &hi2c2, MPU6050_ADDRESS, mpu_done, NULL) == 0, "init");
+    expect(mpu.id == FY_MPU6050_ID, "WHO_AM_I");
+    expect(fake.regs[MPU6050_PWR_MGMT_1] == 0x01 && fake.regs[MPU6050_GYRO_CONFIG] == 0x18, "config written");
+
+    //单次突发读：立即返回，约390us后在中断中完成
+    expect(fy_mpu6050_read_start(&mpu) == 0, "read_start");
+    expect(fy_mpu6050_read_start(&mpu) == -1, "bus busy");
+    expect(fy_mpu6050_get_sample(&mpu, &s, NULL) == -1, "no sample before completion");
+    hal_mock_advance(HAL_MOCK_US(300));
+    expect(mpu_done_count == 0, "burst read still on the bus");
+    hal_mock_advance(HAL_MOCK_US(200));
+    expect(mpu_done_count == 1 && mpu_done_status == 0, "done callback");
+    expect(fy_mpu6050_get_sample(&mpu, &s, NULL) == 0 && s.acc_x == 0x1234 && s.acc_z == 16384, "sample");
+
+    //FIFO流模式：1kHz，每5ms排空一次
+    ringBuffer_init_spsc(&mpu_sample_rb, mpu_sample_buffer, sizeof(mpu_sample_buffer));
+    expect(fy_mpu6050_fifo_start(&mpu, &mpu_sample_rb, 0) == 0, "fifo_start");
+    for (int i = 0; i <= 200; i++) {
+        size_t n;
+
+        //最后一轮只取走还在传输中的数据
+        if (i < 200) {
+            hal_mock_advance(HAL_MOCK_MS(5));
+            fy_mpu6050_fifo_service(&mpu);
+        }
+        hal_mock_advance(HAL_MOCK_MS(2));
+        while ((n = fy_mpu6050_fifo_read(&mpu, rec, 64)) > 0) {
+            for (size_t k = 0; k < n; k++) {
+                if (rec[k].sample.acc_x != (int16_t)expect_seq || rec[k].sample.gyro_z != (int16_t)-expect_seq) gaps++;
+                if (records > 0 && rec[k].timestamp_us - prev_ts != 1000U) gaps++;
+                prev_ts = rec[k].timestamp_us;
+                expect_seq++;
+                records++;
+            }
+        }
+    }
+    expect(gaps == 0, "FIFO frames continuous with 1ms timestamps");
+    expect(records > 1300, "FIFO records");
+    expect(mpu.fifo_overflow_count == 0 && mpu.fifo_dropped == 0, "no FIFO overflow");
+
+    //停止排空100ms：FIFO溢出，复位后重新开始
+    hal_mock_advance(HAL_MOCK_MS(100));
+    fy_mpu6050_fifo_service(&mpu);
+    hal_mock_advance(HAL_MOCK_MS(2));
+    expect(mpu.fifo_overflow_count == 1, "FIFO overflow detected");
+    expect(fake.fifo_resets == 2, "FIFO reset after overflow");
+    hal_mock_advance(HAL_MOCK_MS(10));
+    fy_mpu6050_fifo_service(&mpu);
+    hal_mock_advance(HAL_MOCK_MS(5));
+    expect(fy_mpu6050_fifo_read(&mpu, rec, 64) >= 9 && rec[0].sample.acc_x == 0, "stream restarts after reset");
+    expect(fy_mpu6050_fifo_stop(&mpu) == 0, "fifo_stop");
+    printf("mpu6050: %lu FIFO records, %lu I2C transfers, bus busy %lu%%\n", (unsigned long)records,
+           (unsigned long)hal_mock_i2c_stats(I2C2)->transfers,
+           (unsigned long)(hal_mock_i2c_stats(I2C2)->busy_cycles * 100U / hal_mock_now()));
+
+    ts = HAL_GetTick();
+    expect(fy_mpu6050_read_start(&mpu) == 0, "read_start after FIFO");
+    expect(fy_mpu6050_deinit(&mpu) == 0, "deinit while busy");
+    hal_mock_advance(HAL_MOCK_MS(1));
+    expect(hi2c2.State == HAL_I2C_STATE_READY && HAL_GetTick() == ts + 1, "bus released by abort");
+}
+
+/* elog ----------------------------------------------------------------------*/
+static void elog_uart_out(const char *log, size_t size)
+{
+    uart.uartTx(&uart, (const uint8_t *)log, size);
+}
+
+static void test_elog(void)
+{
+    easy_logger_int_struct_t init = {0};
+
+    uart_setup(FY_UART_RX_DMA_IDLE);
+    init.output = elog_uart_out;
+    expect(elog_init(&init) == ELOG_NO_ERR, "elog_init");
+    elog_set_fmt(ELOG_LVL_INFO, ELOG_FMT_TAG);
+    elog_start();
+    wire_len = 0;
+    elog_i("HOST", "value %d", 42);
+    expect(wire_len == 0, "async log queued");
+    elog_async_flush();
+    uart_drain();
+    wire[wire_len < WIRE_MAX ? wire_len : WIRE_MAX - 1] = '\0';
+    expect(strstr((const char *)wire, "HOST") != NULL && strstr((const char *)wire, "value 42") != NULL, "log line on the wire");
+    elog_deinit();
+    fy_uart_deinit(&uart);
+}
+
+int main(void)
+{
+    test_core();
+    test_tx_stream();
+    test_tx_buffer();
+    test_tx_queue_race();
+    test_rx_dma_idle();
+    test_rx_it();
+    test_reinit();
+    test_mpu6050();
+    test_elog();
+    printf("%s\n", errors ? "FAIL" : "PASS");
+    return errors ? 1 : 0;
+}
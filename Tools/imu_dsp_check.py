@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+"""
+Check the IMU block pipeline (User/Middlewares/ImuDsp) against a
+double-precision reference and benchmark it per block.
+
+A synthetic MPU6050 FIFO capture (slow roll/pitch sweep, gravity, sensor
+noise) is generated with the default register setup (+-16 g, +-2000 dps),
+fed through the host build of the pipeline, and compared with:
+  - the q15 shift/scale conversion, exactly
+  - the biquad low-pass, emulated in integers (must match exactly) and run
+    in double with the same quantized coefficients
+  - the complementary filter, run in double on the reference signals
+The q15 biquad truncates its accumulator every sample. The low-pass amplifies
+that error by its DC gain of 1/A(1), so a few dozen LSB of deviation from the
+double reference are expected at the default cut-offs.
+
+    cmake -S User/Middlewares/ImuDsp -B build/imu_dsp_host -DCMAKE_BUILD_TYPE=Release
+    cmake --build build/imu_dsp_host
+    imu_dsp_check.py build/imu_dsp_host/imu_dsp_host
+
+Use --save to keep the capture, e.g. to replay it on the target.
+"""
+
+import argparse
+import math
+import random
+import struct
+import subprocess
+import sys
+
+ACCEL_LSB_G = 2048.0
+GYRO_LSB_DPS = 16.4
+ACCEL_SHIFT = 3
+GYRO_FRACT = 17855
+ACCEL_FS_G = 2.0
+GYRO_FS_RAD = 64.0
+FUSION_TAU = 0.5
+
+
+def sat16(v):
+    return max(-32768, min(32767, v))
+
+
+def make_capture(rate, seconds, seed):
+    """return (bytes, [(roll, pitch)] true attitude in degrees)"""
+    rnd = random.Random(seed)
+    frames = bytearray()
+    truth = []
+    n = int(rate * seconds)
+    for i in range(n):
+        t = i / rate
+        roll = 30.0 * math.sin(2 * math.pi * 0.5 * t)
+        pitch = 20.0 * math.sin(2 * math.pi * 0.3 * t)
+        droll = 30.0 * 2 * math.pi * 0.5 * math.cos(2 * math.pi * 0.5 * t)
+        dpitch = 20.0 * 2 * math.pi * 0.3 * math.cos(2 * math.pi * 0.3 * t)
+        r, p = math.radians(roll), math.radians(pitch)
+        ax = -math.sin(p)
+        ay = math.cos(p) * math.sin(r)
+        az = math.cos(p) * math.cos(r)
+        acc = [sat16(round((v + rnd.gauss(0, 0.02)) * ACCEL_LSB_G)) for v in (ax, ay, az)]
+        gyro = [sat16(round((v + rnd.gauss(0, 0.5)) * GYRO_LSB_DPS)) for v in (droll, dpitch, 0.0)]
+        frames += struct.pack(">7h", *acc, 2500, *gyro)
+        truth.append((roll, pitch))
+    return bytes(frames), truth
+
+
+def convert(frames):
+    """q15 conversion, bit-exact with arm_shift_q15/arm_scale_q15"""
+    out = []
+    for i in range(0, len(frames) - 13, 14):
+        v = struct.unpack_from(">7h", frames, i)
+        acc = [sat16(x << ACCEL_SHIFT) for x in v[0:3]]
+        gyro = [sat16((x * GYRO_FRACT) >> 15) for x in v[4:7]]
+        out.append(acc + gyro)
+    return out
+
+
+def biquad_q15(x, coeffs):
+    """integer model of arm_biquad_cascade_df1_q15 (64-bit acc, >> (15 - postShift))"""
+    y = x
+    for c in coeffs:
+        b0, _, b1, b2, a1, a2 = c
+        x1 = x2 = y1 = y2 = 0
+        out = []
+        for v in y:
+            acc = sat16((b0 * v + b1 * x1 + b2 * x2 + a1 * y1 + a2 * y2) >> 14)
+            x2, x1, y2, y1 = x1, v, y1, acc
+            out.append(acc)
+        y = out
+    return y
+
+
+def biquad(x, coeffs):
+    """double-precision DF1 cascade with the q15 coefficients (postShift 1)"""
+    y = [float(v) for v in x]
+    for c in coeffs:
+        b0, _, b1, b2, a1, a2 = (2.0 * v / 32768.0 for v in c)
+        x1 = x2 = y1 = y2 = 0.0
+        out = []
+        for v in y:
+            acc = b0 * v + b1 * x1 + b2 * x2 + a1 * y1 + a2 * y2
+            x2, x1, y2, y1 = x1, v, y1, acc
+            out.append(acc)
+        y = out
+    return y
+
+
+def wrap180(a):
+    return (a + 180.0) % 360.0 - 180.0
+
+
+def fuse(acc, gyro_raw, rate, block):
+    att = None
+    out = []
+    for i in range(0, len(acc[0]), block):
+        n = min(block, len(acc[0]) - i)
+        dt = n / rate
+        alpha = FUSION_TAU / (FUSION_TAU + dt)
+        ax, ay, az = (acc[k][i + n - 1] * ACCEL_FS_G / 32768.0 for k in range(3))
+        roll_acc = math.degrees(math.atan2(ay, az))
+        pitch_acc = math.degrees(math.atan2(-ax, math.hypot(ay, az)))
+        if att is None:
+            att = [roll_acc, pitch_acc, 0.0]
+        else:
+            for k in range(3):
+                mean = sum(gyro_raw[k][i:i + n]) / n
+                dps = mean * GYRO_FRACT / 32768.0 * math.degrees(GYRO_FS_RAD) / 32768.0
+                att[k] = wrap180(att[k] + dps * dt)
+            att[0] = wrap180(att[0] + (1 - alpha) * wrap180(roll_acc - att[0]))
+            att[1] = wrap180(att[1] + (1 - alpha) * wrap180(pitch_acc - att[1]))
+        out.append(list(att))
+    return out
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("host", help="imu_dsp_host binary")
+    ap.add_argument("-r", "--rate", type=float, default=1000.0)
+    ap.add_argument("-b", "--block", type=int, default=16)
+    ap.add_argument("-s", "--seconds", type=float, default=10.0)
+    ap.add_argument("--seed", type=int, default=1)
+    ap.add_argument("--tol-lsb", type=int, default=64, help="max filter deviation from the reference")
+    ap.add_argument("--tol-deg", type=float, default=0.5, help="max attitude deviation from the reference")
+    ap.add_argument("--bench", type=int, default=50, help="repetitions for the timing run, 0 to skip")
+    ap.add_argument("--save", help="write the synthetic capture to this file")
+    args = ap.parse_args()
+
+    frames, truth = make_capture(args.rate, args.seconds, args.seed)
+    if args.save:
+        with open(args.save, "wb") as f:
+            f.write(frames)
+
+    cmd = [args.host, "-r", str(args.rate), "-b", str(args.block)]
+    res = subprocess.run(cmd, input=frames, stdout=subprocess.PIPE, check=True)
+    coeffs = {"acc": [], "gyro": []}
+    samples, attitude = [], []
+    for line in res.stdout.decode().splitlines():
+        kind, *vals = line.split()
+        if kind == "C":
+            coeffs[vals[0]].append([int(v) for v in vals[1:]])
+        elif kind == "S":
+            samples.append([int(v) for v in vals])
+        elif kind == "A":
+            attitude.append([float(v) for v in vals])
+
+    conv = convert(frames)
+    chans = [[s[k] for s in conv] for k in range(6)]
+    exact = [biquad_q15(chans[k], coeffs["acc" if k < 3 else "gyro"]) for k in range(6)]
+    mismatch = sum(samples[i][k] != exact[k][i] for i in range(len(samples)) for k in range(6))
+    ref = [biquad(chans[k], coeffs["acc" if k < 3 else "gyro"]) for k in range(6)]
+    err_lsb = max(abs(samples[i][k] - ref[k][i]) for i in range(len(samples)) for k in range(6))
+
+    raw_gyro = [[struct.unpack_from(">h", frames, i * 14 + 8 + 2 * k)[0] for i in range(len(conv))] for k in range(3)]
+    ref_att = fuse(ref[0:3], raw_gyro, args.rate, args.block)
+    err_deg = max(abs(wrap180(a[k] - r[k])) for a, r in zip(attitude, ref_att) for k in range(3))
+    # the filters delay the estimate, so this is only a sanity bound
+    settle = len(attitude) // 5
+    err_truth = max(max(abs(wrap180(a[0] - truth[min(len(truth) - 1, (i + 1) * args.block - 1)][0])),
+                        abs(wrap180(a[1] - truth[min(len(truth) - 1, (i + 1) * args.block - 1)][1])))
+                    for i, a in enumerate(attitude) if i >= settle)
+
+    print("samples %d, blocks %d" % (len(samples), len(attitude)))
+    print("filter:   %d samples differ from the integer model" % mismatch)
+    print("filter:   max |q15 - reference| = %.2f LSB (limit %d)" % (err_lsb, args.tol_lsb))
+    print("attitude: max |fused - reference| = %.3f deg (limit %.3f)" % (err_deg, args.tol_deg))
+    print("attitude: max |fused - true| = %.2f deg after settling" % err_truth)
+
+    ok = len(samples) == len(conv) and mismatch == 0 and err_lsb <= args.tol_lsb and err_deg <= args.tol_deg
+    if args.bench > 0:
+        res = subprocess.run(cmd + ["-n", str(args.bench)], input=frames, stdout=subprocess.PIPE, check=True)
+        print(res.stdout.decode().strip())
+    print("PASS" if ok else "FAIL")
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
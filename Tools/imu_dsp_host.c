@@ -0,0 +1,131 @@
+/*
+ * Host driver for the IMU block pipeline (User/Middlewares/ImuDsp).
+ *
+ * Reads raw MPU6050 FIFO frames (14 byte, big-endian) from a file or stdin,
+ * runs them through fy_imu_dsp_process_be() block by block and prints
+ *   C <stage> b0 0 b1 b2 -a1 -a2       q15 coefficients (accel, then gyro)
+ *   S acc_x acc_y acc_z gx gy gz       filtered q15 output, one line per sample
+ *   A roll pitch yaw                   attitude after each block (degrees)
+ * With -n <repeat> the input is processed <repeat> times without output and
+ * the time per block is reported instead.
+ *
+ *   imu_dsp_host [-r rate] [-b block] [-n repeat] [capture.bin]
+ */
+#define _POSIX_C_SOURCE 199309L
+#include "fy_imu_dsp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static uint8_t *read_all(FILE *f, size_t *len)
+{
+    size_t cap = 1 << 16, n = 0, r;
+    uint8_t *buf = malloc(cap);
+
+    while (buf && (r = fread(buf + n, 1, cap - n, f)) > 0)
+    {
+        n += r;
+        if (n == cap)
+        {
+            cap *= 2;
+            buf = realloc(buf, cap);
+        }
+    }
+    *len = n;
+    return buf;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+    fy_imu_dsp_config_t cfg;
+    static fy_imu_dsp_t dsp;
+    float rate = 1000.0f;
+    size_t block = FY_IMU_DSP_BLOCK_MAX, len, frames, i, j;
+    long repeat = 0;
+    uint8_t *data;
+    FILE *f = stdin;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:b:n:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'r': rate = strtof(optarg, NULL); break;
+        case 'b': block = strtoul(optarg, NULL, 0); break;
+        case 'n': repeat = strtol(optarg, NULL, 0); break;
+        default:
+            fprintf(stderr, "usage: %s [-r rate] [-b block] [-n repeat] [capture.bin]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (block == 0 || block > FY_IMU_DSP_BLOCK_MAX)
+    {
+        fprintf(stderr, "block must be 1..%d\n", FY_IMU_DSP_BLOCK_MAX);
+        return 2;
+    }
+    if (optind < argc && (f = fopen(argv[optind], "rb")) == NULL)
+    {
+        perror(argv[optind]);
+        return 1;
+    }
+    data = read_all(f, &len);
+    frames = len / FY_IMU_DSP_FRAME_LEN;
+
+    fy_imu_dsp_default_config(&cfg, rate);
+    if (data == NULL || fy_imu_dsp_init(&dsp, &cfg) != 0)
+    {
+        fprintf(stderr, "init failed\n");
+        return 1;
+    }
+
+    if (repeat > 0)
+    {
+        double t0 = now_ns(), t;
+        size_t blocks = 0;
+
+        for (long r = 0; r < repeat; r++)
+        {
+            fy_imu_dsp_reset(&dsp);
+            for (i = 0; i < frames; i += block, blocks++)
+            {
+                size_t n = frames - i < block ? frames - i : block;
+                fy_imu_dsp_process_be(&dsp, data + i * FY_IMU_DSP_FRAME_LEN, n);
+            }
+        }
+        t = now_ns() - t0;
+        printf("blocks %zu block %zu: %.1f ns/block, %.2f ns/sample\n",
+               blocks, block, t / blocks, t / ((double)frames * repeat));
+        return 0;
+    }
+
+    for (i = 0; i < FY_IMU_DSP_BIQUAD_STAGES; i++)
+    {
+        printf("C acc");
+        for (j = 0; j < 6; j++) printf(" %d", dsp.accel_coeffs[i * 6 + j]);
+        printf("\nC gyro");
+        for (j = 0; j < 6; j++) printf(" %d", dsp.gyro_coeffs[i * 6 + j]);
+        printf("\n");
+    }
+    for (i = 0; i < frames; i += block)
+    {
+        size_t n = frames - i < block ? frames - i : block;
+        fy_imu_dsp_process_be(&dsp, data + i * FY_IMU_DSP_FRAME_LEN, n);
+        for (j = 0; j < n; j++)
+        {
+            printf("S %d %d %d %d %d %d\n", dsp.acc[0][j], dsp.acc[1][j], dsp.acc[2][j],
+                   dsp.gyro[0][j], dsp.gyro[1][j], dsp.gyro[2][j]);
+        }
+        printf("A %.4f %.4f %.4f\n", dsp.attitude.roll, dsp.attitude.pitch, dsp.attitude.yaw);
+    }
+    free(data);
+    return 0;
+}
@@ -0,0 +1,192 @@
+/*
+ * Host check of the interrupt-driven MPU6050 burst read (fy_mpu6050_read_start
+ * in User/hardware/MPU6050/fy_mpu6050.c) on the simulated I2C2 of the HAL mock
+ * (Tools/HalMock) with a fake sensor behind it.
+ *
+ * The fake answers register reads from a register file the test writes, and can
+ * NACK the next reads. Checked:
+ *   - init writes the configuration and refuses a wrong WHO_AM_I
+ *   - read_start returns at once without moving the clock, the 14 bytes arrive
+ *     in the I2C interrupt about 390us later at 400kHz, the bus is refused
+ *     meanwhile, also to a second sensor on the same I2C
+ *   - big-endian parse of all seven values (negative and extreme ones), the
+ *     completion tick and read_count; a sample is taken only once
+ *   - a NACK completes with status -1, counts error_count, leaves no sample and
+ *     frees the bus for the next read
+ *   - deinit while a read is on the bus aborts it without a callback
+ *
+ *   mpu6050_burst_test
+ */
+#include "hal_mock.h"
+#include "i2c.h"
+#include "fy_mpu6050.h"
+#include <stdio.h>
+#include <string.h>
+
+#define MPU6050_ADDRESS_AD0     0xD2    //AD0接高电平的第二个传感器
+
+typedef struct {
+    uint8_t regs[128];
+    uint32_t nack_reads;//接下来无应答的读取次数
+    uint32_t burst_reads;
+} fake_mpu_t;
+
+static uint32_t errors;
+static fake_mpu_t fake, fake_ad0;
+static fy_mpu6050_t mpu, mpu_ad0;
+static uint32_t done_count;
+static int32_t done_status;
+static fy_mpu6050_t *done_mpu;
+
+static void expect(int cond, const char *what)
+{
+    if (!cond) {
+        printf("ERROR: %s\n", what);
+        errors++;
+    }
+}
+
+static int32_t fake_read(void *ctx, uint16_t reg, uint8_t *data, uint16_t len)
+{
+    fake_mpu_t *m = ctx;
+
+    if (m->nack_reads > 0) {
+        m->nack_reads--;
+        return -1;
+    }
+    if (reg == MPU6050_ACCEL_XOUT_H) {
+        m->burst_reads++;
+    }
+    memcpy(data, &m->regs[reg & 0x7F], len);
+    return 0;
+}
+
+static int32_t fake_write(void *ctx, uint16_t reg, const uint8_t *data, uint16_t len)
+{
+    fake_mpu_t *m = ctx;
+
+    for (uint16_t i = 0; i < len; i++) {
+        m->regs[(reg + i) & 0x7F] = data[i];
+    }
+    return 0;
+}
+
+/* 传感器的测量寄存器，高字节在前 */
+static void fake_set_sample(fake_mpu_t *m, const fy_mpu6050_sample_t *s)
+{
+    int16_t v[7] = {s->acc_x, s->acc_y, s->acc_z, s->temp, s->gyro_x, s->gyro_y, s->gyro_z};
+
+    for (int i = 0; i < 7; i++) {
+        m->regs[MPU6050_ACCEL_XOUT_H + 2 * i] = (uint8_t)((uint16_t)v[i] >> 8);
+        m->regs[MPU6050_ACCEL_XOUT_H + 2 * i + 1] = (uint8_t)v[i];
+    }
+}
+
+static void mpu_done(fy_mpu6050_t *m, int32_t status, void *arg)
+{
+    (void)arg;
+    done_mpu = m;
+    done_status = status;
+    done_count++;
+}
+
+static int read_done(void *ctx)
+{
+    return done_count == *(uint32_t *)ctx;
+}
+
+static void setup(void)
+{
+    static const hal_mock_i2c_dev_t dev = {&fake, fake_read, fake_write};
+    static const hal_mock_i2c_dev_t dev_ad0 = {&fake_ad0, fake_read, fake_write};
+
+    hal_mock_reset();
+    MX_I2C2_Init();
+    memset(&fake, 0, sizeof(fake));
+    memset(&fake_ad0, 0, sizeof(fake_ad0));
+    hal_mock_i2c_attach(I2C2, MPU6050_ADDRESS, &dev);
+    hal_mock_i2c_attach(I2C2, MPU6050_ADDRESS_AD0, &dev_ad0);
+    done_count = 0;
+}
+
+static void test_init(void)
+{
+    setup();
+    fake.regs[MPU6050_WHO_AM_I] = 0x72;
+    expect(fy_mpu6050_init(&mpu, &hi2c2, MPU6050_ADDRESS, mpu_done, NULL) == -1, "wrong WHO_AM_I refused");
+    fake.regs[MPU6050_WHO_AM_I] = FY_MPU6050_ID;
+    expect(fy_mpu6050_init(&mpu, &hi2c2, MPU6050_ADDRESS, mpu_done, NULL) == 0, "init");
+    expect(mpu.id == FY_MPU6050_ID, "WHO_AM_I");
+    expect(fake.regs[MPU6050_PWR_MGMT_1] == 0x01 && fake.regs[MPU6050_SMPLRT_DIV] == 0x09 &&
+           fake.regs[MPU6050_GYRO_CONFIG] == 0x18 && fake.regs[MPU6050_ACCEL_CONFIG] == 0x18, "configuration written");
+    expect(fy_mpu6050_deinit(&mpu) == 0, "deinit");
+}
+
+static void test_burst(void)
+{
+    const fy_mpu6050_sample_t want = {-2, 32767, -32768, -521, 0x1234, 1, -1};
+    fy_mpu6050_sample_t s;
+    uint64_t t0;
+    uint32_t ts, n = 1;
+
+    setup();
+    fake.regs[MPU6050_WHO_AM_I] = FY_MPU6050_ID;
+    fake_ad0.regs[MPU6050_WHO_AM_I] = FY_MPU6050_ID;
+    expect(fy_mpu6050_init(&mpu, &hi2c2, MPU6050_ADDRESS, mpu_done, NULL) == 0, "init");
+    expect(fy_mpu6050_init(&mpu_ad0, &hi2c2, MPU6050_ADDRESS_AD0, mpu_done, NULL) == 0, "init AD0");
+    fake_set_sample(&fake, &want);
+
+    //发起后立即返回，不占用模拟时间
+    t0 = hal_mock_now();
+    expect(fy_mpu6050_read_start(&mpu) == 0, "read_start");
+    expect(hal_mock_now() == t0, "read_start does not wait for the bus");
+    expect(fy_mpu6050_read_start(&mpu) == -1, "bus busy");
+    expect(fy_mpu6050_read_start(&mpu_ad0) == -1, "bus busy for a second sensor on the same I2C");
+    expect(fy_mpu6050_get_sample(&mpu, &s, NULL) == -1, "no sample before completion");
+    hal_mock_advance(HAL_MOCK_US(300));
+    expect(done_count == 0, "burst read still on the bus");
+    expect(hal_mock_run_until(read_done, &n, HAL_MOCK_MS(10)) == 0, "burst read completes");
+    expect(hal_mock_now() - t0 >= HAL_MOCK_US(350) && hal_mock_now() - t0 <= HAL_MOCK_US(450),
+           "14 bytes at 400kHz take about 390us");
+    expect(done_mpu == &mpu && done_status == 0 && mpu.read_count == 1, "done callback");
+    expect(fy_mpu6050_get_sample(&mpu, &s, &ts) == 0, "sample ready");
+    expect(memcmp(&s, &want, sizeof(s)) == 0, "big-endian parse");
+    expect(ts == HAL_GetTick(), "completion tick");
+    expect(fy_mpu6050_get_sample(&mpu, &s, NULL) == -1, "sample taken only once");
+
+    //总线释放后第二个传感器可以读取
+    n++;
+    expect(fy_mpu6050_read_start(&mpu_ad0) == 0, "read_start AD0");
+    expect(hal_mock_run_until(read_done, &n, HAL_MOCK_MS(10)) == 0 && done_mpu == &mpu_ad0, "AD0 read completes");
+    expect(fake_ad0.burst_reads == 1 && fake.burst_reads == 1, "each read goes to its own sensor");
+
+    //无应答：错误回调，不产生样本，总线释放
+    fake.nack_reads = 1;
+    n++;
+    expect(fy_mpu6050_read_start(&mpu) == 0, "read_start before NACK");
+    expect(hal_mock_run_until(read_done, &n, HAL_MOCK_MS(10)) == 0, "NACK completes");
+    expect(done_status == -1 && mpu.error_count == 1 && mpu.read_count == 1, "NACK reported");
+    expect(!mpu.busy && hi2c2.State == HAL_I2C_STATE_READY, "bus free after NACK");
+    expect(fy_mpu6050_get_sample(&mpu, &s, NULL) == -1, "no sample after NACK");
+    n++;
+    expect(fy_mpu6050_read_start(&mpu) == 0, "read_start after NACK");
+    expect(hal_mock_run_until(read_done, &n, HAL_MOCK_MS(10)) == 0 && done_status == 0, "read after NACK");
+    expect(fy_mpu6050_get_sample(&mpu, &s, NULL) == 0 && memcmp(&s, &want, sizeof(s)) == 0, "sample after NACK");
+
+    //读取进行中反初始化：中止传输，不再回调
+    expect(fy_mpu6050_read_start(&mpu) == 0, "read_start before deinit");
+    expect(fy_mpu6050_deinit(&mpu) == 0, "deinit while busy");
+    hal_mock_advance(HAL_MOCK_MS(1));
+    expect(done_count == n && hi2c2.State == HAL_I2C_STATE_READY, "no callback after deinit");
+    expect(fy_mpu6050_deinit(&mpu_ad0) == 0, "deinit AD0");
+    printf("mpu6050 burst: %lu transfers, %lu NACKs\n", (unsigned long)hal_mock_i2c_stats(I2C2)->transfers,
+           (unsigned long)hal_mock_i2c_stats(I2C2)->nacks);
+}
+
+int main(void)
+{
+    test_init();
+    test_burst();
+    printf("%s\n", errors ? "FAIL" : "PASS");
+    return errors ? 1 : 0;
+}
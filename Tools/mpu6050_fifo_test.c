@@ -0,0 +1,292 @@
+/*
+ * Host check of the MPU6050 FIFO streaming mode (fy_mpu6050_fifo_service and
+ * fy_mpu6050_fifo_parse in User/hardware/MPU6050/fy_mpu6050.c) on the simulated
+ * I2C2 of the HAL mock (Tools/HalMock).
+ *
+ * The fake sensor keeps a byte FIFO that the test fills with numbered 14 byte
+ * frames, also a part of a frame at a time, like the sensor writing the next
+ * sample while the FIFO is read. Like the real part it holds at most 1024 bytes,
+ * dropping the oldest. Checked:
+ *   - parse: only whole frames are taken, timestamps are t0 + n * period, a
+ *     full sample ring drops (fifo_dropped) without breaking the timestamps
+ *   - a drain reads only the whole frames, the half written one is read whole
+ *     by the next drain, so frames stay aligned
+ *   - more than FY_MPU6050_FIFO_BATCH_MAX frames are read in batches in the
+ *     I2C interrupt within one fy_mpu6050_fifo_service call
+ *   - an overflowed FIFO (count past the last whole frame) is reset, counted
+ *     in fifo_overflow_count and the timestamps restart at the reset
+ *   - a NACK during the drain reports -1 and frees the bus, nothing is lost
+ *
+ *   mpu6050_fifo_test
+ */
+#include "hal_mock.h"
+#include "i2c.h"
+#include "fy_mpu6050.h"
+#include <stdio.h>
+#include <string.h>
+
+#define FRAME_LEN       FY_MPU6050_BURST_LEN
+#define RATE_DIV        4U      //200Hz，周期5000us
+#define PERIOD_US       (1000U * (1U + RATE_DIV))
+
+typedef struct {
+    uint8_t regs[128];
+    uint8_t fifo[FY_MPU6050_FIFO_SIZE];
+    uint32_t fifo_len;
+    uint32_t next_seq;//下一帧的序号
+    uint32_t next_byte;//下一帧已写入的字节数
+    uint32_t resets;
+    uint32_t nack_reads;
+} fake_mpu_t;
+
+static uint32_t errors;
+static fake_mpu_t fake;
+static fy_mpu6050_t mpu;
+static uint8_t sample_buffer[2048];
+static ringBuffer_t sample_rb;
+static uint32_t done_count;
+static int32_t done_status;
+
+static void expect(int cond, const char *what)
+{
+    if (!cond) {
+        printf("ERROR: %s\n", what);
+        errors++;
+    }
+}
+
+/* 帧内容由序号决定，高字节在前 */
+static void frame_bytes(uint32_t seq, uint8_t *p)
+{
+    int16_t v[7] = {(int16_t)seq, (int16_t)~seq, 16384, -521, (int16_t)(seq * 3U), 0, (int16_t)-seq};
+
+    for (int i = 0; i < 7; i++) {
+        p[2 * i] = (uint8_t)((uint16_t)v[i] >> 8);
+        p[2 * i + 1] = (uint8_t)v[i];
+    }
+}
+
+static int frame_ok(const fy_mpu6050_sample_t *s, uint32_t seq)
+{
+    return s->acc_x == (int16_t)seq && s->acc_y == (int16_t)~seq && s->acc_z == 16384 && s->temp == -521 &&
+           s->gyro_x == (int16_t)(seq * 3U) && s->gyro_y == 0 && s->gyro_z == (int16_t)-seq;
+}
+
+/* 传感器写入FIFO的字节，满1024字节时丢弃最早的 */
+static void fake_push(fake_mpu_t *m, uint32_t bytes)
+{
+    uint8_t frame[FRAME_LEN];
+
+    while (bytes-- > 0) {
+        frame_bytes(m->next_seq, frame);
+        if (m->fifo_len == FY_MPU6050_FIFO_SIZE) {
+            memmove(m->fifo, m->fifo + 1, FY_MPU6050_FIFO_SIZE - 1);
+            m->fifo_len--;
+        }
+        m->fifo[m->fifo_len++] = frame[m->next_byte];
+        if (++m->next_byte == FRAME_LEN) {
+            m->next_byte = 0;
+            m->next_seq++;
+        }
+    }
+}
+
+static int32_t fake_read(void *ctx, uint16_t reg, uint8_t *data, uint16_t len)
+{
+    fake_mpu_t *m = ctx;
+
+    if (m->nack_reads > 0) {
+        m->nack_reads--;
+        return -1;
+    }
+    if (reg == MPU6050_FIFO_COUNTH) {
+        data[0] = (uint8_t)(m->fifo_len >> 8);
+        data[1] = (uint8_t)m->fifo_len;
+    } else if (reg == MPU6050_FIFO_R_W) {
+        if (len > m->fifo_len) return -1;
+        memcpy(data, m->fifo, len);
+        memmove(m->fifo, m->fifo + len, m->fifo_len - len);
+        m->fifo_len -= len;
+    } else {
+        memcpy(data, &m->regs[reg & 0x7F], len);
+    }
+    return 0;
+}
+
+static int32_t fake_write(void *ctx, uint16_t reg, const uint8_t *data, uint16_t len)
+{
+    fake_mpu_t *m = ctx;
+
+    for (uint16_t i = 0; i < len; i++) {
+        m->regs[(reg + i) & 0x7F] = data[i];
+    }
+    //FIFO复位：清空，传感器从下一个完整帧开始写
+    if (reg == MPU6050_USER_CTRL && (data[0] & 0x04)) {
+        m->regs[MPU6050_USER_CTRL] &= (uint8_t)~0x04;
+        m->fifo_len = 0;
+        if (m->next_byte != 0) {
+            m->next_byte = 0;
+            m->next_seq++;
+        }
+        m->resets++;
+    }
+    return 0;
+}
+
+static void mpu_done(fy_mpu6050_t *m, int32_t status, void *arg)
+{
+    (void)m;
+    (void)arg;
+    done_status = status;
+    done_count++;
+}
+
+static int bus_idle(void *ctx)
+{
+    (void)ctx;
+    return !mpu.busy;
+}
+
+/* 发起一次排空并等待完成，返回done回调次数的增量 */
+static uint32_t drain(void)
+{
+    uint32_t before = done_count;
+
+    expect(fy_mpu6050_fifo_service(&mpu) == 0, "fifo_service");
+    expect(hal_mock_run_until(bus_idle, NULL, HAL_MOCK_MS(100)) == 0, "drain completes");
+    return done_count - before;
+}
+
+/* 取出全部记录，检查序号与时间戳连续，返回条数 */
+static uint32_t collect(uint32_t *seq, uint32_t *ts)
+{
+    fy_mpu6050_record_t rec[16];
+    uint32_t total = 0;
+    size_t n;
+
+    while ((n = fy_mpu6050_fifo_read(&mpu, rec, 16)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            if (!frame_ok(&rec[i].sample, *seq)) {
+                printf("ERROR: frame %lu: acc_x %d\n", (unsigned long)*seq, rec[i].sample.acc_x);
+                errors++;
+            }
+            if (rec[i].timestamp_us != *ts) {
+                printf("ERROR: frame %lu: timestamp %lu, expected %lu\n", (unsigned long)*seq,
+                       (unsigned long)rec[i].timestamp_us, (unsigned long)*ts);
+                errors++;
+            }
+            (*seq)++;
+            *ts += PERIOD_US;
+            total++;
+        }
+    }
+    return total;
+}
+
+static void setup(size_t rb_size)
+{
+    static const hal_mock_i2c_dev_t dev = {&fake, fake_read, fake_write};
+
+    hal_mock_reset();
+    MX_I2C2_Init();
+    memset(&fake, 0, sizeof(fake));
+    fake.regs[MPU6050_WHO_AM_I] = FY_MPU6050_ID;
+    hal_mock_i2c_attach(I2C2, MPU6050_ADDRESS, &dev);
+    done_count = 0;
+    HAL_Delay(3);
+    expect(fy_mpu6050_init(&mpu, &hi2c2, MPU6050_ADDRESS, mpu_done, NULL) == 0, "init");
+    expect(fy_mpu6050_fifo_service(&mpu) == -1, "service before fifo_start");
+    ringBuffer_init_spsc(&sample_rb, sample_buffer, rb_size);
+    expect(fy_mpu6050_fifo_start(&mpu, &sample_rb, RATE_DIV) == 0, "fifo_start");
+    expect(fake.regs[MPU6050_SMPLRT_DIV] == RATE_DIV && fake.regs[MPU6050_FIFO_EN] == 0xF8 &&
+           fake.regs[MPU6050_USER_CTRL] == 0x40, "FIFO configuration written");
+}
+
+static void test_parse(void)
+{
+    uint8_t data[12 * FRAME_LEN];
+    uint32_t seq = 0, ts, cap, i;
+
+    //128字节的样本环只放得下几条记录
+    setup(128);
+    ts = mpu.fifo_t0_us;
+    for (i = 0; i < 12; i++) {
+        frame_bytes(i, data + i * FRAME_LEN);
+    }
+    expect(fy_mpu6050_fifo_parse(&mpu, data, 3 * FRAME_LEN + 5) == 3, "parse takes whole frames only");
+    expect(collect(&seq, &ts) == 3, "three records");
+
+    cap = 128U / (uint32_t)sizeof(fy_mpu6050_record_t);
+    expect(fy_mpu6050_fifo_parse(&mpu, data + 3 * FRAME_LEN, 9 * FRAME_LEN) == cap, "parse up to a full sample ring");
+    expect(mpu.fifo_dropped == 9 - cap, "frames over a full sample ring dropped");
+    expect(collect(&seq, &ts) == cap, "records of a full ring");
+    //丢弃的帧也推进时间戳
+    expect(fy_mpu6050_fifo_parse(&mpu, data, FRAME_LEN) == 1, "parse after drops");
+    seq = 0;
+    ts += (9 - cap) * PERIOD_US;
+    expect(collect(&seq, &ts) == 1, "timestamp continues across dropped frames");
+    expect(mpu.fifo_samples == 3 + cap + 1, "fifo_samples");
+    expect(fy_mpu6050_fifo_stop(&mpu) == 0, "fifo_stop");
+    expect(fy_mpu6050_fifo_parse(&mpu, data, FRAME_LEN) == 0, "no parse after fifo_stop");
+    fy_mpu6050_deinit(&mpu);
+}
+
+static void test_service(void)
+{
+    uint32_t seq = 0, ts, n, frames;
+
+    setup(sizeof(sample_buffer));
+    ts = mpu.fifo_t0_us;
+    expect(drain() == 1 && done_status == 0 && collect(&seq, &ts) == 0, "empty FIFO");
+
+    //半帧留在FIFO中，下次读出完整帧
+    fake_push(&fake, 2 * FRAME_LEN + 6);
+    expect(drain() == 1 && done_status == 0, "drain with a half frame");
+    expect(collect(&seq, &ts) == 2 && fake.fifo_len == 6, "only whole frames read");
+    fake_push(&fake, FRAME_LEN - 6 + FRAME_LEN + 3);
+    expect(drain() == 1, "drain after the half frame completes");
+    expect(collect(&seq, &ts) == 2 && fake.fifo_len == 3, "frames stay aligned");
+    fake_push(&fake, FRAME_LEN - 3);
+
+    //超过一批的帧在I2C中断中连续读完
+    frames = 2 * FY_MPU6050_FIFO_BATCH_MAX + 5;
+    fake_push(&fake, (frames - 1) * FRAME_LEN);
+    n = mpu.read_count;
+    expect(fy_mpu6050_fifo_service(&mpu) == 0, "service");
+    expect(fy_mpu6050_fifo_service(&mpu) == -1, "service while draining");
+    expect(hal_mock_run_until(bus_idle, NULL, HAL_MOCK_MS(100)) == 0, "batches complete");
+    expect(mpu.read_count - n == 3 && done_count == 4, "three batches, one done callback");
+    expect(collect(&seq, &ts) == frames && fake.fifo_len == 0, "every frame of the batches");
+
+    //排空时无应答：报告错误并释放总线，数据留在FIFO中
+    fake_push(&fake, 3 * FRAME_LEN);
+    fake.nack_reads = 1;
+    expect(drain() == 1 && done_status == -1 && mpu.error_count == 1, "NACK reported");
+    expect(drain() == 1 && done_status == 0 && collect(&seq, &ts) == 3, "frames read after the NACK");
+
+    //溢出：FIFO写满1024字节后帧边界不可信，复位并从复位时刻重新计时
+    fake_push(&fake, 80 * FRAME_LEN + 4);
+    expect(drain() == 1 && done_status == 0, "drain of an overflowed FIFO");
+    expect(mpu.fifo_overflow_count == 1 && fake.resets == 2, "overflow reset");
+    expect(collect(&seq, &ts) == 0, "nothing parsed from an overflowed FIFO");
+    expect(mpu.fifo_t0_us == HAL_GetTick() * 1000U, "timestamps resynced at the reset");
+    seq = fake.next_seq;
+    ts = mpu.fifo_t0_us;
+    fake_push(&fake, 4 * FRAME_LEN);
+    expect(drain() == 1 && collect(&seq, &ts) == 4, "stream restarts after the reset");
+    expect(mpu.fifo_dropped == 0, "no frame dropped by the sample ring");
+
+    expect(fy_mpu6050_fifo_stop(&mpu) == 0, "fifo_stop");
+    expect(fy_mpu6050_fifo_service(&mpu) == -1, "service after fifo_stop");
+    printf("mpu6050 fifo: %lu records, %lu I2C transfers, %lu overflow resets\n", (unsigned long)mpu.fifo_samples,
+           (unsigned long)hal_mock_i2c_stats(I2C2)->transfers, (unsigned long)mpu.fifo_overflow_count);
+    fy_mpu6050_deinit(&mpu);
+}
+
+int main(void)
+{
+    test_parse();
+    test_service();
+    printf("%s\n", errors ? "FAIL" : "PASS");
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,163 @@
+/*
+ * Host check of the ring buffer zero-copy API (User/Middlewares/Ringbuffer):
+ * reserve/commit on the producer side, peek/consume on the consumer side.
+ *
+ * For every start offset of a small ring, some fill levels and every request
+ * length, the producer writes a counter pattern through reserve/commit and
+ * the consumer reads it back through peek/consume in uneven steps. Checked at
+ * each step:
+ *   - a span starts at the physical head/tail and never runs past the end of
+ *     the buffer, so near the wrap it is shorter than requested and the next
+ *     call continues at buffer[0]
+ *   - reserve never hands out more than the free space (the locked ring keeps
+ *     one slot free, the SPSC ring none)
+ *   - the bytes read through peek are the bytes written through reserve, in
+ *     order, mixed with plain write/read data before them
+ * The same sequence runs on the SPSC and on the locked ring.
+ *
+ *   rb_span_test
+ */
+#include "fy_ringBuffer.h"
+#include <stdio.h>
+
+#define RING_SIZE       64U
+
+static uint8_t storage[RING_SIZE];
+static uint32_t errors;
+
+static void fail(const char *mode, const char *what, size_t a, size_t b)
+{
+    if (++errors <= 10) {
+        printf("ERROR: %s: %s (%zu, %zu)\n", mode, what, a, b);
+    }
+}
+
+static size_t min2(size_t a, size_t b)
+{
+    return (a < b) ? a : b;
+}
+
+static size_t min3(size_t a, size_t b, size_t c)
+{
+    return min2(min2(a, b), c);
+}
+
+/* 写入端/读取端的物理下标 */
+static size_t head_index(const ringBuffer_t *rb)
+{
+    return rb->spsc ? (rb->head & rb->mask) : rb->head;
+}
+
+static size_t tail_index(const ringBuffer_t *rb)
+{
+    return rb->spsc ? (rb->tail & rb->mask) : rb->tail;
+}
+
+/* tail移到offset，再用write写入fill字节(序号从seq开始)，返回下一个序号 */
+static uint8_t setup(ringBuffer_t *rb, size_t offset, size_t fill, uint8_t seq)
+{
+    uint8_t data[RING_SIZE];
+    size_t i;
+
+    rb->clear(rb);
+    rb->write(rb, NULL, offset);
+    rb->read(rb, NULL, offset);
+    for (i = 0; i < fill; i++) {
+        data[i] = seq++;
+    }
+    rb->write(rb, data, fill);
+    return seq;
+}
+
+static void run(const char *mode, ringBuffer_t *rb, size_t capacity)
+{
+    static const size_t fills[] = { 0, 1, RING_SIZE / 2, RING_SIZE - 2 };
+    size_t offset, f, len, spans = 0, short_spans = 0;
+
+    for (offset = 0; offset < RING_SIZE; offset++) {
+        for (f = 0; f < sizeof(fills) / sizeof(fills[0]); f++) {
+            size_t fill = fills[f];
+
+            for (len = 1; len <= RING_SIZE; len++) {
+                uint8_t seq = (uint8_t)(offset * 7U + len), expect = seq;
+                size_t written = 0, read = 0, want, step = 1;
+                rb_span_t span;
+
+                seq = setup(rb, offset, fill, seq);
+                want = min2(len, capacity - fill);
+
+                //生产者：reserve到缓冲区末尾为止，回绕部分再reserve一次
+                while (written < len) {
+                    size_t idx = head_index(rb);
+                    size_t free_space = capacity - fill - written;
+                    size_t i;
+
+                    span = rb->reserve(rb, len - written);
+                    if (span.len != min3(len - written, RING_SIZE - idx, free_space)) {
+                        fail(mode, "reserve length", span.len, min3(len - written, RING_SIZE - idx, free_space));
+                        return;
+                    }
+                    if (span.len == 0) break;
+                    if (span.data != &storage[idx]) {
+                        fail(mode, "reserve start", (size_t)(span.data - storage), idx);
+                        return;
+                    }
+                    if (RING_SIZE - idx < len - written && span.len == RING_SIZE - idx) short_spans++;
+                    spans++;
+                    for (i = 0; i < span.len; i++) {
+                        span.data[i] = seq++;
+                    }
+                    rb->commit(rb, span.len);
+                    written += span.len;
+                }
+                if (written != want) fail(mode, "written", written, want);
+                if (rb->used(rb) != fill + written) fail(mode, "used after commit", rb->used(rb), fill + written);
+
+                //消费者：每次只consume一部分，跨过回绕
+                while (read < fill + written) {
+                    size_t idx = tail_index(rb);
+                    size_t left = fill + written - read;
+                    size_t i, n;
+
+                    span = rb->peek(rb);
+                    if (span.len != min2(left, RING_SIZE - idx)) {
+                        fail(mode, "peek length", span.len, min2(left, RING_SIZE - idx));
+                        return;
+                    }
+                    if (span.data != &storage[idx]) {
+                        fail(mode, "peek start", (size_t)(span.data - storage), idx);
+                        return;
+                    }
+                    n = (step < span.len) ? step : span.len;
+                    for (i = 0; i < n; i++) {
+                        if (span.data[i] != expect) {
+                            fail(mode, "data", offset * 1000U + len, read + i);
+                            return;
+                        }
+                        expect++;
+                    }
+                    rb->consume(rb, n);
+                    read += n;
+                    step = step % 5U + 2U;
+                }
+                span = rb->peek(rb);
+                if (rb->used(rb) != 0 || span.len != 0) fail(mode, "not empty after consume", rb->used(rb), span.len);
+            }
+        }
+    }
+    printf("%-8s %zu spans, %zu cut short at the end of the buffer\n", mode, spans, short_spans);
+    if (short_spans == 0) fail(mode, "wrap never reached", 0, 0);
+}
+
+int main(void)
+{
+    ringBuffer_t rb;
+
+    ringBuffer_init_spsc(&rb, storage, sizeof(storage));
+    run("spsc", &rb, RING_SIZE);
+    ringBuffer_init(&rb, storage, sizeof(storage));
+    run("locked", &rb, RING_SIZE - 1U);
+
+    printf("%s\n", errors ? "FAIL" : "PASS");
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,201 @@
+/*
+ * Host check of the ring buffer SPSC mode (User/Middlewares/Ringbuffer).
+ *
+ * One producer thread writes a position-derived byte stream in chunks of
+ * random length, one consumer thread reads it back in chunks of another
+ * random length and compares every byte, so a lost, repeated or reordered
+ * byte shows up at its stream offset. The same run is made on the lock-free
+ * SPSC ring and on the locked path (ringBuffer_init with a mutex registered
+ * for read and write), and the throughput of both is printed; only data
+ * integrity decides PASS/FAIL, the timing depends on the host.
+ *
+ * Also checked: init rejects sizes that are not 2^n or above UINT16_MAX, and
+ * a full 32768 byte ring reports used() == size.
+ *
+ *   rb_spsc_test [-m MB per run] [-s ring size]       default 32 MB, 1024
+ */
+#include "fy_ringBuffer.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CHUNK_MAX       512U
+
+typedef struct {
+    ringBuffer_t *rb;
+    size_t total;
+    unsigned seed;
+    size_t bad;//第一个错误的位置，total为没有错误
+} stream_t;
+
+static pthread_mutex_t rb_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t errors;
+
+static void fail(const char *what, size_t a, size_t b)
+{
+    errors++;
+    printf("ERROR: %s (%zu, %zu)\n", what, a, b);
+}
+
+static void rb_mutex_lock(void)
+{
+    pthread_mutex_lock(&rb_mutex);
+}
+
+static void rb_mutex_unlock(void)
+{
+    pthread_mutex_unlock(&rb_mutex);
+}
+
+static uint8_t stream_byte(size_t pos)
+{
+    uint32_t v = (uint32_t)pos;
+
+    return (uint8_t)((v ^ (v >> 8) ^ (v >> 16) ^ (v >> 24)) * 0x9DU + 0x5BU);
+}
+
+static size_t chunk_len(unsigned *seed)
+{
+    return (size_t)(rand_r(seed) % CHUNK_MAX) + 1U;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void *producer(void *arg)
+{
+    stream_t *s = arg;
+    uint8_t chunk[CHUNK_MAX];
+    size_t pos = 0, n, i, done;
+
+    while (pos < s->total) {
+        n = chunk_len(&s->seed);
+        if (n > s->total - pos) n = s->total - pos;
+        for (i = 0; i < n; i++) {
+            chunk[i] = stream_byte(pos + i);
+        }
+        for (done = 0; done < n;) {
+            size_t w = s->rb->write(s->rb, chunk + done, n - done);
+
+            if (w == 0) {
+                sched_yield();
+            }
+            done += w;
+        }
+        pos += n;
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    stream_t *s = arg;
+    uint8_t chunk[CHUNK_MAX];
+    size_t pos = 0, n, i;
+
+    s->bad = s->total;
+    while (pos < s->total) {
+        n = s->rb->read(s->rb, chunk, chunk_len(&s->seed));
+        if (n == 0) {
+            sched_yield();
+            continue;
+        }
+        for (i = 0; i < n; i++) {
+            if (chunk[i] != stream_byte(pos + i) && s->bad == s->total) {
+                s->bad = pos + i;
+            }
+        }
+        pos += n;
+    }
+    return NULL;
+}
+
+/* 返回MB/s，数据错误时为0 */
+static double run(const char *name, ringBuffer_t *rb, size_t total)
+{
+    stream_t prod = { rb, total, 1, 0 };
+    stream_t cons = { rb, total, 2, 0 };
+    pthread_t tp, tc;
+    double t0, t;
+
+    t0 = now_s();
+    pthread_create(&tc, NULL, consumer, &cons);
+    pthread_create(&tp, NULL, producer, &prod);
+    pthread_join(tp, NULL);
+    pthread_join(tc, NULL);
+    t = now_s() - t0;
+
+    if (cons.bad != total) {
+        fail(name, cons.bad, total);
+        return 0.0;
+    }
+    if (rb->used(rb) != 0) {
+        fail("ring not empty after the run", rb->used(rb), 0);
+    }
+    printf("%-8s %zu bytes through %zu byte ring: %.3f s, %.1f MB/s\n", name, total, rb->size, t,
+           (double)total / t / 1e6);
+    return (double)total / t / 1e6;
+}
+
+static void check_limits(void)
+{
+    static uint8_t big[65536];
+    ringBuffer_t rb;
+    size_t n;
+
+    if (ringBuffer_init_spsc(&rb, big, 65536) == 0) fail("65536 byte SPSC ring accepted", 65536, 0);
+    if (ringBuffer_init_spsc(&rb, big, 1000) == 0) fail("non 2^n SPSC ring accepted", 1000, 0);
+    if (ringBuffer_init_spsc(&rb, big, 32768) != 0) {
+        fail("32768 byte SPSC ring rejected", 32768, 0);
+        return;
+    }
+    n = rb.write(&rb, big, sizeof(big));
+    if (n != 32768 || rb.used(&rb) != 32768) fail("full 32768 byte ring", n, rb.used(&rb));
+}
+
+int main(int argc, char **argv)
+{
+    size_t total = 32U << 20, size = 1024;
+    uint8_t *storage;
+    ringBuffer_t spsc, locked;
+    double spsc_mbs, locked_mbs;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:s:")) != -1) {
+        switch (opt) {
+        case 'm': total = (size_t)atol(optarg) << 20; break;
+        case 's': size = (size_t)atol(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-m MB per run] [-s ring size]\n", argv[0]);
+            return 2;
+        }
+    }
+    storage = malloc(size);
+    if (total == 0 || storage == NULL || ringBuffer_init_spsc(&spsc, storage, size) != 0) {
+        fprintf(stderr, "MB must be > 0, ring size 2^n up to 32768\n");
+        return 2;
+    }
+
+    check_limits();
+
+    spsc_mbs = run("spsc", &spsc, total);
+    ringBuffer_init(&locked, storage, size);
+    ringBuffer_registerLocks(&locked, rb_mutex_lock, rb_mutex_unlock, rb_mutex_lock, rb_mutex_unlock);
+    locked_mbs = run("locked", &locked, total);
+    if (spsc_mbs > 0.0 && locked_mbs > 0.0) {
+        printf("spsc/locked throughput %.2fx\n", spsc_mbs / locked_mbs);
+    }
+
+    free(storage);
+    printf("%s\n", errors ? "FAIL" : "PASS");
+    return errors ? 1 : 0;
+}
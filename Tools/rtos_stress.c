@@ -0,0 +1,449 @@
+/*
+ * Host stress test of the RTOS threading layer (User/Middlewares/Rtos) on the
+ * POSIX cmsis_os2 port. The thread set mirrors the RTOS mode of user_main():
+ *
+ *   irq      simulated interrupts: sensor records into an SPSC ring and UART
+ *            bytes into another, each followed by osThreadFlagsSet
+ *   dma      simulated UART TX DMA: drains the shared TX ring without a lock
+ *   sensor   waits for the data flag, drains and checks the sensor records
+ *   uart     waits for the RX flag, checks the byte stream, a '\n' posts the
+ *            stats flag to the report thread
+ *   writerN  log through easy logger (async, so via the log thread) and write
+ *            lines directly into the TX ring, competing for the same locks
+ *   log      flushes the async log on the notice flag
+ *   report   samples stack watermarks and CPU load
+ *
+ * The TX ring is the interesting part: several threads write into it with the
+ * ring write lock and the elog output lock mapped to RTOS mutexes, and a lock
+ * free reader drains it. Every line carries "@<source><n> <seq>#".
+ *
+ * Checked at the end:
+ *   - every line on the TX stream is intact (no interleaving) and the
+ *     sequence of each source only increases; direct lines are never lost and
+ *     logged lines are either received or counted as dropped by elog
+ *   - no sensor record is lost or reordered and every RX byte arrives
+ *     (no lost wakeups)
+ *   - every thread left some stack and the stats report was produced
+ *
+ *   rtos_stress [-t seconds] [-w writers] [-v]
+ */
+#include "fy_rtos.h"
+#include "fy_ringBuffer.h"
+#include "elog.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FLAG_DATA           (1UL << 0)
+#define FLAG_RX             (1UL << 1)
+#define FLAG_STATS          (1UL << 2)
+#define FLAG_LOG            (1UL << 3)
+
+#define WRITER_MAX          6
+#define LINE_MAX            160
+
+typedef struct {
+    uint32_t seq;
+    int16_t value[6];
+} sensor_record_t;
+
+/* 与目标板一致的锁：TX缓冲区只有写锁(读取在中断中)，elog输出一把锁 */
+FY_RTOS_LOCK_DEFINE(tx);
+FY_RTOS_LOCK_DEFINE(log);
+
+static uint8_t sensor_buffer[1024];
+static ringBuffer_t sensor_rb;
+static uint8_t rx_buffer[256];
+static ringBuffer_t rx_rb;
+static uint8_t tx_buffer[512];
+static ringBuffer_t tx_rb;
+
+static osThreadId_t sensor_id, uart_id, report_id, log_id;
+/* 按顺序停止：先停产生数据的线程，再停日志线程，最后停dma */
+static volatile int running = 1, log_running = 1, dma_running = 1;
+static volatile uint32_t exited;
+static int verbose;
+static uint32_t errors;
+
+//统计
+static uint32_t sensor_sent, sensor_dropped, sensor_got;
+static uint32_t rx_sent, rx_dropped, rx_got;
+static uint32_t line_direct_sent[WRITER_MAX], line_log_sent[WRITER_MAX];
+static uint32_t line_direct_got[WRITER_MAX], line_log_got[WRITER_MAX];
+static uint32_t line_direct_last[WRITER_MAX], line_log_last[WRITER_MAX];
+static uint32_t lines_bad, lines_total, stats_posts, stats_reports;
+
+static void fail(const char *what, uint32_t a, uint32_t b)
+{
+    if (__atomic_fetch_add(&errors, 1, __ATOMIC_RELAXED) < 10) {
+        printf("ERROR: %s (%u, %u)\n", what, a, b);
+    }
+}
+
+static void thread_done(void)
+{
+    __atomic_fetch_add(&exited, 1, __ATOMIC_ACQ_REL);
+}
+
+/* TX stream -----------------------------------------------------------------*/
+
+/* 整行写入：持有写锁直到写完，锁可递归，RB_Write内部再次加锁 */
+static void tx_write_line(const char *line, size_t len)
+{
+    size_t done = 0;
+
+    tx_lock();
+    while (done < len) {
+        done += tx_rb.write(&tx_rb, (const uint8_t *)line + done, len - done);
+        if (done < len) {
+            osThreadYield();
+        }
+    }
+    tx_unlock();
+}
+
+static void elog_out(const char *log, size_t size)
+{
+    tx_write_line(log, size);
+}
+
+void elog_async_output_notice(void)
+{
+    if (log_id != NULL) {
+        osThreadFlagsSet(log_id, FLAG_LOG);
+    }
+}
+
+/* 解析一行末尾的"@<D|L><n> <seq>#" */
+static void check_line(const char *line, size_t len)
+{
+    const char *at;
+    char src;
+    unsigned n, seq;
+    int used = 0;
+
+    lines_total++;
+    at = memchr(line, '@', len);
+    if (at == NULL || memchr(at + 1, '@', len - (size_t)(at - line) - 1) != NULL || line[len - 1] != '#' ||
+        sscanf(at, "@%c%u %u#%n", &src, &n, &seq, &used) != 3 || at + used != line + len || n >= WRITER_MAX ||
+        (src != 'D' && src != 'L')) {
+        lines_bad++;
+        if (lines_bad <= 3) {
+            printf("bad line: %.*s\n", (int)len, line);
+        }
+        return;
+    }
+    if (src == 'D') {
+        if (seq != line_direct_last[n] + 1) fail("direct line out of sequence", seq, line_direct_last[n]);
+        line_direct_last[n] = seq;
+        line_direct_got[n]++;
+    } else {
+        if (seq <= line_log_last[n]) fail("log line out of order", seq, line_log_last[n]);
+        line_log_last[n] = seq;
+        line_log_got[n]++;
+    }
+}
+
+/* 模拟串口发送DMA：不加锁读取，按行检查 */
+static void dma_thread(void *arg)
+{
+    static char line[LINE_MAX];
+    size_t len = 0, i;
+    rb_span_t span;
+
+    while (dma_running || tx_rb.used(&tx_rb) > 0) {
+        span = tx_rb.peek(&tx_rb);
+        if (span.len == 0) {
+            osDelay(1);
+            continue;
+        }
+        for (i = 0; i < span.len; i++) {
+            char c = (char)span.data[i];
+            if (c == '\r' || c == '\n') {
+                if (len > 0) check_line(line, len);
+                len = 0;
+            } else if (len < sizeof(line)) {
+                line[len++] = c;
+            } else {
+                lines_bad++;
+                len = 0;
+            }
+        }
+        tx_rb.consume(&tx_rb, span.len);
+    }
+    thread_done();
+}
+
+/* simulated interrupts -------------------------------------------------------*/
+
+static void irq_thread(void *arg)
+{
+    sensor_record_t rec;
+    uint8_t b;
+    unsigned seed = 7;
+    int k;
+
+    memset(&rec, 0, sizeof(rec));
+    while (running) {
+        //一次"FIFO读取"产生若干帧
+        for (k = 0; k < 4; k++) {
+            rec.seq = sensor_sent + sensor_dropped + 1;
+            rec.value[0] = (int16_t)rec.seq;
+            rec.value[5] = (int16_t)~rec.seq;
+            if (sensor_rb.write(&sensor_rb, (const uint8_t *)&rec, sizeof(rec)) == sizeof(rec)) {
+                sensor_sent++;
+            } else {
+                sensor_dropped++;
+            }
+        }
+        osThreadFlagsSet(sensor_id, FLAG_DATA);
+
+        //串口字节，偶尔一个换行
+        seed = seed * 1103515245u + 12345u;
+        for (k = (int)((seed >> 16) % 8); k >= 0; k--) {
+            b = ((seed >> 8) % 97 == 0) ? '\n' : (uint8_t)('a' + (rx_sent + rx_dropped) % 26);
+            if (rx_rb.write(&rx_rb, &b, 1) == 1) {
+                rx_sent++;
+            } else {
+                rx_dropped++;
+            }
+            seed = seed * 1103515245u + 12345u;
+        }
+        osThreadFlagsSet(uart_id, FLAG_RX);
+        usleep(200);
+    }
+    thread_done();
+}
+
+/* threads -------------------------------------------------------------------*/
+
+static void sensor_drain(void)
+{
+    sensor_record_t rec;
+    static uint32_t last;
+
+    while (sensor_rb.read(&sensor_rb, (uint8_t *)&rec, sizeof(rec)) == sizeof(rec)) {
+        if (rec.seq <= last || rec.value[0] != (int16_t)rec.seq || rec.value[5] != (int16_t)~rec.seq) {
+            fail("sensor record", rec.seq, last);
+        }
+        last = rec.seq;
+        sensor_got++;
+    }
+}
+
+static void sensor_thread(void *arg)
+{
+    while (running) {
+        if (osThreadFlagsWait(FLAG_DATA, osFlagsWaitAny, 100) == osFlagsErrorTimeout && running) {
+            //irq一直在产生数据，100ms收不到标志说明唤醒丢失
+            fail("sensor wakeup timeout", sensor_sent, sensor_got);
+        }
+        sensor_drain();
+    }
+    thread_done();
+}
+
+static void uart_drain(void)
+{
+    uint8_t buf[32];
+    size_t n, i;
+
+    while ((n = rx_rb.read(&rx_rb, buf, sizeof(buf))) > 0) {
+        for (i = 0; i < n; i++) {
+            if (buf[i] == '\n') {
+                stats_posts++;
+                osThreadFlagsSet(report_id, FLAG_STATS);
+            }
+        }
+        rx_got += n;
+    }
+}
+
+static void uart_thread(void *arg)
+{
+    while (running) {
+        if (osThreadFlagsWait(FLAG_RX, osFlagsWaitAny, 100) == osFlagsErrorTimeout && running) {
+            fail("uart wakeup timeout", rx_sent, rx_got);
+        }
+        uart_drain();
+    }
+    thread_done();
+}
+
+static void writer_thread(void *arg)
+{
+    uint32_t id = (uint32_t)(uintptr_t)arg;
+    char line[48];
+    int len;
+
+    while (running) {
+        line_log_sent[id]++;
+        elog_i("STRESS", "@L%lu %lu#", (unsigned long)id, (unsigned long)line_log_sent[id]);
+
+        line_direct_sent[id]++;
+        len = snprintf(line, sizeof(line), "W%lu @D%lu %lu#\r", (unsigned long)id, (unsigned long)id,
+                       (unsigned long)line_direct_sent[id]);
+        tx_write_line(line, (size_t)len);
+        if ((line_direct_sent[id] & 7) == 0) {
+            osDelay(1);
+        }
+    }
+    thread_done();
+}
+
+static void log_thread(void *arg)
+{
+    while (log_running) {
+        osThreadFlagsWait(FLAG_LOG, osFlagsWaitAny, 10);
+        elog_async_flush();
+    }
+    elog_async_flush();
+    thread_done();
+}
+
+static void report(void)
+{
+    const fy_rtos_thread_t *t;
+    uint32_t i, load;
+
+    fy_rtos_stats_update();
+    load = fy_rtos_load_permille();
+    for (i = 0; (t = fy_rtos_thread_info(i)) != NULL; i++) {
+        printf("%-8s stack %6u/%6u free  cpu %3u.%u%%\n", t->name, t->stack_free_min, t->stack_size,
+               t->load_permille / 10, t->load_permille % 10);
+    }
+    printf("load %u.%u%% of all CPUs\n", load / 10, load % 10);
+}
+
+/* 每200ms统计一次，收到FLAG_STATS时立即统计 */
+static void report_thread(void *arg)
+{
+    uint32_t next = osKernelGetTickCount() + 200, now, flags;
+
+    while (running) {
+        now = osKernelGetTickCount();
+        if ((int32_t)(next - now) > 0) {
+            flags = osThreadFlagsWait(FLAG_STATS, osFlagsWaitAny, next - now);
+            if ((flags & osFlagsError) == 0) {
+                fy_rtos_stats_update();
+                stats_reports++;
+                continue;
+            }
+        }
+        next += 200;
+        fy_rtos_stats_update();
+        stats_reports++;
+        if (verbose) report();
+    }
+    thread_done();
+}
+
+/* main ----------------------------------------------------------------------*/
+
+static void wait_exited(uint32_t n)
+{
+    while (__atomic_load_n(&exited, __ATOMIC_ACQUIRE) < n) {
+        usleep(1000);
+    }
+}
+
+static void logger_init(void)
+{
+    easy_logger_int_struct_t init = {0};
+
+    init.output = elog_out;
+    init.output_lock = log_lock;
+    init.output_unlock = log_unlock;
+    elog_init(&init);
+    elog_set_filter_lvl(ELOG_LVL_VERBOSE);
+    elog_start();
+}
+
+int main(int argc, char **argv)
+{
+    double seconds = 3.0;
+    int writers = 4, opt, i;
+    uint32_t threads, direct_sent = 0, direct_got = 0, log_sent = 0, log_got = 0, dropped;
+    const fy_rtos_thread_t *t;
+
+    while ((opt = getopt(argc, argv, "t:w:v")) != -1) {
+        switch (opt) {
+        case 't': seconds = atof(optarg); break;
+        case 'w': writers = atoi(optarg); break;
+        case 'v': verbose = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-t seconds] [-w writers] [-v]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (seconds <= 0 || writers < 1 || writers > WRITER_MAX) {
+        fprintf(stderr, "seconds must be > 0, writers 1..%d\n", WRITER_MAX);
+        return 2;
+    }
+
+    fy_rtos_init();
+    FY_RTOS_LOCK_INIT(tx);
+    FY_RTOS_LOCK_INIT(log);
+    ringBuffer_init_spsc(&sensor_rb, sensor_buffer, sizeof(sensor_buffer));
+    ringBuffer_init_spsc(&rx_rb, rx_buffer, sizeof(rx_buffer));
+    ringBuffer_init(&tx_rb, tx_buffer, sizeof(tx_buffer));
+    ringBuffer_registerLocks(&tx_rb, NULL, NULL, tx_lock, tx_unlock);
+    logger_init();
+    //丢弃elog启动信息，之后的每一行都带序号
+    elog_async_flush();
+    tx_rb.clear(&tx_rb);
+
+    sensor_id = fy_rtos_thread_new("sensor", sensor_thread, NULL, 512, osPriorityHigh);
+    uart_id = fy_rtos_thread_new("uart", uart_thread, NULL, 384, osPriorityAboveNormal);
+    report_id = fy_rtos_thread_new("report", report_thread, NULL, 640, osPriorityNormal);
+    log_id = fy_rtos_thread_new("log", log_thread, NULL, 768, osPriorityLow);
+    fy_rtos_thread_new("dma", dma_thread, NULL, 256, osPriorityRealtime);
+    fy_rtos_thread_new("irq", irq_thread, NULL, 256, osPriorityRealtime);
+    for (i = 0; i < writers; i++) {
+        static const char *names[WRITER_MAX] = {"writer0", "writer1", "writer2", "writer3", "writer4", "writer5"};
+        fy_rtos_thread_new(names[i], writer_thread, (void *)(uintptr_t)i, 512, osPriorityBelowNormal);
+    }
+    threads = osThreadGetCount();
+    //内核启动前加锁为空操作，这一行直接写入，计为writer0的第一行
+    line_direct_sent[0]++;
+    tx_write_line("boot @D0 1#\r", 12);
+
+    osKernelStart();
+    usleep((useconds_t)(seconds * 1e6));
+    report();
+    running = 0;
+    wait_exited(threads - 2);
+    //中断已停止，剩余数据在这里处理
+    sensor_drain();
+    uart_drain();
+    log_running = 0;
+    wait_exited(threads - 1);
+    dma_running = 0;
+    wait_exited(threads);
+
+    for (i = 0; i < writers; i++) {
+        direct_sent += line_direct_sent[i];
+        direct_got += line_direct_got[i];
+        log_sent += line_log_sent[i];
+        log_got += line_log_got[i];
+    }
+    dropped = elog_get_line_dropped() + elog_async_get_dropped();
+    printf("lines %u (bad %u): direct %u/%u, log %u/%u + %u dropped\n", lines_total, lines_bad, direct_got,
+           direct_sent, log_got, log_sent, dropped);
+    printf("sensor %u/%u (%u ring full), rx %u/%u (%u ring full), stats %u posted / %u reports\n", sensor_got,
+           sensor_sent, sensor_dropped, rx_got, rx_sent, rx_dropped, stats_posts, stats_reports);
+
+    if (lines_bad != 0) fail("corrupted lines", lines_bad, lines_total);
+    if (direct_got != direct_sent) fail("direct lines lost", direct_got, direct_sent);
+    if (log_got + dropped != log_sent) fail("log lines lost", log_got + dropped, log_sent);
+    if (log_got == 0) fail("no log line received", log_got, log_sent);
+    if (sensor_got != sensor_sent) fail("sensor records lost", sensor_got, sensor_sent);
+    if (rx_got != rx_sent) fail("rx bytes lost", rx_got, rx_sent);
+    if (stats_reports == 0) fail("no stats report", 0, 0);
+    for (i = 0; (t = fy_rtos_thread_info(i)) != NULL; i++) {
+        if (t->stack_free_min == 0) fail("stack exhausted", i, t->stack_size);
+    }
+    printf("%s\n", errors ? "FAIL" : "PASS");
+    return errors ? 1 : 0;
+}
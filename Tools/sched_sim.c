@@ -0,0 +1,303 @@
+/*
+ * Host simulation of the cooperative scheduler (User/Middlewares/Scheduler).
+ *
+ * The port runs on a simulated clock: tasks "work" by advancing the cycle
+ * counter, interrupt sources fire at scheduled times and call fy_sched_post()
+ * exactly as the ISRs on the target do, and port.idle() sleeps until the next
+ * interrupt or SysTick, like __WFI. The task set mirrors user_main().
+ *
+ * Checked at the end:
+ *   - idle is never entered while a task has events or a timer is due
+ *   - periodic timers fire once per period (unless overloaded)
+ *   - no event is left unhandled
+ *   - worst-case latency of every task stays below the non-preemptive bound:
+ *     one run of the longest lower-priority task, plus one run of each task at
+ *     the same or higher priority, plus the interrupts in between
+ *   - the reported load matches the simulated busy time
+ *
+ *   sched_sim [-t seconds] [-l]      -l: make the report task overrun its slot
+ */
+#include "fy_sched.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CYCLES_PER_TICK     72000ULL    //72MHz, 1ms tick
+
+#define EVT_DATA            (1UL << 0)
+#define EVT_RX              (1UL << 1)
+#define EVT_ENC             (1UL << 2)
+#define EVT_LOG             (1UL << 3)
+
+typedef struct {
+    const char *name;
+    uint64_t next;//下次触发(cycles)，0为未启用
+    uint64_t cost;//中断服务时间
+    void (*fire)(void);
+    uint32_t count;
+} sim_irq_t;
+
+static uint64_t sim_cycles;
+static uint64_t busy_cycles;
+static uint32_t errors;
+static fy_sched_t sched;
+static fy_task_t imu_task, uart_task, enc_task, report_task, log_task;
+static unsigned seed = 1;
+
+static void irq_i2c(void);
+static void irq_uart(void);
+static void irq_enc(void);
+
+static sim_irq_t irqs[] = {
+    {"i2c",  0, 300,  irq_i2c,  0},
+    {"uart", 0, 400,  irq_uart, 0},
+    {"exti", 0, 150,  irq_enc,  0},
+};
+#define IRQ_NUM (sizeof(irqs) / sizeof(irqs[0]))
+
+static unsigned sim_rand(unsigned max)
+{
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 16) % max;
+}
+
+/* port ----------------------------------------------------------------------*/
+
+static uint32_t sim_now(void)
+{
+    return (uint32_t)(sim_cycles / CYCLES_PER_TICK);
+}
+
+static uint32_t sim_cycles32(void)
+{
+    return (uint32_t)sim_cycles;
+}
+
+/* 推进时间到t，期间到期的中断依次执行 */
+static void sim_advance(uint64_t t)
+{
+    while (1) {
+        sim_irq_t *next = NULL;
+        for (size_t i = 0; i < IRQ_NUM; i++) {
+            if (irqs[i].next != 0 && irqs[i].next <= t && (next == NULL || irqs[i].next < next->next)) {
+                next = &irqs[i];
+            }
+        }
+        if (next == NULL) break;
+        if (next->next > sim_cycles) sim_cycles = next->next;
+        next->next = 0;
+        next->count++;
+        next->fire();
+        sim_cycles += next->cost;
+        busy_cycles += next->cost;
+        if (sim_cycles > t) t = sim_cycles;
+    }
+    sim_cycles = t;
+}
+
+static void sim_idle(uint32_t timeout)
+{
+    uint64_t wake = (sim_cycles / CYCLES_PER_TICK + 1) * CYCLES_PER_TICK;//SysTick
+    fy_task_t *task;
+
+    for (task = sched.tasks; task != NULL; task = task->next) {
+        if (task->events != 0) {
+            printf("ERROR: idle with events pending on %s\n", task->name);
+            errors++;
+        }
+    }
+    if (timeout == 0) {
+        printf("ERROR: idle with an expired timer\n");
+        errors++;
+    }
+    for (size_t i = 0; i < IRQ_NUM; i++) {
+        if (irqs[i].next != 0 && irqs[i].next < wake) wake = irqs[i].next;
+    }
+    //中断在关中断睡眠期间挂起，返回后才执行
+    sim_cycles = wake;
+    sim_advance(wake);
+}
+
+static const fy_sched_port_t sim_port = {
+    .now = sim_now,
+    .cycles = sim_cycles32,
+    .cycles_per_tick = (uint32_t)CYCLES_PER_TICK,
+    .idle = sim_idle,
+};
+
+/* 任务执行c个周期，期间的中断照常发生 */
+static void busy(uint64_t c)
+{
+    busy_cycles += c;
+    sim_advance(sim_cycles + c);
+}
+
+/* interrupts ----------------------------------------------------------------*/
+
+static void irq_i2c(void)
+{
+    fy_sched_post(&imu_task, EVT_DATA);
+}
+
+static void irq_uart(void)
+{
+    fy_sched_post(&uart_task, EVT_RX);
+    irqs[1].next = sim_cycles + (20 + sim_rand(40)) * CYCLES_PER_TICK;
+}
+
+static void irq_enc(void)
+{
+    fy_sched_post(&enc_task, EVT_ENC);
+    irqs[2].next = sim_cycles + (1 + sim_rand(30)) * CYCLES_PER_TICK + sim_rand(CYCLES_PER_TICK);
+}
+
+/* tasks ---------------------------------------------------------------------*/
+
+static uint32_t imu_timer_runs, report_runs;
+static uint64_t report_cost = 150000;
+
+static void imu_fn(fy_task_t *task, uint32_t events)
+{
+    if (events & FY_SCHED_EVT_TIMER) {
+        imu_timer_runs++;
+        busy(800);//发起FIFO_COUNT读取
+        irqs[0].next = sim_cycles + 1500 * 72;//约1.5ms后批量读取完成
+    }
+    if (events & EVT_DATA) {
+        busy(10 * 2200);//10帧的DSP处理
+    }
+}
+
+static void uart_fn(fy_task_t *task, uint32_t events)
+{
+    busy(500);
+}
+
+static void enc_fn(fy_task_t *task, uint32_t events)
+{
+    busy(200);
+    fy_sched_post(&log_task, EVT_LOG);
+}
+
+static void report_fn(fy_task_t *task, uint32_t events)
+{
+    report_runs++;
+    busy(report_cost);
+    fy_sched_post(&log_task, EVT_LOG);
+}
+
+static void log_fn(fy_task_t *task, uint32_t events)
+{
+    busy(30000);
+}
+
+static void print_stats(double seconds)
+{
+    fy_task_t *t;
+
+    printf("%-8s %4s %8s %10s %10s %10s %6s %8s\n", "task", "prio", "runs", "avg(us)", "max(us)",
+           "lat(us)", "late", "overrun");
+    for (t = sched.tasks; t != NULL; t = t->next) {
+        printf("%-8s %4u %8u %10.1f %10.1f %10.1f %6u %8u\n", t->name, t->prio, t->runs,
+               t->runs ? t->run_cycles / 72.0 / t->runs : 0.0, t->run_cycles_max / 72.0,
+               t->latency_max / 72.0, t->late_max, t->overruns);
+    }
+    printf("load %u.%u%%, idle %u times in %.1f s\n", fy_sched_load_permille(&sched) / 10,
+           fy_sched_load_permille(&sched) % 10, sched.idle_count, seconds);
+}
+
+int main(int argc, char **argv)
+{
+    double seconds = 10.0;
+    int overload = 0, opt;
+    uint64_t end, start;
+    uint32_t bound, expect, load, sim_load;
+    fy_task_t *t, *o;
+
+    while ((opt = getopt(argc, argv, "t:l")) != -1) {
+        switch (opt) {
+        case 't': seconds = atof(optarg); break;
+        case 'l': overload = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-t seconds] [-l]\n", argv[0]);
+            return 2;
+        }
+    }
+    //统计计数为32位，72MHz下约59秒回绕
+    if (seconds <= 0 || seconds > 50) {
+        fprintf(stderr, "seconds must be in (0, 50]\n");
+        return 2;
+    }
+    if (overload) {
+        report_cost = 25 * CYCLES_PER_TICK;//比imu周期长，imu定时器会丢周期
+    }
+
+    sim_cycles = 5 * CYCLES_PER_TICK;
+    fy_sched_init(&sched, &sim_port);
+    fy_sched_task_add(&sched, &imu_task, "imu", 0, imu_fn, NULL);
+    fy_sched_task_add(&sched, &uart_task, "uart", 1, uart_fn, NULL);
+    fy_sched_task_add(&sched, &enc_task, "encoder", 1, enc_fn, NULL);
+    fy_sched_task_add(&sched, &report_task, "report", 2, report_fn, NULL);
+    fy_sched_task_add(&sched, &log_task, "log", 3, log_fn, NULL);
+    fy_sched_timer_start(&imu_task, 10, 10);
+    fy_sched_timer_start(&report_task, 500, 500);
+    irqs[1].next = sim_cycles + 7 * CYCLES_PER_TICK;
+    irqs[2].next = sim_cycles + 3 * CYCLES_PER_TICK;
+
+    start = sim_cycles;
+    end = start + (uint64_t)(seconds * 1000) * CYCLES_PER_TICK;
+    while (sim_cycles < end) {
+        fy_sched_run_once(&sched);
+    }
+    //把已到来的事件处理完
+    while (fy_sched_run_once(&sched) && sim_cycles < end + 100 * CYCLES_PER_TICK) {
+    }
+
+    print_stats(seconds);
+
+    for (t = sched.tasks; t != NULL; t = t->next) {
+        //非抢占：最坏等待一个低优先级任务运行完，再加上同级及高优先级任务各运行一次
+        uint32_t blocking = 0;
+        bound = 2000;
+        for (o = sched.tasks; o != NULL; o = o->next) {
+            if (o == t) continue;
+            if (o->prio <= t->prio) {
+                bound += o->run_cycles_max;
+            } else if (o->run_cycles_max > blocking) {
+                blocking = o->run_cycles_max;
+            }
+        }
+        bound += blocking;
+        if (t->latency_max > bound) {
+            printf("ERROR: %s latency %u cycles > bound %u\n", t->name, t->latency_max, bound);
+            errors++;
+        }
+        if (t->events != 0 && t != &imu_task) {
+            printf("ERROR: %s has unhandled events 0x%x\n", t->name, t->events);
+            errors++;
+        }
+    }
+    expect = (uint32_t)(seconds * 100);
+    if (!overload && (imu_timer_runs + 1 < expect || imu_timer_runs > expect + 1 || imu_task.overruns != 0)) {
+        printf("ERROR: imu timer ran %u times, expected %u\n", imu_timer_runs, expect);
+        errors++;
+    }
+    if (overload && imu_task.overruns == 0) {
+        printf("ERROR: overload did not register imu overruns\n");
+        errors++;
+    }
+    if (report_runs + 1 < (uint32_t)(seconds * 2)) {
+        printf("ERROR: report ran %u times\n", report_runs);
+        errors++;
+    }
+    load = fy_sched_load_permille(&sched);
+    sim_load = (uint32_t)(busy_cycles * 1000 / (sim_cycles - start));
+    if (load + 2 < sim_load || load > sim_load + 2) {
+        printf("ERROR: load %u permille, simulated %u\n", load, sim_load);
+        errors++;
+    }
+    printf("irqs: i2c %u, uart %u, exti %u\n", irqs[0].count, irqs[1].count, irqs[2].count);
+    printf("%s\n", errors ? "FAIL" : "PASS");
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * Host check of the event tracer (User/Middlewares/Trace).
+ *
+ * fy_uart is compiled with FY_TRACE and runs on the HAL mock's USART1 at the
+ * firmware's settings; the trace port reads the mock's cycle clock. Every
+ * 5 ms an "app" slice sends a payload line and reads the bytes injected on
+ * RX every 20 ms, the trace is flushed into the free TX ring space every
+ * 10 ms like the firmware's trace task. Everything the mock shifts out on the
+ * TX line goes to stdout, so the converter sees the same mixed stream as on
+ * the board:
+ *
+ *   trace_sim [ms] | Tools/fy_trace.py convert -o trace.json --summary
+ */
+#include "hal_mock.h"
+#include "usart.h"
+#include "fy_uart.h"
+#include "fy_trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static uint8_t uart_rx_buffer[256];
+static uint8_t uart_tx_buffer[256];
+static ringBuffer_t uart_rx_rb;
+static ringBuffer_t uart_tx_rb;
+static fy_uart_t uart;
+static fy_trace_t trace;
+
+static uint32_t port_cycles(void)
+{
+    return (uint32_t)hal_mock_now();
+}
+
+static uint32_t port_now(void)
+{
+    return HAL_GetTick();
+}
+
+static uint32_t port_lock(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    return primask;
+}
+
+static void port_unlock(uint32_t key)
+{
+    __set_PRIMASK(key);
+}
+
+static void wire_out(void *ctx, uint8_t byte)
+{
+    (void)ctx;
+    putchar(byte);
+}
+
+static void trace_out(const char *line, size_t len)
+{
+    uart.uartTx(&uart, (const uint8_t *)line, len);
+}
+
+static size_t tx_room(void)
+{
+    return uart_tx_rb.size - uart_tx_rb.used(&uart_tx_rb);
+}
+
+static int tx_drained(void *ctx)
+{
+    (void)ctx;
+    return !uart.tx_busy && uart.tx_q_count == 0 && hal_mock_uart_tx_idle(USART1);
+}
+
+int main(int argc, char **argv)
+{
+    static const uint8_t ping[] = "ping\r\n";
+    const fy_trace_port_t port = {
+        .cycles = port_cycles,
+        .now = port_now,
+        .lock = port_lock,
+        .unlock = port_unlock,
+        .hz = HAL_MOCK_HCLK,
+    };
+    uint32_t ms = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 300;
+    uint8_t buf[64];
+    int32_t app_id;
+    uint32_t t;
+    int n;
+
+    hal_mock_reset();
+    MX_USART1_UART_Init();
+    hal_mock_uart_set_tx_sink(USART1, wire_out, NULL);
+    ringBuffer_init(&uart_rx_rb, uart_rx_buffer, sizeof(uart_rx_buffer));
+    ringBuffer_init(&uart_tx_rb, uart_tx_buffer, sizeof(uart_tx_buffer));
+    if (fy_trace_init(&trace, &port) != 0 ||
+        fy_uart_init_ex(&uart, &huart1, &uart_rx_rb, &uart_tx_rb, FY_UART_RX_DMA_IDLE) != 0) {
+        fprintf(stderr, "setup failed\n");
+        return 1;
+    }
+    app_id = fy_trace_id(&trace, "app");
+
+    for (t = 0; t < ms; t++) {
+        if (t % 5 == 0) {
+            fy_trace_record(&trace, FY_TRACE_T_ENTER, (uint8_t)app_id, 0);
+            n = snprintf((char *)buf, sizeof(buf), "payload %lu\n", (unsigned long)t);
+            uart.uartTx(&uart, buf, (size_t)n);
+            if (t % 20 == 0) {
+                hal_mock_uart_inject(USART1, ping, sizeof(ping) - 1);
+            }
+            while (uart.uartRx(&uart, buf, sizeof(buf)) > 0) {
+            }
+            fy_trace_record(&trace, FY_TRACE_T_EXIT, (uint8_t)app_id, 0);
+        }
+        if (t % 10 == 0) {
+            fy_trace_flush(&trace, trace_out, tx_room());
+        }
+        hal_mock_advance(HAL_MOCK_MS(1));
+    }
+    //输出剩余记录(输出本身还会产生新的DMA事件，最多再输出几轮)
+    for (t = 0; t < 64 && trace.head != trace.tail; t++) {
+        fy_trace_flush(&trace, trace_out, tx_room());
+        hal_mock_advance(HAL_MOCK_MS(10));
+    }
+    if (hal_mock_run_until(tx_drained, NULL, HAL_MOCK_MS(1000)) != 0) {
+        fprintf(stderr, "uart tx stuck\n");
+        return 1;
+    }
+    fflush(stdout);
+    fprintf(stderr, "records:%lu lost:%lu cost:%lu cycles\n", (unsigned long)trace.head,
+            (unsigned long)trace.lost_total, (unsigned long)trace.record_cycles);
+    return 0;
+}
@@ -0,0 +1,209 @@
+/*
+ * UART path benchmark on the HAL mock (Tools/HalMock).
+ *
+ * Runs the firmware's fy_uart (and elog for the log path) on the simulated
+ * USART1 + DMA1 at several baud rates and reports, per path:
+ *   TX  uartTx chunks / elog async lines / fy_uart_tx_buffer blocks:
+ *       line utilization (bytes on the wire vs. elapsed line time),
+ *       DMA starts and DMA interrupts per KB, host ns per byte of the
+ *       driver + mock (the simulated ISR time is zero, so this is the
+ *       software cost on the host, useful for before/after comparisons)
+ *   RX  DMA_IDLE vs. IT reception of 128 byte bursts while the main loop
+ *       masks interrupts for mask_us every millisecond:
+ *       interrupts per KB, bytes lost (ORE or rx_rb overrun)
+ *
+ *   uart_path_bench [mask_us]      default 20
+ */
+#include "hal_mock.h"
+#include "usart.h"
+#include "fy_uart.h"
+#include "elog.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_BYTES     (64U * 1024U)
+
+static const uint32_t bauds[] = {115200, 921600, 2000000, 4500000};
+
+static uint8_t uart_rx_buffer[1024];
+static uint8_t uart_tx_buffer[1024];
+static ringBuffer_t uart_rx_rb;
+static ringBuffer_t uart_tx_rb;
+static fy_uart_t uart;
+static uint8_t block[1024];
+static uint8_t rx_out[256];
+static uint64_t wire_bytes;
+static unsigned seed = 1;
+
+static unsigned sim_rand(unsigned max)
+{
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 16) % max;
+}
+
+static double host_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void wire_sink(void *ctx, uint8_t byte)
+{
+    (void)ctx;
+    (void)byte;
+    wire_bytes++;
+}
+
+static void setup(uint32_t baud, fy_uart_rx_mode_t mode)
+{
+    hal_mock_reset();
+    MX_USART1_UART_Init();
+    huart1.Init.BaudRate = baud;
+    HAL_UART_Init(&huart1);
+    ringBuffer_init(&uart_rx_rb, uart_rx_buffer, sizeof(uart_rx_buffer));
+    ringBuffer_init(&uart_tx_rb, uart_tx_buffer, sizeof(uart_tx_buffer));
+    wire_bytes = 0;
+    hal_mock_uart_set_tx_sink(USART1, wire_sink, NULL);
+    if (fy_uart_init_ex(&uart, &huart1, &uart_rx_rb, &uart_tx_rb, mode) != 0) {
+        printf("fy_uart_init_ex failed\n");
+        exit(1);
+    }
+}
+
+static int tx_drained(void *ctx)
+{
+    (void)ctx;
+    return !uart.tx_busy && uart.tx_q_count == 0 && hal_mock_uart_tx_idle(USART1);
+}
+
+static void elog_uart_out(const char *log, size_t size)
+{
+    uart.uartTx(&uart, (const uint8_t *)log, size);
+}
+
+typedef enum {
+    TX_UARTTX = 0,
+    TX_ELOG,
+    TX_BUFFER,
+} tx_path_t;
+
+static const char *const tx_path_name[] = {"uartTx", "elog", "tx_buffer"};
+
+static void block_done(fy_uart_t *u, void *arg)
+{
+    (void)u;
+    *(volatile uint8_t *)arg = 0;
+}
+
+/* 生产者尽量写满，写不进时等一个字节时间 */
+static void bench_tx(uint32_t baud, tx_path_t path)
+{
+    volatile uint8_t block_busy = 0;
+    uint64_t start, elapsed;
+    uint32_t line = 0;
+    double t0, t1;
+
+    setup(baud, FY_UART_RX_DMA_IDLE);
+    if (path == TX_ELOG) {
+        easy_logger_int_struct_t init = {0};
+
+        init.output = elog_uart_out;
+        elog_init(&init);
+        elog_set_fmt(ELOG_LVL_INFO, ELOG_FMT_TAG);
+        elog_start();
+    }
+    memset(block, 'x', sizeof(block));
+    start = hal_mock_now();
+    t0 = host_ns();
+    while (uart.tx_bytes + uart_tx_rb.used(&uart_tx_rb) < BENCH_BYTES) {
+        size_t before = uart.tx_bytes + uart_tx_rb.used(&uart_tx_rb);
+
+        switch (path) {
+        case TX_UARTTX:
+            uart.uartTx(&uart, block, 64);
+            break;
+        case TX_ELOG:
+            if (uart_tx_rb.size - uart_tx_rb.used(&uart_tx_rb) > ELOG_LINE_BUF_SIZE) {
+                elog_i("BENCH", "line %lu value %d", (unsigned long)line++, (int)sim_rand(100000));
+                elog_async_flush();
+            }
+            break;
+        case TX_BUFFER:
+            if (!block_busy) {
+                block_busy = 1;
+                fy_uart_tx_buffer(&uart, block, sizeof(block), block_done, (void *)&block_busy);
+            }
+            break;
+        }
+        if (uart.tx_bytes + uart_tx_rb.used(&uart_tx_rb) == before || path == TX_BUFFER) {
+            hal_mock_advance(hal_mock_uart_stats(USART1)->byte_cycles);
+        }
+    }
+    hal_mock_run_until(tx_drained, NULL, HAL_MOCK_MS(10000));
+    t1 = host_ns();
+    elapsed = hal_mock_now() - start;
+    if (path == TX_ELOG) {
+        elog_deinit();
+    }
+    printf("tx %-9s %8lu  %6.1f%%  %9lu  %8.2f  %8.1f\n", tx_path_name[path], (unsigned long)baud,
+           100.0 * (double)hal_mock_uart_stats(USART1)->tx_busy_cycles / (double)elapsed,
+           (unsigned long)uart.tx_dma_starts,
+           (double)hal_mock_irq_count(DMA1_Channel4_IRQn) * 1024.0 / (double)wire_bytes,
+           (t1 - t0) / (double)wire_bytes);
+    fy_uart_deinit(&uart);
+}
+
+/* 128字节突发，突发间隔2个字节时间；主循环每1ms关中断mask_us并读取rx_rb */
+static void bench_rx(uint32_t baud, fy_uart_rx_mode_t mode, uint32_t mask_us)
+{
+    uint64_t next_loop = 0, injected = 0;
+    uint32_t lost;
+
+    setup(baud, mode);
+    memset(block, 0x55, sizeof(block));
+    while (injected < BENCH_BYTES) {
+        if (hal_mock_uart_rx_pending(USART1) == 0) {
+            injected += hal_mock_uart_inject(USART1, block, 128);
+            hal_mock_advance(hal_mock_uart_stats(USART1)->byte_cycles * 2U);
+        }
+        if (hal_mock_now() >= next_loop) {
+            next_loop = hal_mock_now() + HAL_MOCK_MS(1);
+            __disable_irq();
+            hal_mock_advance(HAL_MOCK_US(mask_us));
+            __enable_irq();
+        }
+        hal_mock_advance(hal_mock_uart_stats(USART1)->byte_cycles * 16U);
+        while (uart.uartRx(&uart, rx_out, sizeof(rx_out)) > 0) {
+        }
+    }
+    hal_mock_advance(hal_mock_uart_stats(USART1)->byte_cycles * 200U);
+    lost = hal_mock_uart_stats(USART1)->rx_overrun + uart.rx_overrun_count;
+    printf("rx %-9s %8lu  %9.2f  %6lu  %6lu\n", (mode == FY_UART_RX_DMA_IDLE) ? "dma_idle" : "it",
+           (unsigned long)baud,
+           (double)(hal_mock_irq_count(USART1_IRQn) + hal_mock_irq_count(DMA1_Channel5_IRQn)) * 1024.0 / (double)injected,
+           (unsigned long)lost, (unsigned long)uart.rx_error_count);
+    fy_uart_deinit(&uart);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t mask_us = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 20U;
+
+    printf("%-13s%8s  %7s  %9s  %8s  %8s\n", "path", "baud", "line", "dma_start", "irq/KB", "host_ns/B");
+    for (size_t i = 0; i < sizeof(bauds) / sizeof(bauds[0]); i++) {
+        bench_tx(bauds[i], TX_UARTTX);
+        bench_tx(bauds[i], TX_ELOG);
+        bench_tx(bauds[i], TX_BUFFER);
+    }
+    printf("\nrx, interrupts masked %lu us every 1 ms\n", (unsigned long)mask_us);
+    printf("%-13s%8s  %9s  %6s  %6s\n", "path", "baud", "irq/KB", "lost", "errors");
+    for (size_t i = 0; i < sizeof(bauds) / sizeof(bauds[0]); i++) {
+        bench_rx(bauds[i], FY_UART_RX_DMA_IDLE, mask_us);
+        bench_rx(bauds[i], FY_UART_RX_IT, mask_us);
+    }
+    return 0;
+}
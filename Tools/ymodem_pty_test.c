@@ -0,0 +1,452 @@
+/*
+ * Host test of the YMODEM receive engine (fy_ymodem) over a pseudo-terminal pair.
+ *
+ * The receiver runs on the pty master, like the bootloader main loop: bytes read
+ * from the fd go to fy_ymodem_input, fy_ymodem_poll runs every few ms, ACK/NAK/'C'
+ * are written back. The file goes into an emulated 48K app region with the same
+ * double-buffered page semantics as the bootloader (boot_flash.c): write returns busy
+ * while both 1K page buffers wait for programming, a page takes -d ms to program.
+ *
+ * Built-in scenarios (a forked sender on the pty slave):
+ *   ymodem      YMODEM-1K batch, odd file size, last block SOH 128
+ *   ymodem-err  every 7th block corrupted once (NAK path), one ACK swallowed (duplicate)
+ *   xmodem      XMODEM-1K/CRC (first packet is block 1, single EOT)
+ *   too-big     file larger than the app region (open rejects, CAN CAN)
+ * With -p the receiver prints the slave path and waits for an external sender, e.g.
+ *   sz --ymodem -k app.bin < /dev/pts/N > /dev/pts/N
+ * and the received image is written to -o.
+ *
+ *   ymodem_pty_test [-d page_ms] [-s size] [-v]
+ *   ymodem_pty_test -p [-o out.bin] [-d page_ms]
+ */
+#define _GNU_SOURCE
+#include "fy_ymodem.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#define APP_SIZE    (48 * 1024)
+#define PAGE_SIZE   1024
+
+static uint32_t now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+/* ---------------------------------------------------------------------------
+ * Emulated app region: two page buffers, programming takes page_ms per page.
+ */
+typedef struct {
+    uint32_t addr;
+    uint32_t len;
+    int full;
+} page_t;
+
+typedef struct {
+    int fd;
+    uint8_t flash[APP_SIZE];
+    page_t pages[2];
+    uint8_t buf[2][PAGE_SIZE];
+    int fill, prog;
+    uint32_t pos;
+    uint32_t page_ms;
+    int programming;
+    uint32_t prog_start;
+    char name[FY_YMODEM_NAME_MAX];
+    uint32_t size;
+    int opened, closed, aborted;
+    uint32_t busy, pages_done;
+    int verbose;
+} sink_t;
+
+static void sink_poll(sink_t *s)
+{
+    page_t *p = &s->pages[s->prog];
+
+    if (!p->full) return;
+    if (!s->programming) {
+        s->programming = 1;
+        s->prog_start = now_ms();
+        return;
+    }
+    if (now_ms() - s->prog_start < s->page_ms) return;
+    memset(&s->flash[p->addr], 0xFF, PAGE_SIZE);//erase
+    memcpy(&s->flash[p->addr], s->buf[s->prog], p->len);
+    s->pages_done++;
+    p->len = 0;
+    p->full = 0;
+    s->prog ^= 1;
+    s->programming = 0;
+}
+
+static int32_t sink_open(void *arg, const char *name, uint32_t size)
+{
+    sink_t *s = arg;
+
+    if (size > APP_SIZE) return -1;
+    snprintf(s->name, sizeof(s->name), "%s", name);
+    s->size = size;
+    s->opened++;
+    memset(s->pages, 0, sizeof(s->pages));
+    s->fill = s->prog = 0;
+    s->pos = 0;
+    if (s->verbose) printf("  open \"%s\" %u\n", name, size);
+    return 0;
+}
+
+static int32_t sink_write(void *arg, uint32_t offset, const uint8_t *data, uint32_t len)
+{
+    sink_t *s = arg;
+    page_t *cur = &s->pages[s->fill];
+    uint32_t avail;
+
+    if (offset != s->pos || len > APP_SIZE - s->pos) return -1;
+    avail = cur->full ? 0 : PAGE_SIZE - cur->len;
+    if (!cur->full && !s->pages[s->fill ^ 1].full) avail += PAGE_SIZE;
+    if (len > avail) {
+        s->busy++;
+        return 1;
+    }
+    while (len != 0) {
+        uint32_t n;
+
+        cur = &s->pages[s->fill];
+        if (cur->len == 0) cur->addr = s->pos;
+        n = PAGE_SIZE - cur->len;
+        if (n > len) n = len;
+        memcpy(&s->buf[s->fill][cur->len], data, n);
+        cur->len += n;
+        data += n;
+        len -= n;
+        s->pos += n;
+        if (cur->len == PAGE_SIZE) {
+            cur->full = 1;
+            s->fill ^= 1;
+        }
+    }
+    return 0;
+}
+
+static int32_t sink_close(void *arg, int32_t status)
+{
+    sink_t *s = arg;
+    page_t *cur = &s->pages[s->fill];
+
+    if (status < 0) {
+        s->aborted++;
+        return 0;
+    }
+    if (cur->len != 0 && !cur->full) {
+        cur->full = 1;
+        s->fill ^= 1;
+    }
+    if (s->pages[0].full || s->pages[1].full) return 1;
+    s->closed++;
+    return 0;
+}
+
+static void sink_send(void *arg, const uint8_t *data, uint32_t len)
+{
+    sink_t *s = arg;
+
+    if (write(s->fd, data, len) != (ssize_t)len) perror("write");
+}
+
+static const fy_ymodem_ops_t sink_ops = {sink_open, sink_write, sink_close, sink_send};
+
+/* ---------------------------------------------------------------------------
+ * Sender (child process on the pty slave)
+ */
+typedef struct {
+    int fd;
+    int xmodem;
+    int corrupt_every;//corrupt every Nth data block once
+    int swallow_ack_blk;//resend this block once as if its ACK was lost
+} sender_cfg_t;
+
+static int rx_byte_timeout(int fd, int ms)
+{
+    struct pollfd pfd = {fd, POLLIN, 0};
+    uint8_t c;
+
+    if (poll(&pfd, 1, ms) <= 0) return -1;
+    if (read(fd, &c, 1) != 1) return -1;
+    return c;
+}
+
+static void send_packet(int fd, uint8_t blk, const uint8_t *data, uint32_t len, int corrupt)
+{
+    uint8_t pkt[3 + 1024 + 2];
+    uint16_t crc;
+
+    pkt[0] = (len == 1024) ? FY_YMODEM_STX : FY_YMODEM_SOH;
+    pkt[1] = blk;
+    pkt[2] = (uint8_t)~blk;
+    memcpy(&pkt[3], data, len);
+    crc = fy_ymodem_crc16(0, data, len);
+    pkt[3 + len] = (uint8_t)(crc >> 8);
+    pkt[4 + len] = (uint8_t)(crc ^ (corrupt ? 0x55 : 0));
+    if (write(fd, pkt, 5 + len) != (ssize_t)(5 + len)) _exit(10);
+}
+
+/* send until ACK, returns 0 or -1 (CAN or too many retries) */
+static int send_until_ack(const sender_cfg_t *c, uint8_t blk, const uint8_t *data, uint32_t len, int corrupt)
+{
+    for (int tries = 0; tries < 10; tries++) {
+        send_packet(c->fd, blk, data, len, corrupt && tries == 0);
+        for (;;) {
+            int r = rx_byte_timeout(c->fd, 10000);
+
+            if (r == FY_YMODEM_ACK) return 0;
+            if (r == FY_YMODEM_NAK || r < 0) break;
+            if (r == FY_YMODEM_CAN) return -1;
+            //'C' after a header ACK etc. are ignored here
+        }
+    }
+    return -1;
+}
+
+static int wait_for(int fd, int want, int ms)
+{
+    for (;;) {
+        int r = rx_byte_timeout(fd, ms);
+
+        if (r < 0 || r == FY_YMODEM_CAN) return -1;
+        if (r == want) return 0;
+    }
+}
+
+static int sender_run(const sender_cfg_t *c, const char *name, const uint8_t *file, uint32_t size)
+{
+    uint8_t block[1024];
+    uint32_t off = 0;
+    uint8_t blk = 1;
+    int n_blocks = 0;
+
+    if (wait_for(c->fd, FY_YMODEM_CRC, 5000) != 0) return 1;
+    if (!c->xmodem) {
+        memset(block, 0, 128);
+        int n = snprintf((char *)block, 128, "%s", name);
+        snprintf((char *)block + n + 1, 128 - (size_t)n - 1, "%u 0 0", size);
+        if (send_until_ack(c, 0, block, 128, 0) != 0) return 2;
+        if (wait_for(c->fd, FY_YMODEM_CRC, 5000) != 0) return 3;
+    }
+    while (off < size) {
+        uint32_t rest = size - off;
+        uint32_t len = (rest <= 128) ? 128 : 1024;
+        uint32_t n = (rest < len) ? rest : len;
+
+        memcpy(block, &file[off], n);
+        memset(&block[n], 0x1A, len - n);
+        n_blocks++;
+        if (send_until_ack(c, blk, block, len, c->corrupt_every && n_blocks % c->corrupt_every == 0) != 0) return 4;
+        if (c->swallow_ack_blk == blk) {
+            //the receiver's ACK "was lost": send the same block again, it must be ACKed as a duplicate
+            if (send_until_ack(c, blk, block, len, 0) != 0) return 5;
+        }
+        off += n;
+        blk++;
+    }
+    uint8_t eot = FY_YMODEM_EOT;
+    if (write(c->fd, &eot, 1) != 1) return 6;
+    if (!c->xmodem) {
+        if (wait_for(c->fd, FY_YMODEM_NAK, 5000) != 0) return 7;
+        if (write(c->fd, &eot, 1) != 1) return 6;
+    }
+    if (wait_for(c->fd, FY_YMODEM_ACK, 10000) != 0) return 8;
+    if (!c->xmodem) {
+        if (wait_for(c->fd, FY_YMODEM_CRC, 5000) != 0) return 9;
+        memset(block, 0, 128);
+        if (send_until_ack(c, 0, block, 128, 0) != 0) return 10;
+    }
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------
+ * Receiver loop (parent, pty master)
+ */
+static int open_pty(int *master, char *slave_path, size_t path_len)
+{
+    struct termios tio;
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) {
+        perror("posix_openpt");
+        return -1;
+    }
+    snprintf(slave_path, path_len, "%s", ptsname(fd));
+    //raw mode on the line discipline (set through the master, applies to the slave side)
+    tcgetattr(fd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(fd, TCSANOW, &tio);
+    *master = fd;
+    return 0;
+}
+
+static fy_ymodem_state_t receive(fy_ymodem_t *ym, sink_t *s, uint32_t timeout_ms)
+{
+    uint8_t rx[256];
+    size_t rx_len = 0, rx_pos = 0;
+    uint32_t start = now_ms();
+
+    fy_ymodem_init(ym, &sink_ops, s);
+    fy_ymodem_start(ym, now_ms());
+    for (;;) {
+        struct pollfd pfd = {s->fd, POLLIN, 0};
+        fy_ymodem_state_t st;
+
+        sink_poll(s);
+        if (rx_pos == rx_len && poll(&pfd, 1, 2) > 0 && (pfd.revents & POLLIN)) {
+            ssize_t n = read(s->fd, rx, sizeof(rx));
+
+            rx_len = (n > 0) ? (size_t)n : 0;
+            rx_pos = 0;
+        }
+        if (rx_pos < rx_len) {
+            rx_pos += fy_ymodem_input(ym, &rx[rx_pos], rx_len - rx_pos, now_ms());
+        }
+        st = fy_ymodem_poll(ym, now_ms());
+        if (st == FY_YMODEM_DONE || st == FY_YMODEM_ABORTED) return st;
+        if (timeout_ms && now_ms() - start > timeout_ms) {
+            fy_ymodem_abort(ym);
+            return FY_YMODEM_ABORTED;
+        }
+    }
+}
+
+static uint32_t failures;
+
+static void scenario(const char *title, const sender_cfg_t *cfg_in, uint32_t size, uint32_t page_ms,
+                     int expect_ok, int verbose)
+{
+    static sink_t sink;
+    fy_ymodem_t ym;
+    sender_cfg_t cfg = *cfg_in;
+    char slave_path[128];
+    uint8_t *file = malloc(size);
+    int master, status = 0;
+    pid_t pid;
+    uint32_t t0;
+
+    for (uint32_t i = 0; i < size; i++) file[i] = (uint8_t)(rand() >> 7);
+    if (open_pty(&master, slave_path, sizeof(slave_path)) != 0) exit(2);
+    pid = fork();
+    if (pid == 0) {
+        cfg.fd = open(slave_path, O_RDWR | O_NOCTTY);
+        if (cfg.fd < 0) _exit(20);
+        _exit(sender_run(&cfg, "app.bin", file, size));
+    }
+
+    memset(&sink, 0, sizeof(sink));
+    memset(sink.flash, 0xFF, sizeof(sink.flash));
+    sink.fd = master;
+    sink.page_ms = page_ms;
+    sink.verbose = verbose;
+    t0 = now_ms();
+    fy_ymodem_state_t st = receive(&ym, &sink, 60000);
+    uint32_t ms = now_ms() - t0;
+    waitpid(pid, &status, 0);
+    close(master);
+
+    int data_ok = (sink.pos == size || (cfg.xmodem && sink.pos >= size)) &&
+                  memcmp(sink.flash, file, size) == 0;
+    if (cfg.xmodem) {
+        //XMODEM has no length: the padding of the last block is kept
+        for (uint32_t i = size; i < sink.pos; i++) data_ok &= (sink.flash[i] == 0x1A);
+    } else {
+        for (uint32_t i = size; i < APP_SIZE; i++) data_ok &= (sink.flash[i] == 0xFF);
+    }
+    int ok = expect_ok ? (st == FY_YMODEM_DONE && data_ok && sink.closed == 1 && WIFEXITED(status) &&
+                          WEXITSTATUS(status) == 0)
+                       : (st == FY_YMODEM_ABORTED && sink.closed == 0);
+    printf("%-11s %6u bytes  %5u ms  %s  blocks %u naks %u dup %u busy %u pages %u  sender %d  %s\n",
+           title, size, ms, (st == FY_YMODEM_DONE) ? "done   " : fy_ymodem_error_str(ym.error),
+           ym.blocks, ym.naks, ym.duplicates, sink.busy, sink.pages_done,
+           WIFEXITED(status) ? WEXITSTATUS(status) : -1, ok ? "ok" : "FAIL");
+    if (!ok) failures++;
+    free(file);
+}
+
+static int run_external(const char *out_path, uint32_t page_ms)
+{
+    static sink_t sink;
+    fy_ymodem_t ym;
+    char slave_path[128];
+    int master;
+
+    if (open_pty(&master, slave_path, sizeof(slave_path)) != 0) return 2;
+    memset(&sink, 0, sizeof(sink));
+    memset(sink.flash, 0xFF, sizeof(sink.flash));
+    sink.fd = master;
+    sink.page_ms = page_ms;
+    sink.verbose = 1;
+    printf("receiver on %s, e.g.: sz --ymodem -k app.bin < %s > %s\n", slave_path, slave_path, slave_path);
+    fflush(stdout);
+    fy_ymodem_state_t st = receive(&ym, &sink, 0);
+    printf("%s: \"%s\" %u bytes, blocks %u naks %u dup %u busy %u\n",
+           (st == FY_YMODEM_DONE) ? "done" : fy_ymodem_error_str(ym.error),
+           sink.name, sink.pos, ym.blocks, ym.naks, ym.duplicates, sink.busy);
+    if (out_path != NULL && st == FY_YMODEM_DONE) {
+        FILE *f = fopen(out_path, "wb");
+
+        if (f == NULL || fwrite(sink.flash, 1, sink.pos, f) != sink.pos) {
+            perror(out_path);
+            return 1;
+        }
+        fclose(f);
+    }
+    close(master);
+    return (st == FY_YMODEM_DONE) ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t page_ms = 20, size = 45001;
+    const char *out_path = NULL;
+    int external = 0, verbose = 0, opt;
+
+    while ((opt = getopt(argc, argv, "d:s:po:v")) != -1) {
+        switch (opt) {
+        case 'd': page_ms = (uint32_t)atoi(optarg); break;
+        case 's': size = (uint32_t)atoi(optarg); break;
+        case 'p': external = 1; break;
+        case 'o': out_path = optarg; break;
+        case 'v': verbose = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-d page_ms] [-s size] [-v] | -p [-o out.bin]\n", argv[0]);
+            return 2;
+        }
+    }
+    signal(SIGPIPE, SIG_IGN);
+    if (external) return run_external(out_path, page_ms);
+
+    //CRC16-CCITT(XMODEM) check value
+    if (fy_ymodem_crc16(0, (const uint8_t *)"123456789", 9) != 0x31C3) {
+        printf("crc16: FAIL\n");
+        failures++;
+    }
+    srand(1);
+    sender_cfg_t plain = {0}, err = {0}, xm = {0};
+    err.corrupt_every = 7;
+    err.swallow_ack_blk = 3;
+    xm.xmodem = 1;
+    if (size > APP_SIZE) size = APP_SIZE;
+    scenario("ymodem", &plain, size, page_ms, 1, verbose);
+    scenario("ymodem-err", &err, size, page_ms, 1, verbose);
+    scenario("xmodem", &xm, size - size % 128 + 100, page_ms, 1, verbose);
+    scenario("ymodem", &plain, 100, page_ms, 1, verbose);
+    scenario("too-big", &plain, APP_SIZE + 1, page_ms, 0, verbose);
+    printf("%s\n", failures ? "FAIL" : "PASS");
+    return failures ? 1 : 0;
+}
@@ -6,7 +6,25 @@
 #include "elog.h"
 #include "gpio.h"
 #include "i2c.h"
-#include "MPU6050_Reg.h"
+#include "tim.h"
+#include "fy_mpu6050.h"
+#include "fy_imu_dsp.h"
+#include "fy_encoder.h"
+#ifdef FY_BENCH
+#include "fy_bench.h"
+#endif
+#ifdef FY_PROF
+#include "fy_prof.h"
+#endif
+#ifdef FY_TRACE
+#include "fy_trace.h"
+#endif
+#ifdef FY_USE_RTOS
+#include "fy_rtos.h"
+#include "FreeRTOSConfig.h"
+#else
+#include "fy_sched.h"
+#endif
 
 //UART1相关定义
 uint8_t uart1_rx_buffer[256];
@@ -15,17 +33,62 @@ ringBuffer_t uart1_rx_rb;
 ringBuffer_t uart1_tx_rb;
 fy_uart_t uart1;
 
-//外部中断相关定义(旋转编码器)
-uint16_t enCoder_count = 0;
+//旋转编码器相关定义(默认TIM4编码器接口，定义FY_ENCODER_EXTI时用PB0/PB1外部中断)
+fy_encoder_t encoder;
+int32_t encoder_reported;
+uint32_t encoder_report_tick;
 
 //定时器2相关定义
 uint16_t timer2_overflow_count = 0;
 
+#ifdef FY_USE_RTOS
+//RTOS线程相关定义，线程标志在各线程内独立编号
+#define FLAG_IMU_DATA       (1UL << 0)  //sensor: FIFO批量读取完成
+#define FLAG_UART_RX        (1UL << 0)  //uart: 串口收到数据
+#define FLAG_ENCODER        (1UL << 0)  //report: 编码器计数变化
+#define FLAG_STATS_DUMP     (1UL << 1)  //report: 立即输出线程统计
+#define FLAG_PROF_DUMP      (1UL << 2)  //report: 输出采样剖析结果
+#define FLAG_LOG            (1UL << 0)  //log: 有异步日志待输出
+
+osThreadId_t sensor_thread_id;
+osThreadId_t uart_thread_id;
+osThreadId_t report_thread_id;
+osThreadId_t log_thread_id;
+#ifdef FY_TRACE
+osThreadId_t trace_thread_id;
+#endif
+
+//日志输出与串口发送缓冲区写入在多个线程中进行，用互斥量保护；发送缓冲区的读取在DMA中断中，不加锁
+FY_RTOS_LOCK_DEFINE(logger);
+FY_RTOS_LOCK_DEFINE(uart1_tx);
+#else
+//调度器相关定义，事件位在各任务内独立编号
+#define EVT_IMU_DATA        (1UL << 0)  //FIFO批量读取完成
+#define EVT_UART_RX         (1UL << 0)  //串口收到数据
+#define EVT_STATS_DUMP      (1UL << 0)  //立即输出调度统计
+#define EVT_PROF_DUMP       (1UL << 1)  //输出采样剖析结果
+#define EVT_LOG             (1UL << 0)  //有异步日志待输出
+
+fy_sched_t sched;
+fy_task_t imu_task;
+fy_task_t uart_rx_task;
+fy_task_t encoder_task;
+fy_task_t report_task;
+fy_task_t stats_task;
+fy_task_t log_task;
+#ifdef FY_TRACE
+fy_task_t trace_task;
+#endif
+#endif
+
 void uart1_init(void)
 {
     ringBuffer_init(&uart1_rx_rb, uart1_rx_buffer, sizeof(uart1_rx_buffer));
     ringBuffer_init(&uart1_tx_rb, uart1_tx_buffer, sizeof(uart1_tx_buffer));
-    fy_uart_init(&uart1, &huart1, &uart1_rx_rb, &uart1_tx_rb);
+    fy_uart_init_ex(&uart1, &huart1, &uart1_rx_rb, &uart1_tx_rb, FY_UART_RX_DMA_IDLE);
+#ifdef FY_USE_RTOS
+    ringBuffer_registerLocks(&uart1_tx_rb, NULL, NULL, uart1_tx_lock, uart1_tx_unlock);
+#endif
 }
 
 //注册给easy logger使用的输出函数
@@ -38,8 +101,13 @@ void easy_logger_init(void)
 {
     easy_logger_int_struct_t elog_init_struct = {0};
     elog_init_struct.output = easy_logger_out; // 使用默认输出函数
+#ifdef FY_USE_RTOS
+    elog_init_struct.output_lock = logger_lock; // RTOS互斥量
+    elog_init_struct.output_unlock = logger_unlock;
+#else
     elog_init_struct.output_lock = NULL; // 使用默认锁定函数
     elog_init_struct.output_unlock = NULL; // 使用默认解锁函数
+#endif
     elog_init_struct.get_time = NULL; // 使用默认时间获取函数
     elog_init_struct.get_p_info = NULL; // 使用默认进程信息获取函数
     elog_init_struct.get_t_info = NULL; // 使用默认线程信息获取函数
@@ -60,6 +128,78 @@ void easy_logger_init(void)
     elog_start();
 }
 
+#if defined(FY_BENCH) || defined(FY_PROF)
+//微基准与剖析结果行不经过日志，写满发送缓冲区时等待DMA取走
+static void uart1_out_blocking(const char *line, size_t len)
+{
+    while (len > 0)
+    {
+        uint16_t n = uart1.uartTx(&uart1, (const uint8_t *)line, len);
+        line += n;
+        len -= n;
+    }
+}
+#endif
+
+#ifdef FY_BENCH
+//微基准相关定义，启动时运行一次，结果由Tools/fy_bench.py收集
+fy_bench_t bench;
+
+static void bench_wait_idle(fy_uart_t *uart)
+{
+    while (uart->tx_busy || uart->tx_q_count != 0)
+    {
+    }
+}
+
+/* 编码器A相引脚的外部中断回调：EXTI模式下为一次正交解码，TIM模式下只有引脚判断 */
+static void gpio_exti_cb_run(void *arg)
+{
+    (void)arg;
+    HAL_GPIO_EXTI_Callback(GPIO_PIN_0);
+}
+
+static fy_bench_case_t case_gpio_exti_cb;
+
+void bench_run(void)
+{
+    if (fy_bench_init(&bench, NULL, uart1_out_blocking) != 0 || fy_bench_cases_add(&bench, &uart1, bench_wait_idle) != 0)
+    {
+        elog_e("BENCH", "bench init failed");
+        return;
+    }
+    //读取GPIO IDR，只在固件中运行
+    fy_bench_add(&bench, &case_gpio_exti_cb, "gpio_exti_cb", NULL, gpio_exti_cb_run, NULL);
+    fy_bench_run_all(&bench);
+    elog_async_flush();
+    bench_wait_idle(&uart1);
+}
+#endif
+
+#ifdef FY_PROF
+//采样剖析相关定义，启动后一直采样，串口收到'P'时输出并清零，结果由Tools/fy_prof.py符号化
+fy_prof_t prof;
+
+void prof_init(void)
+{
+    if (fy_prof_init(&prof, NULL) != 0 || fy_prof_start(&prof) != 0)
+    {
+        elog_e("PROF", "prof init failed");
+    }
+}
+
+static void prof_dump(void)
+{
+#ifdef FY_USE_RTOS
+    //持有日志锁，日志行不插入结果中间
+    logger_lock();
+    fy_prof_dump(&prof, uart1_out_blocking);
+    logger_unlock();
+#else
+    fy_prof_dump(&prof, uart1_out_blocking);
+#endif
+}
+#endif
 
 //外部中断回调函数
 void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
@@ -69,86 +209,578 @@ void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
   /* NOTE: This function Should not be modified, when the callback is needed,
            the HAL_GPIO_EXTI_Callback could be implemented in the user file
    */
-    if (GPIO_Pin == GPIO_PIN_0) // 假设使用 GPIO_PIN_0 作为外部中断引脚
+    //EXTI模式下只在中断中计数，计数与测速由周期性的fy_encoder_update完成
+    fy_encoder_exti_irq(&encoder, GPIO_Pin);
+}
+
+void encoder_init(void)
+{
+#ifdef FY_ENCODER_EXTI
+    fy_encoder_init_exti(&encoder, GPIOB, GPIO_PIN_0, GPIOB, GPIO_PIN_1);
+#else
+    if (fy_encoder_init_tim(&encoder, &htim4) != 0)
+    {
+        elog_e("ENCODER", "TIM4 encoder start failed");
+    }
+#endif
+}
+
+//MPU6050相关定义(FIFO流模式，1kHz采样)
+fy_mpu6050_t mpu6050;
+uint8_t mpu6050_sample_buffer[1024];
+ringBuffer_t mpu6050_sample_rb;
+fy_mpu6050_record_t mpu6050_records[FY_IMU_DSP_BLOCK_MAX];
+fy_mpu6050_record_t mpu6050_last;
+fy_imu_dsp_t imu_dsp;
+uint32_t imu_overflow_seen;
+
+//FIFO读取结束(I2C中断)，唤醒imu任务
+static void mpu6050_done(fy_mpu6050_t *mpu, int32_t status, void *arg)
+{
+#ifdef FY_USE_RTOS
+    osThreadFlagsSet(sensor_thread_id, FLAG_IMU_DATA);
+#else
+    fy_sched_post(&imu_task, EVT_IMU_DATA);
+#endif
+}
+
+//串口收到数据(UART/DMA中断)
+static void uart1_rx_notify(fy_uart_t *uart, void *arg)
+{
+#ifdef FY_USE_RTOS
+    osThreadFlagsSet(uart_thread_id, FLAG_UART_RX);
+#else
+    fy_sched_post(&uart_rx_task, EVT_UART_RX);
+#endif
+}
+
+//异步日志入队后调用，唤醒日志任务
+void elog_async_output_notice(void)
+{
+#ifdef FY_USE_RTOS
+    osThreadFlagsSet(log_thread_id, FLAG_LOG);
+#else
+    fy_sched_post(&log_task, EVT_LOG);
+#endif
+}
+
+void mpu6050_init(void)
+{
+    if (fy_mpu6050_init(&mpu6050, &hi2c2, MPU6050_ADDRESS, mpu6050_done, NULL) != 0)
+    {
+        elog_e("MPU6050", "MPU6050 init failed, ID: 0x%02X", mpu6050.id);
+        return;
+    }
+    fy_imu_dsp_config_t cfg;
+    fy_imu_dsp_default_config(&cfg, 1000.0f);
+    fy_imu_dsp_init(&imu_dsp, &cfg);
+    ringBuffer_init_spsc(&mpu6050_sample_rb, mpu6050_sample_buffer, sizeof(mpu6050_sample_buffer));
+    fy_mpu6050_fifo_start(&mpu6050, &mpu6050_sample_rb, 0);
+}
+
+//按块处理FIFO中取出的样本，FIFO复位过(数据不连续)时先清除滤波器状态
+void mpu6050_process(fy_mpu6050_record_t *rec, size_t n)
+{
+    if (mpu6050.fifo_overflow_count != imu_overflow_seen)
     {
-        // 在这里处理外部中断事件
-        if(HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_1))
+        imu_overflow_seen = mpu6050.fifo_overflow_count;
+        fy_imu_dsp_reset(&imu_dsp);
+    }
+    fy_imu_dsp_process(&imu_dsp, &rec[0].sample.acc_x, sizeof(rec[0]) / sizeof(int16_t), n);
+    mpu6050_last = rec[n - 1];
+}
+
+//取出已读到的样本并处理
+static void mpu6050_drain(void)
+{
+    size_t n;
+
+    while ((n = fy_mpu6050_fifo_read(&mpu6050, mpu6050_records, FY_IMU_DSP_BLOCK_MAX)) > 0)
+    {
+        mpu6050_process(mpu6050_records, n);
+    }
+}
+
+#ifdef FY_TRACE
+//事件跟踪相关定义，最低优先级任务每10ms把记录写入串口发送缓冲区的剩余空间，由Tools/fy_trace.py转换
+fy_trace_t trace;
+
+static void trace_out(const char *line, size_t len)
+{
+    uart1.uartTx(&uart1, (const uint8_t *)line, len);
+}
+
+static void trace_flush(void)
+{
+#ifdef FY_USE_RTOS
+    //持有日志锁，日志行不插入跟踪行中间
+    logger_lock();
+    fy_trace_flush(&trace, trace_out, uart1_tx_rb.size - uart1_tx_rb.used(&uart1_tx_rb));
+    logger_unlock();
+#else
+    fy_trace_flush(&trace, trace_out, uart1_tx_rb.size - uart1_tx_rb.used(&uart1_tx_rb));
+#endif
+}
+#endif
+
+//读取串口数据，返回收到的命令：回车输出统计，'P'输出采样剖析结果，'T'重新输出跟踪头部与名称
+#define RX_CMD_STATS        (1UL << 0)
+#define RX_CMD_PROF         (1UL << 1)
+#define RX_CMD_TRACE        (1UL << 2)
+
+#ifdef FY_EMU
+//仿真器场景(Tools/fy_emu.py)：回显串口收到的字节，收到'F'时由日志任务连续输出EMU_FLOOD_LINES行日志
+#define EMU_FLOOD_LINES     200
+volatile uint8_t emu_flood_request;
+
+//在日志任务中运行(唯一的elog_async_flush调用者)，等发送缓冲区放得下一整行再写，日志不截断
+static void emu_flood(void)
+{
+    uint32_t start = HAL_GetTick();
+    uint32_t bytes = uart1.tx_bytes;
+    uint32_t i;
+
+    emu_flood_request = 0;
+    for (i = 0; i < EMU_FLOOD_LINES; i++)
+    {
+        while (uart1_tx_rb.size - uart1_tx_rb.used(&uart1_tx_rb) < ELOG_LINE_BUF_SIZE)
+        {
+        }
+        elog_i("EMU", "flood %lu tick %lu", i, HAL_GetTick());
+        elog_async_flush();
+    }
+    while (uart1.tx_busy || uart1.tx_q_count != 0)
+    {
+    }
+    elog_i("EMU", "flood lines:%lu bytes:%lu ms:%lu", (uint32_t)EMU_FLOOD_LINES, uart1.tx_bytes - bytes,
+           HAL_GetTick() - start);
+}
+#endif
+
+static uint32_t uart1_rx_poll(void)
+{
+    uint8_t buf[32];
+    uint16_t n, i;
+    uint32_t cmd = 0;
+
+    while ((n = uart1.uartRx(&uart1, buf, sizeof(buf))) > 0)
+    {
+#ifdef FY_EMU
+        uart1.uartTx(&uart1, buf, n);
+        if (memchr(buf, 'F', n) != NULL)
         {
-            if (enCoder_count < 65535)
+            emu_flood_request = 1;
+            elog_async_output_notice();
+        }
+#endif
+        for (i = 0; i < n; i++)
+        {
+            if (buf[i] == '\r' || buf[i] == '\n')
+            {
+                cmd |= RX_CMD_STATS;
+            }
+#ifdef FY_PROF
+            if (buf[i] == 'P')
+            {
+                cmd |= RX_CMD_PROF;
+            }
+#endif
+#ifdef FY_TRACE
+            if (buf[i] == 'T')
             {
-                enCoder_count++;
+                cmd |= RX_CMD_TRACE;
             }
+#endif
         }
     }
-    if (GPIO_Pin == GPIO_PIN_1)
+    return cmd;
+}
+
+//每10ms调用，计数变化时返回1(最多每100ms一次)，请求输出计数
+static int32_t encoder_poll(void)
+{
+    int32_t count = fy_encoder_update(&encoder);
+
+    return (count != encoder_reported && HAL_GetTick() - encoder_report_tick >= 100) ? 1 : 0;
+}
+
+static void encoder_report(void)
+{
+    encoder_reported = fy_encoder_get_count(&encoder);
+    encoder_report_tick = HAL_GetTick();
+    elog_i("ENCODER", "count:%ld, speed:%ld/s", encoder_reported, fy_encoder_get_velocity(&encoder));
+#ifdef FY_ENCODER_EXTI
+    elog_i("ENCODER", "irqs:%lu, glitch:%lu, illegal:%lu", encoder.exti_irqs, encoder.exti_glitch,
+           encoder.exti_illegal);
+#endif
+}
+
+static void mpu6050_report(void)
+{
+    elog_a("MPU6050","MPU6050 ID: 0x%02X,AccX:%d, AccY:%d, AccZ:%d,GyroX:%d,GyroY:%d,GyroZ:%d", mpu6050.id,
+           mpu6050_last.sample.acc_x, mpu6050_last.sample.acc_y, mpu6050_last.sample.acc_z,
+           mpu6050_last.sample.gyro_x, mpu6050_last.sample.gyro_y, mpu6050_last.sample.gyro_z);
+    elog_i("MPU6050","samples:%lu, dropped:%lu, overflow:%lu", mpu6050.fifo_samples,
+           mpu6050.fifo_dropped, mpu6050.fifo_overflow_count);
+    //newlib-nano默认不支持%f，按0.01度输出
+    elog_i("IMU","roll:%ld, pitch:%ld, yaw:%ld (0.01deg)", (long)(imu_dsp.attitude.roll * 100.0f),
+           (long)(imu_dsp.attitude.pitch * 100.0f), (long)(imu_dsp.attitude.yaw * 100.0f));
+}
+
+#ifdef FY_USE_RTOS
+/* 距离tick t的剩余tick数，已过时返回0 */
+static uint32_t ticks_until(uint32_t t)
+{
+    int32_t d = (int32_t)(t - osKernelGetTickCount());
+
+    return (d > 0) ? (uint32_t)d : 0U;
+}
+
+//每10ms发起一次FIFO排空并更新编码器，读取完成(I2C中断置标志)后处理样本
+static void sensor_thread(void *arg)
+{
+    uint32_t next = osKernelGetTickCount() + 10;
+
+    for (;;)
+    {
+        if (osThreadFlagsWait(FLAG_IMU_DATA, osFlagsWaitAny, ticks_until(next)) & osFlagsError)
+        {
+            next += 10;
+            fy_mpu6050_fifo_service(&mpu6050);
+            if (encoder_poll())
+            {
+                osThreadFlagsSet(report_thread_id, FLAG_ENCODER);
+            }
+        }
+        mpu6050_drain();
+    }
+}
+
+//串口收到回车('P')时通知report线程输出统计(采样剖析结果)
+static void uart_thread(void *arg)
+{
+    uint32_t cmd;
+
+    for (;;)
+    {
+        osThreadFlagsWait(FLAG_UART_RX, osFlagsWaitAny, osWaitForever);
+        cmd = uart1_rx_poll();
+        if (cmd & RX_CMD_STATS)
+        {
+            osThreadFlagsSet(report_thread_id, FLAG_STATS_DUMP);
+        }
+        if (cmd & RX_CMD_PROF)
+        {
+            osThreadFlagsSet(report_thread_id, FLAG_PROF_DUMP);
+        }
+#ifdef FY_TRACE
+        if (cmd & RX_CMD_TRACE)
+        {
+            fy_trace_announce(&trace);
+        }
+#endif
+    }
+}
+
+//每个线程的栈用量(历史最大)与CPU占用，以及整体CPU占用，统计间隔不超过59秒(DWT回绕)
+static void rtos_stats_dump(void)
+{
+    const fy_rtos_thread_t *t;
+    uint32_t i, load;
+
+    fy_rtos_stats_update();
+    for (i = 0; (t = fy_rtos_thread_info(i)) != NULL; i++)
+    {
+        elog_i("RTOS", "%s stack:%lu/%luB cpu:%lu.%lu%%", t->name, t->stack_size - t->stack_free_min,
+               t->stack_size, t->load_permille / 10, t->load_permille % 10);
+    }
+    load = fy_rtos_load_permille();
+    elog_i("RTOS", "load:%lu.%lu%%", load / 10, load % 10);
+}
+
+//每500ms输出IMU数据，每5秒(或串口收到回车时)输出线程统计，编码器变化时输出计数
+static void report_thread(void *arg)
+{
+    uint32_t next = osKernelGetTickCount() + 500;
+    uint32_t stats_next = osKernelGetTickCount() + 5000;
+    uint32_t flags;
+
+    for (;;)
     {
-        if(HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_0))
+        flags = osThreadFlagsWait(FLAG_ENCODER | FLAG_STATS_DUMP | FLAG_PROF_DUMP, osFlagsWaitAny,
+                                  ticks_until(next));
+        if (flags & osFlagsError)
         {
-            if (enCoder_count > 0)
+            flags = 0;
+            next += 500;
+            mpu6050_report();
+            if (ticks_until(stats_next) == 0)
             {
-                enCoder_count--;
+                stats_next += 5000;
+                flags = FLAG_STATS_DUMP;
             }
         }
+        if (flags & FLAG_ENCODER)
+        {
+            encoder_report();
+        }
+        if (flags & FLAG_STATS_DUMP)
+        {
+            rtos_stats_dump();
+        }
+#ifdef FY_PROF
+        if (flags & FLAG_PROF_DUMP)
+        {
+            prof_dump();
+        }
+#endif
     }
-    
-}
-
-//iic测试
-int16_t AccX,AccY,AccZ,GyroX,GyroY,GyroZ;
-uint8_t mpu_id;
-uint8_t mpu6050_addr = MPU6050_ADDRESS;
-void init_mpu6050()
-{
-    uint8_t tmp_reg_vlaue;
-    tmp_reg_vlaue = 0x01;
-    HAL_I2C_Mem_Write(&hi2c2, MPU6050_ADDRESS, MPU6050_PWR_MGMT_1,   I2C_MEMADD_SIZE_8BIT, &tmp_reg_vlaue, 1, 1000);
-    tmp_reg_vlaue = 0x00;  
-    HAL_I2C_Mem_Write(&hi2c2, MPU6050_ADDRESS, MPU6050_PWR_MGMT_2,   I2C_MEMADD_SIZE_8BIT, &tmp_reg_vlaue, 1, 1000);
-    tmp_reg_vlaue = 0x09;  
-    HAL_I2C_Mem_Write(&hi2c2, MPU6050_ADDRESS, MPU6050_SMPLRT_DIV,   I2C_MEMADD_SIZE_8BIT, &tmp_reg_vlaue, 1, 1000);
-    tmp_reg_vlaue = 0x06;  
-    HAL_I2C_Mem_Write(&hi2c2, MPU6050_ADDRESS, MPU6050_CONFIG,       I2C_MEMADD_SIZE_8BIT, &tmp_reg_vlaue, 1, 1000);
-    tmp_reg_vlaue = 0x18;
-    HAL_I2C_Mem_Write(&hi2c2, MPU6050_ADDRESS, MPU6050_GYRO_CONFIG,  I2C_MEMADD_SIZE_8BIT, &tmp_reg_vlaue, 1, 1000);
-    tmp_reg_vlaue = 0x18;
-    HAL_I2C_Mem_Write(&hi2c2, MPU6050_ADDRESS, MPU6050_ACCEL_CONFIG, I2C_MEMADD_SIZE_8BIT, &tmp_reg_vlaue, 1, 1000);
-}
-void test_iic_mpu6050()
-{
-    HAL_I2C_Mem_Read(&hi2c2, MPU6050_ADDRESS, MPU6050_WHO_AM_I, I2C_MEMADD_SIZE_8BIT, &mpu_id, 1, 1000);
-    HAL_I2C_Mem_Read(&hi2c2, MPU6050_ADDRESS, MPU6050_ACCEL_XOUT_H, I2C_MEMADD_SIZE_8BIT, (uint8_t*)&AccX, 2, 1000);
-    HAL_I2C_Mem_Read(&hi2c2, MPU6050_ADDRESS, MPU6050_ACCEL_YOUT_H, I2C_MEMADD_SIZE_8BIT, (uint8_t*)&AccY, 2, 1000);
-    HAL_I2C_Mem_Read(&hi2c2, MPU6050_ADDRESS, MPU6050_ACCEL_ZOUT_H, I2C_MEMADD_SIZE_8BIT, (uint8_t*)&AccZ, 2, 1000);
-    HAL_I2C_Mem_Read(&hi2c2, MPU6050_ADDRESS, MPU6050_GYRO_XOUT_H, I2C_MEMADD_SIZE_8BIT, (uint8_t*)&GyroX, 2, 1000);
-    HAL_I2C_Mem_Read(&hi2c2, MPU6050_ADDRESS, MPU6050_GYRO_YOUT_H, I2C_MEMADD_SIZE_8BIT, (uint8_t*)&GyroY, 2, 1000);
-    HAL_I2C_Mem_Read(&hi2c2, MPU6050_ADDRESS, MPU6050_GYRO_ZOUT_H, I2C_MEMADD_SIZE_8BIT, (uint8_t*)&GyroZ, 2, 1000);
-    //高低字节交换
-    AccX = (AccX >> 8) | (AccX << 8);
-    AccY = (AccY >> 8) | (AccY << 8);
-    AccZ = (AccZ >> 8) | (AccZ << 8);
-    GyroX = (GyroX >> 8) | (GyroX << 8);
-    GyroY = (GyroY >> 8) | (GyroY << 8);
-    GyroZ = (GyroZ >> 8) | (GyroZ << 8);
+}
+
+//异步日志在最低优先级线程中格式化并输出，启动前积累的日志先输出
+static void log_thread(void *arg)
+{
+    for (;;)
+    {
+        elog_async_flush();
+#ifdef FY_EMU
+        if (emu_flood_request)
+        {
+            emu_flood();
+        }
+#endif
+        osThreadFlagsWait(FLAG_LOG, osFlagsWaitAny, osWaitForever);
+    }
+}
+
+#ifdef FY_TRACE
+//跟踪记录与日志同为最低优先级，每10ms输出一次
+static void trace_thread(void *arg)
+{
+    for (;;)
+    {
+        trace_flush();
+        osDelay(10);
+    }
+}
+#endif
+
+//在中断中调用RTOS API(osThreadFlagsSet)的中断，优先级不能高于configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY
+static void rtos_irq_priority_init(void)
+{
+    HAL_NVIC_SetPriority(I2C2_EV_IRQn, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, 0);
+    HAL_NVIC_SetPriority(I2C2_ER_IRQn, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, 0);
+    HAL_NVIC_SetPriority(USART1_IRQn, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, 0);
+    HAL_NVIC_SetPriority(DMA1_Channel4_IRQn, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, 0);
+    HAL_NVIC_SetPriority(DMA1_Channel5_IRQn, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, 0);
+#ifdef FY_ENCODER_EXTI
+    //编码器每个边沿一次中断，低于串口/DMA/I2C
+    HAL_NVIC_SetPriority(EXTI0_IRQn, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1, 0);
+    HAL_NVIC_SetPriority(EXTI1_IRQn, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1, 0);
+#endif
 }
 
 void user_main(void)
 {
-    /* Example usage of fy_uart and ring buffer can be placed here */
-    uint32_t start_tick = HAL_GetTick();
+    //内核启动前为单线程，锁为空操作；中断中的通知在线程创建前丢弃，线程启动后会重新检查
+    fy_rtos_init();
+    FY_RTOS_LOCK_INIT(logger);
+    FY_RTOS_LOCK_INIT(uart1_tx);
+    rtos_irq_priority_init();
+#ifdef FY_TRACE
+    fy_trace_init(&trace, NULL);
+#endif
 
     //日志
     uart1_init();
+    fy_uart_set_rx_notify(&uart1, uart1_rx_notify, NULL);
     easy_logger_init();
-    init_mpu6050();
-    while (1)
+    //微基准中的外部中断回调用例需要编码器已初始化
+    encoder_init();
+#ifdef FY_BENCH
+    bench_run();
+#endif
+#ifdef FY_PROF
+    prof_init();
+#endif
+    mpu6050_init();
+
+    sensor_thread_id = fy_rtos_thread_new("sensor", sensor_thread, NULL, 768, osPriorityHigh);
+    uart_thread_id = fy_rtos_thread_new("uart", uart_thread, NULL, 384, osPriorityAboveNormal);
+    report_thread_id = fy_rtos_thread_new("report", report_thread, NULL, 640, osPriorityNormal);
+    log_thread_id = fy_rtos_thread_new("log", log_thread, NULL, 768, osPriorityLow);
+#ifdef FY_TRACE
+    trace_thread_id = fy_rtos_thread_new("trace", trace_thread, NULL, 384, osPriorityLow);
+#endif
+    osKernelStart();
+    //堆不足，线程创建失败
+    Error_Handler();
+}
+#else
+//INT引脚未接EXTI，定时发起FIFO排空(1kHz下每次约10帧)，读取完成后处理样本
+static void imu_task_fn(fy_task_t *task, uint32_t events)
+{
+    if (events & FY_SCHED_EVT_TIMER)
+    {
+        fy_mpu6050_fifo_service(&mpu6050);
+    }
+    mpu6050_drain();
+}
+
+//串口收到回车('P')时输出调度统计(采样剖析结果)
+static void uart_rx_task_fn(fy_task_t *task, uint32_t events)
+{
+    uint32_t cmd = uart1_rx_poll();
+
+    if (cmd & RX_CMD_STATS)
+    {
+        fy_sched_post(&stats_task, EVT_STATS_DUMP);
+    }
+    if (cmd & RX_CMD_PROF)
+    {
+        fy_sched_post(&stats_task, EVT_PROF_DUMP);
+    }
+#ifdef FY_TRACE
+    if (cmd & RX_CMD_TRACE)
+    {
+        fy_trace_announce(&trace);
+    }
+#endif
+}
+
+//每10ms读取编码器计数，变化时输出
+static void encoder_task_fn(fy_task_t *task, uint32_t events)
+{
+    if (encoder_poll())
     {
-        HAL_GetTick();
-        if (HAL_GetTick() - start_tick >= 500)
+        encoder_report();
+    }
+}
+
+static void report_task_fn(fy_task_t *task, uint32_t events)
+{
+    mpu6050_report();
+}
+
+//每个任务的运行次数、平均/最长运行时间、最大延迟(us)，定时器迟到(ms)与丢失周期，输出后清零
+static void stats_task_fn(fy_task_t *task, uint32_t events)
+{
+    uint32_t cycles_per_us = SystemCoreClock / 1000000U;
+    uint32_t load = fy_sched_load_permille(&sched);
+    fy_task_t *t;
+
+#ifdef FY_PROF
+    if (events & EVT_PROF_DUMP)
+    {
+        prof_dump();
+        if (events == EVT_PROF_DUMP)
         {
-            test_iic_mpu6050();
-            elog_a("MPU6050","MPU6050 ID: 0x%02X,AccX:%d, AccY:%d, AccZ:%d,GyroX:%d,GyroY:%d,GyroZ:%d", mpu_id, AccX, AccY, AccZ, GyroX, GyroY, GyroZ);
-            start_tick = HAL_GetTick();
+            return;
         }
     }
-    
-}
\ No newline at end of file
+#endif
+    for (t = sched.tasks; t != NULL; t = t->next)
+    {
+        elog_i("SCHED", "%s runs:%lu avg:%luus max:%luus lat:%luus late:%lums overrun:%lu", t->name, t->runs,
+               t->runs ? t->run_cycles / cycles_per_us / t->runs : 0UL, t->run_cycles_max / cycles_per_us,
+               t->latency_max / cycles_per_us, t->late_max, t->overruns);
+    }
+    elog_i("SCHED", "load:%lu.%lu%%, sleep:%lu", load / 10, load % 10, sched.idle_count);
+    fy_sched_stats_reset(&sched);
+}
+
+//异步日志在最低优先级任务中格式化并输出
+static void log_task_fn(fy_task_t *task, uint32_t events)
+{
+    elog_async_flush();
+#ifdef FY_EMU
+    if (emu_flood_request)
+    {
+        emu_flood();
+    }
+#endif
+}
+
+#ifdef FY_TRACE
+static void trace_task_fn(fy_task_t *task, uint32_t events)
+{
+    trace_flush();
+}
+
+//任务的运行区间；睡眠每个tick都被SysTick唤醒，不记录，跟踪任务自身也不记录
+static void trace_sched_hook(fy_task_t *task, uint32_t begin)
+{
+    int32_t id;
+
+    if (task == NULL || task == &trace_task)
+    {
+        return;
+    }
+    id = fy_trace_id(&trace, task->name);
+    if (id >= 0)
+    {
+        fy_trace_record(&trace, begin ? FY_TRACE_T_ENTER : FY_TRACE_T_EXIT, (uint8_t)id, 0);
+    }
+}
+#endif
+
+#ifdef FY_PROF
+//TIM3采样中断为优先级0，其他外设中断降为1才能被采样到(调度器模式下默认全为0)
+static void prof_irq_priority_init(void)
+{
+    HAL_NVIC_SetPriority(I2C2_EV_IRQn, 1, 0);
+    HAL_NVIC_SetPriority(I2C2_ER_IRQn, 1, 0);
+    HAL_NVIC_SetPriority(USART1_IRQn, 1, 0);
+    HAL_NVIC_SetPriority(DMA1_Channel4_IRQn, 1, 0);
+    HAL_NVIC_SetPriority(DMA1_Channel5_IRQn, 1, 0);
+#ifdef FY_ENCODER_EXTI
+    HAL_NVIC_SetPriority(EXTI0_IRQn, 2, 0);
+    HAL_NVIC_SetPriority(EXTI1_IRQn, 2, 0);
+#endif
+}
+#endif
+
+void user_main(void)
+{
+    //先注册任务，初始化过程中的中断与日志可以直接post
+    fy_sched_init(&sched, NULL);
+    fy_sched_task_add(&sched, &imu_task, "imu", 0, imu_task_fn, NULL);
+    fy_sched_task_add(&sched, &uart_rx_task, "uart_rx", 1, uart_rx_task_fn, NULL);
+    fy_sched_task_add(&sched, &encoder_task, "encoder", 1, encoder_task_fn, NULL);
+    fy_sched_task_add(&sched, &report_task, "report", 2, report_task_fn, NULL);
+    fy_sched_task_add(&sched, &stats_task, "stats", 2, stats_task_fn, NULL);
+    fy_sched_task_add(&sched, &log_task, "log", 3, log_task_fn, NULL);
+#ifdef FY_TRACE
+    fy_sched_task_add(&sched, &trace_task, "trace", 3, trace_task_fn, NULL);
+    fy_trace_init(&trace, NULL);
+    fy_sched_set_hook(&sched, trace_sched_hook);
+#endif
+#ifdef FY_PROF
+    prof_irq_priority_init();
+#endif
+
+    //日志
+    uart1_init();
+    fy_uart_set_rx_notify(&uart1, uart1_rx_notify, NULL);
+    easy_logger_init();
+    //微基准中的外部中断回调用例需要编码器已初始化
+    encoder_init();
+#ifdef FY_BENCH
+    bench_run();
+#endif
+#ifdef FY_PROF
+    prof_init();
+#endif
+    mpu6050_init();
+
+    fy_sched_timer_start(&imu_task, 10, 10);
+    fy_sched_timer_start(&encoder_task, 10, 10);
+    fy_sched_timer_start(&report_task, 500, 500);
+    //cycles计数约59秒回绕，统计周期要短于此
+    fy_sched_timer_start(&stats_task, 5000, 5000);
+#ifdef FY_TRACE
+    fy_sched_timer_start(&trace_task, 10, 10);
+#endif
+    fy_sched_run(&sched);
+}
+#endif
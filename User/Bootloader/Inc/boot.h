@@ -0,0 +1,44 @@
+/*
+说明
+    串口(USART1，115200)YMODEM Bootloader，单独的固件镜像，位于Flash起始的16K，应用程序链接在其后。
+    上电后：时钟/看门狗/串口初始化 -> 检查App(SP、复位向量、CRC尾部，见fy_crc.h) -> 等待BOOT_WAIT_MS，期间收到任意字节则留在Bootloader，
+    否则关闭外设与中断后跳转到App；App无效时直接进入Bootloader主循环。
+    主循环中每秒发送'C'等待YMODEM(或XMODEM-1K/CRC)发送方，收到的数据按页流式写入App区(见boot_flash.h)，
+    传输完成并校验通过后跳转到App。传输开始前可输入命令：'j'跳转到App，'i'显示信息。
+
+Flash布局(与STM32F103XX_BOOT.ld/STM32F103XX_APP.ld保持一致):
+    0x08000000  16K  Bootloader
+    0x08004000  48K  App(CMake选项FY_BOOTLOADER=ON时链接到此处，App启动时把SCB->VTOR指向自己的向量表)
+
+看门狗:
+    BOOT_IWDG_ENABLE为1时启用独立看门狗(约2s)，Bootloader主循环中喂狗；IWDG一旦启动无法关闭，
+    App必须继续喂狗，因此默认不启用。
+*/
+#ifndef __BOOT_H
+#define __BOOT_H
+
+#include "main.h"
+
+#define BOOT_VERSION        "1.0"
+
+#define BOOT_FLASH_BASE     0x08000000UL
+#define BOOT_SIZE           0x4000UL                        //16K
+#define BOOT_APP_ADDR       (BOOT_FLASH_BASE + BOOT_SIZE)
+#define BOOT_APP_SIZE       (0x10000UL - BOOT_SIZE)         //48K
+#define BOOT_RAM_BASE       0x20000000UL
+#define BOOT_RAM_SIZE       0x5000UL                        //20K
+
+#ifndef BOOT_WAIT_MS
+#define BOOT_WAIT_MS        3000    //跳转前等待按键的时间
+#endif
+#ifndef BOOT_IWDG_ENABLE
+#define BOOT_IWDG_ENABLE    0
+#endif
+#ifndef BOOT_REQUIRE_FOOTER
+#define BOOT_REQUIRE_FOOTER 0       //1: 没有CRC尾部的App(调试器烧录的ELF)也视为无效
+#endif
+#ifndef BOOT_RX_BUF_SIZE
+#define BOOT_RX_BUF_SIZE    2048    //串口DMA接收缓冲，需容纳擦写一页期间(约50ms)收到的数据
+#endif
+
+#endif
@@ -0,0 +1,43 @@
+/*
+说明
+    Bootloader的App区流式写入，基于流水线Flash写入(User/Drivers/Flash/fy_flash)：
+    boot_flash_write把数据拷入fy_flash的暂存缓冲后返回，擦除与编程在Flash中断中一个接一个进行，
+    页在数据到来之前提前擦除，每页编程后读回CRC校验。暂存缓冲满时返回1(忙)，YMODEM引擎推迟ACK。
+    擦写期间CPU从Flash取指会暂停，但USART1的循环DMA仍把数据写入RAM，因此编程与下一块的接收重叠。
+
+    App的第一页(向量表)在open时先擦除，收到的数据暂存在RAM中，其余页全部写完并校验后最后写入：
+    传输中断时App的SP/复位向量为空白，不会被当作有效App跳转。
+
+使用方法：
+    boot_flash_open(BOOT_APP_ADDR, BOOT_APP_SIZE);
+    boot_flash_write(offset, data, len);   //返回0接受，1忙，-1错误
+    主循环: boot_flash_poll();
+    boot_flash_finish();                   //返回1时继续调用boot_flash_poll直到返回0(完成)或-1
+*/
+#ifndef __BOOT_FLASH_H
+#define __BOOT_FLASH_H
+
+#include "boot.h"
+
+#define BOOT_FLASH_PAGE_SIZE    FLASH_PAGE_SIZE
+
+typedef struct {
+    uint32_t bytes;//已写入(含暂存)的字节数
+    uint32_t pages;//已编程并校验的页数
+    uint32_t busy;//暂存缓冲满的次数
+    uint32_t flash_bps;//除向量表外各页的平均编程速率(字节/秒)
+    uint32_t errors;//擦除/编程/校验失败
+    uint32_t start_tick;//open时刻
+    uint32_t end_tick;//finish完成时刻
+} boot_flash_stats_t;
+
+extern boot_flash_stats_t boot_flash_stats;
+
+int32_t boot_flash_open(uint32_t base, uint32_t size);
+int32_t boot_flash_write(uint32_t offset, const uint8_t *data, uint32_t len);
+void boot_flash_poll(void);
+int32_t boot_flash_finish(void);
+/* 丢弃未写入的数据(包括暂存的第一页，App保持无效) */
+void boot_flash_abort(void);
+
+#endif
@@ -0,0 +1,137 @@
+#include "boot_flash.h"
+#include "fy_flash.h"
+#include <string.h>
+
+boot_flash_stats_t boot_flash_stats;
+
+static fy_flash_t writer;
+static uint32_t flash_base;
+static uint32_t flash_end;
+static uint32_t write_pos;//下一个字节的Flash地址
+static int32_t flash_status;//0正常，-1出错
+static uint8_t vector_phase;//1: 正在写第一页
+static uint8_t first_page[BOOT_FLASH_PAGE_SIZE];//暂存的第一页(向量表)
+static uint16_t first_len;//0表示尚未收到
+
+/* 等上一次(出错或中止的)写入停下来，控制器空闲并已加锁 */
+static void writer_stop(void)
+{
+    while (writer.active) {
+        fy_flash_abort(&writer);
+    }
+}
+
+int32_t boot_flash_open(uint32_t base, uint32_t size)
+{
+    FLASH_EraseInitTypeDef erase = {0};
+    uint32_t page_error = 0;
+
+    writer_stop();
+    flash_base = base;
+    flash_end = base + size;
+    write_pos = base;
+    flash_status = 0;
+    vector_phase = 0;
+    first_len = 0;
+    memset(&boot_flash_stats, 0, sizeof(boot_flash_stats));
+    boot_flash_stats.start_tick = HAL_GetTick();
+
+    //先擦除向量表页，传输中断时旧App不再被当作有效
+    erase.TypeErase = FLASH_TYPEERASE_PAGES;
+    erase.PageAddress = base;
+    erase.NbPages = 1;
+    HAL_FLASH_Unlock();
+    if (HAL_FLASHEx_Erase(&erase, &page_error) != HAL_OK || page_error != 0xFFFFFFFFU) {
+        flash_status = -1;
+    }
+    HAL_FLASH_Lock();
+    if (flash_status == 0 && fy_flash_open(&writer, NULL, base + BOOT_FLASH_PAGE_SIZE,
+                                           size - BOOT_FLASH_PAGE_SIZE) != 0) {
+        flash_status = -1;
+    }
+    if (flash_status < 0) {
+        boot_flash_stats.errors++;
+    }
+    return flash_status;
+}
+
+int32_t boot_flash_write(uint32_t offset, const uint8_t *data, uint32_t len)
+{
+    uint32_t head = 0;
+    int32_t ret;
+
+    if (flash_status < 0 || vector_phase || flash_base + offset != write_pos || len > flash_end - write_pos) {
+        return -1;
+    }
+    //第一页留在RAM中，其余交给流水线写入；流水线忙时整块都不接受
+    if (write_pos < flash_base + BOOT_FLASH_PAGE_SIZE) {
+        head = flash_base + BOOT_FLASH_PAGE_SIZE - write_pos;
+        if (head > len) head = len;
+    }
+    if (len > head) {
+        ret = fy_flash_write(&writer, data + head, len - head);
+        if (ret != 0) {
+            if (ret > 0) {
+                boot_flash_stats.busy++;
+            } else {
+                flash_status = -1;
+                boot_flash_stats.errors++;
+            }
+            return ret;
+        }
+    }
+    memcpy(&first_page[write_pos - flash_base], data, head);
+    first_len = (uint16_t)(first_len + head);
+    write_pos += len;
+    boot_flash_stats.bytes += len;
+    return 0;
+}
+
+void boot_flash_poll(void)
+{
+    fy_flash_poll(&writer);
+}
+
+int32_t boot_flash_finish(void)
+{
+    int32_t ret;
+
+    if (flash_status < 0) {
+        return -1;
+    }
+    ret = fy_flash_finish(&writer);
+    if (ret == 0 && !vector_phase) {
+        boot_flash_stats.pages = writer.verified;
+        boot_flash_stats.flash_bps = fy_flash_rate_bps(&writer);
+        if (first_len != 0) {
+            //其余页写完并校验通过后，最后写入向量表
+            vector_phase = 1;
+            if (fy_flash_open(&writer, NULL, flash_base, BOOT_FLASH_PAGE_SIZE) != 0 ||
+                fy_flash_write(&writer, first_page, first_len) != 0) {
+                ret = -1;
+            } else {
+                ret = 1;
+            }
+        }
+    } else if (ret == 0) {
+        boot_flash_stats.pages += writer.verified;
+    }
+    if (ret < 0) {
+        flash_status = -1;
+        boot_flash_stats.errors++;
+        return -1;
+    }
+    if (ret == 0) {
+        first_len = 0;
+        boot_flash_stats.end_tick = HAL_GetTick();
+    }
+    return ret;
+}
+
+void boot_flash_abort(void)
+{
+    //当前擦写操作结束后写入器自行加锁(boot_flash_poll)
+    fy_flash_abort(&writer);
+    first_len = 0;
+    flash_status = -1;
+}
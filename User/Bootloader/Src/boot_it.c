@@ -0,0 +1,79 @@
+/*
+ * Bootloader interrupt handlers: SysTick for the HAL tick, USART1 and its two DMA
+ * channels for fy_uart, FLASH for the pipelined writer. Faults stop in a loop, the
+ * watchdog (if enabled) resets.
+ */
+#include "main.h"
+#include "stm32f1xx_it.h"
+#include "fy_flash.h"
+
+extern DMA_HandleTypeDef hdma_usart1_tx;
+extern DMA_HandleTypeDef hdma_usart1_rx;
+extern UART_HandleTypeDef huart1;
+
+void NMI_Handler(void)
+{
+    while (1) {
+    }
+}
+
+void HardFault_Handler(void)
+{
+    while (1) {
+    }
+}
+
+void MemManage_Handler(void)
+{
+    while (1) {
+    }
+}
+
+void BusFault_Handler(void)
+{
+    while (1) {
+    }
+}
+
+void UsageFault_Handler(void)
+{
+    while (1) {
+    }
+}
+
+void SVC_Handler(void)
+{
+}
+
+void DebugMon_Handler(void)
+{
+}
+
+void PendSV_Handler(void)
+{
+}
+
+void SysTick_Handler(void)
+{
+    HAL_IncTick();
+}
+
+void DMA1_Channel4_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&hdma_usart1_tx);
+}
+
+void DMA1_Channel5_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&hdma_usart1_rx);
+}
+
+void USART1_IRQHandler(void)
+{
+    HAL_UART_IRQHandler(&huart1);
+}
+
+void FLASH_IRQHandler(void)
+{
+    fy_flash_irq_handler();
+}
@@ -0,0 +1,367 @@
+#include "boot.h"
+#include "boot_flash.h"
+#include "fy_crc.h"
+#include "dma.h"
+#include "usart.h"
+#include "fy_uart.h"
+#include "fy_ymodem.h"
+#include <string.h>
+
+#if BOOT_IWDG_ENABLE
+#define BOOT_IWDG_FEED()    (IWDG->KR = 0xAAAAU)
+#else
+#define BOOT_IWDG_FEED()    do {} while (0)
+#endif
+
+static fy_uart_t uart1;
+static ringBuffer_t uart1_rx_rb;
+static ringBuffer_t uart1_tx_rb;
+static uint8_t uart1_rx_buffer[BOOT_RX_BUF_SIZE];
+static uint8_t uart1_tx_buffer[256];
+static fy_ymodem_t ymodem;
+
+void SystemClock_Config(void);
+
+/* 不使用printf，保持Bootloader在16K以内 */
+static void boot_puts(const char *s)
+{
+    uart1.uartTx(&uart1, (const uint8_t *)s, strlen(s));
+}
+
+static void boot_put_u32(uint32_t v)
+{
+    char buf[11];
+    char *p = &buf[sizeof(buf) - 1];
+
+    *p = '\0';
+    do {
+        *--p = (char)('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+    boot_puts(p);
+}
+
+static void boot_put_hex(uint32_t v)
+{
+    char buf[11] = "0x";
+
+    for (int i = 0; i < 8; i++) {
+        buf[2 + i] = "0123456789ABCDEF"[(v >> (28 - 4 * i)) & 0xF];
+    }
+    buf[10] = '\0';
+    boot_puts(buf);
+}
+
+#if BOOT_IWDG_ENABLE
+/* LSI 40kHz/64，重装值1250，约2s */
+static void boot_iwdg_init(void)
+{
+    IWDG->KR = 0x5555U;
+    IWDG->PR = IWDG_PR_PR_2;
+    IWDG->RLR = 1250U;
+    IWDG->KR = 0xAAAAU;
+    IWDG->KR = 0xCCCCU;
+}
+#endif
+
+/* 栈顶在RAM内，复位向量为App区内的Thumb地址；镜像有尾部(Tools/fy_image.py)时CRC必须一致 */
+static int32_t boot_app_check(void)
+{
+    uint32_t sp = *(volatile const uint32_t *)BOOT_APP_ADDR;
+    uint32_t pc = *(volatile const uint32_t *)(BOOT_APP_ADDR + 4);
+    int32_t r;
+
+    if (sp <= BOOT_RAM_BASE || sp > BOOT_RAM_BASE + BOOT_RAM_SIZE || (sp & 3U) != 0) {
+        return -1;
+    }
+    if ((pc & 1U) == 0 || (pc & ~1U) < BOOT_APP_ADDR || (pc & ~1U) >= BOOT_APP_ADDR + BOOT_APP_SIZE) {
+        return -1;
+    }
+    r = fy_image_check((const uint32_t *)BOOT_APP_ADDR, BOOT_APP_SIZE, NULL, NULL);
+    if (r < 0 || (BOOT_REQUIRE_FOOTER && r != FY_IMAGE_OK)) {
+        return -1;
+    }
+    return 0;
+}
+
+/* 等待发送完成，反初始化外设与中断，切换向量表与栈后跳转到App的复位向量 */
+static void boot_jump(void)
+{
+    uint32_t sp = *(volatile const uint32_t *)BOOT_APP_ADDR;
+    void (*app_reset)(void) = (void (*)(void))(*(volatile const uint32_t *)(BOOT_APP_ADDR + 4));
+    uint32_t t0 = HAL_GetTick();
+
+    while ((uart1.tx_busy || uart1.tx_q_count != 0) && HAL_GetTick() - t0 < 100) {
+    }
+    fy_uart_deinit(&uart1);
+    HAL_UART_DeInit(&huart1);
+
+    __disable_irq();
+    SysTick->CTRL = 0;
+    SysTick->LOAD = 0;
+    SysTick->VAL = 0;
+    HAL_RCC_DeInit();
+    HAL_DeInit();
+    for (uint32_t i = 0; i < sizeof(NVIC->ICER) / sizeof(NVIC->ICER[0]); i++) {
+        NVIC->ICER[i] = 0xFFFFFFFFU;
+        NVIC->ICPR[i] = 0xFFFFFFFFU;
+    }
+    SCB->VTOR = BOOT_APP_ADDR;
+    __DSB();
+    __ISB();
+    __set_MSP(sp);
+    __enable_irq();//与复位后的状态一致
+    app_reset();
+    while (1) {
+    }
+}
+
+/* 在timeout_ms内收到任意字节返回1 */
+static uint8_t boot_wait_key(uint32_t timeout_ms)
+{
+    uint32_t t0 = HAL_GetTick();
+    uint8_t c;
+
+    while (HAL_GetTick() - t0 < timeout_ms) {
+        BOOT_IWDG_FEED();
+        if (uart1.uartRx(&uart1, &c, 1) != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* 镜像CRC的结果，以及外设+DMA与软件实现各自的耗时 */
+static void boot_crc_info(void)
+{
+    const uint32_t *app = (const uint32_t *)BOOT_APP_ADDR;
+    uint32_t cycles_per_us = SystemCoreClock / 1000000U;
+    uint32_t crc = 0, t0, hw, sw;
+    int32_t r;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    t0 = DWT->CYCCNT;
+    r = fy_image_check(app, BOOT_APP_SIZE, NULL, &crc);
+    hw = DWT->CYCCNT - t0;
+    boot_puts(", crc ");
+    switch (r) {
+    case FY_IMAGE_OK:           boot_puts("ok "); break;
+    case FY_IMAGE_NO_FOOTER:    boot_puts("none"); return;
+    case FY_IMAGE_BAD_SIZE:     boot_puts("bad size"); return;
+    default:                    boot_puts("bad "); break;
+    }
+    boot_put_hex(crc);
+    t0 = DWT->CYCCNT;
+    fy_image_check(app, BOOT_APP_SIZE, fy_crc32_sw, NULL);
+    sw = DWT->CYCCNT - t0;
+    boot_puts(" (dma ");
+    boot_put_u32(hw / cycles_per_us);
+    boot_puts(" us, cpu ");
+    boot_put_u32(sw / cycles_per_us);
+    boot_puts(" us)");
+}
+
+static void boot_info(void)
+{
+    boot_puts("boot " BOOT_VERSION ", app ");
+    boot_put_hex(BOOT_APP_ADDR);
+    boot_puts(" ");
+    boot_put_u32(BOOT_APP_SIZE / 1024);
+    boot_puts("K, ");
+    boot_puts((boot_app_check() == 0) ? "valid" : "invalid");
+    boot_crc_info();
+    boot_puts(", uid ");
+    boot_put_hex(HAL_GetUIDw2());
+    boot_put_hex(HAL_GetUIDw1());
+    boot_put_hex(HAL_GetUIDw0());
+    boot_puts("\r\n");
+}
+
+/* YMODEM文件写入App区 */
+static int32_t boot_ym_open(void *arg, const char *name, uint32_t size)
+{
+    if (size > BOOT_APP_SIZE) {
+        return -1;
+    }
+    return boot_flash_open(BOOT_APP_ADDR, BOOT_APP_SIZE);
+}
+
+static int32_t boot_ym_write(void *arg, uint32_t offset, const uint8_t *data, uint32_t len)
+{
+    return boot_flash_write(offset, data, len);
+}
+
+static int32_t boot_ym_close(void *arg, int32_t status)
+{
+    if (status < 0) {
+        boot_flash_abort();
+        return 0;
+    }
+    return boot_flash_finish();
+}
+
+static void boot_ym_send(void *arg, const uint8_t *data, uint32_t len)
+{
+    uart1.uartTx(&uart1, data, len);
+}
+
+static const fy_ymodem_ops_t boot_ym_ops = {
+    boot_ym_open,
+    boot_ym_write,
+    boot_ym_close,
+    boot_ym_send,
+};
+
+static void boot_report(void)
+{
+    uint32_t ms = boot_flash_stats.end_tick - boot_flash_stats.start_tick;
+
+    boot_puts("\r\nreceived ");
+    boot_put_u32(boot_flash_stats.bytes);
+    boot_puts(" bytes, ");
+    boot_put_u32(boot_flash_stats.pages);
+    boot_puts(" pages, ");
+    boot_put_u32(ms);
+    boot_puts(" ms (");
+    boot_put_u32(ms ? boot_flash_stats.bytes * 1000U / 1024U / ms : 0);
+    boot_puts(" KB/s), flash ");
+    boot_put_u32(boot_flash_stats.flash_bps / 1024U);
+    boot_puts(" KB/s, busy ");
+    boot_put_u32(boot_flash_stats.busy);
+    boot_puts(", naks ");
+    boot_put_u32(ymodem.naks);
+    boot_puts("\r\n");
+}
+
+/* 传输开始前的单字节命令，返回1表示已处理 */
+static uint8_t boot_command(uint8_t c)
+{
+    switch (c) {
+    case 'j':
+        if (boot_app_check() == 0) {
+            boot_puts("jump\r\n");
+            boot_jump();
+        }
+        boot_puts("no valid app\r\n");
+        return 1;
+    case 'i':
+        boot_info();
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static void boot_loop(void)
+{
+    uint8_t rx[64];
+    uint32_t rx_len = 0, rx_pos = 0;
+
+    boot_puts("send the app .bin with YMODEM, 'j' jump, 'i' info\r\n");
+    fy_ymodem_init(&ymodem, &boot_ym_ops, NULL);
+    fy_ymodem_start(&ymodem, HAL_GetTick());
+    while (1) {
+        uint32_t now;
+
+        BOOT_IWDG_FEED();
+        boot_flash_poll();
+        now = HAL_GetTick();
+        if (rx_pos == rx_len) {
+            rx_len = uart1.uartRx(&uart1, rx, sizeof(rx));
+            rx_pos = 0;
+        }
+        if (rx_pos < rx_len) {
+            if (!fy_ymodem_started(&ymodem) && boot_command(rx[rx_pos])) {
+                rx_pos++;
+            } else {
+                //块被推迟(Flash缓冲满)时引擎不消耗后续字节，留到下次
+                rx_pos += (uint32_t)fy_ymodem_input(&ymodem, &rx[rx_pos], rx_len - rx_pos, now);
+            }
+        }
+
+        switch (fy_ymodem_poll(&ymodem, now)) {
+        case FY_YMODEM_DONE:
+            boot_report();
+            if (boot_app_check() == 0) {
+                boot_puts("jump\r\n");
+                boot_jump();
+            }
+            boot_puts("no valid app\r\n");
+            fy_ymodem_start(&ymodem, HAL_GetTick());
+            break;
+        case FY_YMODEM_ABORTED:
+            //等发送方停下来再提示，避免文本混入它的数据
+            HAL_Delay(1000);
+            uart1.uartClear_rxBuffer(&uart1);
+            rx_len = rx_pos = 0;
+            boot_puts("\r\ntransfer aborted: ");
+            boot_puts(fy_ymodem_error_str(ymodem.error));
+            boot_puts("\r\n");
+            fy_ymodem_start(&ymodem, HAL_GetTick());
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+int main(void)
+{
+    HAL_Init();
+    SystemClock_Config();
+#if BOOT_IWDG_ENABLE
+    boot_iwdg_init();
+#endif
+    MX_DMA_Init();
+    MX_USART1_UART_Init();
+    ringBuffer_init(&uart1_rx_rb, uart1_rx_buffer, sizeof(uart1_rx_buffer));
+    ringBuffer_init(&uart1_tx_rb, uart1_tx_buffer, sizeof(uart1_tx_buffer));
+    fy_uart_init_ex(&uart1, &huart1, &uart1_rx_rb, &uart1_tx_rb, FY_UART_RX_DMA_IDLE);
+
+    boot_puts("\r\n");
+    boot_info();
+    if (boot_app_check() == 0) {
+        boot_puts("press any key to stay in boot\r\n");
+        if (!boot_wait_key(BOOT_WAIT_MS)) {
+            boot_jump();
+        }
+    }
+    boot_loop();
+    return 0;
+}
+
+/* 与App相同：HSE 8MHz，PLL x9，72MHz */
+void SystemClock_Config(void)
+{
+    RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+    RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+
+    RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSE;
+    RCC_OscInitStruct.HSEState = RCC_HSE_ON;
+    RCC_OscInitStruct.HSEPredivValue = RCC_HSE_PREDIV_DIV1;
+    RCC_OscInitStruct.HSIState = RCC_HSI_ON;
+    RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
+    RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSE;
+    RCC_OscInitStruct.PLL.PLLMUL = RCC_PLL_MUL9;
+    if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK) {
+        Error_Handler();
+    }
+
+    RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_SYSCLK
+                                | RCC_CLOCKTYPE_PCLK1 | RCC_CLOCKTYPE_PCLK2;
+    RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+    RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+    RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV2;
+    RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;
+    if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_2) != HAL_OK) {
+        Error_Handler();
+    }
+}
+
+void Error_Handler(void)
+{
+    __disable_irq();
+    while (1) {
+    }
+}
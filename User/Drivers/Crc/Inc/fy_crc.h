@@ -0,0 +1,62 @@
+/*
+说明
+    App镜像完整性校验。CRC-32按STM32 CRC外设的方式计算：多项式0x04C11DB7，初值0xFFFFFFFF，
+    按32位字输入、高位在前，不反射，无结果异或(字节序列按每个字的小端顺序读取，
+    与CRC-32/MPEG-2对每个字的4个字节逆序输入等价)。
+    fy_crc32_hw用CRC外设，DMA以32位字存储器到存储器的方式把数据送入CRC->DR，CPU不逐字搬运；
+    fy_crc32_sw是逐4位查表的软件实现，结果与外设逐位相同，主机上也可编译(FY_CRC_HOST)。
+    fy_crc32优先使用外设，DMA失败时改用软件实现。
+
+镜像格式(Tools/fy_image.py在编译后生成)：
+    向量表保留项7(偏移0x1C)  FY_IMAGE_MAGIC
+    向量表保留项8(偏移0x20)  镜像长度L(字节，4的倍数，不含尾部)
+    偏移L                    CRC32(镜像[0, L))，即尾部(footer)
+    Cortex-M3不使用这两个保留项，App照常运行；没有尾部的镜像(如调试器直接烧录ELF)魔数为0。
+
+移植:
+    fy_crc_port.c使用CubeMX生成的hcrc(crc.c)与DMA1_Channel1(FY_CRC_DMA_CHANNEL)，该通道需空闲。
+
+使用方法：
+    uint32_t crc;
+    int32_t r = fy_image_check((const uint32_t *)APP_ADDR, APP_SIZE, NULL, &crc);
+    //FY_IMAGE_OK校验通过，FY_IMAGE_NO_FOOTER没有尾部，<0长度错误或CRC不符
+*/
+#ifndef __FY_CRC_H
+#define __FY_CRC_H
+
+#include <stdint.h>
+
+#define FY_CRC_INIT             0xFFFFFFFFUL
+
+#define FY_IMAGE_MAGIC          0x50415946UL    //"FYAP"
+#define FY_IMAGE_MAGIC_OFFSET   0x1CU
+#define FY_IMAGE_SIZE_OFFSET    0x20U
+#define FY_IMAGE_MIN_SIZE       0x24U           //至少包含长度所在的字
+
+#define FY_IMAGE_OK             0
+#define FY_IMAGE_NO_FOOTER      1
+#define FY_IMAGE_BAD_SIZE       (-1)
+#define FY_IMAGE_BAD_CRC        (-2)
+
+#ifndef FY_CRC_DMA_CHANNEL
+#define FY_CRC_DMA_CHANNEL      DMA1_Channel1
+#endif
+
+/* 从FY_CRC_INIT开始计算words个字的CRC */
+typedef uint32_t (*fy_crc_fn_t)(const uint32_t *data, uint32_t words);
+
+/* 软件实现，crc为上一次的结果，首次为FY_CRC_INIT */
+uint32_t fy_crc32_update(uint32_t crc, const uint32_t *data, uint32_t words);
+uint32_t fy_crc32_sw(const uint32_t *data, uint32_t words);
+/* 外设(目标板)或软件(主机) */
+uint32_t fy_crc32(const uint32_t *data, uint32_t words);
+
+/* 检查region_size字节区域内的镜像，crc_fn为NULL时使用fy_crc32，crc非NULL时返回计算结果 */
+int32_t fy_image_check(const uint32_t *image, uint32_t region_size, fy_crc_fn_t crc_fn, uint32_t *crc);
+
+#ifndef FY_CRC_HOST
+/* CRC外设 + 存储器到存储器DMA，返回0成功 */
+int32_t fy_crc32_hw(const uint32_t *data, uint32_t words, uint32_t *crc);
+#endif
+
+#endif
@@ -0,0 +1,55 @@
+#include "fy_crc.h"
+#include <stddef.h>
+
+/* 每次处理4位的CRC-32(不反射，0x04C11DB7)表 */
+static const uint32_t crc32_nibble[16] = {
+    0x00000000, 0x04C11DB7, 0x09823B6E, 0x0D4326D9, 0x130476DC, 0x17C56B6B, 0x1A864DB2, 0x1E475005,
+    0x2608EDB8, 0x22C9F00F, 0x2F8AD6D6, 0x2B4BCB61, 0x350C9B64, 0x31CD86D3, 0x3C8EA00A, 0x384FBDBD,
+};
+
+uint32_t fy_crc32_update(uint32_t crc, const uint32_t *data, uint32_t words)
+{
+    while (words--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc << 4) ^ crc32_nibble[crc >> 28];
+        }
+    }
+    return crc;
+}
+
+uint32_t fy_crc32_sw(const uint32_t *data, uint32_t words)
+{
+    return fy_crc32_update(FY_CRC_INIT, data, words);
+}
+
+uint32_t fy_crc32(const uint32_t *data, uint32_t words)
+{
+#ifndef FY_CRC_HOST
+    uint32_t crc;
+
+    if (fy_crc32_hw(data, words, &crc) == 0) {
+        return crc;
+    }
+#endif
+    return fy_crc32_sw(data, words);
+}
+
+int32_t fy_image_check(const uint32_t *image, uint32_t region_size, fy_crc_fn_t crc_fn, uint32_t *crc)
+{
+    uint32_t size, value;
+
+    if (image[FY_IMAGE_MAGIC_OFFSET / 4] != FY_IMAGE_MAGIC) {
+        return FY_IMAGE_NO_FOOTER;
+    }
+    size = image[FY_IMAGE_SIZE_OFFSET / 4];
+    //尾部也要在区域内
+    if (size < FY_IMAGE_MIN_SIZE || (size & 3U) != 0 || size > region_size - 4U) {
+        return FY_IMAGE_BAD_SIZE;
+    }
+    value = ((crc_fn != NULL) ? crc_fn : fy_crc32)(image, size / 4);
+    if (crc != NULL) {
+        *crc = value;
+    }
+    return (value == image[size / 4]) ? FY_IMAGE_OK : FY_IMAGE_BAD_CRC;
+}
@@ -0,0 +1,49 @@
+/* fy_crc_port.c
+ * CRC peripheral fed by a memory-to-memory DMA channel: the source walks the
+ * image a word at a time, the destination stays on CRC->DR.
+ */
+#include "fy_crc.h"
+#include "crc.h"
+
+#define CRC_DMA_MAX_WORDS   0xFFFFU     //CNDTR为16位
+#define CRC_DMA_TIMEOUT     100U        //ms，64K约1ms
+
+static DMA_HandleTypeDef hdma_crc;
+
+int32_t fy_crc32_hw(const uint32_t *data, uint32_t words, uint32_t *crc)
+{
+    int32_t ret = 0;
+
+    if (hcrc.Instance == NULL) {
+        MX_CRC_Init();
+    }
+    __HAL_CRC_DR_RESET(&hcrc);
+
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    hdma_crc.Instance = FY_CRC_DMA_CHANNEL;
+    hdma_crc.Init.Direction = DMA_MEMORY_TO_MEMORY;
+    hdma_crc.Init.PeriphInc = DMA_PINC_ENABLE;//源地址(CPAR)递增
+    hdma_crc.Init.MemInc = DMA_MINC_DISABLE;//目的地址(CMAR)固定为CRC->DR
+    hdma_crc.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+    hdma_crc.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+    hdma_crc.Init.Mode = DMA_NORMAL;
+    hdma_crc.Init.Priority = DMA_PRIORITY_HIGH;
+    if (HAL_DMA_Init(&hdma_crc) != HAL_OK) {
+        return -1;
+    }
+    while (words != 0 && ret == 0) {
+        uint32_t n = (words > CRC_DMA_MAX_WORDS) ? CRC_DMA_MAX_WORDS : words;
+
+        if (HAL_DMA_Start(&hdma_crc, (uint32_t)data, (uint32_t)&hcrc.Instance->DR, n) != HAL_OK ||
+            HAL_DMA_PollForTransfer(&hdma_crc, HAL_DMA_FULL_TRANSFER, CRC_DMA_TIMEOUT) != HAL_OK) {
+            ret = -1;
+        }
+        data += n;
+        words -= n;
+    }
+    HAL_DMA_DeInit(&hdma_crc);
+    if (ret == 0) {
+        *crc = hcrc.Instance->DR;
+    }
+    return ret;
+}
@@ -0,0 +1,120 @@
+/*
+说明
+    流水线Flash写入：fy_flash_write把数据拷入暂存环形缓冲后立即返回，
+    擦除与编程由Flash操作结束中断(HAL_FLASHEx_Erase_IT/HAL_FLASH_Program_IT)一个接一个地衔接，不在主循环中等待。
+    每次编程一个双字(4个半字，HAL在中断中连续写完4个半字后才回调一次)，减少中断与回调次数。
+    页在数据到来之前提前擦除(当前页之后最多FY_FLASH_ERASE_AHEAD页)，数据到达时控制器可以直接编程。
+    写入时同时计算每页源数据的CRC32，暂存的数据编程后即可释放；主循环中fy_flash_poll读回已编程的整页计算CRC比较，
+    因此暂存缓冲只需容纳正在编程的数据，而不是整页的副本。
+
+    HAL_FLASH_IRQHandler在回调HAL_FLASH_EndOfOperationCallback之后才把编程过程标记为结束，
+    回调中不能启动下一次操作，因此回调只记录完成，FLASH_IRQHandler在HAL_FLASH_IRQHandler返回后
+    (fy_flash_irq_handler)再启动下一次操作。
+    F103只有一个Bank，擦写期间从Flash取指的CPU会暂停；收益在于控制器不再等待主循环，DMA接收等照常进行。
+
+    速率：fy_flash_rate_bps给出open到现在(或finish完成)的平均编程速率(字节/秒)。
+
+移植:
+    页状态与调度(fy_flash.c)只通过port访问Flash，主机上定义FY_FLASH_HOST编译，由调用者提供模拟的Flash
+    (见Tools/flash_writer_sim.c)。目标板使用fy_flash_port_default(fy_flash_port.c)。
+
+使用方法：
+    fy_flash_t fw;
+    FLASH_IRQHandler中调用fy_flash_irq_handler()
+    fy_flash_open(&fw, NULL, addr, size);      //区域需按页对齐，区域内的页会被擦除
+    fy_flash_write(&fw, data, len);           //返回0接受，1忙(暂存满，稍后重试)，-1错误
+    主循环: fy_flash_poll(&fw);
+    fy_flash_finish(&fw);                     //返回1时继续调用，0完成(全部校验通过)，-1错误
+*/
+#ifndef __FY_FLASH_H
+#define __FY_FLASH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef FY_FLASH_PAGE_SIZE
+#define FY_FLASH_PAGE_SIZE      1024    //STM32F103C8
+#endif
+#ifndef FY_FLASH_STAGE_SIZE
+#define FY_FLASH_STAGE_SIZE     2048    //暂存缓冲，2的幂且不小于一页
+#endif
+#ifndef FY_FLASH_ERASE_AHEAD
+#define FY_FLASH_ERASE_AHEAD    2       //提前擦除的页数
+#endif
+#ifndef FY_FLASH_CRC_SLOTS
+#define FY_FLASH_CRC_SLOTS      4       //已暂存但未校验的页数上限
+#endif
+
+#define FY_FLASH_CHUNK          8       //每次编程的字节数(双字)
+
+typedef struct fy_flash fy_flash_t;
+
+typedef struct {
+    /* 解锁Flash并记录fw供中断回调使用 */
+    void (*begin)(fy_flash_t *fw);
+    /* 加锁 */
+    void (*end)(fy_flash_t *fw);
+    /* 开始擦除一页/编程一个双字，完成后在中断中调用fy_flash_op_done；返回0已开始 */
+    int32_t (*erase)(uint32_t addr);
+    int32_t (*program)(uint32_t addr, uint64_t data);
+    /* 读回校验用：Flash地址对应的可读指针 */
+    const uint8_t *(*map)(uint32_t addr);
+    /* 毫秒时刻 */
+    uint32_t (*now)(void);
+} fy_flash_port_t;
+
+typedef struct fy_flash {
+    //成员
+    const fy_flash_port_t *port;
+    uint32_t base;//区域起始
+    uint32_t end;//区域结束
+    //位置(绝对地址)，每个只有一方写
+    volatile uint32_t stage_end;//主循环写：已暂存数据的末尾
+    volatile uint32_t prog_addr;//中断写：此地址之前已编程
+    volatile uint32_t erase_addr;//中断写：此地址之前的页已擦除
+    uint32_t verify_addr;//主循环写：此地址之前已校验
+    uint32_t data_end;//finish时的数据末尾(不含补齐)
+    volatile uint8_t op;//当前Flash操作
+    uint8_t finishing;
+    uint8_t active;//已解锁，等待finish/出错后加锁
+    volatile int8_t status;//0正常，-1出错
+    //校验
+    uint32_t stage_crc;//当前暂存页的源数据CRC
+    uint32_t page_crc[FY_FLASH_CRC_SLOTS];//已暂存完整页的源数据CRC，按页号取模
+    //统计
+    uint32_t bytes;//已接受的字节数
+    volatile uint32_t erases;
+    volatile uint32_t programs;//双字编程次数
+    uint32_t verified;//校验通过的页数
+    uint32_t verify_errors;
+    volatile uint32_t op_errors;//擦除/编程出错(PGERR/WRPRTERR)
+    uint32_t busy;//暂存满，write返回1的次数
+    uint32_t start_ms;//open的时刻
+    uint32_t end_ms;//finish完成(或出错停止)的时刻
+    uint8_t stage[FY_FLASH_STAGE_SIZE];
+} fy_flash_t;
+
+int32_t fy_flash_open(fy_flash_t *fw, const fy_flash_port_t *port, uint32_t addr, uint32_t size);
+int32_t fy_flash_write(fy_flash_t *fw, const void *data, uint32_t len);
+/* 读回校验已编程的页，发现控制器空闲而有工作时启动 */
+void fy_flash_poll(fy_flash_t *fw);
+int32_t fy_flash_finish(fy_flash_t *fw);
+/* 停止：等待当前操作结束后不再启动新的操作 */
+void fy_flash_abort(fy_flash_t *fw);
+uint32_t fy_flash_rate_bps(const fy_flash_t *fw);
+
+/* port在操作完成的中断中调用，ok为0表示出错 */
+void fy_flash_op_done(fy_flash_t *fw, uint8_t ok);
+/* 中断中(HAL处理结束之后)启动下一次操作 */
+void fy_flash_continue(fy_flash_t *fw);
+
+/* CRC-32(与zlib相同，多项式0xEDB88320反射)，crc为上一次的结果，首次为0 */
+uint32_t fy_flash_crc32(uint32_t crc, const uint8_t *data, size_t len);
+
+#ifndef FY_FLASH_HOST
+const fy_flash_port_t *fy_flash_port_default(void);
+/* 在FLASH_IRQHandler中调用，代替HAL_FLASH_IRQHandler */
+void fy_flash_irq_handler(void);
+#endif
+
+#endif
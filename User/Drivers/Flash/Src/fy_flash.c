@@ -0,0 +1,257 @@
+#include "fy_flash.h"
+#include <string.h>
+
+#ifdef FY_FLASH_HOST
+/* 主机模拟为单线程，"中断"只在模拟循环中同步发生 */
+#define FY_FLASH_ENTER_CRITICAL()   do {} while (0)
+#define FY_FLASH_EXIT_CRITICAL()    do {} while (0)
+#else
+#include "stm32f1xx.h"
+#define FY_FLASH_ENTER_CRITICAL()   uint32_t primask_ = __get_PRIMASK(); __disable_irq()
+#define FY_FLASH_EXIT_CRITICAL()    __set_PRIMASK(primask_)
+#endif
+
+#if (FY_FLASH_STAGE_SIZE & (FY_FLASH_STAGE_SIZE - 1)) != 0 || FY_FLASH_STAGE_SIZE < FY_FLASH_PAGE_SIZE
+#error "FY_FLASH_STAGE_SIZE must be a power of 2 and at least one page"
+#endif
+
+#define OP_NONE     0
+#define OP_ERASE    1
+#define OP_PROGRAM  2
+
+#define STAGE_MASK          (FY_FLASH_STAGE_SIZE - 1U)
+#define PAGE_FLOOR(a)       ((a) & ~(uint32_t)(FY_FLASH_PAGE_SIZE - 1U))
+#define PAGE_INDEX(fw, a)   (((a) - (fw)->base) / FY_FLASH_PAGE_SIZE)
+#define CRC_SLOT(fw, a)     (PAGE_INDEX(fw, a) % FY_FLASH_CRC_SLOTS)
+
+/* 每次处理4位的CRC-32(反射)表 */
+static const uint32_t crc32_nibble[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+uint32_t fy_flash_crc32(uint32_t crc, const uint8_t *data, size_t len)
+{
+    crc = ~crc;
+    while (len--) {
+        crc ^= *data++;
+        crc = (crc >> 4) ^ crc32_nibble[crc & 0x0F];
+        crc = (crc >> 4) ^ crc32_nibble[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+/* 控制器空闲时启动下一次操作(中断中，或主循环中关中断调用)：
+   有已暂存的双字时编程(所在页未擦除则先擦除)，否则在当前页之后提前擦除 */
+static void next_op(fy_flash_t *fw)
+{
+    uint32_t pa;
+
+    if (fw->op != OP_NONE || fw->status < 0) {
+        return;
+    }
+    pa = fw->prog_addr;
+    if (fw->stage_end - pa >= FY_FLASH_CHUNK) {
+        if (pa >= fw->erase_addr) {
+            fw->op = OP_ERASE;
+            if (fw->port->erase(fw->erase_addr) != 0) {
+                fw->op = OP_NONE;
+                fw->status = -1;
+            }
+        } else {
+            uint64_t data;
+
+            //双字按8字节对齐，暂存缓冲的大小是8的倍数，不会跨越回绕点
+            memcpy(&data, &fw->stage[pa & STAGE_MASK], sizeof(data));
+            fw->op = OP_PROGRAM;
+            if (fw->port->program(pa, data) != 0) {
+                fw->op = OP_NONE;
+                fw->status = -1;
+            }
+        }
+    } else if (!fw->finishing && fw->erase_addr < fw->end &&
+               fw->erase_addr < PAGE_FLOOR(pa) + (1U + FY_FLASH_ERASE_AHEAD) * FY_FLASH_PAGE_SIZE) {
+        fw->op = OP_ERASE;
+        if (fw->port->erase(fw->erase_addr) != 0) {
+            fw->op = OP_NONE;
+            fw->status = -1;
+        }
+    }
+}
+
+static void kick(fy_flash_t *fw)
+{
+    FY_FLASH_ENTER_CRITICAL();
+    next_op(fw);
+    FY_FLASH_EXIT_CRITICAL();
+}
+
+void fy_flash_op_done(fy_flash_t *fw, uint8_t ok)
+{
+    if (!ok) {
+        fw->op_errors++;
+        fw->status = -1;
+    } else if (fw->op == OP_ERASE) {
+        fw->erase_addr += FY_FLASH_PAGE_SIZE;
+        fw->erases++;
+    } else if (fw->op == OP_PROGRAM) {
+        __atomic_store_n(&fw->prog_addr, fw->prog_addr + FY_FLASH_CHUNK, __ATOMIC_RELEASE);
+        fw->programs++;
+    }
+    fw->op = OP_NONE;
+}
+
+void fy_flash_continue(fy_flash_t *fw)
+{
+    next_op(fw);
+}
+
+int32_t fy_flash_open(fy_flash_t *fw, const fy_flash_port_t *port, uint32_t addr, uint32_t size)
+{
+#ifndef FY_FLASH_HOST
+    if (port == NULL) {
+        port = fy_flash_port_default();
+    }
+#endif
+    if (port == NULL || (addr & (FY_FLASH_PAGE_SIZE - 1U)) != 0 || size == 0 ||
+        (size & (FY_FLASH_CHUNK - 1U)) != 0) {
+        return -1;
+    }
+    memset(fw, 0, offsetof(fy_flash_t, stage));
+    fw->port = port;
+    fw->base = addr;
+    fw->end = addr + size;
+    fw->stage_end = addr;
+    fw->prog_addr = addr;
+    fw->erase_addr = addr;
+    fw->verify_addr = addr;
+    port->begin(fw);
+    fw->active = 1;
+    fw->start_ms = port->now();
+    kick(fw);//数据到来之前先擦除前几页
+    return 0;
+}
+
+int32_t fy_flash_write(fy_flash_t *fw, const void *data, uint32_t len)
+{
+    const uint8_t *src = data;
+    uint32_t pos = fw->stage_end;
+
+    if (fw->status < 0 || fw->finishing || len > fw->end - pos || len > FY_FLASH_STAGE_SIZE) {
+        return -1;
+    }
+    if (len == 0) {
+        return 0;
+    }
+    //整块放得下才接受：暂存空间，以及本次涉及的页都有CRC位置(未校验的页不超过FY_FLASH_CRC_SLOTS)
+    if (pos - __atomic_load_n(&fw->prog_addr, __ATOMIC_ACQUIRE) + len > FY_FLASH_STAGE_SIZE ||
+        PAGE_INDEX(fw, pos + len - 1U) - PAGE_INDEX(fw, fw->verify_addr) >= FY_FLASH_CRC_SLOTS) {
+        fw->busy++;
+        return 1;
+    }
+    while (len != 0) {
+        uint32_t n = FY_FLASH_STAGE_SIZE - (pos & STAGE_MASK);
+        uint32_t page_left = FY_FLASH_PAGE_SIZE - (pos & (FY_FLASH_PAGE_SIZE - 1U));
+
+        if (n > page_left) n = page_left;
+        if (n > len) n = len;
+        memcpy(&fw->stage[pos & STAGE_MASK], src, n);
+        fw->stage_crc = fy_flash_crc32(fw->stage_crc, src, n);
+        src += n;
+        len -= n;
+        pos += n;
+        fw->bytes += n;
+        if ((pos & (FY_FLASH_PAGE_SIZE - 1U)) == 0) {
+            fw->page_crc[CRC_SLOT(fw, pos - FY_FLASH_PAGE_SIZE)] = fw->stage_crc;
+            fw->stage_crc = 0;
+        }
+    }
+    __atomic_store_n(&fw->stage_end, pos, __ATOMIC_RELEASE);
+    kick(fw);
+    return 0;
+}
+
+void fy_flash_poll(fy_flash_t *fw)
+{
+    uint32_t limit = fw->finishing ? fw->data_end : fw->end;
+
+    //读回已编程完的页(最后一页只到数据末尾)，与写入时的CRC比较
+    while (fw->status >= 0 && fw->verify_addr < limit) {
+        uint32_t page_end = fw->verify_addr + FY_FLASH_PAGE_SIZE;
+        uint32_t len_end = (page_end < limit) ? page_end : limit;
+        uint32_t crc;
+
+        if (__atomic_load_n(&fw->prog_addr, __ATOMIC_ACQUIRE) < len_end) {
+            break;
+        }
+        crc = fy_flash_crc32(0, fw->port->map(fw->verify_addr), len_end - fw->verify_addr);
+        if (crc != fw->page_crc[CRC_SLOT(fw, fw->verify_addr)]) {
+            fw->verify_errors++;
+            fw->status = -1;
+            break;
+        }
+        fw->verified++;
+        fw->verify_addr = page_end;
+    }
+    if (fw->status < 0) {
+        //出错后等当前操作结束再加锁
+        if (fw->active && fw->op == OP_NONE) {
+            fw->active = 0;
+            fw->end_ms = fw->port->now();
+            fw->port->end(fw);
+        }
+        return;
+    }
+    kick(fw);
+}
+
+int32_t fy_flash_finish(fy_flash_t *fw)
+{
+    if (fw->status >= 0 && !fw->finishing) {
+        uint32_t pos = fw->stage_end;
+        uint32_t pad = (FY_FLASH_CHUNK - (pos & (FY_FLASH_CHUNK - 1U))) & (FY_FLASH_CHUNK - 1U);
+
+        //最后不满一个双字的数据补0xFF(与擦除后的值相同)
+        if (pos - __atomic_load_n(&fw->prog_addr, __ATOMIC_ACQUIRE) + pad > FY_FLASH_STAGE_SIZE) {
+            return 1;
+        }
+        fw->data_end = pos;
+        if ((pos & (FY_FLASH_PAGE_SIZE - 1U)) != 0) {
+            fw->page_crc[CRC_SLOT(fw, PAGE_FLOOR(pos))] = fw->stage_crc;
+        }
+        memset(&fw->stage[pos & STAGE_MASK], 0xFF, pad);
+        fw->finishing = 1;
+        __atomic_store_n(&fw->stage_end, pos + pad, __ATOMIC_RELEASE);
+        kick(fw);
+    }
+    fy_flash_poll(fw);
+    if (fw->status < 0) {
+        return -1;
+    }
+    if (fw->prog_addr < fw->stage_end || fw->op != OP_NONE || fw->verify_addr < fw->data_end) {
+        return 1;
+    }
+    if (fw->active) {
+        fw->active = 0;
+        fw->end_ms = fw->port->now();
+        fw->port->end(fw);
+    }
+    return 0;
+}
+
+void fy_flash_abort(fy_flash_t *fw)
+{
+    fw->status = -1;
+    fy_flash_poll(fw);
+}
+
+uint32_t fy_flash_rate_bps(const fy_flash_t *fw)
+{
+    uint32_t done = fw->prog_addr - fw->base;
+    uint32_t ms = (fw->active ? fw->port->now() : fw->end_ms) - fw->start_ms;
+
+    if (fw->finishing && done > fw->data_end - fw->base) {
+        done = fw->data_end - fw->base;
+    }
+    return (ms != 0) ? (uint32_t)((uint64_t)done * 1000U / ms) : 0;
+}
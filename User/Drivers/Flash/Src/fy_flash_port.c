@@ -0,0 +1,111 @@
+/* fy_flash_port.c
+ * Default target port of the flash writer: HAL interrupt-mode erase/program on the
+ * internal flash, memory-mapped read back, HAL tick.
+ */
+#include "fy_flash.h"
+#include "main.h"
+
+static fy_flash_t *active_fw;
+
+#ifdef FY_EMU
+/* 仿真器中的Flash控制器模型(Tools/Renode/fy_fpec.py)没有中断线，按电平触发在软件中挂起：
+   操作开始后、以及每次中断处理完成后，中断已使能且标志仍成立时 */
+static void port_emu_pend(void)
+{
+    if ((FLASH->CR & (FLASH_CR_EOPIE | FLASH_CR_ERRIE)) != 0U &&
+        (FLASH->SR & (FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPRTERR)) != 0U) {
+        HAL_NVIC_SetPendingIRQ(FLASH_IRQn);
+    }
+}
+#else
+#define port_emu_pend()
+#endif
+
+static void port_begin(fy_flash_t *fw)
+{
+    active_fw = fw;
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPERR);
+    HAL_NVIC_SetPriority(FLASH_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(FLASH_IRQn);
+}
+
+static void port_end(fy_flash_t *fw)
+{
+    (void)fw;
+    HAL_NVIC_DisableIRQ(FLASH_IRQn);
+    HAL_FLASH_Lock();
+    active_fw = NULL;
+}
+
+static int32_t port_erase(uint32_t addr)
+{
+    FLASH_EraseInitTypeDef erase = {
+        .TypeErase = FLASH_TYPEERASE_PAGES,
+        .Banks = FLASH_BANK_1,
+        .PageAddress = addr,
+        .NbPages = 1,
+    };
+
+    if (HAL_FLASHEx_Erase_IT(&erase) != HAL_OK) return -1;
+    port_emu_pend();
+    return 0;
+}
+
+static int32_t port_program(uint32_t addr, uint64_t data)
+{
+    if (HAL_FLASH_Program_IT(FLASH_TYPEPROGRAM_DOUBLEWORD, addr, data) != HAL_OK) return -1;
+    port_emu_pend();
+    return 0;
+}
+
+static const uint8_t *port_map(uint32_t addr)
+{
+    return (const uint8_t *)addr;
+}
+
+static uint32_t port_now(void)
+{
+    return HAL_GetTick();
+}
+
+const fy_flash_port_t *fy_flash_port_default(void)
+{
+    static const fy_flash_port_t port = {
+        .begin = port_begin,
+        .end = port_end,
+        .erase = port_erase,
+        .program = port_program,
+        .map = port_map,
+        .now = port_now,
+    };
+
+    return &port;
+}
+
+void HAL_FLASH_EndOfOperationCallback(uint32_t ReturnValue)
+{
+    /* 只处理写入器启动的操作 */
+    (void)ReturnValue;
+    if (active_fw != NULL && active_fw->op != 0) {
+        fy_flash_op_done(active_fw, 1);
+    }
+}
+
+void HAL_FLASH_OperationErrorCallback(uint32_t ReturnValue)
+{
+    (void)ReturnValue;
+    if (active_fw != NULL && active_fw->op != 0) {
+        fy_flash_op_done(active_fw, 0);
+    }
+}
+
+void fy_flash_irq_handler(void)
+{
+    HAL_FLASH_IRQHandler();
+    //HAL已把本次操作标记为结束，可以启动下一次
+    if (active_fw != NULL) {
+        fy_flash_continue(active_fw);
+    }
+    port_emu_pend();
+}
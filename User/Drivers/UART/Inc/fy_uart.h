@@ -6,7 +6,23 @@
 
 使用方法：
     定义fy_uart_t，初始化ringBuffer_t
-    调用fy_uart_init初始化fy_uart_t
+    调用fy_uart_init初始化fy_uart_t（逐字节中断接收）
+    每个USART外设只能绑定一个fy_uart_t，重新绑定前先调用fy_uart_deinit
+    或调用fy_uart_init_ex选择FY_UART_RX_DMA_IDLE（循环DMA+空闲中断接收）
+
+FY_UART_RX_DMA_IDLE:
+    DMA以循环模式直接写入rx_rb的存储区，半满/全满/空闲线事件中推进head，
+    中断次数与字节数无关。要求rx_rb大小不超过65535，hdmarx配置为DMA_CIRCULAR。
+    rx_rb读端不能跟上时，DMA会覆盖未读数据，此时rx_overrun_count自增。
+
+发送:
+    发送由描述符队列驱动，DMA传输完成中断中直接衔接下一段，不等待USART TC。
+    uartTx拷贝进tx_rb（ring描述符，回绕时自动拆成两段）；
+    fy_uart_tx_buffer直接发送调用者的缓冲区（无拷贝），缓冲区需保持有效直到done回调。
+    fy_uart_tx_line_utilization返回发送期间线路利用率（千分比），用于确认线路是否跑满。
+
+接收通知:
+    fy_uart_set_rx_notify注册回调，新数据写入rx_rb后在中断中调用，用于唤醒读取rx_rb的任务。
 */
 #ifndef __FY_UART_H
 #define __FY_UART_H
@@ -16,13 +32,52 @@
 
 typedef struct fy_uart fy_uart_t;
 
+#ifndef FY_UART_TX_QUEUE_LEN
+#define FY_UART_TX_QUEUE_LEN    8
+#endif
+
+/* 发送完成回调，在DMA中断中执行 */
+typedef void (*fy_uart_tx_done_fn_t)(fy_uart_t *uart, void *arg);
+
+/* 接收通知回调，在UART/DMA中断中执行 */
+typedef void (*fy_uart_rx_notify_fn_t)(fy_uart_t *uart, void *arg);
+
+/* 发送描述符，data为NULL表示数据位于tx_rb */
+typedef struct {
+    const uint8_t *data;
+    size_t len;                 //剩余未发送长度
+    fy_uart_tx_done_fn_t done;
+    void *arg;
+} fy_uart_tx_desc_t;
+
+typedef enum {
+    FY_UART_RX_IT = 0,      //逐字节中断接收
+    FY_UART_RX_DMA_IDLE,    //循环DMA + IDLE/HT/TC事件
+} fy_uart_rx_mode_t;
+
 typedef struct fy_uart {
     //成员
     UART_HandleTypeDef *huart;
     ringBuffer_t* rx_rb;
     ringBuffer_t* tx_rb;
     uint8_t rx_temp_byte;//中断接收暂存的数据
-    size_t tx_active_len;
+    size_t tx_active_len;//当前DMA段长度
+    size_t tx_released_len;//当前DMA段中已释放的长度
+    fy_uart_tx_desc_t tx_queue[FY_UART_TX_QUEUE_LEN];
+    volatile uint8_t tx_q_head;
+    volatile uint8_t tx_q_count;
+    volatile uint8_t tx_busy;//DMA通道正在发送
+    uint8_t tx_line_active;
+    uint32_t tx_busy_since;//本次连续发送开始的tick
+    uint32_t tx_busy_ticks;//累计连续发送时间(ms)
+    uint32_t tx_bytes;//累计发送字节数
+    uint32_t tx_dma_starts;//DMA启动次数
+    uint32_t tx_error_count;
+    fy_uart_rx_mode_t rx_mode;
+    uint32_t rx_overrun_count;//DMA接收时rx_rb溢出次数
+    uint32_t rx_error_count;//HAL上报的接收错误次数
+    fy_uart_rx_notify_fn_t rx_notify;//有新数据
+    void *rx_notify_arg;
     //方法
     uint16_t (*uartTx)(struct fy_uart *uart, const uint8_t *data, size_t len);
     uint16_t (*uartRx)(struct fy_uart *uart, uint8_t *out, size_t len);
@@ -31,6 +86,11 @@ typedef struct fy_uart {
 } fy_uart_t;
 
 int32_t fy_uart_init(fy_uart_t *uart, UART_HandleTypeDef *huart, ringBuffer_t* rx_rb,ringBuffer_t* tx_rb);
+int32_t fy_uart_init_ex(fy_uart_t *uart, UART_HandleTypeDef *huart, ringBuffer_t* rx_rb, ringBuffer_t* tx_rb, fy_uart_rx_mode_t rx_mode);
+int32_t fy_uart_deinit(fy_uart_t *uart);
+int32_t fy_uart_tx_buffer(fy_uart_t *uart, const uint8_t *data, size_t len, fy_uart_tx_done_fn_t done, void *arg);
+uint32_t fy_uart_tx_line_utilization(const fy_uart_t *uart);
+void fy_uart_set_rx_notify(fy_uart_t *uart, fy_uart_rx_notify_fn_t notify, void *arg);
 // void fy_uart_tx(fy_uart_t *fy_uart, const uint8_t *data, size_t len);
 // uint16_t fy_uart_rx(fy_uart_t *fy_uart, uint8_t *out, size_t len);
 #endif
\ No newline at end of file
@@ -1,125 +1,366 @@
 #include "fy_uart.h"
+#ifdef FY_TRACE
+#include "fy_trace.h"
+#else
+#define FY_TRACE_EVENT(id, arg)
+#endif
 
 /* Private variables ---------------------------------------------------------*/
 /* small registry to support multiple fy_uart_t instances
-   mapped by their HAL `UART_HandleTypeDef *`. */
-static fy_uart_t *uart_registry[8] = {0};
+   mapped by their HAL `UART_HandleTypeDef *`.
+   USART1/2/3 and UART4/5 base addresses differ in bits [12:10], so
+   (Instance >> 10) & 7 is a collision-free slot and lookup is O(1). */
+#define UART_REGISTRY_SIZE      8U
+static fy_uart_t *uart_registry[UART_REGISTRY_SIZE] = {0};
 /* Private functions ---------------------------------------------------------*/
 /* Exported functions --------------------------------------------------------*/
 
+static inline uint32_t uart_registry_slot(const UART_HandleTypeDef *huart)
+{
+    return ((uint32_t)(uintptr_t)huart->Instance >> 10) & (UART_REGISTRY_SIZE - 1U);
+}
+
 static int register_uart_instance(fy_uart_t *uart)
 {
-    for (size_t i = 0; i < sizeof(uart_registry)/sizeof(uart_registry[0]); ++i) {
-        if (uart_registry[i] == NULL) {
-            uart_registry[i] = uart;
-            return 0;
-        }
+    uint32_t slot = uart_registry_slot(uart->huart);
+    if (uart_registry[slot] != NULL && uart_registry[slot] != uart) {
+        return -1;
     }
-    return -1;
+    uart_registry[slot] = uart;
+    return 0;
 }
 
-/*static void unregister_uart_instance(fy_uart_t *uart)
+static void unregister_uart_instance(fy_uart_t *uart)
 {
-    for (size_t i = 0; i < sizeof(uart_registry)/sizeof(uart_registry[0]); ++i) {
-        if (uart_registry[i] == uart) {
-            uart_registry[i] = NULL;
-            return;
-        }
+    uint32_t slot = uart_registry_slot(uart->huart);
+    if (uart_registry[slot] == uart) {
+        uart_registry[slot] = NULL;
     }
-}*/
+}
 
-static fy_uart_t *find_uart_by_huart(UART_HandleTypeDef *huart)
+static inline fy_uart_t *find_uart_by_huart(UART_HandleTypeDef *huart)
 {
-    for (size_t i = 0; i < sizeof(uart_registry)/sizeof(uart_registry[0]); ++i) {
-        if (uart_registry[i] != NULL && uart_registry[i]->huart == huart) {
-            return uart_registry[i];
-        }
+    fy_uart_t *uart = uart_registry[uart_registry_slot(huart)];
+    return (uart != NULL && uart->huart == huart) ? uart : NULL;
+}
+
+/* TX engine -----------------------------------------------------------------*/
+/* 发送由描述符队列驱动：ring类型描述符从tx_rb取数据（回绕时拆成两段），
+   外部描述符直接发送调用者的缓冲区。DMA传输完成中断里立即启动下一段，
+   此时USART移位寄存器仍在发送上一字节，线路不会出现空闲。 */
+
+#define FY_UART_DMA_MAX_LEN     0xFFFFU
+#define FY_UART_BITS_PER_BYTE   10U     /* start + 8 data + stop */
+
+#define FY_UART_ENTER_CRITICAL()    uint32_t primask_ = __get_PRIMASK(); __disable_irq()
+#define FY_UART_EXIT_CRITICAL()     __set_PRIMASK(primask_)
+
+static fy_uart_tx_desc_t *tx_queue_front(fy_uart_t *uart)
+{
+    return (uart->tx_q_count > 0) ? &uart->tx_queue[uart->tx_q_head] : NULL;
+}
+
+static fy_uart_tx_desc_t *tx_queue_back(fy_uart_t *uart)
+{
+    if (uart->tx_q_count == 0) return NULL;
+    uint8_t idx = (uint8_t)((uart->tx_q_head + uart->tx_q_count - 1) % FY_UART_TX_QUEUE_LEN);
+    return &uart->tx_queue[idx];
+}
+
+/* caller holds the critical section */
+static int32_t tx_queue_push(fy_uart_t *uart, const uint8_t *data, size_t len, fy_uart_tx_done_fn_t done, void *arg)
+{
+    if (uart->tx_q_count >= FY_UART_TX_QUEUE_LEN) return -1;
+    uint8_t idx = (uint8_t)((uart->tx_q_head + uart->tx_q_count) % FY_UART_TX_QUEUE_LEN);
+    fy_uart_tx_desc_t *desc = &uart->tx_queue[idx];
+    desc->data = data;
+    desc->len = len;
+    desc->done = done;
+    desc->arg = arg;
+    uart->tx_q_count++;
+    return 0;
+}
+
+/* Take back the last `n` bytes written to tx_rb before any descriptor covers them.
+   Only the producer moves head, and the DMA reads only what a descriptor covers. */
+static void tx_rb_unwrite(ringBuffer_t *rb, size_t n)
+{
+    if (rb->spsc) {
+        rb->head -= n;
+    } else {
+        rb->head = (rb->head + rb->size - n) % rb->size;
     }
-    return NULL;
 }
 
-static void uart_try_transmit(fy_uart_t *uart)
+static void tx_queue_pop(fy_uart_t *uart)
 {
-    ringBuffer_t *rb = uart->tx_rb;
-    
-    /* Check buffer count */
-    size_t len_to_send = rb->used(rb);
+    uart->tx_q_head = (uint8_t)((uart->tx_q_head + 1) % FY_UART_TX_QUEUE_LEN);
+    uart->tx_q_count--;
+}
 
-    /* Calculate contiguous data length from tail */
+/* Start the next segment if the DMA channel is idle. ISR or critical section only. */
+static void uart_tx_kick(fy_uart_t *uart)
+{
+    if (uart->tx_busy) return;
 
-    if (len_to_send > 0) {
-        /* Fix: Ensure we don't read past the end of the physical buffer */
-        size_t contiguous_len = rb->size - rb->tail;
-        if (len_to_send > contiguous_len) {
-            len_to_send = contiguous_len;
-        }
+    fy_uart_tx_desc_t *desc = tx_queue_front(uart);
+    if (desc == NULL) {
+        return;
+    }
 
-        uart->tx_active_len = len_to_send;
-        /* Call HAL_UART_Transmit_DMA */
-        const uint8_t *rb_tail = rb->rb_tail(rb);
-        HAL_UART_Transmit_DMA(uart->huart, rb_tail, len_to_send);
+    const uint8_t *src;
+    size_t len;
+    if (desc->data == NULL) {
+        /* ring segment: contiguous part from tail, the wrapped part follows next */
+        rb_span_t span = uart->tx_rb->peek(uart->tx_rb);
+        src = span.data;
+        len = (span.len < desc->len) ? span.len : desc->len;
+    } else {
+        src = desc->data;
+        len = desc->len;
     }
+    if (len > FY_UART_DMA_MAX_LEN) len = FY_UART_DMA_MAX_LEN;
+    if (len == 0) return;
+
+    if (!uart->tx_line_active) {
+        uart->tx_line_active = 1;
+        uart->tx_busy_since = HAL_GetTick();
+    }
+    uart->tx_active_len = len;
+    uart->tx_released_len = 0;
+    uart->tx_busy = 1;
+    uart->tx_dma_starts++;
+    if (HAL_DMA_Start_IT(uart->huart->hdmatx, (uint32_t)(uintptr_t)src,
+                         (uint32_t)(uintptr_t)&uart->huart->Instance->DR, (uint32_t)len) != HAL_OK) {
+        uart->tx_busy = 0;
+    }
+}
+
+/* Account `n` bytes of the active segment as moved into the USART. */
+static void uart_tx_release(fy_uart_t *uart, size_t n)
+{
+    fy_uart_tx_desc_t *desc = tx_queue_front(uart);
+    if (desc == NULL || n == 0) return;
+
+    if (desc->data == NULL) {
+        uart->tx_rb->consume(uart->tx_rb, n);
+    } else {
+        desc->data += n;
+    }
+    desc->len -= n;
+    uart->tx_released_len += n;
+    uart->tx_bytes += n;
 }
+
+static fy_uart_t *find_uart_by_hdma(DMA_HandleTypeDef *hdma)
+{
+    return find_uart_by_huart((UART_HandleTypeDef *)hdma->Parent);
+}
+
 /* HAL Callbacks -------------------------------------------------------------*/
 
-static void fy_uart_tx_cplt_callback(UART_HandleTypeDef *huart)
+static void fy_uart_tx_dma_cplt_callback(DMA_HandleTypeDef *hdma)
 {
-    /* Look up fy_uart_t instance for this HAL handle */
-    fy_uart_t *uart = find_uart_by_huart(huart);
+    fy_uart_t *uart = find_uart_by_hdma(hdma);
     if (uart != NULL) {
-        ringBuffer_t *rb = uart->tx_rb;
+        FY_TRACE_EVENT(FY_TRACE_ID_UART_TX_DONE, uart->tx_active_len);
+        uart_tx_release(uart, uart->tx_active_len - uart->tx_released_len);
+        uart->tx_busy = 0;
+
+        fy_uart_tx_desc_t *desc = tx_queue_front(uart);
+        fy_uart_tx_done_fn_t done = NULL;
+        void *arg = NULL;
+        if (desc != NULL && desc->len == 0) {
+            done = desc->done;
+            arg = desc->arg;
+            tx_queue_pop(uart);
+        }
 
-        /* Update tail for the remaining part */
-        size_t half = uart->tx_active_len % 2 == 0?uart->tx_active_len/2:(uart->tx_active_len/2)+1;//dma奇数传输像上计算
-        size_t remaining = uart->tx_active_len - half;
-        
-        rb->read(rb, NULL, remaining);
-        uart->tx_active_len = 0;
+        /* chain the next segment first so the line never idles */
+        uart_tx_kick(uart);
+        if (!uart->tx_busy && uart->tx_line_active) {
+            uart->tx_line_active = 0;
+            uart->tx_busy_ticks += HAL_GetTick() - uart->tx_busy_since;
+        }
 
-        /* Check buffer count and transmit next chunk if available */
-        uart_try_transmit(uart);
+        if (done != NULL) {
+            done(uart, arg);
+        }
     }
 }
 
-static void fy_uart_tx_half_cplt_callback(UART_HandleTypeDef *huart)
+static void fy_uart_tx_dma_half_cplt_callback(DMA_HandleTypeDef *hdma)
 {
-    fy_uart_t *uart = find_uart_by_huart(huart);
+    fy_uart_t *uart = find_uart_by_hdma(hdma);
     if (uart != NULL) {
-        ringBuffer_t *rb = uart->tx_rb;
-
-        /* Update tail for the first half */
-        size_t half = uart->tx_active_len % 2 == 0?uart->tx_active_len/2:(uart->tx_active_len/2)+1;//dma奇数传输像上计算
-        if (half > 0) {
-            rb->read(rb, NULL, half);
+        /* free what the DMA has already moved so producers can refill early */
+        size_t moved = uart->tx_active_len - __HAL_DMA_GET_COUNTER(hdma);
+        FY_TRACE_EVENT(FY_TRACE_ID_UART_TX_HALF, moved);
+        if (moved > uart->tx_released_len) {
+            uart_tx_release(uart, moved - uart->tx_released_len);
         }
     }
 }
 
+static void fy_uart_tx_dma_error_callback(DMA_HandleTypeDef *hdma)
+{
+    fy_uart_t *uart = find_uart_by_hdma(hdma);
+    if (uart != NULL) {
+        /* drop the rest of the active segment and carry on with the queue */
+        FY_TRACE_EVENT(FY_TRACE_ID_UART_TX_ERROR, hdma->ErrorCode);
+        uart->tx_error_count++;
+        uart->tx_bytes -= uart->tx_active_len - uart->tx_released_len;
+        fy_uart_tx_dma_cplt_callback(hdma);
+    }
+}
+
 static void fy_uart_rx_cplt_callback(UART_HandleTypeDef *huart)
 {
     fy_uart_t *uart = find_uart_by_huart(huart);
     if (uart != NULL) {
         /* Push received byte to ringbuffer */
+        FY_TRACE_EVENT(FY_TRACE_ID_UART_RX, 1);
         uart->rx_rb->write(uart->rx_rb, &uart->rx_temp_byte, 1);
 
         /* Restart reception */
         HAL_UART_Receive_IT(huart, &uart->rx_temp_byte, 1);
+        if (uart->rx_notify) {
+            uart->rx_notify(uart, uart->rx_notify_arg);
+        }
     }
 }
+
+/* Publish bytes the RX DMA has written up to buffer offset `pos`. */
+static void uart_rx_dma_advance(fy_uart_t *uart, size_t pos)
+{
+    ringBuffer_t *rb = uart->rx_rb;
+    size_t head_idx = (size_t)(rb->rb_head(rb) - rb->buffer);
+
+    /* TC reports pos == size, the DMA has wrapped back to 0 */
+    if (pos >= rb->size) pos = 0;
+
+    size_t delta = (pos >= head_idx) ? (pos - head_idx) : (rb->size - head_idx + pos);
+    if (delta == 0) return;
+
+    FY_TRACE_EVENT(FY_TRACE_ID_UART_RX, delta);
+    /* data is already in place, only move head */
+    if (rb->write(rb, NULL, delta) < delta) {
+        uart->rx_overrun_count++;
+    }
+    if (uart->rx_notify) {
+        uart->rx_notify(uart, uart->rx_notify_arg);
+    }
+}
+
+static int32_t uart_rx_start(fy_uart_t *uart)
+{
+    if (uart->rx_mode == FY_UART_RX_DMA_IDLE) {
+        ringBuffer_t *rb = uart->rx_rb;
+        if (HAL_UARTEx_ReceiveToIdle_DMA(uart->huart, rb->buffer, (uint16_t)rb->size) != HAL_OK) {
+            return -1;
+        }
+        /* Overrun/noise/framing errors would make HAL abort the circular transfer;
+           the bytes are lost either way, keep the DMA running instead */
+        __HAL_UART_DISABLE_IT(uart->huart, UART_IT_ERR);
+        __HAL_UART_DISABLE_IT(uart->huart, UART_IT_PE);
+        return 0;
+    }
+    return (HAL_UART_Receive_IT(uart->huart, &uart->rx_temp_byte, 1) == HAL_OK) ? 0 : -1;
+}
+
+static void fy_uart_rx_event_callback(UART_HandleTypeDef *huart, uint16_t pos)
+{
+    fy_uart_t *uart = find_uart_by_huart(huart);
+    if (uart != NULL) {
+        /* HT, TC and IDLE all report the current DMA write offset */
+        uart_rx_dma_advance(uart, pos);
+    }
+}
+
+static void fy_uart_error_callback(UART_HandleTypeDef *huart)
+{
+    fy_uart_t *uart = find_uart_by_huart(huart);
+    if (uart != NULL) {
+        FY_TRACE_EVENT(FY_TRACE_ID_UART_ERROR, huart->ErrorCode);
+        uart->rx_error_count++;
+        if (huart->RxState != HAL_UART_STATE_READY) return;
+
+        if (uart->rx_mode == FY_UART_RX_DMA_IDLE) {
+            /* a restarted DMA writes from offset 0 again, move head there so
+               the bookkeeping stays aligned (the skipped bytes are stale) */
+            uart_rx_dma_advance(uart, uart->rx_rb->size);
+        }
+        uart_rx_start(uart);
+    }
+}
+
 uint16_t fy_uart_tx(fy_uart_t *uart, const uint8_t *data, size_t len)
 {
     if (uart == NULL || data == NULL || len == 0) return 0;
 
+    /* a full queue can only take more ring data by growing the last ring descriptor */
+    fy_uart_tx_desc_t *back = tx_queue_back(uart);
+    if (uart->tx_q_count >= FY_UART_TX_QUEUE_LEN && (back == NULL || back->data != NULL)) {
+        return 0;
+    }
+
     /* 1. Put data into txbuffer (updates head) */
-    uint16_t tx_len = uart->tx_rb->write(uart->tx_rb, data, len);
+    size_t tx_len = uart->tx_rb->write(uart->tx_rb, data, len);
+    if (tx_len == 0) return 0;
+
+    /* 2. Queue it, merging with a trailing ring descriptor, and kick the DMA.
+       An ISR may have taken the last slot with fy_uart_tx_buffer since the check above;
+       then the bytes have no descriptor and are taken back out of the ring. */
+    FY_UART_ENTER_CRITICAL();
+    back = tx_queue_back(uart);
+    if (back != NULL && back->data == NULL) {
+        back->len += tx_len;
+    } else if (tx_queue_push(uart, NULL, tx_len, NULL, NULL) != 0) {
+        tx_rb_unwrite(uart->tx_rb, tx_len);
+        tx_len = 0;
+    }
+    uart_tx_kick(uart);
+    FY_UART_EXIT_CRITICAL();
+    return (uint16_t)tx_len;
+}
+
+int32_t fy_uart_tx_buffer(fy_uart_t *uart, const uint8_t *data, size_t len, fy_uart_tx_done_fn_t done, void *arg)
+{
+    if (uart == NULL || data == NULL || len == 0) return -1;
 
-    /* 2. Try to transmit if UART is ready */
-    /* Check if DMA is not busy. HAL_UART_Transmit_DMA checks state internally 
-       but we can check gState to avoid function call overhead or logic issues */
-    if (uart->huart->gState == HAL_UART_STATE_READY) {
-        uart_try_transmit(uart);
+    FY_UART_ENTER_CRITICAL();
+    int32_t ret = tx_queue_push(uart, data, len, done, arg);
+    if (ret == 0) {
+        uart_tx_kick(uart);
     }
-    return tx_len;
+    FY_UART_EXIT_CRITICAL();
+    return ret;
+}
+
+uint32_t fy_uart_tx_line_utilization(const fy_uart_t *uart)
+{
+    if (uart == NULL) return 0;
+
+    uint32_t busy_ms = uart->tx_busy_ticks;
+    if (uart->tx_line_active) {
+        busy_ms += HAL_GetTick() - uart->tx_busy_since;
+    }
+    uint64_t capacity_bits = (uint64_t)uart->huart->Init.BaudRate * busy_ms;
+    if (capacity_bits == 0) return 0;
+
+    /* permille of the theoretical byte rate while the engine was active */
+    uint64_t sent_bits = (uint64_t)uart->tx_bytes * FY_UART_BITS_PER_BYTE * 1000U;
+    return (uint32_t)(sent_bits * 1000U / capacity_bits);
+}
+
+/* 在fy_uart_init之后调用，notify为NULL时取消 */
+void fy_uart_set_rx_notify(fy_uart_t *uart, fy_uart_rx_notify_fn_t notify, void *arg)
+{
+    if (uart == NULL) return;
+    FY_UART_ENTER_CRITICAL();
+    uart->rx_notify_arg = arg;
+    uart->rx_notify = notify;
+    FY_UART_EXIT_CRITICAL();
 }
 
 uint16_t fy_uart_rx(fy_uart_t *fy_uart, uint8_t *out, size_t len)
@@ -131,7 +372,14 @@ uint16_t fy_uart_rx(fy_uart_t *fy_uart, uint8_t *out, size_t len)
 void fy_uart_clear_txRb(fy_uart_t *uart)
 {
     if (uart == NULL) return;
-    uart->rx_rb->clear(uart->rx_rb);
+    FY_UART_ENTER_CRITICAL();
+    /* only safe while nothing is in flight */
+    if (!uart->tx_busy) {
+        uart->tx_rb->clear(uart->tx_rb);
+        uart->tx_q_head = 0;
+        uart->tx_q_count = 0;
+    }
+    FY_UART_EXIT_CRITICAL();
 }
 
 void fy_uart_clear_rxRb(fy_uart_t *uart)
@@ -141,14 +389,39 @@ void fy_uart_clear_rxRb(fy_uart_t *uart)
 }
 
 int32_t fy_uart_init(fy_uart_t *uart, UART_HandleTypeDef *huart, ringBuffer_t* rx_rb, ringBuffer_t* tx_rb)
+{
+    return fy_uart_init_ex(uart, huart, rx_rb, tx_rb, FY_UART_RX_IT);
+}
+
+int32_t fy_uart_init_ex(fy_uart_t *uart, UART_HandleTypeDef *huart, ringBuffer_t* rx_rb, ringBuffer_t* tx_rb, fy_uart_rx_mode_t rx_mode)
 {
     if (uart == NULL || huart == NULL || rx_rb == NULL || tx_rb == NULL) return -1;
-    
+    if (huart->hdmatx == NULL) return -1;
+    if (rx_mode == FY_UART_RX_DMA_IDLE &&
+        (huart->hdmarx == NULL || huart->hdmarx->Init.Mode != DMA_CIRCULAR || rx_rb->size > 0xFFFFU)) {
+        return -1;
+    }
+
     uart->huart = huart;
     uart->rx_rb = rx_rb;
 
     uart->tx_rb = tx_rb;
     uart->tx_active_len = 0;
+    uart->tx_released_len = 0;
+    uart->tx_q_head = 0;
+    uart->tx_q_count = 0;
+    uart->tx_busy = 0;
+    uart->tx_line_active = 0;
+    uart->tx_busy_since = 0;
+    uart->tx_busy_ticks = 0;
+    uart->tx_bytes = 0;
+    uart->tx_dma_starts = 0;
+    uart->tx_error_count = 0;
+    uart->rx_mode = rx_mode;
+    uart->rx_overrun_count = 0;
+    uart->rx_error_count = 0;
+    uart->rx_notify = NULL;
+    uart->rx_notify_arg = NULL;
     uart->uartRx = fy_uart_rx;
     uart->uartTx = fy_uart_tx;
     uart->uartClear_txBuffer = fy_uart_clear_txRb;
@@ -161,20 +434,47 @@ int32_t fy_uart_init(fy_uart_t *uart, UART_HandleTypeDef *huart, ringBuffer_t* r
     /* Register locks if needed (optional, user can do it outside) */
 
     /* Register Callbacks */
-    HAL_UART_RegisterCallback(huart, HAL_UART_TX_COMPLETE_CB_ID, fy_uart_tx_cplt_callback);
-    HAL_UART_RegisterCallback(huart, HAL_UART_TX_HALFCOMPLETE_CB_ID, fy_uart_tx_half_cplt_callback);
-    HAL_UART_RegisterCallback(huart, HAL_UART_RX_COMPLETE_CB_ID, fy_uart_rx_cplt_callback);
+    /* TX runs on the DMA channel directly, the USART only needs DMAT set once */
+    huart->hdmatx->XferCpltCallback = fy_uart_tx_dma_cplt_callback;
+    huart->hdmatx->XferHalfCpltCallback = fy_uart_tx_dma_half_cplt_callback;
+    huart->hdmatx->XferErrorCallback = fy_uart_tx_dma_error_callback;
+    ATOMIC_SET_BIT(huart->Instance->CR3, USART_CR3_DMAT);
+    HAL_UART_RegisterCallback(huart, HAL_UART_ERROR_CB_ID, fy_uart_error_callback);
+    if (rx_mode == FY_UART_RX_DMA_IDLE) {
+        /* DMA writes from offset 0, the ring must start there too */
+        rx_rb->clear(rx_rb);
+        HAL_UART_RegisterRxEventCallback(huart, fy_uart_rx_event_callback);
+    } else {
+        HAL_UART_RegisterCallback(huart, HAL_UART_RX_COMPLETE_CB_ID, fy_uart_rx_cplt_callback);
+    }
 
     /* Start Reception */
-    HAL_UART_Receive_IT(huart, &uart->rx_temp_byte, 1);
-    return 0;
+    return uart_rx_start(uart);
 }
 
+int32_t fy_uart_deinit(fy_uart_t *uart)
+{
+    if (uart == NULL || uart->huart == NULL) return -1;
+    UART_HandleTypeDef *huart = uart->huart;
+
+    /* stop both directions, DMAT is still set so HAL aborts hdmatx as well */
+    HAL_UART_Abort(huart);
+    ATOMIC_CLEAR_BIT(huart->Instance->CR3, USART_CR3_DMAT);
+
+    huart->hdmatx->XferCpltCallback = NULL;
+    huart->hdmatx->XferHalfCpltCallback = NULL;
+    huart->hdmatx->XferErrorCallback = NULL;
+    HAL_UART_UnRegisterCallback(huart, HAL_UART_ERROR_CB_ID);
+    if (uart->rx_mode == FY_UART_RX_DMA_IDLE) {
+        HAL_UART_UnRegisterRxEventCallback(huart);
+    } else {
+        HAL_UART_UnRegisterCallback(huart, HAL_UART_RX_COMPLETE_CB_ID);
+    }
 
-
-
-
-
-
-
-
+    unregister_uart_instance(uart);
+    uart->tx_busy = 0;
+    uart->tx_line_active = 0;
+    uart->tx_q_head = 0;
+    uart->tx_q_count = 0;
+    return 0;
+}
@@ -0,0 +1,92 @@
+/*
+说明
+    片上微基准：注册的测试用例先预热warmup次，再计时运行iterations次，
+    输出每个用例的最小/中位数/最大周期数，用于驱动与中间件修改前后的对比。
+    每次运行前调用用例的prepare(不计时，用于恢复初始状态，例如等待串口发送完成)，
+    只对run计时；结果减去空run的最小耗时(计时本身的开销)。
+    计时期间不关中断，偶发的中断只影响最大值，比较时以最小值与中位数为准。
+
+输出格式(每行一条，以\n结束，由Tools/fy_bench.py收集与比较):
+    #bench,v1,unit=cycles,hz=72000000,n=101,warmup=8,overhead=12
+    bench,<name>,<n>,<min>,<median>,<max>
+    #bench,end
+    其他行(日志、用例自身的串口输出)由收集脚本忽略。
+
+移植:
+    fy_bench_init的port传NULL时使用目标板默认实现(fy_bench_port.c：DWT周期计数)，
+    DWT->CYCCNT不计数时(例如QEMU)改用SysTick计数值与HAL tick拼接的周期数。
+    主机上定义FY_BENCH_HOST编译，默认实现为clock_gettime(fy_bench_port_host.c，单位ns)。
+
+使用方法：
+    fy_bench_t bench; fy_bench_case_t c;
+    fy_bench_init(&bench, NULL, out_fn);
+    fy_bench_add(&bench, &c, "rb_write_64", prepare_fn, run_fn, arg);
+    fy_bench_cases_add(&bench, &uart1, wait_idle_fn); //内置的串口/环形缓冲区/日志用例
+    fy_bench_run_all(&bench);
+*/
+#ifndef __FY_BENCH_H
+#define __FY_BENCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef FY_BENCH_ITER_MAX
+#define FY_BENCH_ITER_MAX       101     //每个用例最多计时运行次数(样本缓冲区大小)
+#endif
+#define FY_BENCH_WARMUP         8       //默认预热次数
+#define FY_BENCH_LINE_MAX       96      //单行输出的最大长度
+
+typedef struct {
+    uint32_t (*cycles)(void);//计时用计数，只用差值
+    uint32_t hz;//计数频率
+    const char *unit;//计数单位，输出到结果头
+} fy_bench_port_t;
+
+typedef struct fy_bench_case fy_bench_case_t;
+
+typedef void (*fy_bench_fn_t)(void *arg);
+
+/* 结果输出，line不以\0结束 */
+typedef void (*fy_bench_out_fn_t)(const char *line, size_t len);
+
+typedef struct fy_bench_case {
+    //成员
+    const char *name;
+    fy_bench_fn_t prepare;//每次运行前调用，不计时，可为NULL
+    fy_bench_fn_t run;//计时部分
+    void *arg;
+    fy_bench_case_t *next;
+} fy_bench_case_t;
+
+typedef struct {
+    const char *name;
+    uint32_t n;//样本数
+    uint32_t min;
+    uint32_t median;
+    uint32_t max;
+} fy_bench_result_t;
+
+typedef struct {
+    fy_bench_port_t port;
+    fy_bench_case_t *cases;//按注册顺序
+    fy_bench_out_fn_t out;
+    uint32_t iterations;//计时运行次数，不超过FY_BENCH_ITER_MAX
+    uint32_t warmup;
+    uint32_t overhead;//空run的最小耗时，从每个样本中减去
+    uint32_t samples[FY_BENCH_ITER_MAX];
+} fy_bench_t;
+
+const fy_bench_port_t *fy_bench_port_default(void);
+
+int32_t fy_bench_init(fy_bench_t *bench, const fy_bench_port_t *port, fy_bench_out_fn_t out);
+int32_t fy_bench_set_iterations(fy_bench_t *bench, uint32_t iterations, uint32_t warmup);
+int32_t fy_bench_add(fy_bench_t *bench, fy_bench_case_t *c, const char *name,
+                     fy_bench_fn_t prepare, fy_bench_fn_t run, void *arg);
+int32_t fy_bench_run_case(fy_bench_t *bench, fy_bench_case_t *c, fy_bench_result_t *result);
+int32_t fy_bench_run_all(fy_bench_t *bench);
+
+/* 内置用例(fy_bench_cases.c)，wait_idle等待uart发送全部完成 */
+struct fy_uart;
+int32_t fy_bench_cases_add(fy_bench_t *bench, struct fy_uart *uart, void (*wait_idle)(struct fy_uart *uart));
+
+#endif
@@ -0,0 +1,157 @@
+/* fy_bench.c
+ * Microbenchmark runner: warm-up, timed runs, min/median/max per case.
+ */
+#include "fy_bench.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+static void bench_empty(void *arg)
+{
+    (void)arg;
+}
+
+static void bench_print(fy_bench_t *bench, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void bench_print(fy_bench_t *bench, const char *fmt, ...)
+{
+    char line[FY_BENCH_LINE_MAX];
+    va_list args;
+    int len;
+
+    if (bench->out == NULL) return;
+    va_start(args, fmt);
+    len = vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    if (len <= 0) return;
+    if ((size_t)len >= sizeof(line)) {
+        //截断时保留换行
+        len = sizeof(line) - 1;
+        line[len - 1] = '\n';
+    }
+    bench->out(line, (size_t)len);
+}
+
+/* 样本数不多，插入排序即可 */
+static void bench_sort(uint32_t *v, uint32_t n)
+{
+    for (uint32_t i = 1; i < n; i++) {
+        uint32_t x = v[i];
+        uint32_t j = i;
+
+        while (j > 0 && v[j - 1] > x) {
+            v[j] = v[j - 1];
+            j--;
+        }
+        v[j] = x;
+    }
+}
+
+/* 预热后运行iterations次，样本写入bench->samples，未减开销 */
+static void bench_sample(fy_bench_t *bench, fy_bench_fn_t prepare, fy_bench_fn_t run, void *arg)
+{
+    uint32_t total = bench->warmup + bench->iterations;
+
+    for (uint32_t i = 0; i < total; i++) {
+        uint32_t t0, t1;
+
+        if (prepare != NULL) {
+            prepare(arg);
+        }
+        t0 = bench->port.cycles();
+        run(arg);
+        t1 = bench->port.cycles();
+        if (i >= bench->warmup) {
+            bench->samples[i - bench->warmup] = t1 - t0;
+        }
+    }
+}
+
+int32_t fy_bench_init(fy_bench_t *bench, const fy_bench_port_t *port, fy_bench_out_fn_t out)
+{
+    if (bench == NULL) return -1;
+    if (port == NULL) {
+        port = fy_bench_port_default();
+    }
+    if (port == NULL || port->cycles == NULL) return -1;
+
+    memset(bench, 0, sizeof(*bench));
+    bench->port = *port;
+    bench->out = out;
+    bench->iterations = FY_BENCH_ITER_MAX;
+    bench->warmup = FY_BENCH_WARMUP;
+    return 0;
+}
+
+int32_t fy_bench_set_iterations(fy_bench_t *bench, uint32_t iterations, uint32_t warmup)
+{
+    if (bench == NULL || iterations == 0 || iterations > FY_BENCH_ITER_MAX) return -1;
+
+    bench->iterations = iterations;
+    bench->warmup = warmup;
+    return 0;
+}
+
+/* 用例按注册顺序运行，c由调用者分配，不能重复注册 */
+int32_t fy_bench_add(fy_bench_t *bench, fy_bench_case_t *c, const char *name,
+                     fy_bench_fn_t prepare, fy_bench_fn_t run, void *arg)
+{
+    fy_bench_case_t **pp;
+
+    if (bench == NULL || c == NULL || name == NULL || run == NULL) return -1;
+
+    c->name = name;
+    c->prepare = prepare;
+    c->run = run;
+    c->arg = arg;
+    c->next = NULL;
+    for (pp = &bench->cases; *pp != NULL; pp = &(*pp)->next) {
+        if (*pp == c) return -1;
+    }
+    *pp = c;
+    return 0;
+}
+
+int32_t fy_bench_run_case(fy_bench_t *bench, fy_bench_case_t *c, fy_bench_result_t *result)
+{
+    uint32_t n;
+
+    if (bench == NULL || c == NULL || result == NULL) return -1;
+
+    n = bench->iterations;
+    bench_sample(bench, c->prepare, c->run, c->arg);
+    for (uint32_t i = 0; i < n; i++) {
+        bench->samples[i] = (bench->samples[i] > bench->overhead) ? bench->samples[i] - bench->overhead : 0U;
+    }
+    bench_sort(bench->samples, n);
+    result->name = c->name;
+    result->n = n;
+    result->min = bench->samples[0];
+    result->median = bench->samples[n / 2];
+    result->max = bench->samples[n - 1];
+    return 0;
+}
+
+/* 先测量计时开销，再运行全部用例并逐行输出结果 */
+int32_t fy_bench_run_all(fy_bench_t *bench)
+{
+    fy_bench_result_t result;
+    fy_bench_case_t *c;
+
+    if (bench == NULL) return -1;
+
+    bench_sample(bench, NULL, bench_empty, NULL);
+    bench_sort(bench->samples, bench->iterations);
+    bench->overhead = bench->samples[0];
+
+    bench_print(bench, "#bench,v1,unit=%s,hz=%lu,n=%lu,warmup=%lu,overhead=%lu\n", bench->port.unit,
+                (unsigned long)bench->port.hz, (unsigned long)bench->iterations,
+                (unsigned long)bench->warmup, (unsigned long)bench->overhead);
+    for (c = bench->cases; c != NULL; c = c->next) {
+        fy_bench_run_case(bench, c, &result);
+        bench_print(bench, "bench,%s,%lu,%lu,%lu,%lu\n", result.name, (unsigned long)result.n,
+                    (unsigned long)result.min, (unsigned long)result.median, (unsigned long)result.max);
+    }
+    bench_print(bench, "#bench,end\n");
+    return 0;
+}
@@ -0,0 +1,193 @@
+/* fy_bench_cases.c
+ * Built-in benchmark cases: ring buffer copy, fy_uart transmit paths and
+ * interrupt callbacks, and the logger (synchronous and async), shared by the
+ * firmware and the host build on the HAL mock.
+ */
+#include "fy_bench.h"
+#include "fy_ringBuffer.h"
+#include "fy_uart.h"
+#include "elog.h"
+#include <string.h>
+
+#define BENCH_PAYLOAD_LEN   64U
+
+static fy_uart_t *bench_uart;
+static void (*bench_wait_idle)(fy_uart_t *uart);
+
+static uint8_t rb_storage[256];
+static uint8_t rb_spsc_storage[256];
+static ringBuffer_t rb;
+static ringBuffer_t rb_spsc;
+static uint8_t rb_out[BENCH_PAYLOAD_LEN];
+//以'#'开头、'\n'结束，收集脚本把串口上的这些数据当作注释行忽略
+static uint8_t payload[BENCH_PAYLOAD_LEN];
+
+static fy_bench_case_t case_rb_write;
+static fy_bench_case_t case_rb_read;
+static fy_bench_case_t case_rb_spsc_write;
+static fy_bench_case_t case_uart_tx_idle;
+static fy_bench_case_t case_uart_tx_busy;
+static fy_bench_case_t case_uart_tx_buffer;
+static fy_bench_case_t case_uart_tx_cplt_cb;
+static fy_bench_case_t case_uart_rx_event_cb;
+static fy_bench_case_t case_elog_sync_i;
+static fy_bench_case_t case_elog_async_i;
+static fy_bench_case_t case_elog_flush;
+static fy_bench_case_t case_elog_filtered;
+
+static void rb_clear(void *arg)
+{
+    ringBuffer_t *r = (ringBuffer_t *)arg;
+
+    r->clear(r);
+}
+
+static void rb_fill(void *arg)
+{
+    ringBuffer_t *r = (ringBuffer_t *)arg;
+
+    r->clear(r);
+    r->write(r, payload, sizeof(payload));
+}
+
+static void rb_write_run(void *arg)
+{
+    ringBuffer_t *r = (ringBuffer_t *)arg;
+
+    r->write(r, payload, sizeof(payload));
+}
+
+static void rb_read_run(void *arg)
+{
+    ringBuffer_t *r = (ringBuffer_t *)arg;
+
+    r->read(r, rb_out, sizeof(rb_out));
+}
+
+static void uart_idle(void *arg)
+{
+    (void)arg;
+    bench_wait_idle(bench_uart);
+}
+
+/* DMA正在发送时写入，只有拷贝，不启动DMA */
+static void uart_busy(void *arg)
+{
+    (void)arg;
+    bench_wait_idle(bench_uart);
+    bench_uart->uartTx(bench_uart, payload, sizeof(payload));
+    bench_uart->uartTx(bench_uart, payload, sizeof(payload));
+}
+
+/* 发送空闲时包含DMA启动 */
+static void uart_tx_run(void *arg)
+{
+    (void)arg;
+    bench_uart->uartTx(bench_uart, payload, sizeof(payload));
+}
+
+static void uart_tx_buffer_run(void *arg)
+{
+    (void)arg;
+    fy_uart_tx_buffer(bench_uart, payload, sizeof(payload), NULL, NULL);
+}
+
+/* 发送空闲时的DMA传输完成回调，与中断中HAL_DMA_IRQHandler之后的路径相同：句柄查找与发送引擎记账 */
+static void uart_tx_cplt_cb_run(void *arg)
+{
+    DMA_HandleTypeDef *hdma = bench_uart->huart->hdmatx;
+
+    (void)arg;
+    hdma->XferCpltCallback(hdma);
+}
+
+/* 没有新数据的接收事件(DMA_IDLE)：句柄查找与DMA位置换算；关中断，避免真正的接收中断改动head */
+static void uart_rx_event_cb_run(void *arg)
+{
+    ringBuffer_t *r = bench_uart->rx_rb;
+    uint32_t primask = __get_PRIMASK();
+
+    (void)arg;
+    __disable_irq();
+    bench_uart->huart->RxEventCallback(bench_uart->huart, (uint16_t)(r->rb_head(r) - r->buffer));
+    __set_PRIMASK(primask);
+}
+
+/* 日志队列与串口都空闲，异步输出打开 */
+static void elog_idle(void *arg)
+{
+    (void)arg;
+    elog_async_enabled(true);
+    elog_async_flush();
+    bench_wait_idle(bench_uart);
+}
+
+/* 关闭异步输出，计时部分为格式化、行池与写入串口；之后的用例由elog_idle恢复异步 */
+static void elog_sync_idle(void *arg)
+{
+    elog_idle(arg);
+    elog_async_enabled(false);
+}
+
+static void elog_async_i_run(void *arg)
+{
+    (void)arg;
+    elog_i("BENCH", "bench value:%d", 12345);
+}
+
+/* 队列中有一条记录，计时部分为格式化与写入串口 */
+static void elog_one(void *arg)
+{
+    elog_idle(arg);
+    elog_i("BENCH", "bench value:%d", 12345);
+}
+
+static void elog_flush_run(void *arg)
+{
+    (void)arg;
+    elog_async_flush();
+}
+
+/* "BENCH_OFF"只输出WARN及以上，计时部分为被tag级别过滤掉的日志调用 */
+static void elog_filter_set(void *arg)
+{
+    (void)arg;
+    elog_set_filter_tag_lvl("BENCH_OFF", ELOG_LVL_WARN);
+}
+
+static void elog_filtered_run(void *arg)
+{
+    (void)arg;
+    elog_d("BENCH_OFF", "bench value:%d", 12345);
+}
+
+/* 串口用例需要uart已初始化，日志用例需要elog已启动且输出到该uart */
+int32_t fy_bench_cases_add(fy_bench_t *bench, fy_uart_t *uart, void (*wait_idle)(fy_uart_t *uart))
+{
+    if (bench == NULL || uart == NULL || wait_idle == NULL) return -1;
+
+    bench_uart = uart;
+    bench_wait_idle = wait_idle;
+    memset(payload, '.', sizeof(payload));
+    payload[0] = '#';
+    payload[sizeof(payload) - 1] = '\n';
+    ringBuffer_init(&rb, rb_storage, sizeof(rb_storage));
+    if (ringBuffer_init_spsc(&rb_spsc, rb_spsc_storage, sizeof(rb_spsc_storage)) != 0) return -1;
+
+    fy_bench_add(bench, &case_rb_write, "rb_write_64", rb_clear, rb_write_run, &rb);
+    fy_bench_add(bench, &case_rb_read, "rb_read_64", rb_fill, rb_read_run, &rb);
+    fy_bench_add(bench, &case_rb_spsc_write, "rb_spsc_write_64", rb_clear, rb_write_run, &rb_spsc);
+    fy_bench_add(bench, &case_uart_tx_idle, "uart_tx_64_idle", uart_idle, uart_tx_run, NULL);
+    fy_bench_add(bench, &case_uart_tx_busy, "uart_tx_64_busy", uart_busy, uart_tx_run, NULL);
+    fy_bench_add(bench, &case_uart_tx_buffer, "uart_tx_buffer_64", uart_idle, uart_tx_buffer_run, NULL);
+    fy_bench_add(bench, &case_uart_tx_cplt_cb, "uart_tx_cplt_cb", uart_idle, uart_tx_cplt_cb_run, NULL);
+    if (uart->rx_mode == FY_UART_RX_DMA_IDLE) {
+        fy_bench_add(bench, &case_uart_rx_event_cb, "uart_rx_event_cb", NULL, uart_rx_event_cb_run, NULL);
+    }
+    //须在elog_async_i之前，其elog_idle恢复异步输出
+    fy_bench_add(bench, &case_elog_sync_i, "elog_sync_i", elog_sync_idle, elog_async_i_run, NULL);
+    fy_bench_add(bench, &case_elog_async_i, "elog_async_i", elog_idle, elog_async_i_run, NULL);
+    fy_bench_add(bench, &case_elog_flush, "elog_flush_1", elog_one, elog_flush_run, NULL);
+    fy_bench_add(bench, &case_elog_filtered, "elog_filtered_d", elog_filter_set, elog_filtered_run, NULL);
+    return 0;
+}
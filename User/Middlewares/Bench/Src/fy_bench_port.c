@@ -0,0 +1,44 @@
+/* fy_bench_port.c
+ * Default target port of the benchmark: DWT cycle counter, SysTick fallback
+ * for cores/emulators without a running CYCCNT.
+ */
+#include "fy_bench.h"
+#include "main.h"
+
+static uint32_t port_cycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+/* HAL tick * 每tick周期数 + SysTick已递减的部分，SysTick在tick中断前回绕时重读 */
+static uint32_t port_systick_cycles(void)
+{
+    uint32_t tick, val;
+
+    do {
+        tick = HAL_GetTick();
+        val = SysTick->VAL;
+    } while (tick != HAL_GetTick());
+    return tick / (uint32_t)HAL_GetTickFreq() * (SysTick->LOAD + 1U) + (SysTick->LOAD - val);
+}
+
+const fy_bench_port_t *fy_bench_port_default(void)
+{
+    static fy_bench_port_t port;
+
+    if (port.cycles == NULL) {
+        uint32_t start;
+
+        //只打开周期计数，不清零，调度器也在使用
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+        start = DWT->CYCCNT;
+        for (volatile uint32_t i = 0; i < 100U; i++) {
+        }
+        //QEMU等没有实现DWT时CYCCNT读出恒定值
+        port.cycles = (DWT->CYCCNT != start) ? port_cycles : port_systick_cycles;
+        port.hz = SystemCoreClock;
+        port.unit = "cycles";
+    }
+    return &port;
+}
@@ -0,0 +1,25 @@
+/* fy_bench_port_host.c
+ * Host port of the benchmark (FY_BENCH_HOST): CLOCK_MONOTONIC in ns.
+ */
+#include "fy_bench.h"
+#include <time.h>
+
+static uint32_t port_cycles(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    //只用差值，截断为32位约4.3秒回绕
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+}
+
+const fy_bench_port_t *fy_bench_port_default(void)
+{
+    static const fy_bench_port_t port = {
+        .cycles = port_cycles,
+        .hz = 1000000000UL,
+        .unit = "ns",
+    };
+
+    return &port;
+}
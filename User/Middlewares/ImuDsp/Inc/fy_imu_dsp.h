@@ -0,0 +1,93 @@
+/*
+说明
+    IMU数据块处理，基于CMSIS-DSP(q15)，一次处理一块样本而不是逐个处理：
+    1. 批量字节交换：MPU6050 FIFO中为大端int16，按32位字一次交换两个(fy_imu_dsp_swap16)
+    2. 按通道拆分后统一换算成q15：
+       加速度 arm_shift_q15 左移accel_shift位，q15的1.0对应FY_IMU_ACCEL_FS_G
+       陀螺仪 arm_scale_q15 乘以gyro_scale，q15的1.0对应FY_IMU_GYRO_FS_RAD rad/s
+    3. 每个通道一个arm_biquad_cascade_df1_q15二阶巴特沃斯低通(可级联)，原地滤波
+    4. 互补滤波姿态融合：每块积分一次陀螺仪块均值(未滤波的原始值)，再用块内最后一个滤波后的加速度样本修正roll/pitch，
+       yaw只积分陀螺仪(无磁力计)。浮点运算每块只做一次，M3没有FPU也可以承受。
+    温度通道不处理。
+    不依赖HAL，可在主机上编译(见本目录CMakeLists.txt与Tools/imu_dsp_check.py)。
+
+使用方法：
+    fy_imu_dsp_config_t cfg;
+    fy_imu_dsp_default_config(&cfg, 1000.0f); //采样率
+    按需修改cfg后调用fy_imu_dsp_init
+    原始FIFO字节：fy_imu_dsp_process_be(&dsp, frames, n)
+    已解析的样本：fy_imu_dsp_process(&dsp, &rec[0].sample.acc_x, sizeof(rec[0]) / 2, n)
+    处理后dsp.acc/dsp.gyro中为本块滤波结果(q15)，dsp.attitude为最新姿态(度)
+*/
+#ifndef __FY_IMU_DSP_H
+#define __FY_IMU_DSP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "arm_math.h"
+
+#ifndef FY_IMU_DSP_BLOCK_MAX
+#define FY_IMU_DSP_BLOCK_MAX        16  //一次处理的最大样本数，超过时分块处理
+#endif
+#ifndef FY_IMU_DSP_BIQUAD_STAGES
+#define FY_IMU_DSP_BIQUAD_STAGES    1   //每个通道的二阶节数
+#endif
+
+#define FY_IMU_DSP_FRAME_LEN        14  //一帧: ACC XYZ, TEMP, GYRO XYZ
+#define FY_IMU_DSP_FRAME_WORDS      7
+
+#define FY_IMU_ACCEL_FS_G           2.0f    //q15满量程对应的加速度(g)
+#define FY_IMU_GYRO_FS_RAD          64.0f   //q15满量程对应的角速度(rad/s)
+
+/* 姿态，单位度 */
+typedef struct {
+    float roll;
+    float pitch;
+    float yaw;
+} fy_imu_attitude_t;
+
+typedef struct {
+    float sample_rate;//采样率Hz
+    int8_t accel_shift;//原始加速度到q15的移位，±16g(2048LSB/g)时为3
+    q15_t gyro_scale_fract;//原始陀螺仪到q15的比例 = gyro_scale_fract / 32768 * 2^gyro_scale_shift
+    int8_t gyro_scale_shift;
+    float accel_cutoff;//加速度低通截止频率Hz
+    float gyro_cutoff;//陀螺仪低通截止频率Hz
+    float fusion_tau;//互补滤波时间常数s，越大越信任陀螺仪
+} fy_imu_dsp_config_t;
+
+typedef struct {
+    fy_imu_dsp_config_t cfg;
+    //滤波器
+    q15_t accel_coeffs[6 * FY_IMU_DSP_BIQUAD_STAGES];
+    q15_t gyro_coeffs[6 * FY_IMU_DSP_BIQUAD_STAGES];
+    q15_t state[6][4 * FY_IMU_DSP_BIQUAD_STAGES];
+    arm_biquad_casd_df1_inst_q15 biquad[6];//0~2加速度，3~5陀螺仪
+    //本块数据
+    q15_t acc[3][FY_IMU_DSP_BLOCK_MAX];
+    q15_t gyro[3][FY_IMU_DSP_BLOCK_MAX];
+    size_t block_len;
+    //姿态
+    fy_imu_attitude_t attitude;
+    uint8_t attitude_valid;//收到第一块后用加速度初始化姿态
+    uint32_t samples;//已处理的样本数
+} fy_imu_dsp_t;
+
+void fy_imu_dsp_default_config(fy_imu_dsp_config_t *cfg, float sample_rate);
+int32_t fy_imu_dsp_init(fy_imu_dsp_t *dsp, const fy_imu_dsp_config_t *cfg);
+void fy_imu_dsp_reset(fy_imu_dsp_t *dsp);
+void fy_imu_dsp_swap16(int16_t *dst, const uint8_t *src_be, size_t count);
+void fy_imu_dsp_process(fy_imu_dsp_t *dsp, const int16_t *samples, size_t stride, size_t n);
+void fy_imu_dsp_process_be(fy_imu_dsp_t *dsp, const uint8_t *frames, size_t n);
+int32_t fy_imu_dsp_lowpass_coeffs(q15_t *coeffs, float cutoff, float sample_rate);
+
+static inline float fy_imu_dsp_accel_g(q15_t v)
+{
+    return (float)v * (FY_IMU_ACCEL_FS_G / 32768.0f);
+}
+
+static inline float fy_imu_dsp_gyro_rad(q15_t v)
+{
+    return (float)v * (FY_IMU_GYRO_FS_RAD / 32768.0f);
+}
+#endif
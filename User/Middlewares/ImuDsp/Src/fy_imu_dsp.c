@@ -0,0 +1,248 @@
+#include "fy_imu_dsp.h"
+#include <string.h>
+#include <math.h>
+
+#define IMU_RAD2DEG             57.2957795f
+#define IMU_BIQUAD_POST_SHIFT   1       //系数按1/2存储，范围[-2, 2)
+#define IMU_BUTTERWORTH_Q       0.70710678f
+
+/* 32位字中两个16位数各自交换高低字节，M3上编译为一条REV16 */
+#define IMU_SWAP16X2(w)         ((((w) >> 8) & 0x00FF00FFUL) | (((w) << 8) & 0xFF00FF00UL))
+
+/*
+ * 默认配置，对应fy_mpu6050的寄存器设置：±16g(2048LSB/g)，±2000°/s(16.4LSB/(°/s))
+ */
+void fy_imu_dsp_default_config(fy_imu_dsp_config_t *cfg, float sample_rate)
+{
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->sample_rate = sample_rate;
+    cfg->accel_shift = 3;//2048LSB/g -> 16384/g，q15的1.0为2g
+    //pi / (180 * 16.4) / 64 * 32768 = 0.54488
+    cfg->gyro_scale_fract = 17855;
+    cfg->gyro_scale_shift = 0;
+    cfg->accel_cutoff = 20.0f;
+    cfg->gyro_cutoff = 50.0f;
+    cfg->fusion_tau = 0.5f;
+}
+
+/*
+ * 二阶巴特沃斯低通(双线性变换)，每节系数{b0, 0, b1, b2, -a1, -a2}，
+ * 按arm_biquad_cascade_df1_q15的要求以postShift=1存储
+ * 各节系数相同，级联后阶数为2*FY_IMU_DSP_BIQUAD_STAGES
+ */
+int32_t fy_imu_dsp_lowpass_coeffs(q15_t *coeffs, float cutoff, float sample_rate)
+{
+    float k, norm, c[5];
+    uint32_t i, j;
+
+    if (coeffs == NULL || cutoff <= 0.0f || cutoff >= sample_rate * 0.5f)
+    {
+        return -1;
+    }
+    k = tanf(PI * cutoff / sample_rate);
+    norm = 1.0f / (1.0f + k / IMU_BUTTERWORTH_Q + k * k);
+    c[0] = k * k * norm;
+    c[1] = 2.0f * c[0];
+    c[2] = c[0];
+    c[3] = -2.0f * (k * k - 1.0f) * norm;
+    c[4] = -(1.0f - k / IMU_BUTTERWORTH_Q + k * k) * norm;
+
+    for (i = 0; i < FY_IMU_DSP_BIQUAD_STAGES; i++)
+    {
+        q15_t *p = &coeffs[i * 6];
+        for (j = 0; j < 5; j++)
+        {
+            float v = c[j] * (32768.0f / (1 << IMU_BIQUAD_POST_SHIFT));
+            v = v >= 0.0f ? v + 0.5f : v - 0.5f;
+            if (v > 32767.0f) v = 32767.0f;
+            if (v < -32768.0f) v = -32768.0f;
+            p[j == 0 ? 0 : j + 1] = (q15_t)v;
+        }
+        p[1] = 0;
+    }
+    return 0;
+}
+
+int32_t fy_imu_dsp_init(fy_imu_dsp_t *dsp, const fy_imu_dsp_config_t *cfg)
+{
+    uint32_t i;
+
+    if (dsp == NULL || cfg == NULL || cfg->sample_rate <= 0.0f)
+    {
+        return -1;
+    }
+    memset(dsp, 0, sizeof(*dsp));
+    dsp->cfg = *cfg;
+    if (fy_imu_dsp_lowpass_coeffs(dsp->accel_coeffs, cfg->accel_cutoff, cfg->sample_rate) != 0 ||
+        fy_imu_dsp_lowpass_coeffs(dsp->gyro_coeffs, cfg->gyro_cutoff, cfg->sample_rate) != 0)
+    {
+        return -1;
+    }
+    for (i = 0; i < 6; i++)
+    {
+        arm_biquad_cascade_df1_init_q15(&dsp->biquad[i], FY_IMU_DSP_BIQUAD_STAGES,
+                                        i < 3 ? dsp->accel_coeffs : dsp->gyro_coeffs,
+                                        dsp->state[i], IMU_BIQUAD_POST_SHIFT);
+    }
+    return 0;
+}
+
+/*
+ * 清除滤波器状态与姿态，数据流中断(如FIFO溢出复位)后调用
+ */
+void fy_imu_dsp_reset(fy_imu_dsp_t *dsp)
+{
+    memset(dsp->state, 0, sizeof(dsp->state));
+    memset(&dsp->attitude, 0, sizeof(dsp->attitude));
+    dsp->attitude_valid = 0;
+    dsp->block_len = 0;
+}
+
+/*
+ * 批量大端转本机字节序，每次读写一个32位字(两个int16)
+ * src_be不要求对齐，count为int16个数
+ */
+void fy_imu_dsp_swap16(int16_t *dst, const uint8_t *src_be, size_t count)
+{
+    uint32_t w;
+
+    for (; count >= 2; count -= 2, src_be += 4, dst += 2)
+    {
+        memcpy(&w, src_be, sizeof(w));
+        w = IMU_SWAP16X2(w);
+        memcpy(dst, &w, sizeof(w));
+    }
+    if (count)
+    {
+        *dst = (int16_t)(((uint16_t)src_be[0] << 8) | src_be[1]);
+    }
+}
+
+static inline void imu_load(fy_imu_dsp_t *dsp, const int16_t *s, size_t i)
+{
+    dsp->acc[0][i] = s[0];
+    dsp->acc[1][i] = s[1];
+    dsp->acc[2][i] = s[2];
+    dsp->gyro[0][i] = s[4];
+    dsp->gyro[1][i] = s[5];
+    dsp->gyro[2][i] = s[6];
+}
+
+static inline float imu_wrap180(float a)
+{
+    if (a >= 180.0f) a -= 360.0f;
+    if (a < -180.0f) a += 360.0f;
+    return a;
+}
+
+/*
+ * 互补滤波，每块一次：
+ * 角度 += 陀螺仪块均值 * 块时长，再向加速度算出的角度靠拢(1 - alpha)
+ * 积分用换算前的原始值求和，q15换算和滤波的截断误差约为-0.5LSB/次，
+ * 低通放大后积分会产生明显的漂移
+ */
+static void imu_fuse(fy_imu_dsp_t *dsp, const int32_t *gyro_sum, size_t n)
+{
+    fy_imu_attitude_t *att = &dsp->attitude;
+    float dt = (float)n / dsp->cfg.sample_rate;
+    float alpha = dsp->cfg.fusion_tau / (dsp->cfg.fusion_tau + dt);
+    float ax = fy_imu_dsp_accel_g(dsp->acc[0][n - 1]);
+    float ay = fy_imu_dsp_accel_g(dsp->acc[1][n - 1]);
+    float az = fy_imu_dsp_accel_g(dsp->acc[2][n - 1]);
+    float roll_acc = atan2f(ay, az) * IMU_RAD2DEG;
+    float pitch_acc = atan2f(-ax, sqrtf(ay * ay + az * az)) * IMU_RAD2DEG;
+    //原始值 -> q15 -> rad/s -> 度，再乘块时长除以样本数
+    float k = (float)dsp->cfg.gyro_scale_fract / 32768.0f * ldexpf(1.0f, dsp->cfg.gyro_scale_shift) *
+              (FY_IMU_GYRO_FS_RAD / 32768.0f) * IMU_RAD2DEG * dt / (float)n;
+
+    if (!dsp->attitude_valid)
+    {
+        att->roll = roll_acc;
+        att->pitch = pitch_acc;
+        att->yaw = 0.0f;
+        dsp->attitude_valid = 1;
+        return;
+    }
+    att->roll = imu_wrap180(att->roll + (float)gyro_sum[0] * k);
+    att->pitch = imu_wrap180(att->pitch + (float)gyro_sum[1] * k);
+    att->yaw = imu_wrap180(att->yaw + (float)gyro_sum[2] * k);
+    //按差值修正，避免±180度处跳变
+    att->roll = imu_wrap180(att->roll + (1.0f - alpha) * imu_wrap180(roll_acc - att->roll));
+    att->pitch = imu_wrap180(att->pitch + (1.0f - alpha) * imu_wrap180(pitch_acc - att->pitch));
+}
+
+static void imu_run_block(fy_imu_dsp_t *dsp, size_t n)
+{
+    int32_t gyro_sum[3] = {0};
+    uint32_t i, j;
+
+    for (i = 0; i < 3; i++)
+    {
+        for (j = 0; j < n; j++)
+        {
+            gyro_sum[i] += dsp->gyro[i][j];
+        }
+        arm_shift_q15(dsp->acc[i], dsp->cfg.accel_shift, dsp->acc[i], (uint32_t)n);
+        arm_scale_q15(dsp->gyro[i], dsp->cfg.gyro_scale_fract, dsp->cfg.gyro_scale_shift,
+                      dsp->gyro[i], (uint32_t)n);
+    }
+    for (i = 0; i < 3; i++)
+    {
+        arm_biquad_cascade_df1_q15(&dsp->biquad[i], dsp->acc[i], dsp->acc[i], (uint32_t)n);
+        arm_biquad_cascade_df1_q15(&dsp->biquad[i + 3], dsp->gyro[i], dsp->gyro[i], (uint32_t)n);
+    }
+    imu_fuse(dsp, gyro_sum, n);
+    dsp->block_len = n;
+    dsp->samples += (uint32_t)n;
+}
+
+/*
+ * 处理已是本机字节序的样本
+ * samples: 第一个样本的acc_x，每个样本依次为ACC XYZ, TEMP, GYRO XYZ
+ * stride: 相邻样本间隔(int16个数)，紧密排列时为7
+ * n超过FY_IMU_DSP_BLOCK_MAX时分块处理，acc/gyro中只保留最后一块
+ */
+void fy_imu_dsp_process(fy_imu_dsp_t *dsp, const int16_t *samples, size_t stride, size_t n)
+{
+    size_t i, len;
+
+    while (n > 0)
+    {
+        len = n > FY_IMU_DSP_BLOCK_MAX ? FY_IMU_DSP_BLOCK_MAX : n;
+        for (i = 0; i < len; i++, samples += stride)
+        {
+            imu_load(dsp, samples, i);
+        }
+        imu_run_block(dsp, len);
+        n -= len;
+    }
+}
+
+/*
+ * 处理MPU6050 FIFO中的原始大端帧(每帧14字节)，n为帧数
+ * 每次交换两帧(7个32位字)后拆分到各通道
+ */
+void fy_imu_dsp_process_be(fy_imu_dsp_t *dsp, const uint8_t *frames, size_t n)
+{
+    int16_t tmp[2 * FY_IMU_DSP_FRAME_WORDS];
+    size_t i, len;
+
+    while (n > 0)
+    {
+        len = n > FY_IMU_DSP_BLOCK_MAX ? FY_IMU_DSP_BLOCK_MAX : n;
+        for (i = 0; i + 1 < len; i += 2, frames += 2 * FY_IMU_DSP_FRAME_LEN)
+        {
+            fy_imu_dsp_swap16(tmp, frames, 2 * FY_IMU_DSP_FRAME_WORDS);
+            imu_load(dsp, tmp, i);
+            imu_load(dsp, tmp + FY_IMU_DSP_FRAME_WORDS, i + 1);
+        }
+        if (i < len)
+        {
+            fy_imu_dsp_swap16(tmp, frames, FY_IMU_DSP_FRAME_WORDS);
+            imu_load(dsp, tmp, i);
+            frames += FY_IMU_DSP_FRAME_LEN;
+        }
+        imu_run_block(dsp, len);
+        n -= len;
+    }
+}
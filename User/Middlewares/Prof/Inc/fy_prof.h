@@ -0,0 +1,94 @@
+/*
+说明
+    采样剖析器：周期性中断读取被打断代码的PC与LR(硬件压入异常栈帧的第6、5个字)，
+    按(PC, LR)计数到哈希表中，需要时按行输出，由Tools/fy_prof.py对照ELF符号化，
+    输出按函数统计的平面剖析或火焰图(折叠栈)格式。LR只在被打断的函数还没有把它压栈时(叶函数)是调用者，
+    其他情况下可能是过时的值，主机端只把它当作一层调用者提示。
+
+采样源(fy_prof_port.c，CMake选项FY_PROF_SOURCE):
+    TIM3    TIM3更新中断，频率FY_PROF_HZ(默认997Hz，与1ms的tick和任务周期互质，避免采样与周期性工作同步)，
+            中断优先级0。只有优先级低于它的中断才会被采样到，调度器模式下user_main把其他外设中断降为1，
+            RTOS模式下外设中断本来就是configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY。
+    SYSTICK 在SysTick_Handler(HAL tick，1kHz)中采样，不占用定时器；SysTick优先级最低，
+            看不到中断中的代码，并且与1ms周期的工作同步，结果可能混叠。
+    关中断(PRIMASK)期间的采样会推迟到开中断处，时间计入临界区结束的位置。
+
+开销:
+    每次采样查表最多FY_PROF_PROBES次，不分配内存。采样函数自身的周期数(DWT)累计在overhead_cycles中，
+    输出时给出相对运行时间的千分比与单次最大值；异常进入/退出(约24周期)不在其中。
+    表满时丢弃的样本计入dropped。
+
+输出格式(fy_prof_dump，每行以\n结束):
+    #prof,v1,hz=997,samples=N,dropped=D,ms=M,overhead_permille=P,sample_max=C
+    prof,<pc>,<lr>,<count>          pc/lr为十六进制
+    #prof,end
+
+移植:
+    fy_prof_init的port传NULL时使用目标板默认实现。主机上定义FY_PROF_HOST编译，
+    由调用者提供port并直接调用fy_prof_sample(见Tools/prof_sim.c)。
+
+使用方法：
+    fy_prof_t prof;
+    fy_prof_init(&prof, NULL);
+    fy_prof_start(&prof);
+    需要时: fy_prof_dump(&prof, out_fn);   //输出后清零，继续采样
+*/
+#ifndef __FY_PROF_H
+#define __FY_PROF_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef FY_PROF_SLOTS
+#define FY_PROF_SLOTS       128     //哈希表大小，2的幂，每项12字节
+#endif
+#ifndef FY_PROF_PROBES
+#define FY_PROF_PROBES      8       //每次采样最多探测的表项数
+#endif
+#ifndef FY_PROF_HZ
+#define FY_PROF_HZ          997     //TIM3采样频率
+#endif
+#define FY_PROF_LINE_MAX    96
+
+typedef struct fy_prof fy_prof_t;
+
+/* 结果输出，line不以\0结束 */
+typedef void (*fy_prof_out_fn_t)(const char *line, size_t len);
+
+typedef struct {
+    int32_t (*start)(fy_prof_t *prof);//开始周期性调用fy_prof_sample
+    void (*stop)(void);
+    uint32_t (*cycles)(void);//统计采样开销
+    uint32_t (*now)(void);//ms
+    uint32_t cycles_per_ms;
+    uint32_t hz;//采样频率
+} fy_prof_port_t;
+
+typedef struct {
+    uint32_t pc;//0为空
+    uint32_t lr;
+    uint32_t count;
+} fy_prof_slot_t;
+
+typedef struct fy_prof {
+    fy_prof_port_t port;
+    volatile uint8_t running;
+    uint32_t start_ms;//本轮统计开始
+    //统计
+    uint32_t samples;
+    uint32_t dropped;//表满
+    uint32_t overhead_cycles;//采样函数累计周期数
+    uint32_t sample_cycles_max;
+    fy_prof_slot_t slots[FY_PROF_SLOTS];
+} fy_prof_t;
+
+const fy_prof_port_t *fy_prof_port_default(void);
+
+int32_t fy_prof_init(fy_prof_t *prof, const fy_prof_port_t *port);
+int32_t fy_prof_start(fy_prof_t *prof);
+void fy_prof_stop(fy_prof_t *prof);
+void fy_prof_reset(fy_prof_t *prof);
+void fy_prof_sample(fy_prof_t *prof, uint32_t pc, uint32_t lr);
+int32_t fy_prof_dump(fy_prof_t *prof, fy_prof_out_fn_t out);
+
+#endif
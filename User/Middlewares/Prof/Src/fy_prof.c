@@ -0,0 +1,157 @@
+/* fy_prof.c
+ * Sampling profiler: (PC, LR) histogram in an open-addressing table.
+ */
+#include "fy_prof.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#if (FY_PROF_SLOTS & (FY_PROF_SLOTS - 1)) != 0
+#error "FY_PROF_SLOTS must be a power of 2"
+#endif
+
+#ifdef FY_PROF_HOST
+/* 主机上没有默认实现，必须传入port */
+const fy_prof_port_t *fy_prof_port_default(void)
+{
+    return NULL;
+}
+#endif
+
+static void prof_print(fy_prof_out_fn_t out, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void prof_print(fy_prof_out_fn_t out, const char *fmt, ...)
+{
+    char line[FY_PROF_LINE_MAX];
+    va_list args;
+    int len;
+
+    va_start(args, fmt);
+    len = vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    if (len <= 0) return;
+    if ((size_t)len >= sizeof(line)) {
+        len = sizeof(line) - 1;
+        line[len - 1] = '\n';
+    }
+    out(line, (size_t)len);
+}
+
+int32_t fy_prof_init(fy_prof_t *prof, const fy_prof_port_t *port)
+{
+    if (prof == NULL) return -1;
+    if (port == NULL) {
+        port = fy_prof_port_default();
+    }
+    if (port == NULL || port->start == NULL || port->stop == NULL || port->cycles == NULL || port->now == NULL) {
+        return -1;
+    }
+
+    memset(prof, 0, sizeof(*prof));
+    prof->port = *port;
+    return 0;
+}
+
+int32_t fy_prof_start(fy_prof_t *prof)
+{
+    if (prof == NULL) return -1;
+    if (prof->running) return 0;
+
+    prof->start_ms = prof->port.now();
+    prof->running = 1;
+    if (prof->port.start(prof) != 0) {
+        prof->running = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void fy_prof_stop(fy_prof_t *prof)
+{
+    if (prof == NULL || !prof->running) return;
+
+    prof->port.stop();
+    prof->running = 0;
+}
+
+/* 停止时调用 */
+void fy_prof_reset(fy_prof_t *prof)
+{
+    if (prof == NULL) return;
+
+    memset(prof->slots, 0, sizeof(prof->slots));
+    prof->samples = 0;
+    prof->dropped = 0;
+    prof->overhead_cycles = 0;
+    prof->sample_cycles_max = 0;
+    prof->start_ms = prof->port.now();
+}
+
+/* 在采样中断中调用，查表最多FY_PROF_PROBES次 */
+void fy_prof_sample(fy_prof_t *prof, uint32_t pc, uint32_t lr)
+{
+    uint32_t t0 = prof->port.cycles();
+    uint32_t idx, i, dt;
+
+    if (!prof->running) return;
+
+    //Thumb指令按半字对齐，低位不参与散列
+    idx = ((pc >> 1) ^ (lr * 0x9E3779B1UL)) * 0x9E3779B1UL;
+    idx >>= 32 - 16;
+    for (i = 0; i < FY_PROF_PROBES; i++) {
+        fy_prof_slot_t *s = &prof->slots[(idx + i) & (FY_PROF_SLOTS - 1)];
+
+        if (s->pc == pc && s->lr == lr) {
+            s->count++;
+            break;
+        }
+        if (s->pc == 0) {
+            s->pc = pc;
+            s->lr = lr;
+            s->count = 1;
+            break;
+        }
+    }
+    if (i == FY_PROF_PROBES) {
+        prof->dropped++;
+    }
+    prof->samples++;
+    dt = prof->port.cycles() - t0;
+    prof->overhead_cycles += dt;
+    if (dt > prof->sample_cycles_max) {
+        prof->sample_cycles_max = dt;
+    }
+}
+
+/* 在任务中调用：暂停采样，逐行输出后清零，原来在运行时继续采样 */
+int32_t fy_prof_dump(fy_prof_t *prof, fy_prof_out_fn_t out)
+{
+    uint8_t was_running;
+    uint32_t ms, permille = 0;
+
+    if (prof == NULL || out == NULL) return -1;
+
+    was_running = prof->running;
+    fy_prof_stop(prof);
+    ms = prof->port.now() - prof->start_ms;
+    if (ms != 0 && prof->port.cycles_per_ms != 0) {
+        permille = (uint32_t)((uint64_t)prof->overhead_cycles * 1000U / ((uint64_t)ms * prof->port.cycles_per_ms));
+    }
+    prof_print(out, "#prof,v1,hz=%lu,samples=%lu,dropped=%lu,ms=%lu,overhead_permille=%lu,sample_max=%lu\n",
+               (unsigned long)prof->port.hz, (unsigned long)prof->samples, (unsigned long)prof->dropped,
+               (unsigned long)ms, (unsigned long)permille, (unsigned long)prof->sample_cycles_max);
+    for (uint32_t i = 0; i < FY_PROF_SLOTS; i++) {
+        const fy_prof_slot_t *s = &prof->slots[i];
+
+        if (s->pc != 0) {
+            prof_print(out, "prof,%08lx,%08lx,%lu\n", (unsigned long)s->pc, (unsigned long)s->lr,
+                       (unsigned long)s->count);
+        }
+    }
+    prof_print(out, "#prof,end\n");
+    fy_prof_reset(prof);
+    if (was_running) {
+        return fy_prof_start(prof);
+    }
+    return 0;
+}
@@ -0,0 +1,135 @@
+/* fy_prof_port.c
+ * Default target port of the sampling profiler: TIM3 update interrupt at
+ * FY_PROF_HZ (priority 0), or the HAL tick with FY_PROF_SYSTICK. The handlers
+ * pick the stacked exception frame (MSP or PSP by EXC_RETURN bit 2) and sample
+ * its PC/LR; DWT times the sampling itself.
+ */
+#include "fy_prof.h"
+#include "main.h"
+
+static fy_prof_t *active;
+
+static uint32_t port_cycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+static uint32_t port_now(void)
+{
+    return HAL_GetTick();
+}
+
+/* 异常栈帧: r0 r1 r2 r3 r12 lr pc xpsr */
+static void __attribute__((used)) prof_frame_sample(const uint32_t *frame)
+{
+    fy_prof_t *prof = active;
+
+    if (prof != NULL) {
+        fy_prof_sample(prof, frame[6], frame[5]);
+    }
+}
+
+#ifdef FY_PROF_SYSTICK
+/* stm32f1xx_it.c中的SysTick_Handler编译为SysTick_Handler_it(CMake中定义)，采样后跳转过去 */
+void SysTick_Handler_it(void);
+
+void __attribute__((naked)) SysTick_Handler(void)
+{
+    __asm volatile(
+        "tst lr, #4\n"
+        "ite eq\n"
+        "mrseq r0, msp\n"
+        "mrsne r0, psp\n"
+        "push {r4, lr}\n"
+        "bl prof_frame_sample\n"
+        "pop {r4, lr}\n"
+        "b SysTick_Handler_it\n");
+}
+
+static int32_t port_start(fy_prof_t *prof)
+{
+    active = prof;
+    return 0;
+}
+
+static void port_stop(void)
+{
+    active = NULL;
+}
+#else
+static void __attribute__((used)) prof_tim_sample(const uint32_t *frame)
+{
+    TIM3->SR = ~(uint32_t)TIM_SR_UIF;
+    prof_frame_sample(frame);
+}
+
+void __attribute__((naked)) TIM3_IRQHandler(void)
+{
+    __asm volatile(
+        "tst lr, #4\n"
+        "ite eq\n"
+        "mrseq r0, msp\n"
+        "mrsne r0, psp\n"
+        "b prof_tim_sample\n");
+}
+
+/* APB1分频时定时器时钟为PCLK1的2倍 */
+static uint32_t tim3_clock(void)
+{
+    uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+
+    return ((RCC->CFGR & RCC_CFGR_PPRE1) == RCC_CFGR_PPRE1_DIV1) ? pclk1 : pclk1 * 2U;
+}
+
+static int32_t port_start(fy_prof_t *prof)
+{
+    uint32_t ticks = tim3_clock() / prof->port.hz;
+    uint32_t psc = ticks / 65536U + 1U;
+
+    active = prof;
+    __HAL_RCC_TIM3_CLK_ENABLE();
+    TIM3->CR1 = 0;
+    TIM3->PSC = psc - 1U;
+    TIM3->ARR = ticks / psc - 1U;
+    TIM3->CNT = 0;
+    TIM3->EGR = TIM_EGR_UG;//装载PSC
+    TIM3->SR = 0;
+    TIM3->DIER = TIM_DIER_UIE;
+    HAL_NVIC_SetPriority(TIM3_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(TIM3_IRQn);
+    TIM3->CR1 = TIM_CR1_CEN;
+    return 0;
+}
+
+static void port_stop(void)
+{
+    TIM3->CR1 = 0;
+    TIM3->DIER = 0;
+    HAL_NVIC_DisableIRQ(TIM3_IRQn);
+    TIM3->SR = 0;
+    HAL_NVIC_ClearPendingIRQ(TIM3_IRQn);
+    active = NULL;
+}
+#endif
+
+const fy_prof_port_t *fy_prof_port_default(void)
+{
+    static fy_prof_port_t port;
+
+    if (port.start == NULL) {
+        //只打开周期计数，不清零，调度器也在使用
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+        port.start = port_start;
+        port.stop = port_stop;
+        port.cycles = port_cycles;
+        port.now = port_now;
+        port.cycles_per_ms = SystemCoreClock / 1000U;
+#ifdef FY_PROF_SYSTICK
+        port.hz = 1000U / (uint32_t)HAL_GetTickFreq();
+#else
+        port.hz = FY_PROF_HZ;
+#endif
+    }
+    return &port;
+}
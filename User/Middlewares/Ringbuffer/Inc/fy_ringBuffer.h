@@ -5,6 +5,9 @@
  *      RB_DEFINE_STATIC(myrb, 256);
  *  - Optionally register lock/unlock callbacks with `register_locks` member.
  *  - Use `myrb.write(&myrb, data, len)` and `myrb.read(&myrb, out, len)`.
+ *  - For one producer + one consumer (e.g. ISR -> thread) use
+ *    `ringBuffer_init_spsc` instead: no locks, no modulo, size must be 2^n
+ *    and at most 32768.
  */
 #ifndef __FY_RINGBUFFER_H
 #define __FY_RINGBUFFER_H
@@ -14,6 +17,12 @@
 
 typedef struct ringBuffer ringBuffer_t;
 
+/* 一段物理连续的缓冲区，用于零拷贝读写 */
+typedef struct {
+    uint8_t *data;
+    size_t len;
+} rb_span_t;
+
 typedef void (*rb_lock_fn_t)(void);
 typedef void (*rb_unlock_fn_t)(void);
 typedef size_t (*rb_read_fn_t)(ringBuffer_t *rb, uint8_t *dst, size_t len);
@@ -22,9 +31,11 @@ typedef size_t (*rb_write_fn_t)(ringBuffer_t *rb, const uint8_t *src, size_t len
 struct ringBuffer {
     uint8_t *buffer;        /* pointer to storage */
     size_t size;            /* total buffer size */
-    size_t head;            /* write index */
-    size_t tail;            /* read index */
+    volatile size_t head;   /* write index (SPSC模式下为单调递增计数) */
+    volatile size_t tail;   /* read index (SPSC模式下为单调递增计数) */
+    size_t mask;            /* size - 1, 仅SPSC模式使用 */
     uint8_t use_lock;       /* 是否使用锁（0: 不使用, 1: 使用） */
+    uint8_t spsc;           /* 是否为无锁单生产者单消费者模式 */
 
     /* lock callbacks (can be NULL, in which case no locking performed) */
     rb_lock_fn_t lock_read;
@@ -42,21 +53,44 @@ struct ringBuffer {
     uint16_t (*used)(const ringBuffer_t *rb);
     uint8_t * (*rb_head)(ringBuffer_t *rb);
     uint8_t * (*rb_tail)(ringBuffer_t *rb);
+
+    /* zero-copy helpers: 返回的 span 只到物理缓冲区末尾，回绕部分需再调用一次 */
+    rb_span_t (*reserve)(ringBuffer_t *rb, size_t len);//可写连续空间，最多len
+    void (*commit)(ringBuffer_t *rb, size_t n);//发布已写入reserve区域的n字节
+    rb_span_t (*peek)(ringBuffer_t *rb);//可读连续数据
+    void (*consume)(ringBuffer_t *rb, size_t n);//释放peek区域的前n字节
 };
 
 /* Public API - implementations in Ringbuffer.c */
 void ringBuffer_init(ringBuffer_t *rb, uint8_t *buffer, size_t size);
+int32_t ringBuffer_init_spsc(ringBuffer_t *rb, uint8_t *buffer, size_t size);
 void ringBuffer_clear(ringBuffer_t *rb);
 void ringBuffer_registerLocks(ringBuffer_t *rb, rb_lock_fn_t l_r, rb_unlock_fn_t u_r, rb_lock_fn_t l_w, rb_unlock_fn_t u_w);
 
 /* Note: RB_NoLock is internal (not exposed here). */
 
+/* Memory barrier used by the SPSC path. Cortex-M: DMB, host: full fence. */
+#ifndef RB_DMB
+#if defined(__arm__) || defined(__ARM_ARCH)
+#define RB_DMB()    __asm volatile ("dmb 0xF" ::: "memory")
+#else
+#define RB_DMB()    __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+#endif
+
 /* Helper usage:
  * - 用户手动定义 backing buffer 和 ringBuffer_t 变量，然后调用 `ringBuffer_init`:
  *     static uint8_t buf[256];
  *     ringBuffer_t rb;
  *     ringBuffer_init(&rb, buf, sizeof(buf));
  * - 可选注册锁函数：`ringBuffer_registerLocks(&rb, lock_r, unlock_r, lock_w, unlock_w);`
+ * - 单生产者单消费者（如 UART ISR 写、主循环读）可用无锁模式，size 必须为 2 的幂且不超过 32768
+ *   （used 返回 uint16_t）：
+ *     ringBuffer_init_spsc(&rb, buf, sizeof(buf));
+ *   此模式下 head/tail 单调递增，下标为 head & mask，整个 size 均可用；
+ *   不可再注册锁函数（registerLocks 会被忽略）。
+ * - 零拷贝：生产者 `span = rb.reserve(&rb, n)` 直接写入 span.data 后 `rb.commit(&rb, k)`；
+ *   消费者 `span = rb.peek(&rb)` 直接使用（如交给 DMA）后 `rb.consume(&rb, k)`。
  */
 
 #endif /* __RINGBUFFER_H */
@@ -94,6 +94,153 @@ size_t RB_Read(ringBuffer_t *rb, uint8_t *dst, size_t len)
 }
 
 
+/* SPSC (lock-free) path ---------------------------------------------------*/
+/* head 只由生产者写，tail 只由消费者写，二者均为单调递增计数，
+ * 借助无符号回绕，head - tail 始终是已用字节数（size 为 2 的幂）。 */
+
+static uint16_t rb_used_spsc(const ringBuffer_t *rb)
+{
+	return (uint16_t)(rb->head - rb->tail);
+}
+
+static uint8_t *rb_head_spsc(ringBuffer_t *rb)
+{
+	return &rb->buffer[rb->head & rb->mask];
+}
+
+static uint8_t *rb_tail_spsc(ringBuffer_t *rb)
+{
+	return &rb->buffer[rb->tail & rb->mask];
+}
+
+static size_t RB_Write_SPSC(ringBuffer_t *rb, const uint8_t *src, size_t len)
+{
+	if (rb == NULL || rb->buffer == NULL || len == 0) return 0;
+
+	size_t head = rb->head;
+	size_t tail = rb->tail;
+	/* tail 读取必须先于对空闲区的写入 */
+	RB_DMB();
+
+	size_t free_space = rb->size - (head - tail);
+	size_t to_write = (len <= free_space) ? len : free_space;
+	if (to_write == 0) return 0;
+
+	size_t idx = head & rb->mask;
+	size_t first = rb->size - idx;
+	if (first > to_write) first = to_write;
+	if (src != NULL)
+	{
+		memcpy(&rb->buffer[idx], src, first);
+		if (to_write > first) {
+			memcpy(&rb->buffer[0], src + first, to_write - first);
+		}
+	}
+
+	/* 数据写入完成后才发布 head */
+	RB_DMB();
+	rb->head = head + to_write;
+	return to_write;
+}
+
+static size_t RB_Read_SPSC(ringBuffer_t *rb, uint8_t *dst, size_t len)
+{
+	if (rb == NULL || rb->buffer == NULL || len == 0) return 0;
+
+	size_t tail = rb->tail;
+	size_t head = rb->head;
+	/* head 读取必须先于对数据区的读取 */
+	RB_DMB();
+
+	size_t used = head - tail;
+	size_t to_read = (len <= used) ? len : used;
+	if (to_read == 0) return 0;
+
+	size_t idx = tail & rb->mask;
+	size_t first = rb->size - idx;
+	if (first > to_read) first = to_read;
+	if (dst != NULL)
+	{
+		memcpy(dst, &rb->buffer[idx], first);
+		if (to_read > first) {
+			memcpy(dst + first, &rb->buffer[0], to_read - first);
+		}
+	}
+
+	/* 数据读取完成后才释放空间 */
+	RB_DMB();
+	rb->tail = tail + to_read;
+	return to_read;
+}
+
+/* Zero-copy helpers ---------------------------------------------------------*/
+
+static rb_span_t rb_reserve(ringBuffer_t *rb, size_t len)
+{
+	rb_span_t span = { NULL, 0 };
+	if (rb == NULL || rb->buffer == NULL || len == 0) return span;
+
+	size_t idx, free_space;
+	if (rb->spsc) {
+		size_t head = rb->head;
+		size_t tail = rb->tail;
+		RB_DMB();
+		idx = head & rb->mask;
+		free_space = rb->size - (head - tail);
+	} else {
+		rb->lock_write();
+		idx = rb->head;
+		/* keep one slot free to distinguish full vs empty */
+		free_space = rb->size - rb_used(rb) - 1;
+		rb->unlock_write();
+	}
+
+	size_t contiguous = rb->size - idx;
+	if (free_space > contiguous) free_space = contiguous;
+	span.data = &rb->buffer[idx];
+	span.len = (len <= free_space) ? len : free_space;
+	return span;
+}
+
+static void rb_commit(ringBuffer_t *rb, size_t n)
+{
+	if (rb == NULL || n == 0) return;
+	/* 空指针写入只推进 head */
+	rb->write(rb, NULL, n);
+}
+
+static rb_span_t rb_peek(ringBuffer_t *rb)
+{
+	rb_span_t span = { NULL, 0 };
+	if (rb == NULL || rb->buffer == NULL) return span;
+
+	size_t idx, used;
+	if (rb->spsc) {
+		size_t tail = rb->tail;
+		size_t head = rb->head;
+		RB_DMB();
+		idx = tail & rb->mask;
+		used = head - tail;
+	} else {
+		rb->lock_read();
+		idx = rb->tail;
+		used = rb_used(rb);
+		rb->unlock_read();
+	}
+
+	size_t contiguous = rb->size - idx;
+	span.data = &rb->buffer[idx];
+	span.len = (used <= contiguous) ? used : contiguous;
+	return span;
+}
+
+static void rb_consume(ringBuffer_t *rb, size_t n)
+{
+	if (rb == NULL || n == 0) return;
+	/* 空指针读取只推进 tail */
+	rb->read(rb, NULL, n);
+}
+
 /* Default no-op lock (file-local) */
 static void RB_NoLock(void) { (void)0; }
 
@@ -113,9 +260,36 @@ void ringBuffer_init(ringBuffer_t *rb, uint8_t *buffer, size_t size)
 	rb->init = ringBuffer_init;
 	rb->clear = ringBuffer_clear;
 	rb->use_lock = 0;
+	rb->spsc = 0;
+	rb->mask = 0;
 	rb->used = rb_used;
 	rb->rb_head = rb_head;
 	rb->rb_tail = rb_tail;
+	rb->reserve = rb_reserve;
+	rb->commit = rb_commit;
+	rb->peek = rb_peek;
+	rb->consume = rb_consume;
+}
+
+/**
+ * 初始化为无锁 SPSC 模式。
+ * @return 0 成功；-1 参数错误、size 不是 2 的幂或超过 UINT16_MAX
+ *         （整个 size 均可用，满时 used 须能返回 size）
+ */
+int32_t ringBuffer_init_spsc(ringBuffer_t *rb, uint8_t *buffer, size_t size)
+{
+	if (rb == NULL || buffer == NULL || size == 0) return -1;
+	if ((size & (size - 1)) != 0 || size > UINT16_MAX) return -1;
+
+	ringBuffer_init(rb, buffer, size);
+	rb->mask = size - 1;
+	rb->spsc = 1;
+	rb->read = RB_Read_SPSC;
+	rb->write = RB_Write_SPSC;
+	rb->used = rb_used_spsc;
+	rb->rb_head = rb_head_spsc;
+	rb->rb_tail = rb_tail_spsc;
+	return 0;
 }
 
 void ringBuffer_clear(ringBuffer_t *rb)
@@ -138,7 +312,7 @@ void ringBuffer_clear(ringBuffer_t *rb)
 
 void ringBuffer_registerLocks(ringBuffer_t *rb, rb_lock_fn_t l_r, rb_unlock_fn_t u_r, rb_lock_fn_t l_w, rb_unlock_fn_t u_w)
 {
-	if (rb == NULL) return;
+	if (rb == NULL || rb->spsc) return;
 	rb->lock_read = (l_r != NULL) ? l_r : RB_NoLock;
 	rb->unlock_read = (u_r != NULL) ? u_r : RB_NoLock;
 	rb->lock_write = (l_w != NULL) ? l_w : RB_NoLock;
@@ -0,0 +1,11 @@
+/*
+说明
+    CMSIS-FreeRTOS的os_systick.c用CMSIS_device_header包含器件头文件，
+    不经过CMSIS-Pack构建时由此文件给出(STM32F103xB)。
+*/
+#ifndef RTE_COMPONENTS_H
+#define RTE_COMPONENTS_H
+
+#define CMSIS_device_header "stm32f1xx.h"
+
+#endif
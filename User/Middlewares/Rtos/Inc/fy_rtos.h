@@ -0,0 +1,70 @@
+/*
+说明
+    CMSIS-RTOS2线程层，RTOS模式下user_main使用(CMake选项FY_USE_RTOS)。
+    只依赖cmsis_os2.h：目标板由FreeRTOS + CMSIS_RTOS_V2封装实现，主机上由Posix/cmsis_os2_posix.c(pthread)实现，
+    同一份线程代码可以在Linux上做并发测试(见Tools/rtos_stress.c)。
+
+锁:
+    环形缓冲区与easy logger的锁回调没有参数，FY_RTOS_LOCK_DEFINE为每把锁生成一个互斥量和一对lock/unlock函数，
+    直接传给ringBuffer_registerLocks或easy_logger_int_struct_t。
+    互斥量带优先级继承并可递归；内核启动前(单线程初始化阶段)加锁为空操作。
+    互斥量不能在中断中使用：中断一侧的缓冲区操作保持不加锁(例如串口发送缓冲区只注册写锁，DMA中断读取)。
+
+统计:
+    fy_rtos_thread_new创建的线程记录在表中(登记表不加锁，在osKernelStart之前或固定的一个线程中创建线程)，
+    fy_rtos_stats_update采样一次：
+    每个线程的栈历史最小剩余(osThreadGetStackSpace)与两次采样间的CPU占用，以及整体CPU占用。
+    运行时间由移植层提供(目标板为FreeRTOS运行时间统计，DWT周期计数，72MHz下约59秒回绕，两次采样间隔要短于此；
+    主机为线程CPU时间)。
+
+使用方法：
+    FY_RTOS_LOCK_DEFINE(log);
+    fy_rtos_init();
+    FY_RTOS_LOCK_INIT(log);
+    elog_init_struct.output_lock = log_lock; elog_init_struct.output_unlock = log_unlock;
+    osThreadId_t id = fy_rtos_thread_new("sensor", sensor_thread, NULL, 512, osPriorityHigh);
+    osKernelStart();
+    统计线程中: fy_rtos_stats_update(); 然后按fy_rtos_thread_info(i)输出
+*/
+#ifndef __FY_RTOS_H
+#define __FY_RTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "cmsis_os2.h"
+
+#define FY_RTOS_THREAD_MAX      8
+
+typedef struct {
+    osThreadId_t id;
+    const char *name;
+    uint32_t stack_size;//字节
+    uint32_t stack_free_min;//栈历史最小剩余(字节)
+    uint32_t load_permille;//两次采样间的CPU占用
+    uint32_t run_time_last;//上次采样时的累计运行时间(移植层单位)
+} fy_rtos_thread_t;
+
+#define FY_RTOS_LOCK_DEFINE(name) \
+    static osMutexId_t name##_mutex; \
+    static void name##_lock(void) { fy_rtos_mutex_lock(name##_mutex); } \
+    static void name##_unlock(void) { fy_rtos_mutex_unlock(name##_mutex); }
+
+#define FY_RTOS_LOCK_INIT(name)     (name##_mutex = fy_rtos_mutex_new(#name))
+
+int32_t fy_rtos_init(void);
+osThreadId_t fy_rtos_thread_new(const char *name, osThreadFunc_t fn, void *arg, uint32_t stack_size,
+                                osPriority_t prio);
+osMutexId_t fy_rtos_mutex_new(const char *name);
+void fy_rtos_mutex_lock(osMutexId_t mutex);
+void fy_rtos_mutex_unlock(osMutexId_t mutex);
+
+int32_t fy_rtos_stats_update(void);
+uint32_t fy_rtos_thread_count(void);
+const fy_rtos_thread_t *fy_rtos_thread_info(uint32_t index);
+uint32_t fy_rtos_load_permille(void);
+
+/* 移植层：时间单位任意，只用差值，允许32位回绕 */
+uint32_t fy_rtos_port_time(void);//当前时刻
+uint32_t fy_rtos_port_busy_time(void);//非空闲累计时间
+uint32_t fy_rtos_port_thread_time(osThreadId_t id);//线程累计运行时间
+#endif
@@ -0,0 +1,540 @@
+/* cmsis_os2_posix.c
+ * CMSIS-RTOS2 subset on POSIX threads, so that code written against cmsis_os2.h
+ * (fy_rtos and the RTOS mode of user_main) can run and be stress-tested on Linux.
+ *
+ * Implemented: kernel init/start/state/tick, threads (new, id, name, stack
+ * size/space, count, enumerate, exit, join), thread flags, delay/delay until and
+ * mutexes. Anything else is left undefined so that a missing function shows up
+ * at link time instead of misbehaving.
+ *
+ * Differences from an RTOS kernel:
+ *   - priorities are recorded but not enforced, threads run truly in parallel
+ *   - threads created before osKernelStart wait for it; osKernelStart returns
+ *   - stacks are painted like FreeRTOS does, but sized for x86-64/glibc
+ *     (FY_OS2_POSIX_STACK_SCALE times the requested size), so watermarks are
+ *     only comparable between host runs
+ *   - there is no interrupt context, osErrorISR is never returned
+ */
+#include "cmsis_os2.h"
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FY_OS2_POSIX_STACK_SCALE    16U
+#define FY_OS2_POSIX_STACK_MIN      (64U * 1024U)
+#define FY_OS2_POSIX_STACK_FILL     0xA5U
+#define FY_OS2_POSIX_TICK_FREQ      1000U
+
+typedef struct os2_thread {
+    struct os2_thread *next;//线程链表
+    pthread_t tid;
+    const char *name;
+    osThreadFunc_t func;
+    void *argument;
+    osPriority_t priority;
+    uint32_t attr_bits;
+    uint8_t *stack;
+    size_t stack_size;
+    osThreadState_t state;
+    //线程标志
+    pthread_mutex_t flags_lock;
+    pthread_cond_t flags_cond;
+    uint32_t flags;
+} os2_thread_t;
+
+typedef struct {
+    pthread_mutex_t mutex;
+    const char *name;
+    uint32_t attr_bits;
+} os2_mutex_t;
+
+static pthread_mutex_t kernel_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t kernel_start_cond = PTHREAD_COND_INITIALIZER;
+static osKernelState_t kernel_state = osKernelInactive;
+static struct timespec kernel_epoch;
+static os2_thread_t *thread_list;
+static __thread os2_thread_t *thread_self;
+
+/* ms -> 绝对时刻(CLOCK_MONOTONIC) */
+static void deadline_after(struct timespec *ts, uint32_t ms)
+{
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    ts->tv_sec += ms / 1000U;
+    ts->tv_nsec += (long)(ms % 1000U) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+/* pthread_mutex_timedlock只支持CLOCK_REALTIME */
+static void deadline_after_realtime(struct timespec *ts, uint32_t ms)
+{
+    clock_gettime(CLOCK_REALTIME, ts);
+    ts->tv_sec += ms / 1000U;
+    ts->tv_nsec += (long)(ms % 1000U) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+/* Kernel --------------------------------------------------------------------*/
+
+osStatus_t osKernelInitialize(void)
+{
+    osStatus_t status = osError;
+
+    pthread_mutex_lock(&kernel_lock);
+    if (kernel_state == osKernelInactive) {
+        clock_gettime(CLOCK_MONOTONIC, &kernel_epoch);
+        kernel_state = osKernelReady;
+        status = osOK;
+    }
+    pthread_mutex_unlock(&kernel_lock);
+    return status;
+}
+
+osStatus_t osKernelGetInfo(osVersion_t *version, char *id_buf, uint32_t id_size)
+{
+    if (version != NULL) {
+        version->api = 20010003U;
+        version->kernel = 0U;
+    }
+    if (id_buf != NULL && id_size > 0U) {
+        strncpy(id_buf, "POSIX", id_size - 1U);
+        id_buf[id_size - 1U] = '\0';
+    }
+    return osOK;
+}
+
+osKernelState_t osKernelGetState(void)
+{
+    osKernelState_t state;
+
+    pthread_mutex_lock(&kernel_lock);
+    state = kernel_state;
+    pthread_mutex_unlock(&kernel_lock);
+    return state;
+}
+
+/* 放行已创建的线程后返回，调用者自行等待(目标板上不返回) */
+osStatus_t osKernelStart(void)
+{
+    osStatus_t status = osError;
+
+    pthread_mutex_lock(&kernel_lock);
+    if (kernel_state == osKernelReady) {
+        kernel_state = osKernelRunning;
+        pthread_cond_broadcast(&kernel_start_cond);
+        status = osOK;
+    }
+    pthread_mutex_unlock(&kernel_lock);
+    return status;
+}
+
+uint32_t osKernelGetTickCount(void)
+{
+    struct timespec now;
+    uint64_t ms;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    ms = (uint64_t)(now.tv_sec - kernel_epoch.tv_sec) * 1000U;
+    ms += (uint64_t)((now.tv_nsec - kernel_epoch.tv_nsec) / 1000000L);
+    return (uint32_t)ms;
+}
+
+uint32_t osKernelGetTickFreq(void)
+{
+    return FY_OS2_POSIX_TICK_FREQ;
+}
+
+/* Threads -------------------------------------------------------------------*/
+
+static void thread_unlink(os2_thread_t *t)
+{
+    os2_thread_t **pp;
+
+    pthread_mutex_lock(&kernel_lock);
+    for (pp = &thread_list; *pp != NULL && *pp != t; pp = &(*pp)->next) {
+    }
+    if (*pp != NULL) *pp = t->next;
+    pthread_mutex_unlock(&kernel_lock);
+}
+
+static void thread_exit(os2_thread_t *t)
+{
+    pthread_mutex_lock(&kernel_lock);
+    t->state = osThreadTerminated;
+    pthread_mutex_unlock(&kernel_lock);
+    pthread_exit(NULL);
+}
+
+static void *thread_entry(void *arg)
+{
+    os2_thread_t *t = arg;
+
+    thread_self = t;
+    pthread_mutex_lock(&kernel_lock);
+    while (kernel_state != osKernelRunning) {
+        pthread_cond_wait(&kernel_start_cond, &kernel_lock);
+    }
+    t->state = osThreadRunning;
+    pthread_mutex_unlock(&kernel_lock);
+
+    t->func(t->argument);
+    //CMSIS要求线程函数不返回，这里按osThreadExit处理
+    thread_exit(t);
+    return NULL;
+}
+
+osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr_t *attr)
+{
+    os2_thread_t *t;
+    pthread_attr_t pattr;
+    pthread_condattr_t cattr;
+    uint32_t req = (attr != NULL && attr->stack_size != 0U) ? attr->stack_size : 512U;
+
+    if (func == NULL) return NULL;
+    t = calloc(1, sizeof(*t));
+    if (t == NULL) return NULL;
+
+    t->name = (attr != NULL) ? attr->name : NULL;
+    t->func = func;
+    t->argument = argument;
+    t->priority = (attr != NULL && attr->priority != osPriorityNone) ? attr->priority : osPriorityNormal;
+    t->attr_bits = (attr != NULL) ? attr->attr_bits : osThreadDetached;
+    t->stack_size = (size_t)req * FY_OS2_POSIX_STACK_SCALE;
+    if (t->stack_size < FY_OS2_POSIX_STACK_MIN) t->stack_size = FY_OS2_POSIX_STACK_MIN;
+    if (t->stack_size < PTHREAD_STACK_MIN) t->stack_size = PTHREAD_STACK_MIN;
+    t->stack = aligned_alloc(4096, t->stack_size);
+    if (t->stack == NULL) {
+        free(t);
+        return NULL;
+    }
+    //填充栈用于统计最大用量
+    memset(t->stack, FY_OS2_POSIX_STACK_FILL, t->stack_size);
+    t->state = osThreadReady;
+    pthread_mutex_init(&t->flags_lock, NULL);
+    //超时按CLOCK_MONOTONIC计算
+    pthread_condattr_init(&cattr);
+    pthread_condattr_setclock(&cattr, CLOCK_MONOTONIC);
+    pthread_cond_init(&t->flags_cond, &cattr);
+    pthread_condattr_destroy(&cattr);
+
+    pthread_mutex_lock(&kernel_lock);
+    t->next = thread_list;
+    thread_list = t;
+    pthread_mutex_unlock(&kernel_lock);
+
+    pthread_attr_init(&pattr);
+    pthread_attr_setstack(&pattr, t->stack, t->stack_size);
+    if ((t->attr_bits & osThreadJoinable) == 0U) {
+        pthread_attr_setdetachstate(&pattr, PTHREAD_CREATE_DETACHED);
+    }
+    if (pthread_create(&t->tid, &pattr, thread_entry, t) != 0) {
+        pthread_attr_destroy(&pattr);
+        thread_unlink(t);
+        free(t->stack);
+        free(t);
+        return NULL;
+    }
+    pthread_attr_destroy(&pattr);
+    return (osThreadId_t)t;
+}
+
+const char *osThreadGetName(osThreadId_t thread_id)
+{
+    os2_thread_t *t = (os2_thread_t *)thread_id;
+
+    return (t != NULL) ? t->name : NULL;
+}
+
+osThreadId_t osThreadGetId(void)
+{
+    return (osThreadId_t)thread_self;
+}
+
+osThreadState_t osThreadGetState(osThreadId_t thread_id)
+{
+    os2_thread_t *t = (os2_thread_t *)thread_id;
+    osThreadState_t state;
+
+    if (t == NULL) return osThreadError;
+    pthread_mutex_lock(&kernel_lock);
+    state = t->state;
+    pthread_mutex_unlock(&kernel_lock);
+    return state;
+}
+
+osPriority_t osThreadGetPriority(osThreadId_t thread_id)
+{
+    os2_thread_t *t = (os2_thread_t *)thread_id;
+
+    return (t != NULL) ? t->priority : osPriorityError;
+}
+
+uint32_t osThreadGetStackSize(osThreadId_t thread_id)
+{
+    os2_thread_t *t = (os2_thread_t *)thread_id;
+
+    return (t != NULL) ? (uint32_t)t->stack_size : 0U;
+}
+
+/* 栈向下生长，从低地址数未被改写的填充字节，即历史最小剩余 */
+uint32_t osThreadGetStackSpace(osThreadId_t thread_id)
+{
+    os2_thread_t *t = (os2_thread_t *)thread_id;
+    const volatile uint8_t *p;
+    size_t n = 0;
+
+    if (t == NULL) return 0U;
+    p = t->stack;
+    while (n < t->stack_size && p[n] == FY_OS2_POSIX_STACK_FILL) {
+        n++;
+    }
+    return (uint32_t)n;
+}
+
+/* 主机移植层(fy_rtos_port_posix.c)取线程CPU时间用 */
+pthread_t fy_os2_posix_thread_handle(osThreadId_t thread_id)
+{
+    return ((os2_thread_t *)thread_id)->tid;
+}
+
+uint32_t osThreadGetCount(void)
+{
+    os2_thread_t *t;
+    uint32_t n = 0;
+
+    pthread_mutex_lock(&kernel_lock);
+    for (t = thread_list; t != NULL; t = t->next) {
+        if (t->state != osThreadTerminated) n++;
+    }
+    pthread_mutex_unlock(&kernel_lock);
+    return n;
+}
+
+uint32_t osThreadEnumerate(osThreadId_t *thread_array, uint32_t array_items)
+{
+    os2_thread_t *t;
+    uint32_t n = 0;
+
+    if (thread_array == NULL || array_items == 0U) return 0U;
+    pthread_mutex_lock(&kernel_lock);
+    for (t = thread_list; t != NULL && n < array_items; t = t->next) {
+        if (t->state != osThreadTerminated) thread_array[n++] = (osThreadId_t)t;
+    }
+    pthread_mutex_unlock(&kernel_lock);
+    return n;
+}
+
+osStatus_t osThreadYield(void)
+{
+    sched_yield();
+    return osOK;
+}
+
+__NO_RETURN void osThreadExit(void)
+{
+    if (thread_self != NULL) {
+        thread_exit(thread_self);
+    }
+    pthread_exit(NULL);
+}
+
+/* 只有osThreadJoinable线程可以join，join后释放线程资源 */
+osStatus_t osThreadJoin(osThreadId_t thread_id)
+{
+    os2_thread_t *t = (os2_thread_t *)thread_id;
+
+    if (t == NULL || (t->attr_bits & osThreadJoinable) == 0U || t == thread_self) return osErrorParameter;
+    if (pthread_join(t->tid, NULL) != 0) return osErrorResource;
+
+    thread_unlink(t);
+    pthread_mutex_destroy(&t->flags_lock);
+    pthread_cond_destroy(&t->flags_cond);
+    free(t->stack);
+    free(t);
+    return osOK;
+}
+
+/* Thread flags --------------------------------------------------------------*/
+
+uint32_t osThreadFlagsSet(osThreadId_t thread_id, uint32_t flags)
+{
+    os2_thread_t *t = (os2_thread_t *)thread_id;
+    uint32_t ret;
+
+    if (t == NULL || (flags & osFlagsError) != 0U) return osFlagsErrorParameter;
+    pthread_mutex_lock(&t->flags_lock);
+    t->flags |= flags;
+    ret = t->flags;
+    pthread_cond_broadcast(&t->flags_cond);
+    pthread_mutex_unlock(&t->flags_lock);
+    return ret;
+}
+
+uint32_t osThreadFlagsClear(uint32_t flags)
+{
+    os2_thread_t *t = thread_self;
+    uint32_t ret;
+
+    if (t == NULL) return osFlagsErrorUnknown;
+    if ((flags & osFlagsError) != 0U) return osFlagsErrorParameter;
+    pthread_mutex_lock(&t->flags_lock);
+    ret = t->flags;
+    t->flags &= ~flags;
+    pthread_mutex_unlock(&t->flags_lock);
+    return ret;
+}
+
+uint32_t osThreadFlagsGet(void)
+{
+    os2_thread_t *t = thread_self;
+    uint32_t ret;
+
+    if (t == NULL) return 0U;
+    pthread_mutex_lock(&t->flags_lock);
+    ret = t->flags;
+    pthread_mutex_unlock(&t->flags_lock);
+    return ret;
+}
+
+uint32_t osThreadFlagsWait(uint32_t flags, uint32_t options, uint32_t timeout)
+{
+    os2_thread_t *t = thread_self;
+    struct timespec deadline;
+    uint32_t ret;
+    int rc = 0;
+
+    if (t == NULL) return osFlagsErrorUnknown;
+    if ((flags & osFlagsError) != 0U) return osFlagsErrorParameter;
+    if (timeout != osWaitForever && timeout != 0U) {
+        deadline_after(&deadline, timeout);
+    }
+
+    pthread_mutex_lock(&t->flags_lock);
+    while (1) {
+        ret = t->flags;
+        if ((options & osFlagsWaitAll) ? ((ret & flags) == flags) : ((ret & flags) != 0U)) {
+            if ((options & osFlagsNoClear) == 0U) {
+                t->flags &= ~flags;
+            }
+            break;
+        }
+        if (timeout == 0U) {
+            ret = osFlagsErrorResource;
+            break;
+        }
+        if (rc == ETIMEDOUT) {
+            ret = osFlagsErrorTimeout;
+            break;
+        }
+        if (timeout == osWaitForever) {
+            pthread_cond_wait(&t->flags_cond, &t->flags_lock);
+        } else {
+            rc = pthread_cond_timedwait(&t->flags_cond, &t->flags_lock, &deadline);
+        }
+    }
+    pthread_mutex_unlock(&t->flags_lock);
+    return ret;
+}
+
+/* Delay ---------------------------------------------------------------------*/
+
+osStatus_t osDelay(uint32_t ticks)
+{
+    struct timespec ts;
+
+    if (ticks == 0U) return osErrorParameter;
+    ts.tv_sec = ticks / FY_OS2_POSIX_TICK_FREQ;
+    ts.tv_nsec = (long)(ticks % FY_OS2_POSIX_TICK_FREQ) * (1000000000L / FY_OS2_POSIX_TICK_FREQ);
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+    return osOK;
+}
+
+osStatus_t osDelayUntil(uint32_t ticks)
+{
+    uint32_t delay = ticks - osKernelGetTickCount();
+
+    //与FreeRTOS一致：目标时刻已过(差值超过半个计数范围)时立即返回
+    if (delay == 0U || delay > 0x7FFFFFFFU) return osErrorParameter;
+    return osDelay(delay);
+}
+
+/* Mutex ---------------------------------------------------------------------*/
+
+osMutexId_t osMutexNew(const osMutexAttr_t *attr)
+{
+    os2_mutex_t *m = calloc(1, sizeof(*m));
+    pthread_mutexattr_t mattr;
+
+    if (m == NULL) return NULL;
+    m->name = (attr != NULL) ? attr->name : NULL;
+    m->attr_bits = (attr != NULL) ? attr->attr_bits : 0U;
+
+    pthread_mutexattr_init(&mattr);
+    //非所有者释放时返回错误，便于发现锁的误用
+    pthread_mutexattr_settype(&mattr, (m->attr_bits & osMutexRecursive) ? PTHREAD_MUTEX_RECURSIVE
+                                                                        : PTHREAD_MUTEX_ERRORCHECK);
+    if (m->attr_bits & osMutexPrioInherit) {
+        pthread_mutexattr_setprotocol(&mattr, PTHREAD_PRIO_INHERIT);
+    }
+    if (pthread_mutex_init(&m->mutex, &mattr) != 0) {
+        pthread_mutexattr_destroy(&mattr);
+        free(m);
+        return NULL;
+    }
+    pthread_mutexattr_destroy(&mattr);
+    return (osMutexId_t)m;
+}
+
+const char *osMutexGetName(osMutexId_t mutex_id)
+{
+    os2_mutex_t *m = (os2_mutex_t *)mutex_id;
+
+    return (m != NULL) ? m->name : NULL;
+}
+
+osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout)
+{
+    os2_mutex_t *m = (os2_mutex_t *)mutex_id;
+    struct timespec deadline;
+    int rc;
+
+    if (m == NULL) return osErrorParameter;
+    if (timeout == osWaitForever) {
+        rc = pthread_mutex_lock(&m->mutex);
+    } else if (timeout == 0U) {
+        rc = pthread_mutex_trylock(&m->mutex);
+    } else {
+        deadline_after_realtime(&deadline, timeout);
+        rc = pthread_mutex_timedlock(&m->mutex, &deadline);
+    }
+    if (rc == 0) return osOK;
+    if (rc == EBUSY || rc == EDEADLK) return osErrorResource;
+    return (rc == ETIMEDOUT) ? osErrorTimeout : osError;
+}
+
+osStatus_t osMutexRelease(osMutexId_t mutex_id)
+{
+    os2_mutex_t *m = (os2_mutex_t *)mutex_id;
+
+    if (m == NULL) return osErrorParameter;
+    return (pthread_mutex_unlock(&m->mutex) == 0) ? osOK : osErrorResource;
+}
+
+osStatus_t osMutexDelete(osMutexId_t mutex_id)
+{
+    os2_mutex_t *m = (os2_mutex_t *)mutex_id;
+
+    if (m == NULL) return osErrorParameter;
+    if (pthread_mutex_destroy(&m->mutex) != 0) return osErrorResource;
+    free(m);
+    return osOK;
+}
@@ -0,0 +1,126 @@
+#include "fy_rtos.h"
+#include <string.h>
+
+static fy_rtos_thread_t threads[FY_RTOS_THREAD_MAX];
+static uint32_t thread_count;
+static uint32_t load_permille;
+static uint32_t time_last;
+static uint32_t busy_last;
+
+static uint32_t permille(uint32_t part, uint32_t total)
+{
+    if (total == 0U) return 0U;
+    if (part >= total) return 1000U;
+    return (uint32_t)((uint64_t)part * 1000U / total);
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+int32_t fy_rtos_init(void)
+{
+    memset(threads, 0, sizeof(threads));
+    thread_count = 0;
+    load_permille = 0;
+    if (osKernelGetState() == osKernelInactive && osKernelInitialize() != osOK) return -1;
+    time_last = fy_rtos_port_time();
+    busy_last = fy_rtos_port_busy_time();
+    return 0;
+}
+
+/*
+ * 创建线程并登记到统计表，stack_size为字节；表满时仍创建，只是不统计
+ */
+osThreadId_t fy_rtos_thread_new(const char *name, osThreadFunc_t fn, void *arg, uint32_t stack_size,
+                                osPriority_t prio)
+{
+    osThreadAttr_t attr;
+    osThreadId_t id;
+    fy_rtos_thread_t *t;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.name = name;
+    attr.stack_size = stack_size;
+    attr.priority = prio;
+    id = osThreadNew(fn, arg, &attr);
+    if (id == NULL) return NULL;
+
+    if (thread_count < FY_RTOS_THREAD_MAX) {
+        t = &threads[thread_count];
+        t->id = id;
+        t->name = name;
+        t->stack_size = osThreadGetStackSize(id);
+        if (t->stack_size == 0U) {
+            t->stack_size = stack_size;
+        }
+        t->stack_free_min = t->stack_size;
+        t->load_permille = 0;
+        t->run_time_last = fy_rtos_port_thread_time(id);
+        thread_count++;
+    }
+    return id;
+}
+
+/* 递归、优先级继承的互斥量，用于FY_RTOS_LOCK_DEFINE */
+osMutexId_t fy_rtos_mutex_new(const char *name)
+{
+    osMutexAttr_t attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.name = name;
+    attr.attr_bits = osMutexRecursive | osMutexPrioInherit;
+    return osMutexNew(&attr);
+}
+
+/* 内核启动前只有一个执行流，不需要加锁 */
+void fy_rtos_mutex_lock(osMutexId_t mutex)
+{
+    if (mutex == NULL || osKernelGetState() != osKernelRunning) return;
+    osMutexAcquire(mutex, osWaitForever);
+}
+
+void fy_rtos_mutex_unlock(osMutexId_t mutex)
+{
+    if (mutex == NULL || osKernelGetState() != osKernelRunning) return;
+    osMutexRelease(mutex);
+}
+
+/*
+ * 采样栈水位与运行时间，计算自上次采样以来各线程与整体的CPU占用
+ * 在统计线程中周期调用
+ */
+int32_t fy_rtos_stats_update(void)
+{
+    uint32_t now = fy_rtos_port_time();
+    uint32_t busy = fy_rtos_port_busy_time();
+    uint32_t elapsed = now - time_last;
+    uint32_t run, i;
+    fy_rtos_thread_t *t;
+
+    for (i = 0; i < thread_count; i++) {
+        t = &threads[i];
+        t->stack_free_min = osThreadGetStackSpace(t->id);
+        run = fy_rtos_port_thread_time(t->id);
+        t->load_permille = permille(run - t->run_time_last, elapsed);
+        t->run_time_last = run;
+    }
+    load_permille = permille(busy - busy_last, elapsed);
+    time_last = now;
+    busy_last = busy;
+    return 0;
+}
+
+uint32_t fy_rtos_thread_count(void)
+{
+    return thread_count;
+}
+
+const fy_rtos_thread_t *fy_rtos_thread_info(uint32_t index)
+{
+    return (index < thread_count) ? &threads[index] : NULL;
+}
+
+/* 上次fy_rtos_stats_update时计算的整体CPU占用(千分比)，包含中断时间 */
+uint32_t fy_rtos_load_permille(void)
+{
+    return load_permille;
+}
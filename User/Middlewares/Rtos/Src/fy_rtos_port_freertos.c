@@ -0,0 +1,56 @@
+/* fy_rtos_port_freertos.c
+ * Target port of the threading layer: FreeRTOS run-time stats (DWT cycle counter,
+ * see FreeRTOSConfig.h) and the FreeRTOS application hooks.
+ */
+#include "fy_rtos.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "main.h"
+
+/* FreeRTOSConfig.h中portCONFIGURE_TIMER_FOR_RUN_TIME_STATS调用 */
+void fy_rtos_port_timer_init(void)
+{
+    //只打开周期计数，不清零，其他模块可能也在使用
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t fy_rtos_port_time(void)
+{
+    return DWT->CYCCNT;
+}
+
+static uint32_t task_run_time(TaskHandle_t task)
+{
+    TaskStatus_t status;
+
+    if (task == NULL) return 0;
+    vTaskGetInfo(task, &status, pdFALSE, eRunning);
+    return (uint32_t)status.ulRunTimeCounter;
+}
+
+/* 空闲任务之外的时间都算忙，包含中断；调度器启动前全部算忙 */
+uint32_t fy_rtos_port_busy_time(void)
+{
+    if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) return DWT->CYCCNT;
+    return DWT->CYCCNT - task_run_time(xTaskGetIdleTaskHandle());
+}
+
+uint32_t fy_rtos_port_thread_time(osThreadId_t id)
+{
+    return task_run_time((TaskHandle_t)id);
+}
+
+/* FreeRTOS hooks ------------------------------------------------------------*/
+
+void vApplicationStackOverflowHook(TaskHandle_t task, char *name)
+{
+    (void)task;
+    (void)name;
+    Error_Handler();
+}
+
+void vApplicationMallocFailedHook(void)
+{
+    Error_Handler();
+}
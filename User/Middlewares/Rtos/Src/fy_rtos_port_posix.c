@@ -0,0 +1,40 @@
+/* fy_rtos_port_posix.c
+ * Host port of the threading layer: wall clock and per-thread CPU time in us.
+ * The threads run in parallel on a multi-core host, so the busy time is the
+ * process CPU time divided by the number of online CPUs.
+ */
+#include "fy_rtos.h"
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+/* cmsis_os2_posix.c */
+extern pthread_t fy_os2_posix_thread_handle(osThreadId_t id);
+
+static uint64_t clock_us(clockid_t clock)
+{
+    struct timespec ts;
+
+    if (clock_gettime(clock, &ts) != 0) return 0;
+    return (uint64_t)ts.tv_sec * 1000000U + (uint64_t)ts.tv_nsec / 1000U;
+}
+
+uint32_t fy_rtos_port_time(void)
+{
+    return (uint32_t)clock_us(CLOCK_MONOTONIC);
+}
+
+uint32_t fy_rtos_port_busy_time(void)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return (uint32_t)(clock_us(CLOCK_PROCESS_CPUTIME_ID) / (uint64_t)(cpus > 0 ? cpus : 1));
+}
+
+uint32_t fy_rtos_port_thread_time(osThreadId_t id)
+{
+    clockid_t clock;
+
+    if (id == NULL || pthread_getcpuclockid(fy_os2_posix_thread_handle(id), &clock) != 0) return 0;
+    return (uint32_t)clock_us(clock);
+}
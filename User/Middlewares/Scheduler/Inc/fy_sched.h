@@ -0,0 +1,102 @@
+/*
+说明
+    协作式任务调度器，替代主循环中轮询HAL_GetTick的写法。
+    任务是一个回调函数，由事件驱动：中断中fy_sched_post置事件位，或定时器到期置FY_SCHED_EVT_TIMER。
+    主循环中fy_sched_run按优先级(数值小优先)运行有事件的任务，每运行一个任务后重新从最高优先级开始检查；
+    没有就绪任务时关中断再确认一次，然后进入睡眠(目标板__WFI)，任何中断都会唤醒。
+    任务之间不抢占，任务函数应尽快返回，长时间的工作拆成多次运行。
+    定时器链表按到期时间排序，只能在主循环(任务)中操作；fy_sched_post可在中断中调用。
+
+统计:
+    每个任务记录运行次数、运行时间(总计/最大)、最大延迟(事件产生到任务开始运行)、
+    定时器最大迟到(tick)与周期丢失次数；调度器记录睡眠时间，fy_sched_load_permille给出CPU占用率。
+    时间统计以port.cycles()为单位(目标板为DWT周期计数，72MHz下约59秒回绕，只用差值)。
+    fy_sched_set_hook注册的回调在每个任务运行前后与睡眠前后调用(睡眠时task为NULL)，用于事件跟踪。
+
+移植:
+    fy_sched_init的port传NULL时使用目标板默认实现(fy_sched_port.c：HAL_GetTick/DWT/__WFI)。
+    主机上定义FY_SCHED_HOST编译，由调用者提供模拟tick的port(见Tools/sched_sim.c)。
+
+使用方法：
+    fy_sched_t sched; fy_task_t task;
+    fy_sched_init(&sched, NULL);
+    fy_sched_task_add(&sched, &task, "imu", 0, imu_task_fn, NULL);
+    fy_sched_timer_start(&task, 10, 10); //10ms后首次运行，之后每10ms
+    中断中: fy_sched_post(&task, EVT_DATA);
+    fy_sched_run(&sched); //不返回
+*/
+#ifndef __FY_SCHED_H
+#define __FY_SCHED_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define FY_SCHED_EVT_TIMER      (1UL << 31)     //定时器到期，其余位由用户定义
+#define FY_SCHED_NO_TIMEOUT     0xFFFFFFFFUL
+
+typedef struct fy_sched fy_sched_t;
+typedef struct fy_task fy_task_t;
+
+/* 任务函数，events为本次取走的全部事件位 */
+typedef void (*fy_task_fn_t)(fy_task_t *task, uint32_t events);
+
+/* 运行钩子，begin为1时在任务(睡眠)开始前调用，为0时在结束后调用；睡眠时在关中断状态下调用 */
+typedef void (*fy_sched_hook_fn_t)(fy_task_t *task, uint32_t begin);
+
+typedef struct {
+    uint32_t (*now)(void);//定时器时基(tick，目标板为ms)
+    uint32_t (*cycles)(void);//统计用高精度计数
+    uint32_t cycles_per_tick;//用于换算，0表示未知
+    /* 无就绪任务时在关中断状态下调用，需在有中断挂起时返回；
+       timeout为距最近定时器到期的tick数，FY_SCHED_NO_TIMEOUT表示没有定时器 */
+    void (*idle)(uint32_t timeout);
+} fy_sched_port_t;
+
+typedef struct fy_task {
+    //成员
+    const char *name;
+    fy_task_fn_t fn;
+    void *arg;
+    uint8_t prio;//数值小优先
+    uint8_t timer_armed;
+    fy_sched_t *sched;
+    fy_task_t *next;//任务链表(按优先级)
+    fy_task_t *timer_next;//定时器链表(按到期时间)
+    volatile uint32_t events;//待处理事件位
+    volatile uint32_t ready_cycles;//事件从无到有的时刻
+    uint32_t deadline;//定时器到期tick
+    uint32_t period;//0为单次定时器
+    //统计
+    uint32_t runs;
+    uint32_t run_cycles;//累计运行时间
+    uint32_t run_cycles_max;
+    uint32_t latency_max;//事件产生到开始运行的最大间隔(cycles)
+    uint32_t late_max;//定时器到期到被发现的最大迟到(tick)
+    uint32_t overruns;//周期定时器因任务运行太久而跳过的周期数
+} fy_task_t;
+
+typedef struct fy_sched {
+    fy_sched_port_t port;
+    fy_task_t *tasks;
+    fy_task_t *timers;
+    volatile uint8_t pending;//有事件被置位，需要重新检查任务
+    fy_sched_hook_fn_t hook;
+    //统计
+    uint32_t stats_since;//统计起点(cycles)
+    uint32_t idle_cycles;//睡眠累计时间
+    uint32_t idle_count;//睡眠次数
+} fy_sched_t;
+
+int32_t fy_sched_init(fy_sched_t *sched, const fy_sched_port_t *port);
+int32_t fy_sched_task_add(fy_sched_t *sched, fy_task_t *task, const char *name, uint8_t prio,
+                          fy_task_fn_t fn, void *arg);
+int32_t fy_sched_timer_start(fy_task_t *task, uint32_t delay, uint32_t period);
+void fy_sched_timer_stop(fy_task_t *task);
+void fy_sched_post(fy_task_t *task, uint32_t events);
+int32_t fy_sched_run_once(fy_sched_t *sched);
+void fy_sched_run(fy_sched_t *sched);
+void fy_sched_stats_reset(fy_sched_t *sched);
+void fy_sched_set_hook(fy_sched_t *sched, fy_sched_hook_fn_t hook);
+uint32_t fy_sched_load_permille(const fy_sched_t *sched);
+const fy_sched_port_t *fy_sched_port_default(void);
+#endif
@@ -0,0 +1,282 @@
+#include "fy_sched.h"
+#include <string.h>
+
+#ifdef FY_SCHED_HOST
+/* 主机模拟为单线程，"中断"只在port.idle中同步发生 */
+#define FY_SCHED_ENTER_CRITICAL()   do {} while (0)
+#define FY_SCHED_EXIT_CRITICAL()    do {} while (0)
+#else
+#include "stm32f1xx.h"
+#define FY_SCHED_ENTER_CRITICAL()   uint32_t primask_ = __get_PRIMASK(); __disable_irq()
+#define FY_SCHED_EXIT_CRITICAL()    __set_PRIMASK(primask_)
+#endif
+
+#ifdef FY_SCHED_HOST
+/* 主机上没有默认实现，必须传入port */
+const fy_sched_port_t *fy_sched_port_default(void)
+{
+    return NULL;
+}
+#endif
+
+/* 回绕安全的时间比较：a在b之前(或相等) */
+#define TICK_BEFORE_EQ(a, b)    ((int32_t)((a) - (b)) <= 0)
+
+static void timer_insert(fy_sched_t *sched, fy_task_t *task)
+{
+    fy_task_t **pp = &sched->timers;
+
+    //相同到期时间按启动顺序排在后面
+    while (*pp != NULL && TICK_BEFORE_EQ((*pp)->deadline, task->deadline)) {
+        pp = &(*pp)->timer_next;
+    }
+    task->timer_next = *pp;
+    *pp = task;
+    task->timer_armed = 1;
+}
+
+static void timer_remove(fy_sched_t *sched, fy_task_t *task)
+{
+    fy_task_t **pp = &sched->timers;
+
+    while (*pp != NULL && *pp != task) {
+        pp = &(*pp)->timer_next;
+    }
+    if (*pp != NULL) {
+        *pp = task->timer_next;
+    }
+    task->timer_next = NULL;
+    task->timer_armed = 0;
+}
+
+/* 到期的定时器置FY_SCHED_EVT_TIMER，周期定时器按原相位重新排入 */
+static void timer_expire(fy_sched_t *sched, uint32_t now)
+{
+    fy_task_t *task;
+    uint32_t late, missed;
+
+    while ((task = sched->timers) != NULL && TICK_BEFORE_EQ(task->deadline, now)) {
+        sched->timers = task->timer_next;
+        task->timer_next = NULL;
+        task->timer_armed = 0;
+        late = now - task->deadline;
+        if (late > task->late_max) {
+            task->late_max = late;
+        }
+        if (task->period != 0) {
+            missed = late / task->period;
+            task->overruns += missed;
+            task->deadline += (missed + 1) * task->period;
+            timer_insert(sched, task);
+        }
+        fy_sched_post(task, FY_SCHED_EVT_TIMER);
+    }
+}
+
+/* 没有就绪任务时睡眠，关中断后再检查一次，避免检查与睡眠之间到来的事件被错过 */
+static void sched_idle(fy_sched_t *sched)
+{
+    uint32_t now, timeout, t0;
+
+    FY_SCHED_ENTER_CRITICAL();
+    now = sched->port.now();
+    if (!sched->pending && (sched->timers == NULL || !TICK_BEFORE_EQ(sched->timers->deadline, now))) {
+        timeout = (sched->timers != NULL) ? sched->timers->deadline - now : FY_SCHED_NO_TIMEOUT;
+        if (sched->hook != NULL) {
+            sched->hook(NULL, 1);
+        }
+        t0 = sched->port.cycles();
+        sched->port.idle(timeout);
+        //唤醒后中断仍被屏蔽，中断服务时间不计入睡眠
+        sched->idle_cycles += sched->port.cycles() - t0;
+        sched->idle_count++;
+        if (sched->hook != NULL) {
+            sched->hook(NULL, 0);
+        }
+    }
+    FY_SCHED_EXIT_CRITICAL();
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+int32_t fy_sched_init(fy_sched_t *sched, const fy_sched_port_t *port)
+{
+    if (sched == NULL) return -1;
+    if (port == NULL) {
+        port = fy_sched_port_default();
+    }
+    if (port == NULL || port->now == NULL || port->cycles == NULL || port->idle == NULL) return -1;
+
+    memset(sched, 0, sizeof(*sched));
+    sched->port = *port;
+    sched->stats_since = port->cycles();
+    return 0;
+}
+
+/*
+ * 注册任务，prio数值小优先，同优先级按注册顺序
+ * 注册前已post的事件保留
+ */
+int32_t fy_sched_task_add(fy_sched_t *sched, fy_task_t *task, const char *name, uint8_t prio,
+                          fy_task_fn_t fn, void *arg)
+{
+    fy_task_t **pp;
+    uint32_t events;
+
+    if (sched == NULL || task == NULL || fn == NULL || task->sched != NULL) return -1;
+
+    events = task->events;
+    memset(task, 0, sizeof(*task));
+    task->name = name;
+    task->fn = fn;
+    task->arg = arg;
+    task->prio = prio;
+    task->events = events;
+    task->ready_cycles = sched->port.cycles();
+
+    for (pp = &sched->tasks; *pp != NULL && (*pp)->prio <= prio; pp = &(*pp)->next) {
+    }
+    task->next = *pp;
+    *pp = task;
+    task->sched = sched;
+    if (events != 0) {
+        sched->pending = 1;
+    }
+    return 0;
+}
+
+/*
+ * 启动定时器，delay个tick后置FY_SCHED_EVT_TIMER，period非0时之后按周期重复
+ * 已启动时重新开始；只能在主循环(任务)中调用
+ */
+int32_t fy_sched_timer_start(fy_task_t *task, uint32_t delay, uint32_t period)
+{
+    fy_sched_t *sched;
+
+    if (task == NULL || (sched = task->sched) == NULL) return -1;
+    if (task->timer_armed) {
+        timer_remove(sched, task);
+    }
+    task->deadline = sched->port.now() + delay;
+    task->period = period;
+    timer_insert(sched, task);
+    return 0;
+}
+
+/*
+ * 停止定时器，并清除尚未处理的FY_SCHED_EVT_TIMER；只能在主循环(任务)中调用
+ */
+void fy_sched_timer_stop(fy_task_t *task)
+{
+    if (task == NULL || task->sched == NULL) return;
+    if (task->timer_armed) {
+        timer_remove(task->sched, task);
+    }
+    task->period = 0;
+    __atomic_fetch_and(&task->events, ~FY_SCHED_EVT_TIMER, __ATOMIC_ACQ_REL);
+}
+
+/*
+ * 置事件位，可在中断中调用，多次post在任务运行前合并
+ */
+void fy_sched_post(fy_task_t *task, uint32_t events)
+{
+    fy_sched_t *sched;
+
+    if (task == NULL || events == 0) return;
+
+    sched = task->sched;
+    //事件从无到有时记录时刻，任务先读时刻再取走事件，见fy_sched_run_once
+    if (__atomic_fetch_or(&task->events, events, __ATOMIC_ACQ_REL) == 0 && sched != NULL) {
+        task->ready_cycles = sched->port.cycles();
+    }
+    if (sched != NULL) {
+        sched->pending = 1;
+    }
+}
+
+/*
+ * 处理到期定时器，运行优先级最高的一个就绪任务
+ * 返回1运行了任务，0没有就绪任务(已睡眠到下一个中断)
+ */
+int32_t fy_sched_run_once(fy_sched_t *sched)
+{
+    fy_task_t *task;
+    uint32_t events, ready, start, run;
+
+    timer_expire(sched, sched->port.now());
+    sched->pending = 0;
+
+    for (task = sched->tasks; task != NULL; task = task->next) {
+        if (task->events == 0) continue;
+
+        ready = task->ready_cycles;
+        events = __atomic_exchange_n(&task->events, 0, __ATOMIC_ACQ_REL);
+        start = sched->port.cycles();
+        if (start - ready > task->latency_max) {
+            task->latency_max = start - ready;
+        }
+        if (sched->hook != NULL) {
+            sched->hook(task, 1);
+        }
+        task->fn(task, events);
+        run = sched->port.cycles() - start;
+        if (sched->hook != NULL) {
+            sched->hook(task, 0);
+        }
+        task->runs++;
+        task->run_cycles += run;
+        if (run > task->run_cycles_max) {
+            task->run_cycles_max = run;
+        }
+        return 1;
+    }
+    sched_idle(sched);
+    return 0;
+}
+
+void fy_sched_run(fy_sched_t *sched)
+{
+    while (1) {
+        fy_sched_run_once(sched);
+    }
+}
+
+/*
+ * 清零统计；cycles计数会回绕，统计周期需短于回绕时间(72MHz下约59秒)
+ */
+void fy_sched_stats_reset(fy_sched_t *sched)
+{
+    fy_task_t *task;
+
+    for (task = sched->tasks; task != NULL; task = task->next) {
+        task->runs = 0;
+        task->run_cycles = 0;
+        task->run_cycles_max = 0;
+        task->latency_max = 0;
+        task->late_max = 0;
+        task->overruns = 0;
+    }
+    sched->idle_cycles = 0;
+    sched->idle_count = 0;
+    sched->stats_since = sched->port.cycles();
+}
+
+/*
+ * 注册运行钩子，NULL取消；在主循环中调用
+ */
+void fy_sched_set_hook(fy_sched_t *sched, fy_sched_hook_fn_t hook)
+{
+    sched->hook = hook;
+}
+
+/*
+ * 自上次清零统计以来的CPU占用率(千分比)，包含中断时间
+ */
+uint32_t fy_sched_load_permille(const fy_sched_t *sched)
+{
+    uint32_t elapsed = sched->port.cycles() - sched->stats_since;
+
+    if (elapsed == 0 || sched->idle_cycles >= elapsed) return 0;
+    return (uint32_t)((uint64_t)(elapsed - sched->idle_cycles) * 1000U / elapsed);
+}
@@ -0,0 +1,43 @@
+/* fy_sched_port.c
+ * Default target port of the scheduler: HAL tick, DWT cycle counter, WFI sleep.
+ */
+#include "fy_sched.h"
+#include "main.h"
+
+static uint32_t port_now(void)
+{
+    return HAL_GetTick();
+}
+
+static uint32_t port_cycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+static void port_idle(uint32_t timeout)
+{
+    /* SysTick每个tick都会唤醒，timeout暂不使用 */
+    (void)timeout;
+    __DSB();
+    __WFI();
+}
+
+const fy_sched_port_t *fy_sched_port_default(void)
+{
+    static fy_sched_port_t port;
+
+    if (port.now == NULL) {
+        //只打开周期计数，不清零，其他模块可能也在使用
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#ifdef DEBUG
+        //睡眠时保持调试器连接
+        DBGMCU->CR |= DBGMCU_CR_DBG_SLEEP;
+#endif
+        port.now = port_now;
+        port.cycles = port_cycles;
+        port.cycles_per_tick = SystemCoreClock / 1000U * (uint32_t)HAL_GetTickFreq();
+        port.idle = port_idle;
+    }
+    return &port;
+}
@@ -0,0 +1,131 @@
+/*
+说明
+    事件跟踪：中断处理函数进入/退出、fy_uart回调事件、调度器任务运行与用户事件，
+    以DWT周期为时间戳写入RAM中的记录环(每条8字节)，最低优先级任务在串口空闲时按行输出，
+    Tools/fy_trace.py转换为Chrome trace JSON(chrome://tracing、ui.perfetto.dev)，
+    在时间轴上查看中断延迟、嵌套与DMA传输间隔。
+
+记录:
+    写入在port.lock(目标板PRIMASK)内完成，任何中断与任务中都可调用，不分配内存。
+    环满时丢弃新记录并计数，全部输出后才继续记录，先写入一条LOST记录(参数为丢弃数)，
+    时间轴上是一段段完整的记录，片段之间有一个标明的缺口。
+    单条记录的周期数在fy_trace_init时测量，在头部行中输出(cost)。
+    串口带宽有限：每条记录输出约17字节，115200波特率下约每秒650条，SysTick(每秒2000条)默认不记录，
+    可用fy_trace_enable打开；输出本身产生的DMA/USART中断也会被记录。
+
+编号(id):
+    0~15     中断，ENTER/EXIT，在Handler轨道上按嵌套显示
+    16~31    fy_uart回调事件(在中断中)，EVENT
+    32~63    fy_trace_id按名字分配，任务/代码段的ENTER/EXIT与EVENT，在Thread轨道上显示
+
+输出格式(fy_trace_flush，每行以\n结束):
+    #trace,v1,hz=72000000,records=256,cost=40,lost=0      头部，启动后与fy_trace_announce后输出
+    #trace,names,<id>=<name>,...                            编号名称，一行放不下时分多行
+    #T,<seq>,<记录>...                                      seq为两位十六进制行序号(回绕)，
+                                                            每条记录16个十六进制字符：cycles(8) type(2) id(2) arg(4)
+    时间戳32位回绕(72MHz下约59秒)，fy_trace_flush每秒写入一条SYNC记录保证主机端能展开。
+
+移植:
+    fy_trace_init的port传NULL时使用目标板默认实现(fy_trace_port.c：DWT/HAL_GetTick/PRIMASK)。
+    主机上定义FY_TRACE_HOST编译，由调用者提供port(见Tools/trace_sim.c)。
+    中断与驱动中通过FY_TRACE_ISR_ENTER/EXIT、FY_TRACE_EVENT记录到最近一次fy_trace_init的实例，
+    未初始化时为空操作；没有定义FY_TRACE的编译中这些宏为空。
+
+使用方法：
+    fy_trace_t trace;
+    fy_trace_init(&trace, NULL);
+    中断中: FY_TRACE_ISR_ENTER(FY_TRACE_ID_USART1); ... FY_TRACE_ISR_EXIT(FY_TRACE_ID_USART1);
+    任务中: fy_trace_record(&trace, FY_TRACE_T_ENTER, fy_trace_id(&trace, "imu"), 0);
+    最低优先级任务中: fy_trace_flush(&trace, out_fn, 串口发送缓冲区剩余空间);
+*/
+#ifndef __FY_TRACE_H
+#define __FY_TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef FY_TRACE_RECORDS
+#define FY_TRACE_RECORDS        256     //记录环大小，2的幂，每条8字节
+#endif
+#define FY_TRACE_LINE_RECORDS   6       //每行记录数
+#define FY_TRACE_LINE_MAX       112     //一行的最大长度
+#define FY_TRACE_SYNC_MS        1000    //SYNC记录间隔
+
+//记录类型
+#define FY_TRACE_T_ENTER        0
+#define FY_TRACE_T_EXIT         1
+#define FY_TRACE_T_EVENT        2
+#define FY_TRACE_T_LOST         3       //arg: 之前丢弃的记录数(最大65535)
+#define FY_TRACE_T_SYNC         4       //arg: HAL tick(ms)低16位
+
+//固定编号
+#define FY_TRACE_ID_SYSTICK         0
+#define FY_TRACE_ID_EXTI0           1
+#define FY_TRACE_ID_EXTI1           2
+#define FY_TRACE_ID_DMA1_CH4        3   //USART1 TX
+#define FY_TRACE_ID_DMA1_CH5        4   //USART1 RX
+#define FY_TRACE_ID_I2C2_EV         5
+#define FY_TRACE_ID_I2C2_ER         6
+#define FY_TRACE_ID_USART1          7
+#define FY_TRACE_ID_UART_TX_DONE    16  //arg: 本段字节数
+#define FY_TRACE_ID_UART_TX_HALF    17  //arg: DMA已搬运字节数
+#define FY_TRACE_ID_UART_TX_ERROR   18
+#define FY_TRACE_ID_UART_RX         19  //arg: 新收到的字节数
+#define FY_TRACE_ID_UART_ERROR      20  //arg: HAL ErrorCode
+#define FY_TRACE_ID_TRACE           31  //LOST与SYNC记录
+#define FY_TRACE_ID_USER            32  //fy_trace_id分配的起始编号
+#define FY_TRACE_IDS                64
+
+typedef struct fy_trace fy_trace_t;
+
+/* 结果输出，line不以\0结束 */
+typedef void (*fy_trace_out_fn_t)(const char *line, size_t len);
+
+typedef struct {
+    uint32_t (*cycles)(void);//时间戳
+    uint32_t (*now)(void);//ms
+    uint32_t (*lock)(void);//关中断，返回之前的状态
+    void (*unlock)(uint32_t key);
+    uint32_t hz;//cycles的频率
+} fy_trace_port_t;
+
+typedef struct {
+    uint32_t cycles;
+    uint8_t type;
+    uint8_t id;
+    uint16_t arg;
+} fy_trace_record_t;
+
+typedef struct fy_trace {
+    fy_trace_port_t port;
+    fy_trace_record_t records[FY_TRACE_RECORDS];
+    volatile uint32_t head;//写入计数
+    volatile uint32_t tail;//输出计数
+    uint32_t lost;//待报告的丢弃数
+    uint32_t lost_total;
+    uint32_t mask[FY_TRACE_IDS / 32];//按编号开关
+    const char *names[FY_TRACE_IDS - FY_TRACE_ID_USER];
+    uint8_t user_count;
+    uint8_t announce;//下一个要输出名称的编号，FY_TRACE_IDS为全部已输出
+    uint8_t header_pending;
+    uint8_t seq;//行序号
+    uint32_t sync_ms;//上一条SYNC记录
+    uint32_t record_cycles;//单条记录开销
+} fy_trace_t;
+
+extern fy_trace_t *fy_trace_active;
+
+#define FY_TRACE_ISR_ENTER(id)      fy_trace_record(fy_trace_active, FY_TRACE_T_ENTER, (id), 0)
+#define FY_TRACE_ISR_EXIT(id)       fy_trace_record(fy_trace_active, FY_TRACE_T_EXIT, (id), 0)
+#define FY_TRACE_EVENT(id, arg)     fy_trace_record(fy_trace_active, FY_TRACE_T_EVENT, (id), (uint16_t)(arg))
+
+const fy_trace_port_t *fy_trace_port_default(void);
+
+int32_t fy_trace_init(fy_trace_t *trace, const fy_trace_port_t *port);
+void fy_trace_enable(fy_trace_t *trace, uint8_t id, int32_t on);
+int32_t fy_trace_id(fy_trace_t *trace, const char *name);
+void fy_trace_record(fy_trace_t *trace, uint8_t type, uint8_t id, uint16_t arg);
+void fy_trace_announce(fy_trace_t *trace);
+uint32_t fy_trace_flush(fy_trace_t *trace, fy_trace_out_fn_t out, size_t room);
+
+#endif
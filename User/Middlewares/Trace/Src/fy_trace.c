@@ -0,0 +1,249 @@
+/* fy_trace.c
+ * Event trace recorder: timestamped records in a RAM ring, streamed as hex lines.
+ */
+#include "fy_trace.h"
+#include <stdio.h>
+#include <string.h>
+
+#if (FY_TRACE_RECORDS & (FY_TRACE_RECORDS - 1)) != 0
+#error "FY_TRACE_RECORDS must be a power of 2"
+#endif
+
+fy_trace_t *fy_trace_active;
+
+static const char *const fixed_names[FY_TRACE_ID_USER] = {
+    [FY_TRACE_ID_SYSTICK] = "SysTick",
+    [FY_TRACE_ID_EXTI0] = "EXTI0",
+    [FY_TRACE_ID_EXTI1] = "EXTI1",
+    [FY_TRACE_ID_DMA1_CH4] = "DMA1_Channel4",
+    [FY_TRACE_ID_DMA1_CH5] = "DMA1_Channel5",
+    [FY_TRACE_ID_I2C2_EV] = "I2C2_EV",
+    [FY_TRACE_ID_I2C2_ER] = "I2C2_ER",
+    [FY_TRACE_ID_USART1] = "USART1",
+    [FY_TRACE_ID_UART_TX_DONE] = "uart_tx_done",
+    [FY_TRACE_ID_UART_TX_HALF] = "uart_tx_half",
+    [FY_TRACE_ID_UART_TX_ERROR] = "uart_tx_error",
+    [FY_TRACE_ID_UART_RX] = "uart_rx",
+    [FY_TRACE_ID_UART_ERROR] = "uart_error",
+    [FY_TRACE_ID_TRACE] = "trace",
+};
+
+#ifdef FY_TRACE_HOST
+/* 主机上没有默认实现，必须传入port */
+const fy_trace_port_t *fy_trace_port_default(void)
+{
+    return NULL;
+}
+#endif
+
+static const char *trace_name(const fy_trace_t *trace, uint32_t id)
+{
+    if (id < FY_TRACE_ID_USER) return fixed_names[id];
+    if (id - FY_TRACE_ID_USER < trace->user_count) return trace->names[id - FY_TRACE_ID_USER];
+    return NULL;
+}
+
+static char *put_hex(char *p, uint32_t v, uint32_t digits)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    while (digits-- > 0) {
+        *p++ = hex[(v >> (digits * 4U)) & 0xFU];
+    }
+    return p;
+}
+
+int32_t fy_trace_init(fy_trace_t *trace, const fy_trace_port_t *port)
+{
+    uint32_t t0, i;
+
+    if (trace == NULL) return -1;
+    if (port == NULL) {
+        port = fy_trace_port_default();
+    }
+    if (port == NULL || port->cycles == NULL || port->now == NULL || port->lock == NULL || port->unlock == NULL) {
+        return -1;
+    }
+
+    fy_trace_active = NULL;
+    memset(trace, 0, sizeof(*trace));
+    trace->port = *port;
+    memset(trace->mask, 0xFF, sizeof(trace->mask));
+    //SysTick每秒2000条，超出串口带宽
+    fy_trace_enable(trace, FY_TRACE_ID_SYSTICK, 0);
+
+    //测量单条记录的开销，测量用的记录不输出
+    t0 = trace->port.cycles();
+    for (i = 0; i < 8U; i++) {
+        fy_trace_record(trace, FY_TRACE_T_EVENT, FY_TRACE_ID_USER, 0);
+    }
+    trace->record_cycles = (trace->port.cycles() - t0) / 8U;
+    trace->head = 0;
+    trace->tail = 0;
+
+    trace->header_pending = 1;
+    trace->sync_ms = trace->port.now();
+    fy_trace_active = trace;
+    return 0;
+}
+
+void fy_trace_enable(fy_trace_t *trace, uint8_t id, int32_t on)
+{
+    uint32_t key;
+
+    if (trace == NULL || id >= FY_TRACE_IDS) return;
+
+    key = trace->port.lock();
+    if (on) {
+        trace->mask[id >> 5] |= 1UL << (id & 31U);
+    } else {
+        trace->mask[id >> 5] &= ~(1UL << (id & 31U));
+    }
+    trace->port.unlock(key);
+}
+
+/* 按名字(指针)查找编号，没有时分配，在任务中调用；编号用完时返回-1 */
+int32_t fy_trace_id(fy_trace_t *trace, const char *name)
+{
+    uint32_t i;
+
+    if (trace == NULL || name == NULL) return -1;
+
+    for (i = 0; i < trace->user_count; i++) {
+        if (trace->names[i] == name) return (int32_t)(FY_TRACE_ID_USER + i);
+    }
+    if (trace->user_count >= FY_TRACE_IDS - FY_TRACE_ID_USER) return -1;
+
+    trace->names[trace->user_count] = name;
+    if (trace->announce > FY_TRACE_ID_USER + trace->user_count) {
+        trace->announce = FY_TRACE_ID_USER + trace->user_count;
+    }
+    trace->user_count++;
+    return (int32_t)(FY_TRACE_ID_USER + i);
+}
+
+/* 在任何上下文中调用，环满时丢弃 */
+void fy_trace_record(fy_trace_t *trace, uint8_t type, uint8_t id, uint16_t arg)
+{
+    fy_trace_record_t *r;
+    uint32_t key, used;
+
+    if (trace == NULL || id >= FY_TRACE_IDS || !(trace->mask[id >> 5] & (1UL << (id & 31U)))) return;
+
+    key = trace->port.lock();
+    used = trace->head - trace->tail;
+    //环满后等全部输出再继续，时间轴上是完整的片段，而不是很多小缺口
+    if (used >= FY_TRACE_RECORDS || (trace->lost != 0 && used != 0)) {
+        trace->lost++;
+        trace->lost_total++;
+        trace->port.unlock(key);
+        return;
+    }
+    if (trace->lost != 0) {
+        r = &trace->records[trace->head & (FY_TRACE_RECORDS - 1U)];
+        r->cycles = trace->port.cycles();
+        r->type = FY_TRACE_T_LOST;
+        r->id = FY_TRACE_ID_TRACE;
+        r->arg = (trace->lost > 0xFFFFU) ? 0xFFFFU : (uint16_t)trace->lost;
+        trace->head++;
+        trace->lost = 0;
+    }
+    r = &trace->records[trace->head & (FY_TRACE_RECORDS - 1U)];
+    r->cycles = trace->port.cycles();
+    r->type = type;
+    r->id = id;
+    r->arg = arg;
+    trace->head++;
+    trace->port.unlock(key);
+}
+
+/* 重新输出头部与全部名称，主机端中途开始接收时使用 */
+void fy_trace_announce(fy_trace_t *trace)
+{
+    if (trace == NULL) return;
+
+    trace->header_pending = 1;
+    trace->announce = 0;
+}
+
+/* 在最低优先级任务中调用：room为输出端可以不阻塞写入的字节数，只输出完整的行；返回输出的记录数 */
+uint32_t fy_trace_flush(fy_trace_t *trace, fy_trace_out_fn_t out, size_t room)
+{
+    char line[FY_TRACE_LINE_MAX];
+    uint32_t head, tail, n, total = 0;
+    uint32_t now;
+    int len;
+    char *p;
+
+    if (trace == NULL || out == NULL) return 0;
+
+    now = trace->port.now();
+    if (now - trace->sync_ms >= FY_TRACE_SYNC_MS) {
+        trace->sync_ms = now;
+        fy_trace_record(trace, FY_TRACE_T_SYNC, FY_TRACE_ID_TRACE, (uint16_t)now);
+    }
+
+    if (trace->header_pending && room >= FY_TRACE_LINE_MAX) {
+        len = snprintf(line, sizeof(line), "#trace,v1,hz=%lu,records=%u,cost=%lu,lost=%lu\n",
+                       (unsigned long)trace->port.hz, (unsigned)FY_TRACE_RECORDS,
+                       (unsigned long)trace->record_cycles, (unsigned long)trace->lost_total);
+        out(line, (size_t)len);
+        room -= (size_t)len;
+        trace->header_pending = 0;
+    }
+    //名称按"编号=名称"合并成行，一行放不下的留到下一行
+    while (trace->announce < FY_TRACE_IDS && room >= FY_TRACE_LINE_MAX) {
+        len = snprintf(line, sizeof(line), "#trace,names");
+        for (; trace->announce < FY_TRACE_IDS; trace->announce++) {
+            const char *name = trace_name(trace, trace->announce);
+            int n;
+
+            if (name == NULL) {
+                if (trace->announce >= FY_TRACE_ID_USER) {
+                    trace->announce = FY_TRACE_IDS;
+                    break;
+                }
+                continue;
+            }
+            n = snprintf(line + len, sizeof(line) - (size_t)len, ",%u=%s", (unsigned)trace->announce, name);
+            if (len + n >= (int)sizeof(line) - 1) {
+                if (len == 12) {
+                    trace->announce++;//名称太长，跳过
+                }
+                break;
+            }
+            len += n;
+        }
+        if (len > 12) {
+            line[len++] = '\n';
+            out(line, (size_t)len);
+            room -= (size_t)len;
+        }
+    }
+
+    //写入端不会改写tail到head之间的记录
+    head = trace->head;
+    tail = trace->tail;
+    while (head != tail && room >= FY_TRACE_LINE_MAX) {
+        p = line;
+        *p++ = '#';
+        *p++ = 'T';
+        *p++ = ',';
+        p = put_hex(p, trace->seq++, 2);
+        for (n = 0; n < FY_TRACE_LINE_RECORDS && tail != head; n++, tail++) {
+            const fy_trace_record_t *r = &trace->records[tail & (FY_TRACE_RECORDS - 1U)];
+
+            *p++ = ',';
+            p = put_hex(p, r->cycles, 8);
+            p = put_hex(p, r->type, 2);
+            p = put_hex(p, r->id, 2);
+            p = put_hex(p, r->arg, 4);
+        }
+        *p++ = '\n';
+        trace->tail = tail;
+        out(line, (size_t)(p - line));
+        room -= (size_t)(p - line);
+        total += n;
+    }
+    return total;
+}
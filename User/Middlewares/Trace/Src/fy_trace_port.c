@@ -0,0 +1,46 @@
+/* fy_trace_port.c
+ * Default target port of the trace recorder: DWT cycle counter, HAL tick,
+ * PRIMASK around the ring update.
+ */
+#include "fy_trace.h"
+#include "main.h"
+
+static uint32_t port_cycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+static uint32_t port_now(void)
+{
+    return HAL_GetTick();
+}
+
+static uint32_t port_lock(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    return primask;
+}
+
+static void port_unlock(uint32_t key)
+{
+    __set_PRIMASK(key);
+}
+
+const fy_trace_port_t *fy_trace_port_default(void)
+{
+    static fy_trace_port_t port;
+
+    if (port.cycles == NULL) {
+        //只打开周期计数，不清零，调度器也在使用
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+        port.cycles = port_cycles;
+        port.now = port_now;
+        port.lock = port_lock;
+        port.unlock = port_unlock;
+        port.hz = SystemCoreClock;
+    }
+    return &port;
+}
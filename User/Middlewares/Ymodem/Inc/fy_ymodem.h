@@ -0,0 +1,147 @@
+/*
+说明
+    YMODEM(兼容XMODEM-CRC/1K)接收协议引擎，不阻塞、不直接访问硬件：
+    收到的字节由fy_ymodem_input送入，应答通过ops.send发出，文件数据通过ops.write交给调用者(如写Flash)。
+    fy_ymodem_poll在主循环中周期调用，处理超时、重发'C'/NAK与被推迟的应答。
+
+协议:
+    接收方每秒发送'C'请求CRC模式；SOH为128字节块，STX为1024字节块，块号与反码、CRC16-CCITT(多项式0x1021，初值0)校验。
+    块0为文件头(文件名\0十进制长度 ...)，文件名为空的块0表示批量传输结束；数据块从1开始，块号8位回绕。
+    第一个EOT回NAK，第二个EOT回ACK并发送'C'等待下一个文件头(YMODEM)；首个数据包为块1时按XMODEM处理，单个EOT即结束。
+    块号重复(ACK丢失)重新ACK，块号错乱取消传输，CRC错误或字节超时回NAK，连续FY_YMODEM_RETRY_MAX次失败取消传输。
+    连续两个CAN为发送方取消；取消时发送CAN CAN。
+    开始时(还没有收到任何文件)一直发送'C'，何时放弃由调用者决定；文件结束后等待下一个文件头超时视为传输结束。
+    只支持CRC校验，不支持XMODEM的累加和模式。
+    文件头中给出长度时，最后一块的填充(0x1A)不交给write。
+
+流控:
+    write/close返回1表示忙(如Flash缓冲区都已占满)，此时不应答，发送方等待ACK期间不会发送下一块；
+    fy_ymodem_poll中重试，接受后再ACK。忙期间fy_ymodem_input不消耗字节(返回值小于len)，
+    调用者应保留剩余字节稍后再送入，或在fy_ymodem_busy为真时暂停读取。
+
+移植:
+    只依赖调用者传入的时刻(ms)与ops，主机上直接编译
+    (见Tools/ymodem_pty_test.c，在伪终端对上完成一次完整的传输)。
+
+使用方法：
+    static const fy_ymodem_ops_t ops = {my_open, my_write, my_close, my_send};
+    fy_ymodem_t ym;
+    fy_ymodem_init(&ym, &ops, arg);
+    fy_ymodem_start(&ym, HAL_GetTick());
+    主循环: n = fy_ymodem_input(&ym, buf, len, HAL_GetTick()); fy_ymodem_poll(&ym, HAL_GetTick());
+    fy_ymodem_state为FY_YMODEM_DONE(成功)或FY_YMODEM_ABORTED(error给出原因)时结束
+*/
+#ifndef __FY_YMODEM_H
+#define __FY_YMODEM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define FY_YMODEM_SOH       0x01
+#define FY_YMODEM_STX       0x02
+#define FY_YMODEM_EOT       0x04
+#define FY_YMODEM_ACK       0x06
+#define FY_YMODEM_NAK       0x15
+#define FY_YMODEM_CAN       0x18
+#define FY_YMODEM_CRC       'C'
+
+#define FY_YMODEM_BLOCK_MAX 1024
+#define FY_YMODEM_NAME_MAX  64
+
+#ifndef FY_YMODEM_TIMEOUT_MS
+#define FY_YMODEM_TIMEOUT_MS    1000    //包内字节间隔/等待下一包的超时
+#endif
+#ifndef FY_YMODEM_RETRY_MAX
+#define FY_YMODEM_RETRY_MAX     10      //连续失败次数上限
+#endif
+
+typedef enum {
+    FY_YMODEM_IDLE = 0,
+    FY_YMODEM_WAIT_HEADER,//发送'C'，等待文件头(或XMODEM的块1)
+    FY_YMODEM_RECEIVING,//文件数据
+    FY_YMODEM_DONE,//批量传输结束
+    FY_YMODEM_ABORTED,//已取消，原因见error
+} fy_ymodem_state_t;
+
+typedef enum {
+    FY_YMODEM_ERR_NONE = 0,
+    FY_YMODEM_ERR_TIMEOUT,//连续超时
+    FY_YMODEM_ERR_RETRY,//连续CRC错误
+    FY_YMODEM_ERR_CANCEL,//发送方(或fy_ymodem_abort)取消
+    FY_YMODEM_ERR_SEQUENCE,//块号错乱
+    FY_YMODEM_ERR_REJECT,//open拒绝(如文件太大)
+    FY_YMODEM_ERR_WRITE,//write/close出错
+} fy_ymodem_error_t;
+
+typedef struct {
+    /* 文件头：name为文件名，size为长度(未知或XMODEM时为0)；返回0接受，<0拒绝并取消传输 */
+    int32_t (*open)(void *arg, const char *name, uint32_t size);
+    /* 文件数据，offset从0连续递增；返回0已接受，1忙(稍后以同样的参数重试)，<0出错并取消传输 */
+    int32_t (*write)(void *arg, uint32_t offset, const uint8_t *data, uint32_t len);
+    /* status为0时文件正常结束(返回值同write，忙时推迟最后一个EOT的ACK)；<0时为取消，返回值忽略 */
+    int32_t (*close)(void *arg, int32_t status);
+    /* 发送应答 */
+    void (*send)(void *arg, const uint8_t *data, uint32_t len);
+} fy_ymodem_ops_t;
+
+typedef struct fy_ymodem {
+    //成员
+    const fy_ymodem_ops_t *ops;
+    void *arg;
+    uint8_t state;//fy_ymodem_state_t
+    uint8_t error;//fy_ymodem_error_t
+    uint8_t xmodem;//按XMODEM接收(没有文件头)
+    uint8_t file_open;
+    uint8_t pending;//等待write/close接受后再应答
+    uint8_t expect_blk;//期望的块号
+    uint8_t eot_count;
+    uint8_t can_count;
+    uint8_t retries;//连续失败次数
+    //当前包
+    uint8_t pkt_type;//SOH/STX，0表示等待包头
+    uint16_t pkt_len;//数据长度
+    uint16_t pkt_pos;//已收到的字节(块号、反码、数据、CRC)
+    uint32_t timer;//上次收发的时刻，超时从此计算
+    //文件
+    char name[FY_YMODEM_NAME_MAX];
+    uint32_t size;//文件头中的长度，0表示未知
+    uint32_t offset;//已交给write的字节数
+    //统计
+    uint32_t files;
+    uint32_t blocks;
+    uint32_t naks;
+    uint32_t duplicates;
+    uint32_t busy_polls;//write/close忙的次数
+    uint8_t pkt[FY_YMODEM_BLOCK_MAX + 4];//块号、反码、数据、CRC
+} fy_ymodem_t;
+
+void fy_ymodem_init(fy_ymodem_t *ym, const fy_ymodem_ops_t *ops, void *arg);
+/* 开始接收(立即发送第一个'C') */
+void fy_ymodem_start(fy_ymodem_t *ym, uint32_t now);
+/* 送入收到的字节，返回消耗的字节数；忙时返回值可能小于len */
+size_t fy_ymodem_input(fy_ymodem_t *ym, const uint8_t *data, size_t len, uint32_t now);
+/* 超时与被推迟的应答，返回当前状态 */
+fy_ymodem_state_t fy_ymodem_poll(fy_ymodem_t *ym, uint32_t now);
+/* 调用者取消传输(发送CAN CAN，已打开的文件以status<0关闭) */
+void fy_ymodem_abort(fy_ymodem_t *ym);
+/* CRC16-CCITT(XMODEM) */
+uint16_t fy_ymodem_crc16(uint16_t crc, const uint8_t *data, size_t len);
+const char *fy_ymodem_error_str(uint8_t error);
+
+static inline fy_ymodem_state_t fy_ymodem_state(const fy_ymodem_t *ym)
+{
+    return (fy_ymodem_state_t)ym->state;
+}
+
+static inline uint8_t fy_ymodem_busy(const fy_ymodem_t *ym)
+{
+    return ym->pending;
+}
+
+/* 已收到包头，传输已经开始(此后不应再向串口输出文本) */
+static inline uint8_t fy_ymodem_started(const fy_ymodem_t *ym)
+{
+    return ym->file_open || ym->files != 0 || ym->pkt_type != 0;
+}
+
+#endif
@@ -0,0 +1,320 @@
+#include "fy_ymodem.h"
+#include <string.h>
+
+#define PENDING_NONE    0
+#define PENDING_WRITE   1//数据块等待write接受
+#define PENDING_CLOSE   2//最后的EOT等待close接受
+
+/* 每次处理4位的CRC16-CCITT表 */
+static const uint16_t crc16_nibble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+uint16_t fy_ymodem_crc16(uint16_t crc, const uint8_t *data, size_t len)
+{
+    while (len--) {
+        uint8_t b = *data++;
+
+        crc = (uint16_t)((crc << 4) ^ crc16_nibble[(crc >> 12) ^ (b >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ crc16_nibble[(crc >> 12) ^ (b & 0x0F)]);
+    }
+    return crc;
+}
+
+const char *fy_ymodem_error_str(uint8_t error)
+{
+    static const char *const str[] = {
+        "none", "timeout", "too many errors", "cancelled",
+        "block sequence", "rejected", "write failed",
+    };
+
+    return (error < sizeof(str) / sizeof(str[0])) ? str[error] : "?";
+}
+
+static void send_byte(fy_ymodem_t *ym, uint8_t c, uint32_t now)
+{
+    ym->ops->send(ym->arg, &c, 1);
+    ym->timer = now;
+}
+
+static void finish_abort(fy_ymodem_t *ym, uint8_t error, uint8_t send_can)
+{
+    static const uint8_t can[2] = {FY_YMODEM_CAN, FY_YMODEM_CAN};
+
+    if (send_can) {
+        ym->ops->send(ym->arg, can, sizeof(can));
+    }
+    if (ym->file_open) {
+        ym->file_open = 0;
+        ym->ops->close(ym->arg, -1);
+    }
+    ym->pending = PENDING_NONE;
+    ym->pkt_type = 0;
+    ym->error = error;
+    ym->state = FY_YMODEM_ABORTED;
+}
+
+/* CRC错误或超时：回NAK(等待文件头时为'C')，连续失败过多取消传输 */
+static void retry(fy_ymodem_t *ym, uint8_t error, uint32_t now)
+{
+    if (ym->state == FY_YMODEM_WAIT_HEADER && ym->files == 0 && error == FY_YMODEM_ERR_TIMEOUT) {
+        send_byte(ym, FY_YMODEM_CRC, now);//还没开始，一直请求
+        return;
+    }
+    if (++ym->retries > FY_YMODEM_RETRY_MAX) {
+        if (ym->state == FY_YMODEM_WAIT_HEADER && ym->files != 0 && error == FY_YMODEM_ERR_TIMEOUT) {
+            ym->state = FY_YMODEM_DONE;//发送方没有发结束的空文件头
+            return;
+        }
+        finish_abort(ym, error, 1);
+        return;
+    }
+    ym->naks++;
+    send_byte(ym, (ym->state == FY_YMODEM_WAIT_HEADER) ? FY_YMODEM_CRC : FY_YMODEM_NAK, now);
+}
+
+/* 本块交给write的长度，文件头给出长度时去掉最后一块的填充 */
+static uint32_t block_data_len(const fy_ymodem_t *ym)
+{
+    uint32_t n = ym->pkt_len;
+
+    if (ym->size != 0) {
+        if (ym->offset >= ym->size) {
+            n = 0;
+        } else if (ym->size - ym->offset < n) {
+            n = ym->size - ym->offset;
+        }
+    }
+    return n;
+}
+
+/* 把被推迟的块/EOT交给调用者，接受后应答 */
+static void try_pending(fy_ymodem_t *ym, uint32_t now)
+{
+    int32_t r;
+
+    if (ym->pending == PENDING_WRITE) {
+        uint32_t n = block_data_len(ym);
+
+        r = (n != 0) ? ym->ops->write(ym->arg, ym->offset, &ym->pkt[2], n) : 0;
+        if (r > 0) {
+            ym->busy_polls++;
+            return;
+        }
+        ym->pending = PENDING_NONE;
+        if (r < 0) {
+            finish_abort(ym, FY_YMODEM_ERR_WRITE, 1);
+            return;
+        }
+        ym->offset += n;
+        ym->expect_blk++;
+        send_byte(ym, FY_YMODEM_ACK, now);
+    } else if (ym->pending == PENDING_CLOSE) {
+        r = ym->ops->close(ym->arg, 0);
+        if (r > 0) {
+            ym->busy_polls++;
+            return;
+        }
+        ym->pending = PENDING_NONE;
+        ym->file_open = 0;
+        if (r < 0) {
+            finish_abort(ym, FY_YMODEM_ERR_WRITE, 1);
+            return;
+        }
+        ym->files++;
+        ym->retries = 0;
+        send_byte(ym, FY_YMODEM_ACK, now);
+        if (ym->xmodem) {
+            ym->state = FY_YMODEM_DONE;
+        } else {
+            ym->state = FY_YMODEM_WAIT_HEADER;
+            send_byte(ym, FY_YMODEM_CRC, now);
+        }
+    }
+}
+
+static void open_file(fy_ymodem_t *ym, const char *name, uint32_t size)
+{
+    size_t n = strlen(name);
+
+    if (n >= sizeof(ym->name)) n = sizeof(ym->name) - 1;
+    memcpy(ym->name, name, n);
+    ym->name[n] = '\0';
+    ym->size = size;
+    ym->offset = 0;
+    ym->expect_blk = 1;
+    ym->eot_count = 0;
+    ym->retries = 0;
+    if (ym->ops->open(ym->arg, ym->name, size) < 0) {
+        finish_abort(ym, FY_YMODEM_ERR_REJECT, 1);
+        return;
+    }
+    ym->file_open = 1;
+    ym->state = FY_YMODEM_RECEIVING;
+}
+
+/* 块0：文件名\0长度(十进制，后面可能有空格分隔的其他字段) */
+static void on_header(fy_ymodem_t *ym, uint32_t now)
+{
+    const uint8_t *data = &ym->pkt[2];
+    char name[FY_YMODEM_NAME_MAX];
+    uint32_t i = 0, size = 0;
+
+    if (data[0] == '\0') {
+        send_byte(ym, FY_YMODEM_ACK, now);//空文件头，批量传输结束
+        ym->state = FY_YMODEM_DONE;
+        return;
+    }
+    while (i < ym->pkt_len && data[i] != '\0') {
+        if (i < sizeof(name) - 1) name[i] = (char)data[i];
+        i++;
+    }
+    name[(i < sizeof(name) - 1) ? i : sizeof(name) - 1] = '\0';
+    for (i++; i < ym->pkt_len && data[i] >= '0' && data[i] <= '9'; i++) {
+        size = size * 10 + (uint32_t)(data[i] - '0');
+    }
+    open_file(ym, name, size);
+    if (ym->state == FY_YMODEM_RECEIVING) {
+        send_byte(ym, FY_YMODEM_ACK, now);
+        send_byte(ym, FY_YMODEM_CRC, now);
+    }
+}
+
+static void on_packet(fy_ymodem_t *ym, uint32_t now)
+{
+    const uint8_t *crc = &ym->pkt[2 + ym->pkt_len];
+    uint8_t blk = ym->pkt[0];
+
+    if ((uint8_t)(blk ^ ym->pkt[1]) != 0xFF ||
+        fy_ymodem_crc16(0, &ym->pkt[2], ym->pkt_len) != (uint16_t)((crc[0] << 8) | crc[1])) {
+        retry(ym, FY_YMODEM_ERR_RETRY, now);
+        return;
+    }
+    if (ym->state == FY_YMODEM_WAIT_HEADER) {
+        if (blk == 0) {
+            on_header(ym, now);
+            return;
+        }
+        if (blk != 1 || ym->files != 0) {
+            finish_abort(ym, FY_YMODEM_ERR_SEQUENCE, 1);
+            return;
+        }
+        //首个数据包是块1：发送方为XMODEM，没有文件名与长度
+        ym->xmodem = 1;
+        open_file(ym, "", 0);
+        if (ym->state != FY_YMODEM_RECEIVING) return;
+    }
+
+    if (blk == ym->expect_blk) {
+        ym->blocks++;
+        ym->retries = 0;
+        ym->eot_count = 0;
+        ym->pending = PENDING_WRITE;
+        try_pending(ym, now);
+    } else if (blk == (uint8_t)(ym->expect_blk - 1)) {
+        //上一块的ACK丢失，重新应答(文件头还要再请求一次数据)
+        ym->duplicates++;
+        send_byte(ym, FY_YMODEM_ACK, now);
+        if (blk == 0 && !ym->xmodem) send_byte(ym, FY_YMODEM_CRC, now);
+    } else {
+        finish_abort(ym, FY_YMODEM_ERR_SEQUENCE, 1);
+    }
+}
+
+static void on_eot(fy_ymodem_t *ym, uint32_t now)
+{
+    if (ym->state == FY_YMODEM_RECEIVING) {
+        //YMODEM第一个EOT回NAK确认，第二个才结束文件
+        if (!ym->xmodem && ym->eot_count++ == 0) {
+            send_byte(ym, FY_YMODEM_NAK, now);
+            return;
+        }
+        ym->pending = PENDING_CLOSE;
+        try_pending(ym, now);
+    } else if (ym->files != 0) {
+        send_byte(ym, FY_YMODEM_ACK, now);//结束EOT的ACK丢失
+    }
+}
+
+static void rx_byte(fy_ymodem_t *ym, uint8_t c, uint32_t now)
+{
+    ym->timer = now;
+    if (ym->pkt_type == 0) {
+        if (c == FY_YMODEM_CAN) {
+            if (++ym->can_count >= 2) finish_abort(ym, FY_YMODEM_ERR_CANCEL, 0);
+            return;
+        }
+        ym->can_count = 0;
+        if (c == FY_YMODEM_SOH || c == FY_YMODEM_STX) {
+            ym->pkt_type = c;
+            ym->pkt_len = (c == FY_YMODEM_SOH) ? 128 : FY_YMODEM_BLOCK_MAX;
+            ym->pkt_pos = 0;
+        } else if (c == FY_YMODEM_EOT) {
+            on_eot(ym, now);
+        }
+        return;//其他为线路噪声
+    }
+    ym->pkt[ym->pkt_pos++] = c;
+    if (ym->pkt_pos == ym->pkt_len + 4) {
+        ym->pkt_type = 0;
+        on_packet(ym, now);
+    }
+}
+
+void fy_ymodem_init(fy_ymodem_t *ym, const fy_ymodem_ops_t *ops, void *arg)
+{
+    memset(ym, 0, offsetof(fy_ymodem_t, pkt));
+    ym->ops = ops;
+    ym->arg = arg;
+    ym->state = FY_YMODEM_IDLE;
+}
+
+void fy_ymodem_start(fy_ymodem_t *ym, uint32_t now)
+{
+    const fy_ymodem_ops_t *ops = ym->ops;
+    void *arg = ym->arg;
+
+    if (ym->file_open) ops->close(arg, -1);
+    fy_ymodem_init(ym, ops, arg);
+    ym->state = FY_YMODEM_WAIT_HEADER;
+    send_byte(ym, FY_YMODEM_CRC, now);
+}
+
+size_t fy_ymodem_input(fy_ymodem_t *ym, const uint8_t *data, size_t len, uint32_t now)
+{
+    size_t i;
+
+    if (ym->state != FY_YMODEM_WAIT_HEADER && ym->state != FY_YMODEM_RECEIVING) {
+        return len;//没有在接收，丢弃
+    }
+    for (i = 0; i < len; i++) {
+        if (ym->pending != PENDING_NONE) break;//块还在pkt中，等待调用者接受
+        rx_byte(ym, data[i], now);
+        if (ym->state != FY_YMODEM_WAIT_HEADER && ym->state != FY_YMODEM_RECEIVING) return len;
+    }
+    return i;
+}
+
+fy_ymodem_state_t fy_ymodem_poll(fy_ymodem_t *ym, uint32_t now)
+{
+    if (ym->state != FY_YMODEM_WAIT_HEADER && ym->state != FY_YMODEM_RECEIVING) {
+        return (fy_ymodem_state_t)ym->state;
+    }
+    if (ym->pending != PENDING_NONE) {
+        try_pending(ym, now);//忙期间不计超时，发送方在等待ACK
+        ym->timer = now;
+    } else if (now - ym->timer >= FY_YMODEM_TIMEOUT_MS) {
+        ym->pkt_type = 0;//丢弃不完整的包
+        retry(ym, FY_YMODEM_ERR_TIMEOUT, now);
+        ym->timer = now;
+    }
+    return (fy_ymodem_state_t)ym->state;
+}
+
+void fy_ymodem_abort(fy_ymodem_t *ym)
+{
+    if (ym->state == FY_YMODEM_WAIT_HEADER || ym->state == FY_YMODEM_RECEIVING) {
+        finish_abort(ym, FY_YMODEM_ERR_CANCEL, 1);
+    }
+}
@@ -45,6 +45,14 @@
     #error "Please configure buffer size for every line's log (in elog_cfg.h)"
 #endif
 
+#if !defined(ELOG_LINE_POOL_NUM)
+    #error "Please configure line pool size (in elog_cfg.h)"
+#endif
+
+#if (ELOG_LINE_POOL_NUM & (ELOG_LINE_POOL_NUM - 1)) != 0
+    #error "ELOG_LINE_POOL_NUM must be power of 2"
+#endif
+
 #if !defined(ELOG_FILTER_TAG_MAX_LEN)
     #error "Please configure output filter's tag max length (in elog_cfg.h)"
 #endif
@@ -62,6 +70,19 @@
 #define ELOG_FILTER_TAG_LVL_MAX_NUM          4
 #endif
 
+/* output filter's tag level hash table size */
+#ifndef ELOG_FILTER_TAG_LVL_HASH_SIZE
+#define ELOG_FILTER_TAG_LVL_HASH_SIZE        8
+#endif
+
+#if (ELOG_FILTER_TAG_LVL_HASH_SIZE & (ELOG_FILTER_TAG_LVL_HASH_SIZE - 1)) != 0
+    #error "ELOG_FILTER_TAG_LVL_HASH_SIZE must be power of 2"
+#endif
+
+#if ELOG_FILTER_TAG_LVL_HASH_SIZE <= ELOG_FILTER_TAG_LVL_MAX_NUM
+    #error "ELOG_FILTER_TAG_LVL_HASH_SIZE must be larger than ELOG_FILTER_TAG_LVL_MAX_NUM"
+#endif
+
 #ifdef ELOG_COLOR_ENABLE
 /**
  * CSI(Control Sequence Introducer/Initiator) sign
@@ -116,8 +137,19 @@
 
 /* EasyLogger object */
 static EasyLogger elog = { 0 };
-/* every line log's buffer */
-static char log_buf[ELOG_LINE_BUF_SIZE] = { 0 };
+/* one line in the line pool */
+typedef struct {
+    volatile uint32_t seq;      /**< line index + 1 once published */
+    size_t len;                 /**< 0: nothing to output, e.g. keyword filtered */
+    char buf[ELOG_LINE_BUF_SIZE + 1];   /**< +1 for the string end sign */
+} ElogLine;
+/* every line log's buffer. writers claim a line and format it without lock,
+ * the lines are output in claim order by whoever holds line_draining */
+static ElogLine line_pool[ELOG_LINE_POOL_NUM];
+static volatile uint32_t line_write_idx = 0;
+static volatile uint32_t line_read_idx = 0;
+static volatile uint32_t line_dropped = 0;
+static volatile uint8_t line_draining = 0;
 /* level output info */
 static const char *level_output_info[] = {
         [ELOG_LVL_ASSERT]  = "A/",
@@ -140,10 +172,21 @@ static const char *color_output_info[] = {
 };
 #endif /* ELOG_COLOR_ENABLE */
 
-static bool get_fmt_enabled(uint8_t level, size_t set);
-static bool get_fmt_used_and_enabled_u32(uint8_t level, size_t set, uint32_t arg);
-static bool get_fmt_used_and_enabled_ptr(uint8_t level, size_t set, const char* arg);
+/* context of the vsnprintf based message formatter */
+typedef struct {
+    const char *format;
+    va_list args;
+} ElogVaFormatCtx;
+
+static inline bool get_fmt_enabled(uint8_t level, size_t set);
+static int elog_va_formatter(char *buf, size_t size, void *ctx);
+static void elog_voutput(uint8_t level, const char *tag, uint32_t hash, const char *file, const char *func,
+        const long line, const char *format, va_list args);
+static inline bool get_fmt_used_and_enabled_u32(uint8_t level, size_t set, uint32_t arg);
+static inline bool get_fmt_used_and_enabled_ptr(uint8_t level, size_t set, const char* arg);
 static void elog_set_filter_tag_lvl_default(void);
+static ElogLine *line_claim(uint32_t *idx);
+static void line_publish(ElogLine *line, uint32_t idx, size_t len);
 
 /* EasyLogger assert hook */
 void (*elog_assert_hook)(const char* expr, const char* func, size_t line);
@@ -172,8 +215,13 @@ ElogErrCode elog_init(easy_logger_int_struct_t *init_struct) {
     elog.get_t_info = init_struct->get_t_info;
     elog_assert_hook = init_struct->assert_hook;
 
+    memset(line_pool, 0, sizeof(line_pool));
+    line_write_idx = 0;
+    line_read_idx = 0;
+    line_dropped = 0;
+    line_draining = 0;
+
 #ifdef ELOG_ASYNC_OUTPUT_ENABLE
-    extern ElogErrCode elog_async_init(void);
     result = elog_async_init();
     if (result != ELOG_NO_ERR) {
         return result;
@@ -208,8 +256,6 @@ ElogErrCode elog_init(easy_logger_int_struct_t *init_struct) {
  *
  */
 void elog_deinit(void) {
-    extern ElogErrCode elog_async_deinit(void);
-
     if (!elog.init_ok) {
         return ;
     }
@@ -309,6 +355,7 @@ bool elog_get_output_enabled(void) {
 
 /**
  * set log output format. only enable or disable
+ * @note it has no effect when ELOG_FMT_STATIC is defined
  *
  * @param level level
  * @param set format set
@@ -394,13 +441,47 @@ void elog_output_unlock(void) {
  */
 static void elog_set_filter_tag_lvl_default(void)
 {
-    uint8_t i = 0;
+    memset(elog.filter.tag_lvl, 0, sizeof(elog.filter.tag_lvl));
+    elog.filter.tag_lvl_num = 0;
+}
 
-    for (i =0; i< ELOG_FILTER_TAG_LVL_MAX_NUM; i++){
-        memset(elog.filter.tag_lvl[i].tag, '\0', ELOG_FILTER_TAG_MAX_LEN + 1);
-        elog.filter.tag_lvl[i].level = ELOG_FILTER_LVL_SILENT;
-        elog.filter.tag_lvl[i].tag_use_flag = false;
+/**
+ * find the tag in the tag level hash table by linear probing
+ *
+ * @param tag tag
+ * @param hash elog_tag_hash(tag)
+ * @param slot if not NULL, set to the slot where the tag would be added: the first
+ *        removed one (level ELOG_FILTER_LVL_ALL) on the probe chain, else the free
+ *        one that ends it. NULL when no slot is left.
+ *
+ * @return the tag's slot, NULL when the tag is not in the table
+ */
+static ElogTagLvlFilter *elog_find_tag_lvl(const char *tag, uint32_t hash, ElogTagLvlFilter **slot)
+{
+    ElogTagLvlFilter *filter;
+    uint32_t i, slot_hash;
+
+    if (slot != NULL) {
+        *slot = NULL;
     }
+    for (i = 0; i < ELOG_FILTER_TAG_LVL_HASH_SIZE; i++) {
+        filter = &elog.filter.tag_lvl[(hash + i) & (ELOG_FILTER_TAG_LVL_HASH_SIZE - 1)];
+        slot_hash = __atomic_load_n(&filter->hash, __ATOMIC_ACQUIRE);
+        if (slot_hash == 0) {
+            if (slot != NULL && *slot == NULL) {
+                *slot = filter;
+            }
+            return NULL;
+        }
+        if (slot_hash == hash && !strncmp(tag, filter->tag, ELOG_FILTER_TAG_MAX_LEN)) {
+            return filter;
+        }
+        if (slot != NULL && *slot == NULL && filter->level == ELOG_FILTER_LVL_ALL) {
+            *slot = filter;
+        }
+    }
+
+    return NULL;
 }
 
 /**
@@ -425,43 +506,40 @@ void elog_set_filter_tag_lvl(const char *tag, uint8_t level)
 {
     ELOG_ASSERT(level <= ELOG_LVL_VERBOSE);
     ELOG_ASSERT(tag != ((void *)0));
-    uint8_t i = 0;
+    uint32_t hash = elog_tag_hash(tag);
+    ElogTagLvlFilter *filter, *slot;
 
     if (!elog.init_ok) {
         return;
     }
 
+    /* writers are serialized by the lock, readers are lock slot */
     elog_output_lock();
-    /* find the tag in arr */
-    for (i =0; i< ELOG_FILTER_TAG_LVL_MAX_NUM; i++){
-        if (elog.filter.tag_lvl[i].tag_use_flag == true &&
-            !strncmp(tag, elog.filter.tag_lvl[i].tag,ELOG_FILTER_TAG_MAX_LEN)){
-            break;
-        }
-    }
-
-    if (i < ELOG_FILTER_TAG_LVL_MAX_NUM){
-        /* find OK */
-        if (level == ELOG_FILTER_LVL_ALL){
-            /* remove current tag's level filter when input level is the lowest level */
-             elog.filter.tag_lvl[i].tag_use_flag = false;
-             memset(elog.filter.tag_lvl[i].tag, '\0', ELOG_FILTER_TAG_MAX_LEN + 1);
-             elog.filter.tag_lvl[i].level = ELOG_FILTER_LVL_SILENT;
-        } else{
-            elog.filter.tag_lvl[i].level = level;
-        }
-    } else{
-        /* only add the new tag's level filer when level is not ELOG_FILTER_LVL_ALL */
-        if (level != ELOG_FILTER_LVL_ALL){
-            for (i =0; i< ELOG_FILTER_TAG_LVL_MAX_NUM; i++){
-                if (elog.filter.tag_lvl[i].tag_use_flag == false){
-                    strncpy(elog.filter.tag_lvl[i].tag, tag, ELOG_FILTER_TAG_MAX_LEN);
-                    elog.filter.tag_lvl[i].level = level;
-                    elog.filter.tag_lvl[i].tag_use_flag = true;
-                    break;
-                }
+    filter = elog_find_tag_lvl(tag, hash, &slot);
+    if (filter != NULL) {
+        /* find OK. ELOG_FILTER_LVL_ALL removes the level filter, the slot is kept
+         * so the probe chains stay valid, and it can be reused by any tag */
+        if (filter->level == ELOG_FILTER_LVL_ALL && level != ELOG_FILTER_LVL_ALL) {
+            if (elog.filter.tag_lvl_num < ELOG_FILTER_TAG_LVL_MAX_NUM) {
+                filter->level = level;
+                elog.filter.tag_lvl_num++;
             }
+        } else {
+            if (filter->level != ELOG_FILTER_LVL_ALL && level == ELOG_FILTER_LVL_ALL) {
+                elog.filter.tag_lvl_num--;
+            }
+            filter->level = level;
         }
+    } else if (slot != NULL && level != ELOG_FILTER_LVL_ALL
+            && elog.filter.tag_lvl_num < ELOG_FILTER_TAG_LVL_MAX_NUM) {
+        /* only add the new tag's level filer when level is not ELOG_FILTER_LVL_ALL.
+         * a removed slot still has level ELOG_FILTER_LVL_ALL while its tag is
+         * replaced, so a lookup of the old tag meanwhile gets the same answer */
+        strncpy(slot->tag, tag, ELOG_FILTER_TAG_MAX_LEN);
+        /* publish the slot after the tag, then set the level */
+        __atomic_store_n(&slot->hash, hash, __ATOMIC_RELEASE);
+        slot->level = level;
+        elog.filter.tag_lvl_num++;
     }
     elog_output_unlock();
 }
@@ -477,25 +555,114 @@ void elog_set_filter_tag_lvl(const char *tag, uint8_t level)
 uint8_t elog_get_filter_tag_lvl(const char *tag)
 {
     ELOG_ASSERT(tag != ((void *)0));
-    uint8_t i = 0;
-    uint8_t level = ELOG_FILTER_LVL_ALL;
 
-    if (!elog.init_ok) {
-        return level;
+    return elog_get_filter_tag_lvl_hashed(tag, elog_tag_hash(tag));
+}
+
+/**
+ * get the level on tag's level filer with the precomputed tag hash, lock free
+ *
+ * @param tag tag
+ * @param hash elog_tag_hash(tag)
+ *
+ * @return It will return the lowest level when tag was not found.
+ *         Other level will return when tag was found.
+ */
+uint8_t elog_get_filter_tag_lvl_hashed(const char *tag, uint32_t hash)
+{
+    ElogTagLvlFilter *filter;
+
+    if (!elog.init_ok || elog.filter.tag_lvl_num == 0) {
+        return ELOG_FILTER_LVL_ALL;
     }
 
-    elog_output_lock();
-    /* find the tag in arr */
-    for (i =0; i< ELOG_FILTER_TAG_LVL_MAX_NUM; i++){
-        if (elog.filter.tag_lvl[i].tag_use_flag == true &&
-            !strncmp(tag, elog.filter.tag_lvl[i].tag,ELOG_FILTER_TAG_MAX_LEN)){
-            level = elog.filter.tag_lvl[i].level;
-            break;
-        }
+    filter = elog_find_tag_lvl(tag, hash, NULL);
+    if (filter == NULL) {
+        return ELOG_FILTER_LVL_ALL;
     }
-    elog_output_unlock();
 
-    return level;
+    return filter->level;
+}
+
+/**
+ * claim a free line of the line pool, lock free for any number of writers (thread or ISR)
+ *
+ * @param idx line index, pass it to line_publish
+ *
+ * @return NULL when every line is in use
+ */
+static ElogLine *line_claim(uint32_t *idx) {
+    uint32_t i = __atomic_load_n(&line_write_idx, __ATOMIC_RELAXED);
+
+    do {
+        if (i - __atomic_load_n(&line_read_idx, __ATOMIC_ACQUIRE) >= ELOG_LINE_POOL_NUM) {
+            __atomic_fetch_add(&line_dropped, 1, __ATOMIC_RELAXED);
+            return NULL;
+        }
+    } while (!__atomic_compare_exchange_n(&line_write_idx, &i, i + 1, true,
+            __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+    *idx = i;
+
+    return &line_pool[i & (ELOG_LINE_POOL_NUM - 1)];
+}
+
+/**
+ * output every published line in order. only one context drains at a time,
+ * the others return at once and leave their lines to it
+ */
+static void line_drain(void) {
+    ElogLine *line;
+    uint32_t idx;
+
+    do {
+        if (__atomic_exchange_n(&line_draining, 1, __ATOMIC_ACQUIRE)) {
+            return;
+        }
+        while (1) {
+            idx = line_read_idx;
+            line = &line_pool[idx & (ELOG_LINE_POOL_NUM - 1)];
+            /* stop at the first line that is claimed but not yet published */
+            if (__atomic_load_n(&line->seq, __ATOMIC_ACQUIRE) != idx + 1) {
+                break;
+            }
+            if (line->len) {
+                elog_output_lock();
+#if defined(ELOG_BUF_OUTPUT_ENABLE)
+                extern void elog_buf_output(const char *log, size_t size);
+                elog_buf_output(line->buf, line->len);
+#else
+                if (elog.output)
+                    elog.output(line->buf, line->len);
+#endif
+                elog_output_unlock();
+            }
+            __atomic_store_n(&line_read_idx, idx + 1, __ATOMIC_RELEASE);
+        }
+        __atomic_store_n(&line_draining, 0, __ATOMIC_RELEASE);
+        /* a line published after the last check gave up on draining, take it */
+        idx = __atomic_load_n(&line_read_idx, __ATOMIC_ACQUIRE);
+        line = &line_pool[idx & (ELOG_LINE_POOL_NUM - 1)];
+    } while (__atomic_load_n(&line->seq, __ATOMIC_ACQUIRE) == idx + 1);
+}
+
+/**
+ * publish a formatted line and output the lines ready so far
+ *
+ * @param line line from line_claim
+ * @param idx line index from line_claim
+ * @param len line length, 0 to skip the output
+ */
+static void line_publish(ElogLine *line, uint32_t idx, size_t len) {
+    line->len = len;
+    __atomic_store_n(&line->seq, idx + 1, __ATOMIC_RELEASE);
+    line_drain();
+}
+
+/**
+ * get the number of logs dropped because every line of the line pool was in use
+ */
+uint32_t elog_get_line_dropped(void) {
+    return line_dropped;
 }
 
 /**
@@ -508,20 +675,25 @@ void elog_raw_output(const char *format, ...) {
     va_list args;
     size_t log_len = 0;
     int fmt_result;
+    ElogLine *log_line;
+    uint32_t idx;
 
     /* check output enabled */
     if (!elog.output_enabled) {
         return;
     }
 
+    /* claim a line */
+    log_line = line_claim(&idx);
+    if (log_line == NULL) {
+        return;
+    }
+
     /* args point to the first variable parameter */
     va_start(args, format);
 
-    /* lock output */
-    elog_output_lock();
-
     /* package log data to buffer */
-    fmt_result = vsnprintf(log_buf, ELOG_LINE_BUF_SIZE, format, args);
+    fmt_result = vsnprintf(log_line->buf, ELOG_LINE_BUF_SIZE, format, args);
 
     /* output converted log */
     if ((fmt_result > -1) && (fmt_result <= ELOG_LINE_BUF_SIZE)) {
@@ -529,20 +701,8 @@ void elog_raw_output(const char *format, ...) {
     } else {
         log_len = ELOG_LINE_BUF_SIZE;
     }
-    /* output log */
-#if defined(ELOG_ASYNC_OUTPUT_ENABLE)
-    extern void elog_async_output(uint8_t level, const char *log, size_t size);
-    /* raw log will using assert level */
-    elog_async_output(ELOG_LVL_ASSERT, log_buf, log_len);
-#elif defined(ELOG_BUF_OUTPUT_ENABLE)
-    extern void elog_buf_output(const char *log, size_t size);
-    elog_buf_output(log_buf, log_len);
-#else
-    if (elog.output)
-        elog.output(log_buf, log_len);
-#endif
-    /* unlock output */
-    elog_output_unlock();
+    /* output log, raw log is always synchronous */
+    line_publish(log_line, idx, log_len);
 
     va_end(args);
 }
@@ -561,12 +721,43 @@ void elog_raw_output(const char *format, ...) {
  */
 void elog_output(uint8_t level, const char *tag, const char *file, const char *func,\
         const long line, const char *format, ...) {
+    va_list args;
 
-    size_t tag_len = strlen(tag), log_len = 0, newline_len = strlen(ELOG_NEWLINE_SIGN);
-    char line_num[ELOG_LINE_NUM_MAX_LEN + 1] = { 0 };
-    char tag_sapce[ELOG_FILTER_TAG_MAX_LEN / 2 + 1] = { 0 };
+    /* args point to the first variable parameter */
+    va_start(args, format);
+    elog_voutput(level, tag, elog_tag_hash(tag), file, func, line, format, args);
+    va_end(args);
+}
+
+/**
+ * output the log with the precomputed tag hash, used by the elog_x macros
+ *
+ * @param level level
+ * @param tag tag
+ * @param hash elog_tag_hash(tag)
+ * @param file file name
+ * @param func function name
+ * @param line line number
+ * @param format output format
+ * @param ... args
+ *
+ */
+void elog_output_hashed(uint8_t level, const char *tag, uint32_t hash, const char *file, const char *func,
+        const long line, const char *format, ...) {
     va_list args;
-    int fmt_result;
+
+    /* args point to the first variable parameter */
+    va_start(args, format);
+    elog_voutput(level, tag, hash, file, func, line, format, args);
+    va_end(args);
+}
+
+/**
+ * filter and output the log
+ */
+static void elog_voutput(uint8_t level, const char *tag, uint32_t hash, const char *file, const char *func,
+        const long line, const char *format, va_list args) {
+    ElogVaFormatCtx ctx;
 
     ELOG_ASSERT(level <= ELOG_LVL_VERBOSE);
 
@@ -575,16 +766,66 @@ void elog_output(uint8_t level, const char *tag, const char *file, const char *f
         return;
     }
     /* level filter */
-    if (level > elog.filter.level || level > elog_get_filter_tag_lvl(tag)) {
+    if (level > elog.filter.level || level > elog_get_filter_tag_lvl_hashed(tag, hash)) {
         return;
-    } else if (!strstr(tag, elog.filter.tag)) { /* tag filter */
+    } else if (elog.filter.tag[0] != '\0' && !strstr(tag, elog.filter.tag)) { /* tag filter */
         return;
     }
-    /* args point to the first variable parameter */
-    va_start(args, format);
-    /* lock output */
-    elog_output_lock();
 
+#ifdef ELOG_ASYNC_OUTPUT_ENABLE
+    /* defer formatting: only the raw arguments are queued here */
+    if (level >= ELOG_ASYNC_OUTPUT_LVL && elog_async_get_enabled()) {
+        elog_async_output(level, tag, file, func, line, format, args);
+        return;
+    }
+#endif
+
+    ctx.format = format;
+    va_copy(ctx.args, args);
+    elog_output_line(level, tag, file, func, line, elog_va_formatter, &ctx);
+    va_end(ctx.args);
+}
+
+/**
+ * vsnprintf based message formatter for elog_output_line
+ */
+static int elog_va_formatter(char *buf, size_t size, void *ctx) {
+    ElogVaFormatCtx *va = (ElogVaFormatCtx *)ctx;
+
+    return vsnprintf(buf, size, va->format, va->args);
+}
+
+/**
+ * package and output one log line, the message body is produced by the formatter
+ * @note filters (except keyword) must be checked by caller
+ *
+ * @param level level
+ * @param tag tag
+ * @param file file name
+ * @param func function name
+ * @param line line number
+ * @param formatter message body formatter, vsnprintf-like return value
+ * @param ctx formatter context
+ */
+void elog_output_line(uint8_t level, const char *tag, const char *file, const char *func,
+        const long line, ElogMsgFormatter formatter, void *ctx) {
+
+    size_t tag_len = strlen(tag), log_len = 0, newline_len = strlen(ELOG_NEWLINE_SIGN);
+    char line_num[ELOG_LINE_NUM_MAX_LEN + 1] = { 0 };
+    char tag_sapce[ELOG_FILTER_TAG_MAX_LEN / 2 + 1] = { 0 };
+    int fmt_result;
+    ElogLine *log_line;
+    char *log_buf;
+    uint32_t idx;
+
+    ELOG_ASSERT(level <= ELOG_LVL_VERBOSE);
+
+    /* claim a line, it is formatted without holding the output lock */
+    log_line = line_claim(&idx);
+    if (log_line == NULL) {
+        return;
+    }
+    log_buf = log_line->buf;
 #ifdef ELOG_COLOR_ENABLE
     /* add CSI start sign and color info */
     if (elog.text_color_enabled) {
@@ -661,10 +902,9 @@ void elog_output(uint8_t level, const char *tag, const char *file, const char *f
         }
         log_len += elog_strcpy(log_len, log_buf + log_len, "):");
     }
-    /* package other log data to buffer. '\0' must be added in the end by vsnprintf. */
-    fmt_result = vsnprintf(log_buf + log_len, ELOG_LINE_BUF_SIZE - log_len, format, args);
+    /* package other log data to buffer. '\0' must be added in the end by formatter. */
+    fmt_result = formatter(log_buf + log_len, ELOG_LINE_BUF_SIZE - log_len, ctx);
 
-    va_end(args);
     /* calculate log length */
     if ((log_len + fmt_result <= ELOG_LINE_BUF_SIZE) && (fmt_result > -1)) {
         log_len += fmt_result;
@@ -693,8 +933,8 @@ void elog_output(uint8_t level, const char *tag, const char *file, const char *f
         log_buf[log_len] = '\0';
         /* find the keyword */
         if (!strstr(log_buf, elog.filter.keyword)) {
-            /* unlock output */
-            elog_output_unlock();
+            /* keep the line order, publish it with nothing to output */
+            line_publish(log_line, idx, 0);
             return;
         }
     }
@@ -713,17 +953,19 @@ void elog_output(uint8_t level, const char *tag, const char *file, const char *f
     log_buf[log_len] = '\0';
 
     /* output log */
-#if defined(ELOG_ASYNC_OUTPUT_ENABLE)
-    extern void elog_async_output(uint8_t level, const char *log, size_t size);
-    elog_async_output(level, log_buf, log_len);
-#elif defined(ELOG_BUF_OUTPUT_ENABLE)
-    extern void elog_buf_output(const char *log, size_t size);
-    elog_buf_output(log_buf, log_len);
-#else
+    line_publish(log_line, idx, log_len);
+}
+
+/**
+ * output bytes as they are, e.g. binary log frames
+ *
+ * @param log bytes
+ * @param size size
+ */
+void elog_output_bytes(const char *log, size_t size) {
+    elog_output_lock();
     if (elog.output)
-        elog.output(log_buf, log_len);
-#endif
-    /* unlock output */
+        elog.output(log, size);
     elog_output_unlock();
 }
 
@@ -735,7 +977,12 @@ void elog_output(uint8_t level, const char *tag, const char *file, const char *f
  *
  * @return enable or disable
  */
-static bool get_fmt_enabled(uint8_t level, size_t set) {
+static inline bool get_fmt_enabled(uint8_t level, size_t set) {
+#ifdef ELOG_FMT_STATIC
+    /* constant set, the branches of the disabled formats are folded away */
+    (void)level;
+    return (ELOG_FMT_STATIC(level) & set) ? true : false;
+#else
     ELOG_ASSERT(level <= ELOG_LVL_VERBOSE);
 
     if (elog.enabled_fmt_set[level] & set) {
@@ -743,12 +990,13 @@ static bool get_fmt_enabled(uint8_t level, size_t set) {
     } else {
         return false;
     }
+#endif /* ELOG_FMT_STATIC */
 }
 
-static bool get_fmt_used_and_enabled_u32(uint8_t level, size_t set, uint32_t arg) {
+static inline bool get_fmt_used_and_enabled_u32(uint8_t level, size_t set, uint32_t arg) {
     return arg && get_fmt_enabled(level, set);
 }
-static bool get_fmt_used_and_enabled_ptr(uint8_t level, size_t set, const char* arg) {
+static inline bool get_fmt_used_and_enabled_ptr(uint8_t level, size_t set, const char* arg) {
     return arg && get_fmt_enabled(level, set);
 }
 
@@ -873,6 +1121,9 @@ void elog_hex_output(uint8_t level, const char *tag, const void *buf, uint16_t s
     int fmt_result;
     size_t tag_len = strlen(tag);
     char tag_sapce[ELOG_FILTER_TAG_MAX_LEN / 2 + 1] = { 0 };
+    ElogLine *log_line;
+    char *log_buf;
+    uint32_t idx;
 
     if (!elog.output_enabled) {
         return;
@@ -881,12 +1132,16 @@ void elog_hex_output(uint8_t level, const char *tag, const void *buf, uint16_t s
     /* level filter */
     if (level > elog.filter.level || level > elog_get_filter_tag_lvl(tag)) {
         return;
-    } else if (!strstr(tag, elog.filter.tag)) { /* tag filter */
+    } else if (elog.filter.tag[0] != '\0' && !strstr(tag, elog.filter.tag)) { /* tag filter */
         return;
     }
 
-    /* lock output */
-    elog_output_lock();
+    /* claim a line */
+    log_line = line_claim(&idx);
+    if (log_line == NULL) {
+        return;
+    }
+    log_buf = log_line->buf;
 
     if (get_fmt_enabled(level, ELOG_FMT_TAG)) {
         log_len += elog_strcpy(log_len, log_buf + log_len, tag);
@@ -911,18 +1166,6 @@ void elog_hex_output(uint8_t level, const char *tag, const void *buf, uint16_t s
     log_len += elog_strcpy(log_len, log_buf + log_len, "\r\n");
     /* add string end sign */
     log_buf[log_len] = '\0';
-    /* do log output */
-#if defined(ELOG_ASYNC_OUTPUT_ENABLE)
-    extern void elog_async_output(uint8_t level, const char *log, size_t size);
-    elog_async_output(level, log_buf, log_len);
-#elif defined(ELOG_BUF_OUTPUT_ENABLE)
-    extern void elog_buf_output(const char *log, size_t size);
-    elog_buf_output(log_buf, log_len);
-#else
-    if (elog.output)
-        elog.output(log_buf, log_len);
-#endif
-
-    /* unlock output */
-    elog_output_unlock();
+    /* do log output, hex dump is always synchronous */
+    line_publish(log_line, idx, log_len);
 }
@@ -33,6 +33,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdarg.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -53,9 +54,31 @@ extern "C" {
 /* output log's level total number */
 #define ELOG_LVL_TOTAL_NUM                   6
 
+/**
+ * tag hash (FNV-1a) for the tag level filter, only the first ELOG_FILTER_TAG_MAX_LEN
+ * characters are used. GCC folds it to a constant for string literal tags when optimizing.
+ */
+static inline uint32_t elog_tag_hash(const char *tag) {
+    uint32_t hash = 2166136261UL;
+    size_t i;
+
+    for (i = 0; i < ELOG_FILTER_TAG_MAX_LEN && tag[i] != '\0'; i++) {
+        hash = (hash ^ (uint8_t)tag[i]) * 16777619UL;
+    }
+
+    return hash ? hash : 1;
+}
+
 /* EasyLogger software version number */
 #define ELOG_SW_VERSION                      "2.2.99"
 
+/* queued logs must reach the output before an assert halts */
+#ifdef ELOG_ASYNC_OUTPUT_ENABLE
+    #define ELOG_ASYNC_FLUSH()                   elog_async_flush()
+#else
+    #define ELOG_ASYNC_FLUSH()                   ((void)0)
+#endif
+
 /* EasyLogger assert for developer. */
 #ifdef ELOG_ASSERT_ENABLE
     #define ELOG_ASSERT(EXPR)                                                 \
@@ -63,6 +86,7 @@ extern "C" {
     {                                                                         \
         if (elog_assert_hook == NULL) {                                       \
             elog_a("elog", "(%s) has assert failed at %s:%ld.", #EXPR, __FUNCTION__, __LINE__); \
+            ELOG_ASYNC_FLUSH();                                               \
             while (1);                                                        \
         } else {                                                              \
             elog_assert_hook(#EXPR, __FUNCTION__, __LINE__);                  \
@@ -103,42 +127,48 @@ extern "C" {
     #define elog_raw(...)  elog_raw_output(__VA_ARGS__)
     #if ELOG_OUTPUT_LVL >= ELOG_LVL_ASSERT
         #define elog_assert(tag, ...) \
-                elog_output(ELOG_LVL_ASSERT, tag, ELOG_OUTPUT_DIR, ELOG_OUTPUT_FUNC, ELOG_OUTPUT_LINE, __VA_ARGS__)
+                elog_output_hashed(ELOG_LVL_ASSERT, tag, elog_tag_hash(tag), ELOG_OUTPUT_DIR, ELOG_OUTPUT_FUNC, \
+                        ELOG_OUTPUT_LINE, __VA_ARGS__)
     #else
         #define elog_assert(tag, ...)
     #endif /* ELOG_OUTPUT_LVL >= ELOG_LVL_ASSERT */
 
     #if ELOG_OUTPUT_LVL >= ELOG_LVL_ERROR
         #define elog_error(tag, ...) \
-                elog_output(ELOG_LVL_ERROR, tag, ELOG_OUTPUT_DIR, ELOG_OUTPUT_FUNC, ELOG_OUTPUT_LINE, __VA_ARGS__)
+                elog_output_hashed(ELOG_LVL_ERROR, tag, elog_tag_hash(tag), ELOG_OUTPUT_DIR, ELOG_OUTPUT_FUNC, \
+                        ELOG_OUTPUT_LINE, __VA_ARGS__)
     #else
         #define elog_error(tag, ...)
     #endif /* ELOG_OUTPUT_LVL >= ELOG_LVL_ERROR */
 
     #if ELOG_OUTPUT_LVL >= ELOG_LVL_WARN
         #define elog_warn(tag, ...) \
-                elog_output(ELOG_LVL_WARN, tag, ELOG_OUTPUT_DIR, ELOG_OUTPUT_FUNC, ELOG_OUTPUT_LINE, __VA_ARGS__)
+                elog_output_hashed(ELOG_LVL_WARN, tag, elog_tag_hash(tag), ELOG_OUTPUT_DIR, ELOG_OUTPUT_FUNC, \
+                        ELOG_OUTPUT_LINE, __VA_ARGS__)
     #else
         #define elog_warn(tag, ...)
     #endif /* ELOG_OUTPUT_LVL >= ELOG_LVL_WARN */
 
     #if ELOG_OUTPUT_LVL >= ELOG_LVL_INFO
         #define elog_info(tag, ...) \
-                elog_output(ELOG_LVL_INFO, tag, ELOG_OUTPUT_DIR, ELOG_OUTPUT_FUNC, ELOG_OUTPUT_LINE, __VA_ARGS__)
+                elog_output_hashed(ELOG_LVL_INFO, tag, elog_tag_hash(tag), ELOG_OUTPUT_DIR, ELOG_OUTPUT_FUNC, \
+                        ELOG_OUTPUT_LINE, __VA_ARGS__)
     #else
         #define elog_info(tag, ...)
     #endif /* ELOG_OUTPUT_LVL >= ELOG_LVL_INFO */
 
     #if ELOG_OUTPUT_LVL >= ELOG_LVL_DEBUG
         #define elog_debug(tag, ...) \
-                elog_output(ELOG_LVL_DEBUG, tag, ELOG_OUTPUT_DIR, ELOG_OUTPUT_FUNC, ELOG_OUTPUT_LINE, __VA_ARGS__)
+                elog_output_hashed(ELOG_LVL_DEBUG, tag, elog_tag_hash(tag), ELOG_OUTPUT_DIR, ELOG_OUTPUT_FUNC, \
+                        ELOG_OUTPUT_LINE, __VA_ARGS__)
     #else
         #define elog_debug(tag, ...)
     #endif /* ELOG_OUTPUT_LVL >= ELOG_LVL_DEBUG */
 
     #if ELOG_OUTPUT_LVL == ELOG_LVL_VERBOSE
         #define elog_verbose(tag, ...) \
-                elog_output(ELOG_LVL_VERBOSE, tag, ELOG_OUTPUT_DIR, ELOG_OUTPUT_FUNC, ELOG_OUTPUT_LINE, __VA_ARGS__)
+                elog_output_hashed(ELOG_LVL_VERBOSE, tag, elog_tag_hash(tag), ELOG_OUTPUT_DIR, ELOG_OUTPUT_FUNC, \
+                        ELOG_OUTPUT_LINE, __VA_ARGS__)
     #else
         #define elog_verbose(tag, ...)
     #endif /* ELOG_OUTPUT_LVL == ELOG_LVL_VERBOSE */
@@ -160,11 +190,11 @@ typedef enum {
 #define ELOG_FMT_ALL    (ELOG_FMT_LVL|ELOG_FMT_TAG|ELOG_FMT_TIME|ELOG_FMT_P_INFO|ELOG_FMT_T_INFO| \
     ELOG_FMT_DIR|ELOG_FMT_FUNC|ELOG_FMT_LINE)
 
-/* output log's tag filter */
+/* output log's tag filter, one slot of the open addressing hash table */
 typedef struct {
-    uint8_t level;
+    volatile uint32_t hash; /**< elog_tag_hash of tag, 0: slot is no used */
+    volatile uint8_t level;
     char tag[ELOG_FILTER_TAG_MAX_LEN + 1];
-    bool tag_use_flag; /**< false : tag is no used   true: tag is used */
 } ElogTagLvlFilter, *ElogTagLvlFilter_t;
 
 /* output log's filter */
@@ -172,7 +202,8 @@ typedef struct {
     uint8_t level;
     char tag[ELOG_FILTER_TAG_MAX_LEN + 1];
     char keyword[ELOG_FILTER_KW_MAX_LEN + 1];
-    ElogTagLvlFilter tag_lvl[ELOG_FILTER_TAG_LVL_MAX_NUM];
+    ElogTagLvlFilter tag_lvl[ELOG_FILTER_TAG_LVL_HASH_SIZE];
+    uint8_t tag_lvl_num; /**< tag_lvl slots with a level filter, removed ones are not counted */
 } ElogFilter, *ElogFilter_t;
 
 typedef struct easy_logger_int_struct
@@ -218,6 +249,9 @@ typedef enum {
     ELOG_NO_ERR,
 } ElogErrCode;
 
+/* log message body formatter, returns the same as vsnprintf */
+typedef int (*ElogMsgFormatter)(char *buf, size_t size, void *ctx);
+
 /* elog.c */
 ElogErrCode elog_init(easy_logger_int_struct_t *init_struct);
 void elog_deinit(void);
@@ -234,9 +268,16 @@ void elog_set_filter_tag(const char *tag);
 void elog_set_filter_kw(const char *keyword);
 void elog_set_filter_tag_lvl(const char *tag, uint8_t level);
 uint8_t elog_get_filter_tag_lvl(const char *tag);
+uint8_t elog_get_filter_tag_lvl_hashed(const char *tag, uint32_t hash);
 void elog_raw_output(const char *format, ...);
 void elog_output(uint8_t level, const char *tag, const char *file, const char *func,
         const long line, const char *format, ...);
+void elog_output_hashed(uint8_t level, const char *tag, uint32_t hash, const char *file, const char *func,
+        const long line, const char *format, ...);
+void elog_output_line(uint8_t level, const char *tag, const char *file, const char *func,
+        const long line, ElogMsgFormatter formatter, void *ctx);
+void elog_output_bytes(const char *log, size_t size);
+uint32_t elog_get_line_dropped(void);
 void elog_output_lock_enabled(bool enabled);
 extern void (*elog_assert_hook)(const char* expr, const char* func, size_t line);
 void elog_assert_set_hook(void (*hook)(const char* expr, const char* func, size_t line));
@@ -310,9 +351,15 @@ void elog_hex_output(uint8_t level, const char *tag, const void *buf, uint16_t s
 // void elog_flush(void);
 
 /* elog_async.c */
-// void elog_async_enabled(bool enabled);
-// size_t elog_async_get_log(char *log, size_t size);
-// size_t elog_async_get_line_log(char *log, size_t size);
+ElogErrCode elog_async_init(void);
+void elog_async_deinit(void);
+void elog_async_enabled(bool enabled);
+bool elog_async_get_enabled(void);
+void elog_async_output(uint8_t level, const char *tag, const char *file, const char *func,
+        const long line, const char *format, va_list args);
+size_t elog_async_flush(void);
+uint32_t elog_async_get_dropped(void);
+void elog_async_output_notice(void);
 
 /* elog_utils.c */
 size_t elog_strcpy(size_t cur_len, char *dst, const char *src);
@@ -0,0 +1,533 @@
+/*
+ * This file is part of the EasyLogger Library.
+ *
+ * Copyright (c) 2016, Armink, <armink.ztl@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * 'Software'), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Function: Logs asynchronous output with deferred formatting.
+ *           The caller only packs the raw arguments into a record slot, the
+ *           formatting and output run later in elog_async_flush().
+ *           With ELOG_BINARY_OUTPUT_ENABLE the records are sent as binary
+ *           frames and formatted on host by Tools/elog_decode.py.
+ * Created on: 2016-11-06
+ */
+
+#include <elog.h>
+#include <string.h>
+#include <stdio.h>
+
+#if defined(ELOG_BINARY_OUTPUT_ENABLE) && !defined(ELOG_ASYNC_OUTPUT_ENABLE)
+    #error "ELOG_BINARY_OUTPUT_ENABLE needs ELOG_ASYNC_OUTPUT_ENABLE"
+#endif
+
+#ifdef ELOG_ASYNC_OUTPUT_ENABLE
+
+#if !defined(ELOG_ASYNC_RECORD_NUM)
+    #error "Please configure async log record number (in elog_cfg.h)"
+#endif
+
+#if (ELOG_ASYNC_RECORD_NUM & (ELOG_ASYNC_RECORD_NUM - 1)) != 0
+    #error "ELOG_ASYNC_RECORD_NUM must be power of 2"
+#endif
+
+#if !defined(ELOG_ASYNC_ARG_WORDS)
+    #error "Please configure async log argument words (in elog_cfg.h)"
+#endif
+
+#if defined(ELOG_BINARY_OUTPUT_ENABLE) && !defined(ELOG_BINARY_ADDR_BASE)
+    #error "Please configure binary log address base (in elog_cfg.h)"
+#endif
+
+/* max length of one printf conversion, e.g. "%-08.3lx" */
+#define ELOG_ASYNC_SPEC_MAX_LEN        15
+
+/* argument class of a printf conversion */
+typedef enum {
+    ARG_NONE,
+    ARG_INT,
+    ARG_LONG,
+    ARG_LLONG,
+    ARG_SIZE,
+    ARG_PTR,
+    ARG_DOUBLE,
+} ElogArgClass;
+
+/* one parsed printf conversion */
+typedef struct {
+    const char *start;
+    size_t len;
+    uint8_t stars;
+    ElogArgClass cls;
+} ElogConvSpec;
+
+/* one deferred log record */
+typedef struct {
+    volatile uint32_t seq;      /**< record index + 1 once published */
+    uint8_t level;
+    uint8_t truncated;          /**< arguments did not fit */
+    uint8_t words;              /**< used argument words */
+    long line;
+    const char *tag;
+    const char *file;
+    const char *func;
+    const char *format;
+    uint32_t args[ELOG_ASYNC_ARG_WORDS];
+} ElogAsyncRecord;
+
+static ElogAsyncRecord records[ELOG_ASYNC_RECORD_NUM];
+/* producers claim slots by CAS on write_idx, the single consumer owns read_idx */
+static volatile uint32_t write_idx = 0;
+static volatile uint32_t read_idx = 0;
+static volatile uint32_t dropped = 0;
+static bool is_enabled = false;
+
+/**
+ * parse one conversion starting at '%'
+ *
+ * @return the character after the conversion
+ */
+static const char *parse_spec(const char *p, ElogConvSpec *spec) {
+    uint8_t longs = 0, size_t_len = 0;
+
+    spec->start = p++;
+    spec->stars = 0;
+    spec->cls = ARG_NONE;
+
+    /* flags */
+    while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') {
+        p++;
+    }
+    /* width */
+    if (*p == '*') {
+        spec->stars++;
+        p++;
+    } else {
+        while (*p >= '0' && *p <= '9') p++;
+    }
+    /* precision */
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            spec->stars++;
+            p++;
+        } else {
+            while (*p >= '0' && *p <= '9') p++;
+        }
+    }
+    /* length */
+    while (*p == 'l') {
+        longs++;
+        p++;
+    }
+    while (*p == 'h') p++;
+    if (*p == 'z' || *p == 't') {
+        size_t_len = 1;
+        p++;
+    } else if (*p == 'j') {
+        longs = 2;
+        p++;
+    }
+
+    switch (*p) {
+    case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+        if (longs >= 2) {
+            spec->cls = ARG_LLONG;
+        } else if (longs == 1) {
+            spec->cls = ARG_LONG;
+        } else if (size_t_len) {
+            spec->cls = ARG_SIZE;
+        } else {
+            spec->cls = ARG_INT;
+        }
+        break;
+    case 's': case 'p':
+        spec->cls = ARG_PTR;
+        break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        spec->cls = ARG_DOUBLE;
+        break;
+    default:
+        break;
+    }
+    if (*p != '\0') {
+        p++;
+    }
+    spec->len = (size_t)(p - spec->start);
+
+    return p;
+}
+
+/**
+ * store one argument value into the record
+ *
+ * @return false when the record is full
+ */
+static bool put_arg(ElogAsyncRecord *rec, size_t *word, const void *val, size_t size) {
+    size_t words = (size + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    if (*word + words > ELOG_ASYNC_ARG_WORDS) {
+        rec->truncated = 1;
+        return false;
+    }
+    memcpy(&rec->args[*word], val, size);
+    *word += words;
+    rec->words = (uint8_t)*word;
+
+    return true;
+}
+
+static bool get_arg(const ElogAsyncRecord *rec, size_t *word, void *val, size_t size) {
+    size_t words = (size + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    if (*word + words > ELOG_ASYNC_ARG_WORDS) {
+        return false;
+    }
+    memcpy(val, &rec->args[*word], size);
+    *word += words;
+
+    return true;
+}
+
+#define PUT_ARG(type)                                                         \
+    do {                                                                      \
+        type v_ = va_arg(args, type);                                         \
+        if (!put_arg(rec, &word, &v_, sizeof(v_))) return;                    \
+    } while (0)
+
+/**
+ * copy the raw variable arguments described by the format into the record
+ */
+static void pack_args(ElogAsyncRecord *rec, const char *format, va_list args) {
+    ElogConvSpec spec;
+    size_t word = 0;
+    uint8_t i;
+
+    while (*format) {
+        if (*format != '%') {
+            format++;
+            continue;
+        }
+        format = parse_spec(format, &spec);
+        for (i = 0; i < spec.stars; i++) {
+            PUT_ARG(int);
+        }
+        switch (spec.cls) {
+        case ARG_INT:    PUT_ARG(int);       break;
+        case ARG_LONG:   PUT_ARG(long);      break;
+        case ARG_LLONG:  PUT_ARG(long long); break;
+        case ARG_SIZE:   PUT_ARG(size_t);    break;
+        case ARG_PTR:    PUT_ARG(void *);    break;
+        case ARG_DOUBLE: PUT_ARG(double);    break;
+        default:                             break;
+        }
+    }
+}
+
+/**
+ * append a string to the formatter output, keeping the vsnprintf length semantics
+ */
+static void append_str(char *buf, size_t size, size_t *len, const char *src, size_t n) {
+    if (*len < size) {
+        size_t room = size - *len - 1;
+        memcpy(buf + *len, src, (n < room) ? n : room);
+    }
+    *len += n;
+}
+
+#define FMT_ARG(type)                                                                     \
+    do {                                                                                  \
+        type v_;                                                                          \
+        if (!get_arg(rec, &word, &v_, sizeof(v_))) goto __exit;                           \
+        n = (spec.stars == 0) ? snprintf(dst, room, spec_buf, v_) :                       \
+            (spec.stars == 1) ? snprintf(dst, room, spec_buf, star[0], v_) :              \
+                                snprintf(dst, room, spec_buf, star[0], star[1], v_);      \
+    } while (0)
+
+/**
+ * message formatter of a queued record, used by elog_output_line
+ */
+static int async_formatter(char *buf, size_t size, void *ctx) {
+    const ElogAsyncRecord *rec = (const ElogAsyncRecord *)ctx;
+    const char *p = rec->format;
+    char spec_buf[ELOG_ASYNC_SPEC_MAX_LEN + 1];
+    ElogConvSpec spec;
+    size_t len = 0, word = 0;
+    int star[2] = { 0 };
+    uint8_t i;
+
+    if (size == 0) {
+        return 0;
+    }
+
+    while (*p) {
+        if (*p != '%') {
+            const char *next = strchr(p, '%');
+            size_t n = (next != NULL) ? (size_t)(next - p) : strlen(p);
+            append_str(buf, size, &len, p, n);
+            p += n;
+            continue;
+        }
+
+        p = parse_spec(p, &spec);
+        if (spec.cls == ARG_NONE) {
+            /* "%%" or an unsupported conversion */
+            if (spec.len == 2 && spec.start[1] == '%') {
+                append_str(buf, size, &len, "%", 1);
+            }
+            continue;
+        }
+        if (spec.len > ELOG_ASYNC_SPEC_MAX_LEN) {
+            goto __exit;
+        }
+        memcpy(spec_buf, spec.start, spec.len);
+        spec_buf[spec.len] = '\0';
+        /* parse_spec counts at most two '*' (width and precision) */
+        for (i = 0; i < spec.stars && i < 2; i++) {
+            if (!get_arg(rec, &word, &star[i], sizeof(int))) goto __exit;
+        }
+
+        {
+            char *dst = buf + ((len < size) ? len : size - 1);
+            size_t room = (len < size) ? size - len : 1;
+            int n = 0;
+
+            switch (spec.cls) {
+            case ARG_INT:    FMT_ARG(int);          break;
+            case ARG_LONG:   FMT_ARG(long);         break;
+            case ARG_LLONG:  FMT_ARG(long long);    break;
+            case ARG_SIZE:   FMT_ARG(size_t);       break;
+            case ARG_PTR:    FMT_ARG(void *);       break;
+            case ARG_DOUBLE: FMT_ARG(double);       break;
+            default:                                break;
+            }
+            if (n > 0) {
+                len += (size_t)n;
+            }
+        }
+    }
+
+__exit:
+    if (rec->truncated) {
+        append_str(buf, size, &len, "...", 3);
+    }
+    buf[(len < size) ? len : size - 1] = '\0';
+
+    return (int)len;
+}
+
+#ifdef ELOG_BINARY_OUTPUT_ENABLE
+/*
+ * binary frame:
+ *   0xA5 | hdr | fmt | tag | [func] | [file line] | words | arg * words | check
+ *   hdr bit0-2: level, bit3: func present, bit4: file and line present, bit5: truncated
+ *   strings are sent as varint(address - ELOG_BINARY_ADDR_BASE), args as zigzag varint
+ *   of every 32-bit word, check = ~(sum of all previous bytes)
+ */
+#define ELOG_BIN_SYNC                  0xA5
+#define ELOG_BIN_HDR_FUNC              (1 << 3)
+#define ELOG_BIN_HDR_FILE_LINE         (1 << 4)
+#define ELOG_BIN_HDR_TRUNCATED         (1 << 5)
+#define ELOG_BIN_FRAME_MAX             (3 + 5 * 10 + 1 + 5 * ELOG_ASYNC_ARG_WORDS + 1)
+
+static size_t put_varint(uint8_t *buf, uintptr_t val) {
+    size_t len = 0;
+
+    while (val >= 0x80) {
+        buf[len++] = (uint8_t)(val | 0x80);
+        val >>= 7;
+    }
+    buf[len++] = (uint8_t)val;
+
+    return len;
+}
+
+static size_t put_addr(uint8_t *buf, const void *addr) {
+    return put_varint(buf, (uintptr_t)addr - (uintptr_t)ELOG_BINARY_ADDR_BASE);
+}
+
+/**
+ * encode one record into a binary frame
+ *
+ * @return frame length
+ */
+static size_t encode_record(const ElogAsyncRecord *rec, uint8_t *frame) {
+    size_t len = 0, i;
+    uint8_t hdr = rec->level & 0x07, sum = 0;
+
+    if (rec->func) hdr |= ELOG_BIN_HDR_FUNC;
+    if (rec->file) hdr |= ELOG_BIN_HDR_FILE_LINE;
+    if (rec->truncated) hdr |= ELOG_BIN_HDR_TRUNCATED;
+
+    frame[len++] = ELOG_BIN_SYNC;
+    frame[len++] = hdr;
+    len += put_addr(frame + len, rec->format);
+    len += put_addr(frame + len, rec->tag);
+    if (rec->func) {
+        len += put_addr(frame + len, rec->func);
+    }
+    if (rec->file) {
+        len += put_addr(frame + len, rec->file);
+        len += put_varint(frame + len, (uint32_t)rec->line);
+    }
+    frame[len++] = rec->words;
+    for (i = 0; i < rec->words; i++) {
+        int32_t w = (int32_t)rec->args[i];
+        len += put_varint(frame + len, ((uint32_t)w << 1) ^ (uint32_t)(w >> 31));
+    }
+    for (i = 0; i < len; i++) {
+        sum += frame[i];
+    }
+    frame[len++] = (uint8_t)~sum;
+
+    return len;
+}
+#endif /* ELOG_BINARY_OUTPUT_ENABLE */
+
+/**
+ * queue one log, only the raw arguments are copied
+ * @note the format, tag, func and every "%s" argument must point to static storage
+ *
+ * @param level level
+ * @param tag tag
+ * @param file file name
+ * @param func function name
+ * @param line line number
+ * @param format output format
+ * @param args variable arguments
+ */
+void elog_async_output(uint8_t level, const char *tag, const char *file, const char *func,
+        const long line, const char *format, va_list args) {
+    ElogAsyncRecord *rec;
+    uint32_t idx;
+
+    /* claim a slot, lock free for any number of producers (thread or ISR) */
+    idx = __atomic_load_n(&write_idx, __ATOMIC_RELAXED);
+    do {
+        if (idx - __atomic_load_n(&read_idx, __ATOMIC_ACQUIRE) >= ELOG_ASYNC_RECORD_NUM) {
+            __atomic_fetch_add(&dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+    } while (!__atomic_compare_exchange_n(&write_idx, &idx, idx + 1, true,
+            __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    rec = &records[idx & (ELOG_ASYNC_RECORD_NUM - 1)];
+    rec->level = level;
+    rec->truncated = 0;
+    rec->words = 0;
+    rec->line = line;
+    rec->tag = tag;
+    rec->file = file;
+    rec->func = func;
+    rec->format = format;
+    pack_args(rec, format, args);
+
+    /* publish */
+    __atomic_store_n(&rec->seq, idx + 1, __ATOMIC_RELEASE);
+
+    elog_async_output_notice();
+}
+
+/**
+ * format and output every published record in order
+ * @note call it from one context only, e.g. the main loop or PendSV
+ *
+ * @return output record count
+ */
+size_t elog_async_flush(void) {
+    ElogAsyncRecord *rec;
+    uint32_t idx;
+    size_t count = 0;
+#ifdef ELOG_BINARY_OUTPUT_ENABLE
+    uint8_t frame[ELOG_BIN_FRAME_MAX];
+#endif
+
+    while (1) {
+        idx = read_idx;
+        rec = &records[idx & (ELOG_ASYNC_RECORD_NUM - 1)];
+        /* stop at the first slot that is claimed but not yet published */
+        if (__atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE) != idx + 1) {
+            break;
+        }
+#ifdef ELOG_BINARY_OUTPUT_ENABLE
+        elog_output_bytes((const char *)frame, encode_record(rec, frame));
+#else
+        elog_output_line(rec->level, rec->tag, rec->file, rec->func, rec->line, async_formatter, rec);
+#endif
+        __atomic_store_n(&read_idx, idx + 1, __ATOMIC_RELEASE);
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * get the number of logs dropped because the record queue was full
+ */
+uint32_t elog_async_get_dropped(void) {
+    return dropped;
+}
+
+/**
+ * it will be called after a log is queued. Override it to trigger the flush,
+ * e.g. set PendSV pending and call elog_async_flush() in PendSV_Handler.
+ */
+__attribute__((weak)) void elog_async_output_notice(void) {
+}
+
+/**
+ * enable or disable asynchronous output mode
+ * the log will be output directly when mode is disabled
+ *
+ * @param enabled true: enabled, false: disabled
+ */
+void elog_async_enabled(bool enabled) {
+    is_enabled = enabled;
+}
+
+/**
+ * get asynchronous output mode enable status
+ */
+bool elog_async_get_enabled(void) {
+    return is_enabled;
+}
+
+/**
+ * asynchronous output mode initialize
+ *
+ * @return result
+ */
+ElogErrCode elog_async_init(void) {
+    memset(records, 0, sizeof(records));
+    write_idx = 0;
+    read_idx = 0;
+    dropped = 0;
+
+    return ELOG_NO_ERR;
+}
+
+/**
+ * asynchronous output mode deinitialize
+ */
+void elog_async_deinit(void) {
+    is_enabled = false;
+}
+
+#endif /* ELOG_ASYNC_OUTPUT_ENABLE */
@@ -37,6 +37,8 @@
 #define ELOG_ASSERT_ENABLE
 /* buffer size for every line's log */
 #define ELOG_LINE_BUF_SIZE                       128
+/* line pool size, lines being formatted by different contexts at once, must be power of 2 */
+#define ELOG_LINE_POOL_NUM                       4
 /* output line number max length */
 #define ELOG_LINE_NUM_MAX_LEN                    5
 /* output filter's tag max length */
@@ -44,7 +46,9 @@
 /* output filter's keyword max length */
 #define ELOG_FILTER_KW_MAX_LEN                   16
 /* output filter's tag level max num */
-#define ELOG_FILTER_TAG_LVL_MAX_NUM              5
+#define ELOG_FILTER_TAG_LVL_MAX_NUM              16
+/* tag level hash table size, must be power of 2 and larger than the max num */
+#define ELOG_FILTER_TAG_LVL_HASH_SIZE            32
 /* output newline sign */
 #define ELOG_NEWLINE_SIGN                        "\r"
 /*---------------------------------------------------------------------------*/
@@ -63,17 +67,26 @@
 #define ELOG_FMT_USING_FUNC
 // #define ELOG_FMT_USING_DIR
 // #define ELOG_FMT_USING_LINE
+/* build-time format set of every level, elog_set_fmt() has no effect when it is defined.
+ * the unused format code is dropped by the compiler, it is smallest when the set is the
+ * same for all levels. comment it to set the format at run time by elog_set_fmt() */
+#define ELOG_FMT_STATIC(level)                   (ELOG_FMT_TAG | ELOG_FMT_FUNC)
 /*---------------------------------------------------------------------------*/
-/* enable asynchronous output mode */
-// #define ELOG_ASYNC_OUTPUT_ENABLE
+/* enable asynchronous output mode (deferred formatting, flushed by elog_async_flush) */
+#define ELOG_ASYNC_OUTPUT_ENABLE
 /* the highest output level for async mode, other level will sync output */
 #define ELOG_ASYNC_OUTPUT_LVL                    ELOG_LVL_ASSERT
-/* buffer size for asynchronous output mode */
-#define ELOG_ASYNC_OUTPUT_BUF_SIZE               (ELOG_LINE_BUF_SIZE * 10)
-/* each asynchronous output's log which must end with newline sign */
-#define ELOG_ASYNC_LINE_OUTPUT
-/* asynchronous output mode using POSIX pthread implementation */
-#define ELOG_ASYNC_OUTPUT_USING_PTHREAD
+/* queued log record number, must be power of 2 */
+#define ELOG_ASYNC_RECORD_NUM                    16
+/* max 32-bit argument words per async record (double/long long use 2) */
+#define ELOG_ASYNC_ARG_WORDS                     12
+/*---------------------------------------------------------------------------*/
+/* enable binary (dictionary) output: async records are sent as string addresses
+ * plus packed arguments, decode on host with Tools/elog_decode.py. need async mode.
+ * set by the CMake option FY_ELOG_BINARY, which also dumps the string table */
+// #define ELOG_BINARY_OUTPUT_ENABLE
+/* string addresses are sent as offsets from this base (flash start) */
+#define ELOG_BINARY_ADDR_BASE                    0x08000000UL
 /*---------------------------------------------------------------------------*/
 /* enable buffered output mode */
 // #define ELOG_BUF_OUTPUT_ENABLE
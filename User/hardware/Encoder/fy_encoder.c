@@ -0,0 +1,139 @@
+#include "fy_encoder.h"
+#include <string.h>
+
+void fy_encoder_reset(fy_encoder_t *enc, uint8_t mode, uint32_t raw, uint32_t now)
+{
+    enc->mode = mode;
+    enc->raw_last = raw;
+    enc->count = 0;
+    enc->updates = 0;
+    enc->vel_count = 0;
+    enc->vel_tick = now;
+    enc->velocity = 0;
+}
+
+int32_t fy_encoder_sample(fy_encoder_t *enc, uint32_t raw, uint32_t now)
+{
+    int32_t delta;
+    uint32_t dt;
+
+    //CNT为16位，按有符号差值扩展；EXTI计数为32位，同样按差值累加
+    if (enc->mode == FY_ENCODER_MODE_TIM)
+    {
+        delta = (int16_t)(uint16_t)(raw - enc->raw_last);
+    }
+    else
+    {
+        delta = (int32_t)(raw - enc->raw_last);
+    }
+    enc->raw_last = raw;
+    enc->count = (int32_t)((uint32_t)enc->count + (uint32_t)delta);
+    enc->updates++;
+
+    dt = now - enc->vel_tick;
+    if (dt >= FY_ENCODER_VEL_WINDOW_MS)
+    {
+        enc->velocity = (int32_t)((int64_t)(enc->count - enc->vel_count) * 1000 / (int64_t)dt);
+        enc->vel_count = enc->count;
+        enc->vel_tick = now;
+    }
+    return enc->count;
+}
+
+/* 索引为(上次状态<<2)|本次状态，正转0->2->3->1->0为+1，反转为-1，状态不变为0，
+   两相同时变化为QDEC_ILLEGAL */
+#define QDEC_ILLEGAL    2
+static const int8_t qdec_table[16] = {
+    0,              -1,             1,              QDEC_ILLEGAL,
+    1,              0,              QDEC_ILLEGAL,   -1,
+    -1,             QDEC_ILLEGAL,   0,              1,
+    QDEC_ILLEGAL,   1,              -1,             0,
+};
+
+void fy_encoder_exti_sync(fy_encoder_t *enc, uint8_t a, uint8_t b)
+{
+    enc->exti_state = FY_ENCODER_STATE(a, b);
+}
+
+/* 只在中断中调用(A/B两相的中断优先级相同，不会嵌套)，exti_count以单次32位写入发布 */
+static inline void qdec_step(fy_encoder_t *enc, uint8_t state)
+{
+    int8_t d = qdec_table[(enc->exti_state << 2) | state];
+
+    enc->exti_state = state;
+    enc->exti_irqs++;
+    if (d == 0)
+    {
+        enc->exti_glitch++;
+    }
+    else if (d == QDEC_ILLEGAL)
+    {
+        enc->exti_illegal++;
+    }
+    else
+    {
+        __atomic_store_n(&enc->exti_count, enc->exti_count + (uint32_t)(int32_t)d, __ATOMIC_RELEASE);
+    }
+}
+
+void fy_encoder_exti_input(fy_encoder_t *enc, uint8_t a, uint8_t b)
+{
+    qdec_step(enc, FY_ENCODER_STATE(a, b));
+}
+
+#ifndef FY_ENCODER_HOST
+int32_t fy_encoder_init_tim(fy_encoder_t *enc, TIM_HandleTypeDef *htim)
+{
+    memset(enc, 0, sizeof(fy_encoder_t));
+    enc->htim = htim;
+    if (HAL_TIM_Encoder_Start(htim, TIM_CHANNEL_ALL) != HAL_OK)
+    {
+        return -1;
+    }
+    fy_encoder_reset(enc, FY_ENCODER_MODE_TIM, __HAL_TIM_GET_COUNTER(htim), HAL_GetTick());
+    return 0;
+}
+
+int32_t fy_encoder_init_exti(fy_encoder_t *enc, GPIO_TypeDef *a_port, uint16_t a_pin,
+                             GPIO_TypeDef *b_port, uint16_t b_pin)
+{
+    memset(enc, 0, sizeof(fy_encoder_t));
+    enc->a_port = a_port;
+    enc->a_pin = a_pin;
+    enc->b_port = b_port;
+    enc->b_pin = b_pin;
+    fy_encoder_exti_sync(enc, HAL_GPIO_ReadPin(a_port, a_pin) == GPIO_PIN_SET,
+                         HAL_GPIO_ReadPin(b_port, b_pin) == GPIO_PIN_SET);
+    fy_encoder_reset(enc, FY_ENCODER_MODE_EXTI, 0, HAL_GetTick());
+    return 0;
+}
+
+void fy_encoder_exti_irq(fy_encoder_t *enc, uint16_t GPIO_Pin)
+{
+    uint32_t idr_a, idr_b;
+
+    if (enc->mode != FY_ENCODER_MODE_EXTI || (GPIO_Pin != enc->a_pin && GPIO_Pin != enc->b_pin))
+    {
+        return;
+    }
+    //两相在同一端口时一次读出，得到同一时刻的状态
+    idr_a = enc->a_port->IDR;
+    idr_b = (enc->b_port == enc->a_port) ? idr_a : enc->b_port->IDR;
+    qdec_step(enc, FY_ENCODER_STATE(idr_a & enc->a_pin, idr_b & enc->b_pin));
+}
+
+int32_t fy_encoder_update(fy_encoder_t *enc)
+{
+    uint32_t raw;
+
+    if (enc->mode == FY_ENCODER_MODE_TIM)
+    {
+        raw = __HAL_TIM_GET_COUNTER(enc->htim);
+    }
+    else
+    {
+        raw = __atomic_load_n(&enc->exti_count, __ATOMIC_ACQUIRE);
+    }
+    return fy_encoder_sample(enc, raw, HAL_GetTick());
+}
+#endif
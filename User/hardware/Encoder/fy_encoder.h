@@ -0,0 +1,106 @@
+/*
+说明
+    增量式(AB相)旋转编码器驱动，两种计数方式：
+    TIM模式(默认)：通用定时器工作在编码器接口模式(TIM_ENCODERMODE_TI12，A/B两个边沿都计数，每个周期4次)，
+        计数由硬件完成，每个边沿没有CPU开销，输入滤波由定时器的ICxFilter完成。
+        只能接在定时器的CH1/CH2上：TIM4为PB6/PB7，TIM3部分重映射为PB4/PB5(需关闭JTAG，保留SWD)。
+        此驱动不做定时器初始化，请在使用前自行初始化(MX_TIM4_Init，ARR为0xFFFF)。
+    EXTI模式(备用)：A/B两个引脚的双边沿外部中断，中断中一次读出两相电平，以(上次状态,本次状态)
+        查表得到-1/0/+1(4倍频，与TIM模式计数一致)，只在中断中写32位计数，主循环原子读取，不需要关中断。
+        抖动(毛刺)在单相上来回翻转，查表结果正负抵消；中断响应前已经恢复的毛刺读到的状态不变，计入exti_glitch；
+        两相同时变化(中断响应太慢，丢了边沿)无法判断方向，不计数，计入exti_illegal。
+        每个边沿一次中断，转速高时中断占用CPU，高速场合使用TIM模式。
+    两种方式都由fy_encoder_update周期性地把硬件(或中断中的)计数累加为32位有符号计数，
+    TIM模式的CNT只有16位，两次update之间的变化不能超过±32767(72MHz下输入滤波后的最高边沿频率
+    约500kHz，10ms调用一次有足够余量)，因此不需要溢出中断，也没有溢出中断与读取CNT之间的竞争。
+    速度为每FY_ENCODER_VEL_WINDOW_MS以上的窗口内的平均值，单位为计数/秒。
+
+移植:
+    计数与测速的核心(fy_encoder_sample/fy_encoder_exti_input)只依赖传入的原始值，
+    主机上定义FY_ENCODER_HOST编译，由调用者提供CNT与引脚电平
+    (见Tools/encoder_sim.c，以及用记录的边沿序列测试解码的Tools/encoder_qdec_test.c)。
+
+使用方法：
+    fy_encoder_t enc;
+    fy_encoder_init_tim(&enc, &htim4);  或  fy_encoder_init_exti(&enc, GPIOB, GPIO_PIN_0, GPIOB, GPIO_PIN_1);
+    EXTI模式在HAL_GPIO_EXTI_Callback中调用fy_encoder_exti_irq(&enc, GPIO_Pin)
+    每10ms调用fy_encoder_update(&enc)，之后用fy_encoder_get_count/fy_encoder_get_velocity读取
+*/
+#ifndef __FY_ENCODER_H
+#define __FY_ENCODER_H
+
+#include <stdint.h>
+
+#ifndef FY_ENCODER_HOST
+#include "main.h"
+#endif
+
+#ifndef FY_ENCODER_VEL_WINDOW_MS
+#define FY_ENCODER_VEL_WINDOW_MS    20      //测速窗口最小长度
+#endif
+
+#define FY_ENCODER_MODE_TIM     0
+#define FY_ENCODER_MODE_EXTI    1
+
+/* 两相电平组成的状态，正转(A领先)为0->2->3->1->0 */
+#define FY_ENCODER_STATE(a, b)  ((uint8_t)(((a) ? 2U : 0U) | ((b) ? 1U : 0U)))
+
+typedef struct fy_encoder {
+    //硬件
+    uint8_t mode;//FY_ENCODER_MODE_TIM/FY_ENCODER_MODE_EXTI
+#ifndef FY_ENCODER_HOST
+    TIM_HandleTypeDef *htim;
+    GPIO_TypeDef *a_port;
+    GPIO_TypeDef *b_port;
+    uint16_t a_pin;
+    uint16_t b_pin;
+#endif
+    //EXTI模式，只在中断中写
+    uint8_t exti_state;//上次的两相状态
+    uint32_t exti_count;//4倍频计数，按差值使用，回绕无影响
+    uint32_t exti_irqs;//中断次数
+    uint32_t exti_glitch;//状态未变化的中断(毛刺)
+    uint32_t exti_illegal;//两相同时变化(丢失边沿)
+    //计数
+    uint32_t raw_last;//上次update时的CNT(TIM)或exti_count(EXTI)
+    int32_t count;//32位扩展计数
+    uint32_t updates;
+    //测速
+    int32_t vel_count;//窗口起点的计数
+    uint32_t vel_tick;//窗口起点时刻(ms)
+    int32_t velocity;//计数/秒
+} fy_encoder_t;
+
+/* 核心(与硬件无关) */
+/* 以原始值raw(TIM模式为CNT，EXTI模式为exti_count)与时刻now(ms)复位计数与测速窗口 */
+void fy_encoder_reset(fy_encoder_t *enc, uint8_t mode, uint32_t raw, uint32_t now);
+/* 累加raw相对上次的变化，窗口到期时更新速度，返回当前计数 */
+int32_t fy_encoder_sample(fy_encoder_t *enc, uint32_t raw, uint32_t now);
+/* EXTI模式：以当前两相电平设置初始状态，不计数 */
+void fy_encoder_exti_sync(fy_encoder_t *enc, uint8_t a, uint8_t b);
+/* EXTI模式的一次边沿中断，a/b为中断中读到的电平 */
+void fy_encoder_exti_input(fy_encoder_t *enc, uint8_t a, uint8_t b);
+
+static inline int32_t fy_encoder_get_count(const fy_encoder_t *enc)
+{
+    return enc->count;
+}
+
+static inline int32_t fy_encoder_get_velocity(const fy_encoder_t *enc)
+{
+    return enc->velocity;
+}
+
+#ifndef FY_ENCODER_HOST
+/* 启动定时器编码器接口，成功返回0 */
+int32_t fy_encoder_init_tim(fy_encoder_t *enc, TIM_HandleTypeDef *htim);
+/* 使用A/B两个引脚的双边沿外部中断，引脚与NVIC需已配置(MX_GPIO_Init) */
+int32_t fy_encoder_init_exti(fy_encoder_t *enc, GPIO_TypeDef *a_port, uint16_t a_pin,
+                             GPIO_TypeDef *b_port, uint16_t b_pin);
+/* 在HAL_GPIO_EXTI_Callback中调用，不是本编码器的引脚时直接返回 */
+void fy_encoder_exti_irq(fy_encoder_t *enc, uint16_t GPIO_Pin);
+/* 读取CNT(或中断计数)与HAL_GetTick，更新计数与速度，返回当前计数 */
+int32_t fy_encoder_update(fy_encoder_t *enc);
+#endif
+
+#endif
@@ -6,6 +6,10 @@
 #define	MPU6050_CONFIG			0x1A
 #define	MPU6050_GYRO_CONFIG		0x1B
 #define	MPU6050_ACCEL_CONFIG	0x1C
+#define	MPU6050_FIFO_EN			0x23
+#define	MPU6050_INT_PIN_CFG		0x37
+#define	MPU6050_INT_ENABLE		0x38
+#define	MPU6050_INT_STATUS		0x3A
 
 #define	MPU6050_ACCEL_XOUT_H	0x3B
 #define	MPU6050_ACCEL_XOUT_L	0x3C
@@ -22,8 +26,12 @@
 #define	MPU6050_GYRO_ZOUT_H		0x47
 #define	MPU6050_GYRO_ZOUT_L		0x48
 
+#define	MPU6050_USER_CTRL		0x6A
 #define	MPU6050_PWR_MGMT_1		0x6B
 #define	MPU6050_PWR_MGMT_2		0x6C
+#define	MPU6050_FIFO_COUNTH		0x72
+#define	MPU6050_FIFO_COUNTL		0x73
+#define	MPU6050_FIFO_R_W		0x74
 #define	MPU6050_WHO_AM_I		0x75
 
 #endif
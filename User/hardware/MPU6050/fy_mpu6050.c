@@ -0,0 +1,396 @@
+#include "fy_mpu6050.h"
+#include <string.h>
+
+/* Private variables ---------------------------------------------------------*/
+/* 每个I2C外设记录当前占用总线的器件，完成回调只拿到I2C句柄。
+   I2C1/I2C2基地址在bit10不同，(Instance >> 10) & 1 即为槽位。 */
+#define MPU_BUS_SLOTS           2U
+static fy_mpu6050_t *bus_active[MPU_BUS_SLOTS] = {0};
+
+#define FY_MPU6050_TIMEOUT      100     //阻塞读写超时(ms)，仅用于初始化和FIFO启停
+
+/* USER_CTRL / FIFO_EN / INT_ENABLE 位定义 */
+#define MPU_USER_CTRL_FIFO_EN       0x40
+#define MPU_USER_CTRL_FIFO_RESET    0x04
+#define MPU_FIFO_EN_TEMP_GYRO_ACCEL 0xF8    //TEMP|XG|YG|ZG|ACCEL，FIFO中顺序与寄存器顺序相同
+#define MPU_INT_DATA_RDY_EN         0x01
+#define MPU_INT_FIFO_OFLOW_EN       0x10
+
+/* FIFO中能容纳的完整帧数，FIFO_COUNT超过该值说明已经溢出，帧边界不再可信 */
+#define MPU_FIFO_MAX_FRAMES     (FY_MPU6050_FIFO_SIZE / FY_MPU6050_BURST_LEN)
+
+#define FY_MPU6050_ENTER_CRITICAL()    uint32_t primask_ = __get_PRIMASK(); __disable_irq()
+#define FY_MPU6050_EXIT_CRITICAL()     __set_PRIMASK(primask_)
+
+/* 初始化写入的配置：时钟源PLL X轴，10分频采样，5Hz低通，陀螺仪±2000dps，加速度±16g */
+static const uint8_t mpu6050_init_regs[][2] = {
+    {MPU6050_PWR_MGMT_1,   0x01},
+    {MPU6050_PWR_MGMT_2,   0x00},
+    {MPU6050_SMPLRT_DIV,   0x09},
+    {MPU6050_CONFIG,       0x06},
+    {MPU6050_GYRO_CONFIG,  0x18},
+    {MPU6050_ACCEL_CONFIG, 0x18},
+};
+
+/* Private functions ---------------------------------------------------------*/
+static inline uint32_t bus_slot(const I2C_HandleTypeDef *hi2c)
+{
+    return ((uint32_t)(uintptr_t)hi2c->Instance >> 10) & (MPU_BUS_SLOTS - 1U);
+}
+
+static inline int16_t be16(const uint8_t *p)
+{
+    return (int16_t)(((uint16_t)p[0] << 8) | p[1]);
+}
+
+/* 占用总线，失败说明该I2C外设上已有操作在进行 */
+static int32_t bus_claim(fy_mpu6050_t *mpu, fy_mpu6050_op_t op)
+{
+    uint32_t slot = bus_slot(mpu->hi2c);
+
+    FY_MPU6050_ENTER_CRITICAL();
+    if (bus_active[slot] != NULL) {
+        FY_MPU6050_EXIT_CRITICAL();
+        return -1;
+    }
+    bus_active[slot] = mpu;
+    mpu->busy = 1;
+    mpu->op = op;
+    FY_MPU6050_EXIT_CRITICAL();
+    return 0;
+}
+
+static void bus_release(fy_mpu6050_t *mpu)
+{
+    mpu->op = FY_MPU6050_OP_IDLE;
+    mpu->busy = 0;
+    bus_active[bus_slot(mpu->hi2c)] = NULL;
+}
+
+static void mpu6050_finish(fy_mpu6050_t *mpu, int32_t status)
+{
+    if (status != 0) {
+        mpu->error_count++;
+    }
+    bus_release(mpu);
+    if (mpu->done) {
+        mpu->done(mpu, status, mpu->arg);
+    }
+}
+
+static void fifo_read_count(fy_mpu6050_t *mpu)
+{
+    mpu->op = FY_MPU6050_OP_FIFO_COUNT;
+    if (HAL_I2C_Mem_Read_IT(mpu->hi2c, mpu->addr, MPU6050_FIFO_COUNTH, I2C_MEMADD_SIZE_8BIT,
+            mpu->rx_buf, 2) != HAL_OK) {
+        mpu6050_finish(mpu, -1);
+    }
+}
+
+/* FIFO溢出：复位FIFO，完成后重新同步时间戳 */
+static void fifo_reset(fy_mpu6050_t *mpu)
+{
+    mpu->fifo_overflow_count++;
+    mpu->op = FY_MPU6050_OP_FIFO_RESET;
+    mpu->fifo_cmd = MPU_USER_CTRL_FIFO_EN | MPU_USER_CTRL_FIFO_RESET;
+    if (HAL_I2C_Mem_Write_IT(mpu->hi2c, mpu->addr, MPU6050_USER_CTRL, I2C_MEMADD_SIZE_8BIT,
+            &mpu->fifo_cmd, 1) != HAL_OK) {
+        mpu6050_finish(mpu, -1);
+    }
+}
+
+static void fifo_count_done(fy_mpu6050_t *mpu)
+{
+    uint16_t count = (uint16_t)(((uint16_t)mpu->rx_buf[0] << 8) | mpu->rx_buf[1]);
+    uint16_t frames = count / FY_MPU6050_BURST_LEN;
+
+    if (count > MPU_FIFO_MAX_FRAMES * FY_MPU6050_BURST_LEN) {
+        fifo_reset(mpu);
+        return;
+    }
+    if (frames == 0) {
+        mpu6050_finish(mpu, 0);
+        return;
+    }
+    //只读完整帧，正在写入的半帧留到下次
+    mpu->fifo_pending = (frames > FY_MPU6050_FIFO_BATCH_MAX) ? FY_MPU6050_FIFO_BATCH_MAX : frames;
+    mpu->fifo_left = frames - mpu->fifo_pending;
+    mpu->op = FY_MPU6050_OP_FIFO_DATA;
+    if (HAL_I2C_Mem_Read_IT(mpu->hi2c, mpu->addr, MPU6050_FIFO_R_W, I2C_MEMADD_SIZE_8BIT,
+            mpu->fifo_buf, mpu->fifo_pending * FY_MPU6050_BURST_LEN) != HAL_OK) {
+        mpu6050_finish(mpu, -1);
+    }
+}
+
+static void fy_mpu6050_rx_cplt_callback(I2C_HandleTypeDef *hi2c)
+{
+    fy_mpu6050_t *mpu = bus_active[bus_slot(hi2c)];
+
+    if (mpu == NULL || mpu->hi2c != hi2c) return;
+
+    switch (mpu->op) {
+    case FY_MPU6050_OP_SAMPLE:
+        fy_mpu6050_parse_frame(mpu->rx_buf, &mpu->sample);
+        mpu->timestamp = HAL_GetTick();
+        mpu->read_count++;
+        mpu->ready = 1;
+        mpu6050_finish(mpu, 0);
+        break;
+    case FY_MPU6050_OP_FIFO_COUNT:
+        fifo_count_done(mpu);
+        break;
+    case FY_MPU6050_OP_FIFO_DATA:
+        fy_mpu6050_fifo_parse(mpu, mpu->fifo_buf, mpu->fifo_pending * FY_MPU6050_BURST_LEN);
+        mpu->read_count++;
+        //FIFO中还有数据，不释放总线继续读取
+        if (mpu->fifo_left > 0) {
+            fifo_read_count(mpu);
+        } else {
+            mpu6050_finish(mpu, 0);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void fy_mpu6050_tx_cplt_callback(I2C_HandleTypeDef *hi2c)
+{
+    fy_mpu6050_t *mpu = bus_active[bus_slot(hi2c)];
+
+    if (mpu == NULL || mpu->hi2c != hi2c) return;
+
+    if (mpu->op == FY_MPU6050_OP_FIFO_RESET) {
+        mpu->fifo_t0_us = HAL_GetTick() * 1000U;
+        mpu->fifo_seq = 0;
+        mpu6050_finish(mpu, 0);
+    }
+}
+
+static void fy_mpu6050_error_callback(I2C_HandleTypeDef *hi2c)
+{
+    fy_mpu6050_t *mpu = bus_active[bus_slot(hi2c)];
+
+    if (mpu == NULL || mpu->hi2c != hi2c) return;
+
+    mpu6050_finish(mpu, -1);
+}
+
+static int32_t write_reg(fy_mpu6050_t *mpu, uint8_t reg, uint8_t value)
+{
+    return (HAL_I2C_Mem_Write(mpu->hi2c, mpu->addr, reg, I2C_MEMADD_SIZE_8BIT, &value, 1,
+            FY_MPU6050_TIMEOUT) == HAL_OK) ? 0 : -1;
+}
+
+/* Exported functions --------------------------------------------------------*/
+int32_t fy_mpu6050_init(fy_mpu6050_t *mpu, I2C_HandleTypeDef *hi2c, uint16_t addr, fy_mpu6050_done_fn_t done, void *arg)
+{
+    size_t i;
+
+    if (mpu == NULL || hi2c == NULL) {
+        return -1;
+    }
+    memset(mpu, 0, sizeof(fy_mpu6050_t));
+    mpu->hi2c = hi2c;
+    mpu->addr = addr;
+    mpu->done = done;
+    mpu->arg = arg;
+
+    //初始化阶段允许阻塞
+    for (i = 0; i < sizeof(mpu6050_init_regs) / sizeof(mpu6050_init_regs[0]); i++) {
+        if (write_reg(mpu, mpu6050_init_regs[i][0], mpu6050_init_regs[i][1]) != 0) {
+            return -1;
+        }
+    }
+    if (HAL_I2C_Mem_Read(hi2c, addr, MPU6050_WHO_AM_I, I2C_MEMADD_SIZE_8BIT, &mpu->id, 1, FY_MPU6050_TIMEOUT) != HAL_OK) {
+        return -1;
+    }
+    if (mpu->id != FY_MPU6050_ID) {
+        return -1;
+    }
+
+    if (HAL_I2C_RegisterCallback(hi2c, HAL_I2C_MEM_RX_COMPLETE_CB_ID, fy_mpu6050_rx_cplt_callback) != HAL_OK) {
+        return -1;
+    }
+    if (HAL_I2C_RegisterCallback(hi2c, HAL_I2C_MEM_TX_COMPLETE_CB_ID, fy_mpu6050_tx_cplt_callback) != HAL_OK) {
+        return -1;
+    }
+    if (HAL_I2C_RegisterCallback(hi2c, HAL_I2C_ERROR_CB_ID, fy_mpu6050_error_callback) != HAL_OK) {
+        return -1;
+    }
+    return 0;
+}
+
+int32_t fy_mpu6050_deinit(fy_mpu6050_t *mpu)
+{
+    if (mpu == NULL || mpu->hi2c == NULL) {
+        return -1;
+    }
+    if (mpu->busy) {
+        HAL_I2C_Master_Abort_IT(mpu->hi2c, mpu->addr);
+        bus_release(mpu);
+    }
+    mpu->fifo_rb = NULL;
+    HAL_I2C_UnRegisterCallback(mpu->hi2c, HAL_I2C_MEM_RX_COMPLETE_CB_ID);
+    HAL_I2C_UnRegisterCallback(mpu->hi2c, HAL_I2C_MEM_TX_COMPLETE_CB_ID);
+    HAL_I2C_UnRegisterCallback(mpu->hi2c, HAL_I2C_ERROR_CB_ID);
+    mpu->hi2c = NULL;
+    return 0;
+}
+
+/* 发起一次14字节突发读，立即返回；总线忙或I2C未就绪返回-1 */
+int32_t fy_mpu6050_read_start(fy_mpu6050_t *mpu)
+{
+    if (mpu == NULL || mpu->hi2c == NULL) {
+        return -1;
+    }
+    if (bus_claim(mpu, FY_MPU6050_OP_SAMPLE) != 0) {
+        return -1;
+    }
+    if (HAL_I2C_Mem_Read_IT(mpu->hi2c, mpu->addr, MPU6050_ACCEL_XOUT_H, I2C_MEMADD_SIZE_8BIT,
+            mpu->rx_buf, FY_MPU6050_BURST_LEN) != HAL_OK) {
+        bus_release(mpu);
+        mpu->error_count++;
+        return -1;
+    }
+    return 0;
+}
+
+/* 取走最新数据，没有新数据返回-1；timestamp可为NULL */
+int32_t fy_mpu6050_get_sample(fy_mpu6050_t *mpu, fy_mpu6050_sample_t *out, uint32_t *timestamp)
+{
+    int32_t ret = -1;
+
+    if (mpu == NULL || out == NULL) {
+        return -1;
+    }
+    FY_MPU6050_ENTER_CRITICAL();
+    if (mpu->ready) {
+        *out = mpu->sample;
+        if (timestamp) *timestamp = mpu->timestamp;
+        mpu->ready = 0;
+        ret = 0;
+    }
+    FY_MPU6050_EXIT_CRITICAL();
+    return ret;
+}
+
+/* 解析一帧14字节数据(高字节在前)：加速度、温度、陀螺仪 */
+void fy_mpu6050_parse_frame(const uint8_t *frame, fy_mpu6050_sample_t *out)
+{
+    out->acc_x  = be16(frame + 0);
+    out->acc_y  = be16(frame + 2);
+    out->acc_z  = be16(frame + 4);
+    out->temp   = be16(frame + 6);
+    out->gyro_x = be16(frame + 8);
+    out->gyro_y = be16(frame + 10);
+    out->gyro_z = be16(frame + 12);
+}
+
+/* 开启FIFO流模式，阻塞写配置，不能在中断中调用
+   rate_div: SMPLRT_DIV，低通开启时采样率为1kHz/(1+rate_div)
+   sample_rb: 用ringBuffer_init_spsc初始化的样本环形缓冲区 */
+int32_t fy_mpu6050_fifo_start(fy_mpu6050_t *mpu, ringBuffer_t *sample_rb, uint8_t rate_div)
+{
+    int32_t ret = 0;
+
+    if (mpu == NULL || mpu->hi2c == NULL || sample_rb == NULL || !sample_rb->spsc) {
+        return -1;
+    }
+    if (bus_claim(mpu, FY_MPU6050_OP_FIFO_RESET) != 0) {
+        return -1;
+    }
+    ret |= write_reg(mpu, MPU6050_INT_ENABLE, 0x00);
+    ret |= write_reg(mpu, MPU6050_FIFO_EN, 0x00);
+    ret |= write_reg(mpu, MPU6050_USER_CTRL, MPU_USER_CTRL_FIFO_RESET);
+    ret |= write_reg(mpu, MPU6050_SMPLRT_DIV, rate_div);
+    ret |= write_reg(mpu, MPU6050_FIFO_EN, MPU_FIFO_EN_TEMP_GYRO_ACCEL);
+    ret |= write_reg(mpu, MPU6050_USER_CTRL, MPU_USER_CTRL_FIFO_EN);
+    ret |= write_reg(mpu, MPU6050_INT_ENABLE, MPU_INT_DATA_RDY_EN | MPU_INT_FIFO_OFLOW_EN);
+    if (ret == 0) {
+        mpu->fifo_period_us = 1000U * (1U + rate_div);
+        mpu->fifo_t0_us = HAL_GetTick() * 1000U;
+        mpu->fifo_seq = 0;
+        mpu->fifo_rb = sample_rb;
+    }
+    bus_release(mpu);
+    return ret;
+}
+
+/* 关闭FIFO流模式，排空进行中时返回-1，稍后重试 */
+int32_t fy_mpu6050_fifo_stop(fy_mpu6050_t *mpu)
+{
+    int32_t ret = 0;
+
+    if (mpu == NULL || mpu->hi2c == NULL) {
+        return -1;
+    }
+    if (bus_claim(mpu, FY_MPU6050_OP_FIFO_RESET) != 0) {
+        return -1;
+    }
+    mpu->fifo_rb = NULL;
+    ret |= write_reg(mpu, MPU6050_INT_ENABLE, 0x00);
+    ret |= write_reg(mpu, MPU6050_FIFO_EN, 0x00);
+    ret |= write_reg(mpu, MPU6050_USER_CTRL, MPU_USER_CTRL_FIFO_RESET);
+    bus_release(mpu);
+    return ret;
+}
+
+/* 发起一次FIFO排空，可在INT引脚的EXTI回调或主循环中调用
+   未开启流模式或总线忙(上一次排空还在进行)时返回-1 */
+int32_t fy_mpu6050_fifo_service(fy_mpu6050_t *mpu)
+{
+    if (mpu == NULL || mpu->hi2c == NULL || mpu->fifo_rb == NULL) {
+        return -1;
+    }
+    if (bus_claim(mpu, FY_MPU6050_OP_FIFO_COUNT) != 0) {
+        return -1;
+    }
+    fifo_read_count(mpu);
+    return 0;
+}
+
+/* 解析FIFO数据中的完整帧并写入样本环形缓冲区，返回写入的样本数
+   时间戳按 t0 + 帧序号 * 采样周期 递推，不受排空时刻抖动影响 */
+size_t fy_mpu6050_fifo_parse(fy_mpu6050_t *mpu, const uint8_t *data, size_t len)
+{
+    ringBuffer_t *rb = mpu->fifo_rb;
+    fy_mpu6050_record_t rec;
+    size_t n = 0;
+
+    if (rb == NULL) {
+        return 0;
+    }
+    for (; len >= FY_MPU6050_BURST_LEN; data += FY_MPU6050_BURST_LEN, len -= FY_MPU6050_BURST_LEN) {
+        rec.timestamp_us = mpu->fifo_t0_us + mpu->fifo_seq * mpu->fifo_period_us;
+        mpu->fifo_seq++;
+        if (rb->size - rb->used(rb) < sizeof(rec)) {
+            mpu->fifo_dropped++;
+            continue;
+        }
+        fy_mpu6050_parse_frame(data, &rec.sample);
+        rb->write(rb, (const uint8_t *)&rec, sizeof(rec));
+        n++;
+    }
+    mpu->fifo_samples += n;
+    return n;
+}
+
+/* 从样本环形缓冲区取出最多max条记录，返回取出的条数 */
+size_t fy_mpu6050_fifo_read(fy_mpu6050_t *mpu, fy_mpu6050_record_t *out, size_t max)
+{
+    ringBuffer_t *rb;
+    size_t i;
+
+    if (mpu == NULL || out == NULL || mpu->fifo_rb == NULL) {
+        return 0;
+    }
+    rb = mpu->fifo_rb;
+    for (i = 0; i < max; i++) {
+        if (rb->used(rb) < sizeof(fy_mpu6050_record_t)) {
+            break;
+        }
+        rb->read(rb, (uint8_t *)&out[i], sizeof(fy_mpu6050_record_t));
+    }
+    return i;
+}
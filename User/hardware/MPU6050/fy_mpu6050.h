@@ -0,0 +1,111 @@
+/*
+说明
+    MPU6050驱动，此驱动不做I2C硬件初始化，请在使用前自行初始化(MX_I2C2_Init)。
+    需要使能I2C事件与错误中断(I2Cx_EV_IRQn/I2Cx_ER_IRQn)。
+    初始化时阻塞写入配置寄存器并校验WHO_AM_I，之后每次采样只发起一次
+    从ACCEL_XOUT_H开始的14字节突发读(加速度、温度、陀螺仪)，中断方式完成，不阻塞主循环。
+    F103上I2C2的DMA通道(CH4/CH5)已被USART1占用，所以使用IT方式。
+
+使用方法：
+    定义fy_mpu6050_t，调用fy_mpu6050_init绑定I2C句柄
+    周期调用fy_mpu6050_read_start发起读取，完成后在I2C中断中调用done回调
+    主循环调用fy_mpu6050_get_sample取最新数据，没有新数据时返回-1
+    每个I2C外设同一时刻只能有一个读取在进行，总线忙时fy_mpu6050_read_start返回-1
+
+FIFO流模式:
+    fy_mpu6050_fifo_start打开传感器内部FIFO(加速度+温度+陀螺仪，每帧14字节)与数据就绪中断，
+    之后调用fy_mpu6050_fifo_service(INT引脚的EXTI回调中或主循环中定时调用)发起一次排空：
+    先读FIFO_COUNT，再一次突发读出最多FY_MPU6050_FIFO_BATCH_MAX帧，解析后写入样本环形缓冲区，
+    FIFO中还有剩余时在中断中继续读取。
+    样本环形缓冲区需用ringBuffer_init_spsc初始化(中断写、主循环读)，元素为fy_mpu6050_record_t，
+    主循环用fy_mpu6050_fifo_read取出。
+    FIFO溢出(1024字节)或帧不对齐时复位FIFO，fifo_overflow_count自增，时间戳重新同步；
+    样本环形缓冲区满时丢弃新样本，fifo_dropped自增。
+    1kHz采样每秒约14KB数据，I2C需工作在400kHz快速模式。
+*/
+#ifndef __FY_MPU6050_H
+#define __FY_MPU6050_H
+
+#include "i2c.h"
+#include "MPU6050_Reg.h"
+#include "fy_ringBuffer.h"
+
+#define FY_MPU6050_ID           0x68    //WHO_AM_I的值
+#define FY_MPU6050_BURST_LEN    14      //ACCEL_XOUT_H ~ GYRO_ZOUT_L
+#define FY_MPU6050_FIFO_SIZE    1024    //传感器内部FIFO大小
+
+#ifndef FY_MPU6050_FIFO_BATCH_MAX
+#define FY_MPU6050_FIFO_BATCH_MAX   32  //一次突发读出的最大帧数
+#endif
+
+typedef struct fy_mpu6050 fy_mpu6050_t;
+
+/* 一次采样的原始数据 */
+typedef struct {
+    int16_t acc_x;
+    int16_t acc_y;
+    int16_t acc_z;
+    int16_t temp;
+    int16_t gyro_x;
+    int16_t gyro_y;
+    int16_t gyro_z;
+} fy_mpu6050_sample_t;
+
+/* FIFO流模式写入样本环形缓冲区的记录 */
+typedef struct {
+    uint32_t timestamp_us;//采样时刻，按采样周期递推
+    fy_mpu6050_sample_t sample;
+} fy_mpu6050_record_t;
+
+/* 读取完成回调，在I2C中断中执行，status: 0成功，-1 I2C错误 */
+typedef void (*fy_mpu6050_done_fn_t)(fy_mpu6050_t *mpu, int32_t status, void *arg);
+
+/* 当前进行中的I2C操作 */
+typedef enum {
+    FY_MPU6050_OP_IDLE = 0,
+    FY_MPU6050_OP_SAMPLE,       //14字节寄存器突发读
+    FY_MPU6050_OP_FIFO_COUNT,   //读FIFO_COUNT
+    FY_MPU6050_OP_FIFO_DATA,    //读FIFO数据
+    FY_MPU6050_OP_FIFO_RESET,   //复位FIFO
+} fy_mpu6050_op_t;
+
+typedef struct fy_mpu6050 {
+    //成员
+    I2C_HandleTypeDef *hi2c;
+    uint16_t addr;//8位器件地址
+    uint8_t id;//WHO_AM_I
+    uint8_t rx_buf[FY_MPU6050_BURST_LEN];//突发读缓冲区
+    volatile uint8_t busy;//I2C操作进行中
+    volatile uint8_t ready;//有未取走的新数据
+    fy_mpu6050_op_t op;
+    fy_mpu6050_sample_t sample;//最新数据
+    uint32_t timestamp;//最新数据完成时的tick
+    uint32_t read_count;
+    uint32_t error_count;
+    fy_mpu6050_done_fn_t done;
+    void *arg;
+    //FIFO流模式
+    ringBuffer_t *fifo_rb;//样本环形缓冲区，NULL表示未开启
+    uint8_t fifo_buf[FY_MPU6050_FIFO_BATCH_MAX * FY_MPU6050_BURST_LEN];
+    uint8_t fifo_cmd;//复位FIFO时写入USER_CTRL的值
+    uint16_t fifo_pending;//本次读取的帧数
+    uint16_t fifo_left;//读取后FIFO中剩余的帧数
+    uint32_t fifo_period_us;//采样周期
+    uint32_t fifo_t0_us;//第0帧的时间
+    uint32_t fifo_seq;//自t0以来的帧数
+    uint32_t fifo_samples;//写入环形缓冲区的样本数
+    uint32_t fifo_dropped;//环形缓冲区满丢弃的样本数
+    uint32_t fifo_overflow_count;//FIFO溢出/不对齐复位次数
+} fy_mpu6050_t;
+
+int32_t fy_mpu6050_init(fy_mpu6050_t *mpu, I2C_HandleTypeDef *hi2c, uint16_t addr, fy_mpu6050_done_fn_t done, void *arg);
+int32_t fy_mpu6050_deinit(fy_mpu6050_t *mpu);
+int32_t fy_mpu6050_read_start(fy_mpu6050_t *mpu);
+int32_t fy_mpu6050_get_sample(fy_mpu6050_t *mpu, fy_mpu6050_sample_t *out, uint32_t *timestamp);
+void fy_mpu6050_parse_frame(const uint8_t *frame, fy_mpu6050_sample_t *out);
+int32_t fy_mpu6050_fifo_start(fy_mpu6050_t *mpu, ringBuffer_t *sample_rb, uint8_t rate_div);
+int32_t fy_mpu6050_fifo_stop(fy_mpu6050_t *mpu);
+int32_t fy_mpu6050_fifo_service(fy_mpu6050_t *mpu);
+size_t fy_mpu6050_fifo_parse(fy_mpu6050_t *mpu, const uint8_t *data, size_t len);
+size_t fy_mpu6050_fifo_read(fy_mpu6050_t *mpu, fy_mpu6050_record_t *out, size_t max);
+#endif